@@ -1,15 +1,25 @@
 module;
 
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
 #include <fstream>
 #include <memory>
 #include <mutex>
 #include <queue>
+#include <span>
 #include <stdexcept>
 #include <string>
 #include <string_view>
 #include <utility>
+#include <unistd.h>
 #include <vector>
 
+#ifdef MINI_REDIS_HAVE_IO_URING
+#include <liburing.h>
+#endif
+
 export module aof;
 
 import logger;
@@ -29,17 +39,46 @@ public:
     Aof &operator=(const Aof&) = delete;
 
     explicit Aof(std::string filename, AofSyncStrategy sync_strategy = AofSyncStrategy::ALWAYS);
+    ~Aof();
+    // 改用 io_uring 写文件：IORING_OP_WRITE 与 FSYNC 链接提交，一次系统调用完成写入和刷盘。
+    // 未编译 io_uring 支持或初始化失败时返回 false，继续使用文件流
+    bool enable_io_uring();
     void fsync_async();                           // 异步刷盘
+    // 每轮事件循环等待之前调用：本轮追加的命令一次写出，always 策略下同时刷盘。
+    // 未启用 io_uring 时文件流在追加时已经写出，这里什么都不做
+    void flush_pending();
     void append(const resp::RespValue &command);  // 追加命令
+    void append(std::span<const std::string_view> argv); // 追加请求参数形式的命令
     std::vector<resp::RespValue> load_commands(); // 加载命令
 
 private:
+    void append_serialized(std::string_view serialized_command); // 写入已序列化的命令
+
     std::string filename_; // 文件名
     std::ofstream file_;   // 写入文件的文件流
     AofSyncStrategy sync_strategy_; // 同步策略
 
     std::mutex buffer_mutex_;       // 保护缓冲区的互斥锁
     bool has_pending_sync_ = false; // 是否有待同步的数据
+
+#ifdef MINI_REDIS_HAVE_IO_URING
+    // 取出积压的数据写入文件，sync 为 true 时在同一条链上追加 fsync；写入失败的剩余数据放回缓冲区
+    void flush_uring(bool sync);
+    // 同 flush_uring，调用方已持有 uring_mutex_
+    void flush_uring_locked(bool sync);
+    // 写入 data，sync 为 true 时写完后刷盘。written 为写入的字节数，全部写入（并刷盘）时返回 true
+    bool write_uring(std::string_view data, bool sync, size_t &written);
+
+    std::mutex uring_mutex_;    // 串行化 ring_ 上的提交，保证各事件循环取出的数据按追加顺序落盘
+    io_uring ring_;             // AOF 专用的 io_uring 实例
+    bool uring_enabled_ = false; // 是否已启用 io_uring
+    int uring_fd_ = -1;          // 以追加模式打开的文件描述符
+    std::string uring_pending_;  // 尚未提交的命令数据
+    // 追加的命令按顺序编号。appended_seq_ 为最后追加的编号，synced_seq_ 之前（含）的命令都已写入并刷盘。
+    // 两者都由 buffer_mutex_ 保护
+    uint64_t appended_seq_ = 0;
+    uint64_t synced_seq_ = 0;
+#endif
 };
 
 Aof::Aof(std::string filename, AofSyncStrategy sync_strategy) // 传入需要写入的文件名和同步策略
@@ -58,13 +97,170 @@ Aof::Aof(std::string filename, AofSyncStrategy sync_strategy) // 传入需要写
                                                             : "no");
 }
 
+Aof::~Aof() {
+#ifdef MINI_REDIS_HAVE_IO_URING
+    if (uring_enabled_) {
+        flush_uring(true);
+        io_uring_queue_exit(&ring_);
+        close(uring_fd_);
+    }
+#endif
+}
+
+bool Aof::enable_io_uring() {
+#ifdef MINI_REDIS_HAVE_IO_URING
+    std::lock_guard<std::mutex> lock(buffer_mutex_);
+    if (uring_enabled_) {
+        return true;
+    }
+    uring_fd_ = open(filename_.c_str(), O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0644);
+    if (uring_fd_ < 0) {
+        LOG_ERROR("AOF 打开文件失败: {}", strerror(errno));
+        return false;
+    }
+    int ret = io_uring_queue_init(8, &ring_, 0);
+    if (ret < 0) {
+        LOG_WARN("AOF 初始化 io_uring 失败: {}，继续使用文件流", strerror(-ret));
+        close(uring_fd_);
+        uring_fd_ = -1;
+        return false;
+    }
+    // 之后的写入全部经由 io_uring，文件流中残留的数据先写出，保证顺序
+    file_.flush();
+    uring_enabled_ = true;
+    LOG_INFO("AOF 使用 io_uring 写入");
+    return true;
+#else
+    LOG_WARN("未编译 io_uring 支持，AOF 继续使用文件流");
+    return false;
+#endif
+}
+
+#ifdef MINI_REDIS_HAVE_IO_URING
+void Aof::flush_uring(bool sync) {
+    // 先取得 ring 的锁再取出数据，多个事件循环同时刷写时数据仍按追加顺序写入。
+    // 取出后立即释放缓冲区锁，其他事件循环追加命令时不必等待磁盘 I/O
+    std::lock_guard<std::mutex> ring_lock(uring_mutex_);
+    flush_uring_locked(sync);
+}
+
+void Aof::flush_uring_locked(bool sync) {
+    std::string data;
+    uint64_t seq = 0;
+    {
+        std::lock_guard<std::mutex> lock(buffer_mutex_);
+        data.swap(uring_pending_);
+        seq = appended_seq_;
+    }
+    if (data.empty() && !sync) {
+        return;
+    }
+    size_t written = 0;
+    bool ok = write_uring(data, sync, written);
+    std::lock_guard<std::mutex> lock(buffer_mutex_);
+    if (written < data.size()) {
+        uring_pending_.insert(0, data, written);
+    }
+    if (ok && sync) {
+        synced_seq_ = seq;
+    }
+}
+
+bool Aof::write_uring(std::string_view data, bool sync, size_t &written) {
+    written = 0;
+    while (written < data.size() || sync) {
+        unsigned submitted = 0;
+        if (written < data.size()) {
+            io_uring_sqe *sqe = io_uring_get_sqe(&ring_);
+            // offset 为 -1 表示使用文件当前位置，配合 O_APPEND 追加到末尾
+            io_uring_prep_write(sqe, uring_fd_, data.data() + written,
+                                data.size() - written, static_cast<__u64>(-1));
+            sqe->user_data = 0;
+            if (sync) {
+                // 写入与刷盘链接在一起：写入完整成功后才执行 fsync，短写会取消后续的 fsync
+                sqe->flags |= IOSQE_IO_LINK;
+            }
+            ++submitted;
+        }
+        if (sync) {
+            io_uring_sqe *sqe = io_uring_get_sqe(&ring_);
+            io_uring_prep_fsync(sqe, uring_fd_, IORING_FSYNC_DATASYNC);
+            sqe->user_data = 1;
+            ++submitted;
+        }
+        int ret = io_uring_submit_and_wait(&ring_, submitted);
+        if (ret < 0) {
+            LOG_ERROR("AOF 提交 io_uring 请求失败: {}", strerror(-ret));
+            break;
+        }
+
+        bool synced = false;
+        bool failed = false;
+        for (unsigned i = 0; i < submitted; ++i) {
+            io_uring_cqe *cqe = nullptr;
+            if (io_uring_wait_cqe(&ring_, &cqe) < 0) {
+                failed = true;
+                break;
+            }
+            int res = cqe->res;
+            if (cqe->user_data == 0) {
+                if (res < 0) {
+                    LOG_ERROR("AOF 写入失败: {}", strerror(-res));
+                    failed = true;
+                } else if (res == 0) {
+                    // 没有写入任何数据（如磁盘已满），重试只会原地空转
+                    LOG_ERROR("AOF 写入失败: 没有写入任何数据");
+                    failed = true;
+                } else {
+                    written += static_cast<size_t>(res);
+                }
+            } else if (res == 0) {
+                synced = true;
+            } else if (res != -ECANCELED) {
+                LOG_ERROR("AOF 刷盘失败: {}", strerror(-res));
+                failed = true;
+            }
+            io_uring_cqe_seen(&ring_, cqe);
+        }
+        if (failed) {
+            break;
+        }
+        // 短写导致 fsync 被取消时，带着剩余数据重新提交
+        if (synced) {
+            sync = false;
+        }
+    }
+    return written == data.size() && !sync;
+}
+#endif
+
 void Aof::append(const resp::RespValue &command) {
+    // 将命令转换为RESP格式字符串
+    append_serialized(resp::serialize(command));
+}
+
+void Aof::append(std::span<const std::string_view> argv) {
+    // 直接从请求参数序列化，不经过 RespValue
+    append_serialized(resp::serialize_command(argv));
+}
+
+void Aof::append_serialized(std::string_view serialized_command) {
+#ifdef MINI_REDIS_HAVE_IO_URING
+    if (uring_enabled_) {
+        // 只追加到缓冲区，事件循环在本轮等待之前一次写出，不在每条命令上提交 I/O
+        std::lock_guard<std::mutex> lock(buffer_mutex_);
+        uring_pending_ += serialized_command;
+        ++appended_seq_;
+        if (sync_strategy_ != AofSyncStrategy::ALWAYS) {
+            has_pending_sync_ = true;
+        }
+        return;
+    }
+#endif
     if (!file_.is_open()) {
         LOG_ERROR("AOF 文件未打开，无法追加命令");
         return;
     }
-    // 将命令转换为RESP格式字符串
-    std::string serialized_command = resp::serialize(command);
     // 加锁保护共享资源
     std::lock_guard<std::mutex> lock(buffer_mutex_);
     // 写入文件并且刷新
@@ -79,11 +275,60 @@ void Aof::append(const resp::RespValue &command) {
     }
 }
 
+void Aof::flush_pending() {
+#ifdef MINI_REDIS_HAVE_IO_URING
+    if (!uring_enabled_) {
+        return;
+    }
+    if (sync_strategy_ != AofSyncStrategy::ALWAYS) {
+        {
+            std::lock_guard<std::mutex> lock(buffer_mutex_);
+            if (uring_pending_.empty()) {
+                return;
+            }
+        }
+        flush_uring(false);
+        return;
+    }
+    // always 策略：本轮所有写命令的数据合并为一次写入和一次 fsync，返回前本事件循环追加的命令都已刷盘，
+    // 事件后端之后才提交本轮的回复。其他事件循环可能已经取走这些数据并正在写入：
+    // 它持有 uring_mutex_ 直到刷盘完成，取得锁之后再检查编号，已被它刷盘时不必再写
+    uint64_t target = 0;
+    {
+        std::lock_guard<std::mutex> lock(buffer_mutex_);
+        target = appended_seq_;
+        if (synced_seq_ >= target) {
+            return;
+        }
+    }
+    std::lock_guard<std::mutex> ring_lock(uring_mutex_);
+    {
+        std::lock_guard<std::mutex> lock(buffer_mutex_);
+        if (synced_seq_ >= target) {
+            return;
+        }
+    }
+    flush_uring_locked(true);
+#endif
+}
+
 // 异步刷盘操作，由定时器触发
 void Aof::fsync_async() {
+#ifdef MINI_REDIS_HAVE_IO_URING
+    if (uring_enabled_) {
+        {
+            std::lock_guard<std::mutex> lock(buffer_mutex_);
+            if (!std::exchange(has_pending_sync_, false)) {
+                return;
+            }
+        }
+        flush_uring(true);
+        LOG_DEBUG("AOF 异步刷盘完成");
+        return;
+    }
+#endif
     // 加锁保护共享资源
     std::lock_guard<std::mutex> lock(buffer_mutex_);
-
     // 如果有待同步数据，则执行刷盘操作
     if (has_pending_sync_ && file_.is_open()) {
         file_.flush();
@@ -1,15 +1,58 @@
 module;
+#include <algorithm>
+#include <cctype>
+#include <charconv>
 #include <chrono>
+#include <csignal>
 #include <memory>
+#include <optional>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
 
 export module application;
 import logger;
 import config;
 import epoll_server;
+import event_backend;
 import kv_server;
 import aof;
 import timer;
+import evict;
+import value_object;
+
+// 解析内存大小，与 Redis 相同：k/m/g 为 1000 的幂，kb/mb/gb 为 1024 的幂，不区分大小写
+std::optional<size_t> parse_memory_size(std::string_view text) {
+    size_t value = 0;
+    auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (ec != std::errc() || ptr == text.data()) {
+        return std::nullopt;
+    }
+    std::string unit(ptr, text.data() + text.size());
+    for (char &c : unit) {
+        c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+    size_t multiplier = 0;
+    if (unit.empty() || unit == "b") {
+        multiplier = 1;
+    } else if (unit == "k") {
+        multiplier = 1000;
+    } else if (unit == "kb") {
+        multiplier = 1024;
+    } else if (unit == "m") {
+        multiplier = 1000 * 1000;
+    } else if (unit == "mb") {
+        multiplier = 1024 * 1024;
+    } else if (unit == "g") {
+        multiplier = 1000ULL * 1000 * 1000;
+    } else if (unit == "gb") {
+        multiplier = 1024ULL * 1024 * 1024;
+    } else {
+        return std::nullopt;
+    }
+    return value * multiplier;
+}
 
 export class Application {
 public:
@@ -21,8 +64,9 @@ public:
     void run();
 
 private:
-    std::unique_ptr<EpollServer> server_;
-    std::unique_ptr<KVServer> kv_server_;
+    // 每个事件循环拥有一个 EpollServer 和一个键空间分片，下标一一对应
+    std::vector<std::unique_ptr<EpollServer>> servers_;
+    std::vector<std::unique_ptr<KVServer>> kv_servers_;
     std::unique_ptr<Aof> aof_;
 };
 
@@ -54,8 +98,129 @@ bool Application::init(const std::string &config_file) {
         Logger::instance().set_level(LogLevel::FATAL);
     }
 
-    // 创建 KVServer
-    kv_server_ = std::make_unique<KVServer>();
+    // 向已关闭的连接写入时由 write 返回 EPIPE 处理，而不是让进程收到 SIGPIPE 退出
+    std::signal(SIGPIPE, SIG_IGN);
+
+    // 获取事件循环数量，每个事件循环独占一个键空间分片
+    int io_threads = Config::instance().get_int("io-threads", 1);
+    if (io_threads < 1) {
+        LOG_WARN("io-threads 配置无效: {}，使用 1", io_threads);
+        io_threads = 1;
+    }
+
+    // 选择事件后端，io_uring 在服务器初始化时不可用会自动回退到 epoll
+    std::string backend_name = Config::instance().get_string("event-backend", "epoll");
+    EventBackendType backend_type = EventBackendType::Epoll;
+    if (backend_name == "io_uring") {
+        backend_type = EventBackendType::IoUring;
+    } else if (backend_name != "epoll") {
+        LOG_WARN("event-backend 配置无效: {}，使用 epoll", backend_name);
+    }
+
+    // 创建 KVServer 分片
+    for (int i = 0; i < io_threads; ++i) {
+        kv_servers_.push_back(std::make_unique<KVServer>());
+        kv_servers_.back()->set_shard(static_cast<size_t>(i), static_cast<size_t>(io_threads));
+    }
+
+    // 惰性释放阈值（字节），需在 AOF 重放之前设置
+    int lazyfree_threshold = Config::instance().get_int("lazyfree-threshold", 65536);
+    if (lazyfree_threshold < 0) {
+        LOG_WARN("lazyfree-threshold 配置无效: {}，使用 65536", lazyfree_threshold);
+        lazyfree_threshold = 65536;
+    }
+    for (auto &kv_server : kv_servers_) {
+        kv_server->set_lazyfree_threshold(static_cast<size_t>(lazyfree_threshold));
+    }
+
+    // 内存上限与淘汰策略。上限按分片平均分配，每个分片只按自己的用量独立淘汰。
+    // 上限小于分片数时每个分片至少分到 1 字节，避免份额变成 0（不限制）
+    MaxmemoryConfig maxmemory_config;
+    std::string maxmemory = Config::instance().get_string("maxmemory", "0");
+    if (auto bytes = parse_memory_size(maxmemory)) {
+        maxmemory_config.maxmemory = *bytes > 0 ? std::max<size_t>(1, *bytes / kv_servers_.size()) : 0;
+        maxmemory_config.configured_maxmemory = *bytes;
+    } else {
+        LOG_WARN("maxmemory 配置无效: {}，不限制内存", maxmemory);
+    }
+    std::string policy = Config::instance().get_string("maxmemory-policy", "noeviction");
+    if (auto parsed = parse_eviction_policy(policy)) {
+        maxmemory_config.policy = *parsed;
+    } else {
+        LOG_WARN("maxmemory-policy 配置无效: {}，使用 noeviction", policy);
+    }
+    maxmemory_config.samples = Config::instance().get_int("maxmemory-samples", 5);
+    if (maxmemory_config.samples < 1 || maxmemory_config.samples > 64) {
+        LOG_WARN("maxmemory-samples 配置无效: {}，使用 5", maxmemory_config.samples);
+        maxmemory_config.samples = 5;
+    }
+    for (auto &kv_server : kv_servers_) {
+        kv_server->set_maxmemory_config(maxmemory_config);
+    }
+    if (maxmemory_config.maxmemory > 0) {
+        LOG_INFO("内存上限: 每个分片 {} 字节，淘汰策略 {}", maxmemory_config.maxmemory,
+                 eviction_policy_name(maxmemory_config.policy));
+    }
+
+    // 碎片整理：键空间条目分配在按尺寸分类的 slab 中，碎片超过阈值时由定时任务搬迁稀疏 slab 中的条目
+    ActiveDefragConfig defrag_config;
+    defrag_config.enabled = Config::instance().get_string("activedefrag", "no") == "yes";
+    defrag_config.threshold_lower = Config::instance().get_int("active-defrag-threshold-lower", 10);
+    if (defrag_config.threshold_lower < 0) {
+        LOG_WARN("active-defrag-threshold-lower 配置无效: {}，使用 10", defrag_config.threshold_lower);
+        defrag_config.threshold_lower = 10;
+    }
+    std::string ignore_bytes = Config::instance().get_string("active-defrag-ignore-bytes", "8mb");
+    if (auto bytes = parse_memory_size(ignore_bytes)) {
+        defrag_config.ignore_bytes = *bytes / kv_servers_.size();
+    } else {
+        LOG_WARN("active-defrag-ignore-bytes 配置无效: {}，使用 8mb", ignore_bytes);
+    }
+    defrag_config.cpu_percent = Config::instance().get_int("active-defrag-cpu-percent", 25);
+    if (defrag_config.cpu_percent < 1 || defrag_config.cpu_percent > 100) {
+        LOG_WARN("active-defrag-cpu-percent 配置无效: {}，使用 25", defrag_config.cpu_percent);
+        defrag_config.cpu_percent = 25;
+    }
+    for (auto &kv_server : kv_servers_) {
+        kv_server->set_active_defrag_config(defrag_config);
+    }
+
+    // 紧凑编码：小的哈希存放在连续的 listpack 中，超过阈值后转换为哈希表；列表由 listpack 节点组成；
+    // 小的整数集合存放在有序的 intset 中，小的有序集合同样使用 listpack，超过阈值后转换为跳表加哈希表
+    EncodingConfig encoding_config;
+    int hash_entries = Config::instance().get_int("hash-max-listpack-entries", 128);
+    int hash_value = Config::instance().get_int("hash-max-listpack-value", 64);
+    if (hash_entries < 0 || hash_value < 0) {
+        LOG_WARN("hash-max-listpack-entries/hash-max-listpack-value 配置无效: {}/{}，使用 128/64",
+                 hash_entries, hash_value);
+    } else {
+        encoding_config.hash_max_listpack_entries = static_cast<size_t>(hash_entries);
+        encoding_config.hash_max_listpack_value = static_cast<size_t>(hash_value);
+    }
+    int list_size = Config::instance().get_int("list-max-listpack-size", -2);
+    if (list_size == 0 || list_size < -5) {
+        LOG_WARN("list-max-listpack-size 配置无效: {}，使用 -2", list_size);
+    } else {
+        encoding_config.list_max_listpack_size = list_size;
+    }
+    int set_entries = Config::instance().get_int("set-max-intset-entries", 512);
+    if (set_entries < 0) {
+        LOG_WARN("set-max-intset-entries 配置无效: {}，使用 512", set_entries);
+    } else {
+        encoding_config.set_max_intset_entries = static_cast<size_t>(set_entries);
+    }
+    int zset_entries = Config::instance().get_int("zset-max-listpack-entries", 128);
+    int zset_value = Config::instance().get_int("zset-max-listpack-value", 64);
+    if (zset_entries < 0 || zset_value < 0) {
+        LOG_WARN("zset-max-listpack-entries/zset-max-listpack-value 配置无效: {}/{}，使用 128/64",
+                 zset_entries, zset_value);
+    } else {
+        encoding_config.zset_max_listpack_entries = static_cast<size_t>(zset_entries);
+        encoding_config.zset_max_listpack_value = static_cast<size_t>(zset_value);
+    }
+    for (auto &kv_server : kv_servers_) {
+        kv_server->set_encoding_config(encoding_config);
+    }
 
     // 配置 AOF
     if (Config::instance().get_string("aof-enabled", "no") == "yes") {
@@ -77,11 +242,22 @@ bool Application::init(const std::string &config_file) {
         }
 
         aof_ = std::make_unique<Aof>(aof_file, sync_strategy);
-        kv_server_->set_aof(aof_.get());
+        for (auto &kv_server : kv_servers_) {
+            kv_server->set_aof(aof_.get());
+        }
 
+        // 按键将命令重放到所属分片，全分片命令（如 FLUSHALL）在每个分片上重放
         auto commands = aof_->load_commands();
         for (const auto &cmd : commands) {
-            kv_server_->execute_command(cmd, true);
+            if (KVServer::runs_on_all_shards(cmd)) {
+                for (auto &kv_server : kv_servers_) {
+                    kv_server->execute_command(cmd, true);
+                }
+                continue;
+            }
+            auto key = KVServer::routing_key(cmd);
+            size_t shard = key ? KVServer::shard_of(*key, kv_servers_.size()) : 0;
+            kv_servers_[shard]->execute_command(cmd, true);
         }
     }
 
@@ -89,23 +265,59 @@ bool Application::init(const std::string &config_file) {
     int port = Config::instance().get_int("port", 6379);
 
     LOG_INFO("应用程序初始化成功");
-    LOG_INFO("服务器将在端口 {} 上启动", port);
+    LOG_INFO("服务器将在端口 {} 上启动，事件循环数量: {}", port, io_threads);
 
-    // 创建服务器实例
-    server_ = std::make_unique<EpollServer>(port, *kv_server_);
+    // 创建服务器实例，每个事件循环服务一个分片
+    std::vector<EpollServer *> group;
+    for (int i = 0; i < io_threads; ++i) {
+        servers_.push_back(std::make_unique<EpollServer>(port, *kv_servers_[i], i, backend_type));
+        group.push_back(servers_.back().get());
+    }
+    for (auto &server : servers_) {
+        server->set_shard_group(group);
+    }
+    // 所有事件循环的监听 socket 和事件后端都在这里初始化，任何一个失败都终止启动：
+    // 否则该分片的邮箱没有线程处理，键属于它的客户端会一直等待回复
+    for (int i = 0; i < io_threads; ++i) {
+        if (!servers_[i]->init(port)) {
+            LOG_FATAL("事件循环 #{} 初始化失败", i);
+            return false;
+        }
+    }
+    // AOF 只在事件后端确实是 io_uring 时改用 io_uring 写入：io_uring 后端在每轮等待之前先把 AOF
+    // 刷盘再提交回复，epoll 后端在命令执行后立即写回复，无法等待按轮批量的刷盘
+    if (aof_ && servers_.front()->backend_name() == "io_uring") {
+        aof_->enable_io_uring();
+    }
 
-    // 获取EpollServer中的定时器队列，并将其设置到KVServer
-    // 这样KVServer就可以使用定时器来进行过期键的清理
-    TimerQueue *timer_queue = server_->get_time_queue();
-    if(timer_queue) {
-        kv_server_->set_timer_queue(timer_queue);
-        LOG_INFO("已将定时器队列设置到KVServer，启用键过期功能");
+    // 主动过期配置：hz 为每秒慢周期次数，active-expire-cpu-percent 为慢周期的 CPU 时间上限
+    ActiveExpireConfig expire_config;
+    expire_config.hz = Config::instance().get_int("hz", 10);
+    expire_config.cpu_percent = Config::instance().get_int("active-expire-cpu-percent", 25);
+    if (expire_config.hz < 1 || expire_config.hz > 500) {
+        LOG_WARN("hz 配置无效: {}，使用 10", expire_config.hz);
+        expire_config.hz = 10;
+    }
+    if (expire_config.cpu_percent < 1 || expire_config.cpu_percent > 100) {
+        LOG_WARN("active-expire-cpu-percent 配置无效: {}，使用 25", expire_config.cpu_percent);
+        expire_config.cpu_percent = 25;
     }
 
+    // 获取每个EpollServer中的定时器队列，并将其设置到对应的KVServer
+    // 这样KVServer就可以在自己的事件循环线程上清理过期键
+    for (int i = 0; i < io_threads; ++i) {
+        kv_servers_[i]->set_active_expire_config(expire_config);
+        TimerQueue *timer_queue = servers_[i]->get_time_queue();
+        if (timer_queue) {
+            kv_servers_[i]->set_timer_queue(timer_queue);
+        }
+    }
+    LOG_INFO("已将定时器队列设置到KVServer，启用键过期功能");
+
     // 如果AOF使用everysec策略，设置每秒刷盘定时器
     if (aof_ && Config::instance().get_string("appendfsync", "always") == "everysec") {
         // 创建一个每秒触发一次的定时器，用于AOF刷盘
-        server_->add_timer(std::chrono::milliseconds(1000), [this]() {
+        servers_.front()->add_timer(std::chrono::milliseconds(1000), [this]() {
             if (this->aof_) {
                 this->aof_->fsync_async();
             }
@@ -119,9 +331,17 @@ bool Application::init(const std::string &config_file) {
 }
 
 void Application::run() {
-    if (server_) {
-        server_->start();
-    } else {
+    if (servers_.empty()) {
         LOG_FATAL("服务器未正确初始化");
+        return;
+    }
+    // 事件循环 #0 运行在主线程，其余各占一个线程。各事件循环已在 init 中初始化完毕
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < servers_.size(); ++i) {
+        threads.emplace_back([server = servers_[i].get()]() { server->run(); });
+    }
+    servers_.front()->run();
+    for (auto &thread : threads) {
+        thread.join();
     }
 }
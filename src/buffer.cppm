@@ -6,6 +6,7 @@ module;
 #include <string_view>
 #include <sys/uio.h>
 #include <unistd.h>
+#include <utility>
 #include <vector>
 
 export module buffer;
@@ -54,10 +55,24 @@ public:
 
     // 向缓冲区追加数据。
     void append(std::string_view data);
+    // 撤销最近追加的 len 字节，len 不能超过可读数据的长度。
+    void unwrite(size_t len) noexcept { writer_index_ -= len; }
+    // 预留至少 len 字节的可写空间。已知即将到达大量数据时一次分配到位，
+    // 避免随数据分批到达反复扩容、反复拷贝已有数据。
+    void reserve_writable(size_t len) { ensure_writable_bytes(len); }
+    // 与另一个缓冲区交换内容，用于在不拷贝的情况下移交待发送数据。
+    void swap(Buffer &other) noexcept {
+        buffer_.swap(other.buffer_);
+        std::swap(reader_index_, other.reader_index_);
+        std::swap(writer_index_, other.writer_index_);
+    }
 
     // 从文件描述符（如 socket）读取数据到缓冲区。使用 readv
     // 进行分散-聚集I/O以提高效率。
     ssize_t read_fd(int fd, int *saved_errno);
+    // 将可读数据写入文件描述符，并消费掉已写出的部分。
+    // 可能只写出一部分（例如 socket 发送缓冲区已满），剩余数据保留在缓冲区中。
+    ssize_t write_fd(int fd, int *saved_errno);
 
 private:
     // 获取整个缓冲区存储区的起始地址（非常量版本）。
@@ -190,4 +205,16 @@ ssize_t Buffer::read_fd(int fd, int *saved_errno) {
         append({extrabuf, static_cast<size_t>(n) - writable});
     }
     return n;
-}
\ No newline at end of file
+}
+
+// 将可读数据写入文件描述符 fd。
+ssize_t Buffer::write_fd(int fd, int *saved_errno) {
+    // 所有待发送数据在缓冲区中是连续的，一次 write 即可提交，无需分散写。
+    const ssize_t n = ::write(fd, peek(), readable_bytes());
+    if (n < 0) {
+        *saved_errno = errno;
+    } else {
+        retrieve(static_cast<size_t>(n));
+    }
+    return n;
+}
@@ -0,0 +1,543 @@
+module;
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <string_view>
+#include <vector>
+
+export module bitmap_command;
+
+import command_defs;
+import bitops;
+import resp;
+import buffer;
+import logger;
+
+// 位图命令：把字符串值看作位数组，第 0 位是第一个字节的最高位。
+// 读命令中超出字符串长度的位都是 0；写命令按需把字符串补零扩展，原地修改值字节（KvEntry::writable_raw），
+// 不会每次复制整个位图。BITCOUNT、BITPOS、BITOP 的批量部分由 bitops 中运行时选择的 SIMD 内核完成
+
+// 位偏移的上限：与 Redis 相同，字符串至多 512MB
+constexpr uint64_t MAX_BIT_OFFSET = 512ULL * 1024 * 1024 * 8 - 1;
+
+constexpr std::string_view BIT_OFFSET_ERROR = "ERR bit offset is not an integer or out of range";
+constexpr std::string_view INTEGER_ERROR = "ERR value is not an integer or out of range";
+
+bool parse_bit_offset(std::string_view arg, uint64_t &offset, Buffer &out) {
+  int64_t n;
+  if (!parse_canonical_int(arg, n) || n < 0 || static_cast<uint64_t>(n) > MAX_BIT_OFFSET) {
+    resp::write_error(out, BIT_OFFSET_ERROR);
+    return false;
+  }
+  offset = static_cast<uint64_t>(n);
+  return true;
+}
+
+// 查找存活的字符串键。值是其他类型时写出 WRONGTYPE 错误并返回 false；键不存在时 it 为 end()，返回 true
+bool find_live_string(KVServerContext &context, std::string_view key, Storage::iterator &it, Buffer &out) {
+  it = context.find_live_key(key);
+  if (it != context.get_db().end() && it->is_object()) {
+    resp::write_error(out, WRONGTYPE_ERROR);
+    return false;
+  }
+  return true;
+}
+
+const uint8_t *byte_data(std::string_view bytes) { return reinterpret_cast<const uint8_t *>(bytes.data()); }
+
+bool bit_at(std::string_view bytes, uint64_t pos) {
+  return pos / 8 < bytes.size() && ((static_cast<uint8_t>(bytes[pos / 8]) >> (7 - pos % 8)) & 1) != 0;
+}
+
+void set_bit(std::span<char> bytes, uint64_t pos, bool on) {
+  uint8_t mask = static_cast<uint8_t>(0x80 >> (pos % 8));
+  uint8_t &byte = reinterpret_cast<uint8_t &>(bytes[pos / 8]);
+  byte = on ? static_cast<uint8_t>(byte | mask) : static_cast<uint8_t>(byte & ~mask);
+}
+
+// 位区间 [first, last] 中值为 1 的位数，区间在字符串之内。两端不完整的字节用掩码处理，中间的整字节交给 SIMD 内核
+uint64_t count_bits(std::string_view bytes, uint64_t first, uint64_t last) {
+  uint64_t begin = first / 8;
+  uint64_t end = last / 8;
+  uint8_t head = static_cast<uint8_t>(0xff >> (first % 8));
+  uint8_t tail = static_cast<uint8_t>(0xff << (7 - last % 8));
+  auto byte = [&](uint64_t i) { return static_cast<uint8_t>(bytes[i]); };
+  if (begin == end) {
+    return static_cast<uint64_t>(std::popcount(static_cast<uint8_t>(byte(begin) & head & tail)));
+  }
+  return static_cast<uint64_t>(std::popcount(static_cast<uint8_t>(byte(begin) & head))) +
+         bitops::popcount(byte_data(bytes) + begin + 1, end - begin - 1) +
+         static_cast<uint64_t>(std::popcount(static_cast<uint8_t>(byte(end) & tail)));
+}
+
+// 位区间 [first, last] 中第一个值为 bit 的位，没有时返回 -1。
+// 整字节部分用 SIMD 内核跳过全为 0x00（找 1 时）或 0xff（找 0 时）的字节，两端不完整的字节逐位检查
+int64_t find_bit(std::string_view bytes, uint64_t first, uint64_t last, bool bit) {
+  uint8_t fill = bit ? 0x00 : 0xff;
+  uint64_t pos = first;
+  while (pos <= last) {
+    if (pos % 8 == 0 && last - pos >= 7) {
+      uint64_t begin = pos / 8;
+      uint64_t end = (last + 1) / 8;
+      uint64_t found = begin + bitops::find_byte_not(byte_data(bytes) + begin, end - begin, fill);
+      pos = found * 8;
+      if (found < end) {
+        // 与 fill 异或后第一个 1 就是要找的位
+        uint8_t diff = static_cast<uint8_t>(static_cast<uint8_t>(bytes[found]) ^ fill);
+        return static_cast<int64_t>(pos + std::countl_zero(diff));
+      }
+      continue;
+    }
+    if (bit_at(bytes, pos) == bit) {
+      return static_cast<int64_t>(pos);
+    }
+    ++pos;
+  }
+  return -1;
+}
+
+// 解析 BITCOUNT/BITPOS 的区间单位，BIT 时返回 true
+bool parse_range_unit(std::string_view arg, bool &bit_unit, Buffer &out) {
+  if (option_is(arg, "BIT")) {
+    bit_unit = true;
+  } else if (option_is(arg, "BYTE")) {
+    bit_unit = false;
+  } else {
+    resp::write_error(out, "ERR syntax error");
+    return false;
+  }
+  return true;
+}
+
+// 把以字节或位为单位的 [start, end] 规范化为位区间 [first, last]，区间为空时返回 false
+bool normalize_bit_range(int64_t start, int64_t end, size_t size, bool bit_unit, uint64_t &first, uint64_t &last) {
+  size_t lo, hi;
+  if (!normalize_range(start, end, bit_unit ? size * 8 : size, lo, hi)) {
+    return false;
+  }
+  first = bit_unit ? lo : lo * 8;
+  last = bit_unit ? hi : hi * 8 + 7;
+  return true;
+}
+
+// SetBit命令：SETBIT key offset value，返回该位原来的值。键不存在时创建，值不够长时补零扩展
+export void setbit_command(KVServerContext &context, CommandArgs args, Buffer &out) {
+  uint64_t offset;
+  if (!parse_bit_offset(args[1], offset, out)) {
+    return;
+  }
+  if (args[2] != "0" && args[2] != "1") {
+    resp::write_error(out, "ERR bit is not an integer or out of range");
+    return;
+  }
+  bool on = args[2] == "1";
+
+  Storage::iterator it;
+  if (!find_live_string(context, args[0], it, out)) {
+    return;
+  }
+  auto &db = context.get_db();
+  size_t len = offset / 8 + 1;
+  if (it == db.end()) {
+    db.insert(db.create_raw_entry(args[0], len, [&](std::span<char> bytes) { set_bit(bytes, offset, on); }));
+    LOG_DEBUG("SETBIT命令创建新键: {}，{} 字节", args[0], len);
+    resp::write_integer(out, 0);
+    return;
+  }
+
+  KvEntry::ValueBuffer buf;
+  std::string_view current = it->value(buf);
+  bool old = bit_at(current, offset);
+  if (old == on && len <= current.size()) {
+    context.suppress_propagation();
+  } else {
+    db.update_raw(it, len, [&](std::span<char> bytes) { set_bit(bytes, offset, on); });
+  }
+  resp::write_integer(out, old ? 1 : 0);
+}
+
+// GetBit命令：超出字符串长度或键不存在时返回 0
+export void getbit_command(KVServerContext &context, CommandArgs args, Buffer &out) {
+  uint64_t offset;
+  if (!parse_bit_offset(args[1], offset, out)) {
+    return;
+  }
+  Storage::iterator it;
+  if (!find_live_string(context, args[0], it, out)) {
+    return;
+  }
+  if (it == context.get_db().end()) {
+    resp::write_integer(out, 0);
+    return;
+  }
+  KvEntry::ValueBuffer buf;
+  resp::write_integer(out, bit_at(it->value(buf), offset) ? 1 : 0);
+}
+
+// BitCount命令：BITCOUNT key [start end [BYTE|BIT]]，区间的下标规则与 LRANGE 相同
+export void bitcount_command(KVServerContext &context, CommandArgs args, Buffer &out) {
+  if (args.size() == 2 || args.size() > 4) {
+    resp::write_error(out, "ERR syntax error");
+    return;
+  }
+  int64_t start = 0;
+  int64_t end = -1;
+  bool bit_unit = false;
+  if (args.size() >= 3) {
+    if (!parse_canonical_int(args[1], start) || !parse_canonical_int(args[2], end)) {
+      resp::write_error(out, INTEGER_ERROR);
+      return;
+    }
+    if (args.size() == 4 && !parse_range_unit(args[3], bit_unit, out)) {
+      return;
+    }
+  }
+
+  Storage::iterator it;
+  if (!find_live_string(context, args[0], it, out)) {
+    return;
+  }
+  if (it == context.get_db().end()) {
+    resp::write_integer(out, 0);
+    return;
+  }
+  KvEntry::ValueBuffer buf;
+  std::string_view bytes = it->value(buf);
+  uint64_t first, last;
+  if (!normalize_bit_range(start, end, bytes.size(), bit_unit, first, last)) {
+    resp::write_integer(out, 0);
+    return;
+  }
+  resp::write_integer(out, static_cast<int64_t>(count_bits(bytes, first, last)));
+}
+
+// BitPos命令：BITPOS key bit [start [end [BYTE|BIT]]]，返回区间中第一个值为 bit 的位，没有时返回 -1。
+// 找 0 且没有指定 end 时，字符串右侧视为补了无限个 0，返回字符串之后的第一位
+export void bitpos_command(KVServerContext &context, CommandArgs args, Buffer &out) {
+  if (args.size() > 5) {
+    resp::write_error(out, "ERR syntax error");
+    return;
+  }
+  if (args[1] != "0" && args[1] != "1") {
+    resp::write_error(out, "ERR The bit argument must be 1 or 0.");
+    return;
+  }
+  bool bit = args[1] == "1";
+  int64_t start = 0;
+  int64_t end = -1;
+  bool end_given = args.size() >= 4;
+  bool bit_unit = false;
+  if ((args.size() >= 3 && !parse_canonical_int(args[2], start)) || (end_given && !parse_canonical_int(args[3], end))) {
+    resp::write_error(out, INTEGER_ERROR);
+    return;
+  }
+  if (args.size() == 5 && !parse_range_unit(args[4], bit_unit, out)) {
+    return;
+  }
+
+  Storage::iterator it;
+  if (!find_live_string(context, args[0], it, out)) {
+    return;
+  }
+  if (it == context.get_db().end()) {
+    resp::write_integer(out, bit ? -1 : 0);
+    return;
+  }
+  KvEntry::ValueBuffer buf;
+  std::string_view bytes = it->value(buf);
+  uint64_t first, last;
+  if (!normalize_bit_range(start, end, bytes.size(), bit_unit, first, last)) {
+    resp::write_integer(out, -1);
+    return;
+  }
+  int64_t pos = find_bit(bytes, first, last, bit);
+  if (pos < 0 && !bit && !end_given) {
+    pos = static_cast<int64_t>(bytes.size() * 8);
+  }
+  resp::write_integer(out, pos);
+}
+
+// BitOp命令：BITOP AND|OR|XOR|NOT destkey key [key ...]，结果写入 destkey，返回结果的字节数。
+// 较短的源按补零处理，结果与最长的源一样长；结果为空时删除 destkey。
+// 覆盖 destkey 原有的任意类型的值，不保留过期时间
+export void bitop_command(KVServerContext &context, CommandArgs args, Buffer &out) {
+  bitops::BitOp op;
+  if (option_is(args[0], "AND")) {
+    op = bitops::BitOp::And;
+  } else if (option_is(args[0], "OR")) {
+    op = bitops::BitOp::Or;
+  } else if (option_is(args[0], "XOR")) {
+    op = bitops::BitOp::Xor;
+  } else if (option_is(args[0], "NOT")) {
+    op = bitops::BitOp::Not;
+  } else {
+    resp::write_error(out, "ERR syntax error");
+    return;
+  }
+  CommandArgs keys = args.subspan(2);
+  if (op == bitops::BitOp::Not && keys.size() != 1) {
+    resp::write_error(out, "ERR BITOP NOT must be called with a single source key.");
+    return;
+  }
+
+  // 源的值直接引用条目中的字节，整数编码的值格式化到各自的缓冲区中。条目块的地址不随哈希表渐进扩容变化；
+  // 过期按命令开始时的时间判断，同一个键重复出现时后面的查找不会删除前面已引用的条目
+  std::vector<KvEntry::ValueBuffer> buffers(keys.size());
+  std::vector<std::string_view> sources;
+  sources.reserve(keys.size());
+  size_t len = 0;
+  for (size_t i = 0; i < keys.size(); ++i) {
+    Storage::iterator it;
+    if (!find_live_string(context, keys[i], it, out)) {
+      return;
+    }
+    sources.push_back(it == context.get_db().end() ? std::string_view() : it->value(buffers[i]));
+    len = std::max(len, sources.back().size());
+  }
+
+  // 结果直接写入新条目，再替换目标键。目标键可能也是源键之一，要先算出结果
+  auto &db = context.get_db();
+  KvEntry result;
+  if (len > 0) {
+    result = db.create_raw_entry(args[1], len, [&](std::span<char> bytes) {
+      auto *dst = reinterpret_cast<uint8_t *>(bytes.data());
+      if (op == bitops::BitOp::Not) {
+        bitops::apply(op, dst, byte_data(sources[0]), len);
+        return;
+      }
+      if (!sources[0].empty()) {
+        std::memcpy(dst, sources[0].data(), sources[0].size());
+      }
+      for (size_t i = 1; i < sources.size(); ++i) {
+        bitops::apply(op, dst, byte_data(sources[i]), sources[i].size());
+        if (op == bitops::BitOp::And) {
+          std::memset(dst + sources[i].size(), 0, len - sources[i].size());
+        }
+      }
+    });
+  }
+  auto it = context.find_live_key(args[1]);
+  if (it != db.end()) {
+    context.unlink_key(it);
+  }
+  if (len > 0) {
+    db.insert(std::move(result));
+  }
+  LOG_DEBUG("BITOP命令结果写入键 {}: {} 字节", args[1], len);
+  resp::write_integer(out, static_cast<int64_t>(len));
+}
+
+// BITFIELD 的一个子命令
+struct BitfieldOp {
+  enum class Kind { Get, Set, IncrBy };
+  enum class Overflow { Wrap, Sat, Fail };
+
+  Kind kind;
+  bool is_signed;
+  unsigned bits;
+  uint64_t offset;
+  int64_t value; // SET 的新值或 INCRBY 的增量
+  Overflow overflow;
+};
+
+// 解析 i<位数> 或 u<位数>：有符号至多 64 位，无符号至多 63 位（结果要能作为 RESP 整数返回）
+bool parse_bitfield_type(std::string_view arg, BitfieldOp &op, Buffer &out) {
+  int64_t bits;
+  bool valid = arg.size() >= 2 && (arg[0] == 'i' || arg[0] == 'I' || arg[0] == 'u' || arg[0] == 'U') &&
+               parse_canonical_int(arg.substr(1), bits);
+  op.is_signed = valid && (arg[0] == 'i' || arg[0] == 'I');
+  if (!valid || bits < 1 || bits > (op.is_signed ? 64 : 63)) {
+    resp::write_error(out,
+                      "ERR Invalid bitfield type. Use something like i16 u8. Note that u64 is not supported but i64 is.");
+    return false;
+  }
+  op.bits = static_cast<unsigned>(bits);
+  return true;
+}
+
+// 解析位偏移，"#N" 表示第 N 个该类型的字段，即 N * 位数
+bool parse_bitfield_offset(std::string_view arg, BitfieldOp &op, Buffer &out) {
+  bool by_field = !arg.empty() && arg[0] == '#';
+  int64_t n;
+  if (!parse_canonical_int(by_field ? arg.substr(1) : arg, n) || n < 0) {
+    resp::write_error(out, BIT_OFFSET_ERROR);
+    return false;
+  }
+  uint64_t offset = static_cast<uint64_t>(n);
+  if (by_field) {
+    if (offset > MAX_BIT_OFFSET / op.bits) {
+      resp::write_error(out, BIT_OFFSET_ERROR);
+      return false;
+    }
+    offset *= op.bits;
+  }
+  if (offset > MAX_BIT_OFFSET + 1 - op.bits) {
+    resp::write_error(out, BIT_OFFSET_ERROR);
+    return false;
+  }
+  op.offset = offset;
+  return true;
+}
+
+// 读出字段的值，超出字符串长度的位为 0
+int64_t read_bitfield(std::string_view bytes, const BitfieldOp &op) {
+  uint64_t raw = 0;
+  for (unsigned i = 0; i < op.bits; ++i) {
+    raw = (raw << 1) | (bit_at(bytes, op.offset + i) ? 1 : 0);
+  }
+  if (op.is_signed && op.bits < 64 && (raw >> (op.bits - 1)) != 0) {
+    raw |= ~uint64_t{0} << op.bits; // 符号扩展
+  }
+  return static_cast<int64_t>(raw);
+}
+
+void write_bitfield(std::span<char> bytes, const BitfieldOp &op, int64_t value) {
+  auto raw = static_cast<uint64_t>(value);
+  for (unsigned i = 0; i < op.bits; ++i) {
+    set_bit(bytes, op.offset + i, ((raw >> (op.bits - 1 - i)) & 1) != 0);
+  }
+}
+
+// 按字段类型和溢出策略处理要写入的值。WRAP 取低位（有符号时再符号扩展），SAT 截到类型的最值，
+// FAIL 时不写入并返回 false
+bool fit_bitfield(const BitfieldOp &op, __int128 wide, int64_t &result) {
+  __int128 min = op.is_signed ? -(static_cast<__int128>(1) << (op.bits - 1)) : 0;
+  __int128 max = (static_cast<__int128>(1) << (op.is_signed ? op.bits - 1 : op.bits)) - 1;
+  if (wide >= min && wide <= max) {
+    result = static_cast<int64_t>(wide);
+    return true;
+  }
+  switch (op.overflow) {
+  case BitfieldOp::Overflow::Wrap: {
+    uint64_t raw = static_cast<uint64_t>(wide);
+    if (op.bits < 64) {
+      raw &= (uint64_t{1} << op.bits) - 1;
+      if (op.is_signed && (raw >> (op.bits - 1)) != 0) {
+        raw |= ~uint64_t{0} << op.bits;
+      }
+    }
+    result = static_cast<int64_t>(raw);
+    return true;
+  }
+  case BitfieldOp::Overflow::Sat:
+    result = static_cast<int64_t>(wide < min ? min : max);
+    return true;
+  case BitfieldOp::Overflow::Fail:
+    break;
+  }
+  return false;
+}
+
+// BitField命令：BITFIELD key [GET type offset] [SET type offset value] [INCRBY type offset increment]
+// [OVERFLOW WRAP|SAT|FAIL] ...，按顺序执行子命令，每个 GET/SET/INCRBY 回复一项：
+// GET 为字段的值，SET 为旧值，INCRBY 为新值，FAIL 策略下溢出时为 nil。
+// 先解析全部子命令，有错误时什么都不做。只有 GET 时不创建键
+export void bitfield_command(KVServerContext &context, CommandArgs args, Buffer &out) {
+  std::vector<BitfieldOp> ops;
+  auto overflow = BitfieldOp::Overflow::Wrap;
+  bool has_write = false;
+  uint64_t write_end = 0; // 写入的字段覆盖的字节数
+  for (size_t i = 1; i < args.size();) {
+    if (option_is(args[i], "OVERFLOW") && i + 1 < args.size()) {
+      if (option_is(args[i + 1], "WRAP")) {
+        overflow = BitfieldOp::Overflow::Wrap;
+      } else if (option_is(args[i + 1], "SAT")) {
+        overflow = BitfieldOp::Overflow::Sat;
+      } else if (option_is(args[i + 1], "FAIL")) {
+        overflow = BitfieldOp::Overflow::Fail;
+      } else {
+        resp::write_error(out, "ERR Invalid OVERFLOW type specified");
+        return;
+      }
+      i += 2;
+      continue;
+    }
+    BitfieldOp op{};
+    op.overflow = overflow;
+    size_t arity;
+    if (option_is(args[i], "GET")) {
+      op.kind = BitfieldOp::Kind::Get;
+      arity = 3;
+    } else if (option_is(args[i], "SET")) {
+      op.kind = BitfieldOp::Kind::Set;
+      arity = 4;
+    } else if (option_is(args[i], "INCRBY")) {
+      op.kind = BitfieldOp::Kind::IncrBy;
+      arity = 4;
+    } else {
+      resp::write_error(out, "ERR syntax error");
+      return;
+    }
+    if (i + arity > args.size()) {
+      resp::write_error(out, "ERR syntax error");
+      return;
+    }
+    if (!parse_bitfield_type(args[i + 1], op, out) || !parse_bitfield_offset(args[i + 2], op, out)) {
+      return;
+    }
+    if (arity == 4) {
+      if (!parse_canonical_int(args[i + 3], op.value)) {
+        resp::write_error(out, INTEGER_ERROR);
+        return;
+      }
+      has_write = true;
+      write_end = std::max(write_end, (op.offset + op.bits + 7) / 8);
+    }
+    ops.push_back(op);
+    i += arity;
+  }
+
+  Storage::iterator it;
+  if (!find_live_string(context, args[0], it, out)) {
+    return;
+  }
+  auto &db = context.get_db();
+  resp::write_array_header(out, ops.size());
+  if (!has_write) {
+    KvEntry::ValueBuffer buf;
+    std::string_view bytes = it == db.end() ? std::string_view() : it->value(buf);
+    for (const auto &op : ops) {
+      resp::write_integer(out, read_bitfield(bytes, op));
+    }
+    return;
+  }
+
+  // 与 Redis 相同，即使所有写入都因 FAIL 而放弃，键也会被创建并扩展到写入字段所需的长度
+  bool changed = false;
+  if (it == db.end()) {
+    it = db.insert(db.create_entry(args[0], "")).first;
+    changed = true;
+  } else {
+    KvEntry::ValueBuffer buf;
+    changed = it->value(buf).size() < write_end;
+  }
+  db.update_raw(it, write_end, [&](std::span<char> bytes) {
+    std::string_view view(bytes.data(), bytes.size());
+    for (const auto &op : ops) {
+      int64_t current = read_bitfield(view, op);
+      if (op.kind == BitfieldOp::Kind::Get) {
+        resp::write_integer(out, current);
+        continue;
+      }
+      // 无符号字段的 SET 把值当作 64 位无符号数，负数总是溢出
+      __int128 wide = op.is_signed ? static_cast<__int128>(op.value) : static_cast<uint64_t>(op.value);
+      if (op.kind == BitfieldOp::Kind::IncrBy) {
+        wide = static_cast<__int128>(current) + op.value;
+      }
+      int64_t value;
+      if (!fit_bitfield(op, wide, value)) {
+        resp::write_null_bulk_string(out);
+        continue;
+      }
+      write_bitfield(bytes, op, value);
+      changed = true;
+      resp::write_integer(out, op.kind == BitfieldOp::Kind::Set ? current : value);
+    }
+  });
+  if (!changed) {
+    context.suppress_propagation();
+  }
+}
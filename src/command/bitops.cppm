@@ -0,0 +1,243 @@
+module;
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+export module bitops;
+
+// 位图的批量运算：位计数（BITCOUNT）、按字节的位运算（BITOP）和查找第一个不等于给定值的字节（BITPOS）。
+// 位图可达上亿位，这些运算按块处理，块内使用 SIMD 指令（AVX2，运行时按 CPU 选择）；
+// 不支持时按 64 位字处理，位计数在支持 POPCNT 指令时使用该指令
+
+export namespace bitops {
+
+enum class BitOp { And, Or, Xor, Not };
+
+} // namespace bitops
+
+namespace bitops_detail {
+
+using bitops::BitOp;
+
+uint64_t load64(const uint8_t *p) {
+  uint64_t v;
+  std::memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+void store64(uint8_t *p, uint64_t v) { std::memcpy(p, &v, sizeof(v)); }
+
+// 不按块处理，只用 64 位字
+struct Scalar {
+  static constexpr size_t BYTES = 0;
+};
+
+#if defined(__x86_64__) || defined(__i386__)
+struct Avx2 {
+  static constexpr size_t BYTES = 32;
+
+  __attribute__((target("avx2"))) static __m256i load(const uint8_t *p) {
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+  }
+  __attribute__((target("avx2"))) static void store(uint8_t *p, __m256i v) {
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(p), v);
+  }
+
+  // 查表法：每个字节拆成高低 4 位，用 vpshufb 查 16 项的位数表。每轮每个字节的计数至多为 8，
+  // 按字节累加 31 轮后用 vpsadbw 汇总到 4 个 64 位计数中，不会溢出
+  __attribute__((target("avx2"))) static uint64_t popcount(const uint8_t *p, size_t blocks) {
+    const __m256i table = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4, 0, 1, 1, 2, 1, 2, 2, 3,
+                                           1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i low = _mm256_set1_epi8(0x0f);
+    __m256i total = _mm256_setzero_si256();
+    size_t i = 0;
+    while (i < blocks) {
+      size_t end = std::min(blocks, i + 31);
+      __m256i counts = _mm256_setzero_si256();
+      for (; i < end; ++i) {
+        __m256i v = load(p + i * BYTES);
+        __m256i lo = _mm256_shuffle_epi8(table, _mm256_and_si256(v, low));
+        __m256i hi = _mm256_shuffle_epi8(table, _mm256_and_si256(_mm256_srli_epi16(v, 4), low));
+        counts = _mm256_add_epi8(counts, _mm256_add_epi8(lo, hi));
+      }
+      total = _mm256_add_epi64(total, _mm256_sad_epu8(counts, _mm256_setzero_si256()));
+    }
+    uint64_t lanes[4];
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(lanes), total);
+    return lanes[0] + lanes[1] + lanes[2] + lanes[3];
+  }
+
+  __attribute__((target("avx2"))) static void apply(BitOp op, uint8_t *dst, const uint8_t *src, size_t blocks) {
+    switch (op) {
+    case BitOp::And:
+      for (size_t i = 0; i < blocks * BYTES; i += BYTES) {
+        store(dst + i, _mm256_and_si256(load(dst + i), load(src + i)));
+      }
+      break;
+    case BitOp::Or:
+      for (size_t i = 0; i < blocks * BYTES; i += BYTES) {
+        store(dst + i, _mm256_or_si256(load(dst + i), load(src + i)));
+      }
+      break;
+    case BitOp::Xor:
+      for (size_t i = 0; i < blocks * BYTES; i += BYTES) {
+        store(dst + i, _mm256_xor_si256(load(dst + i), load(src + i)));
+      }
+      break;
+    case BitOp::Not:
+      for (size_t i = 0; i < blocks * BYTES; i += BYTES) {
+        store(dst + i, _mm256_xor_si256(load(src + i), _mm256_set1_epi8(-1)));
+      }
+      break;
+    }
+  }
+
+  // 第一个含有不等于 fill 的字节的块，都等于 fill 时返回 blocks
+  __attribute__((target("avx2"))) static size_t find_block_not(const uint8_t *p, size_t blocks, uint8_t fill) {
+    const __m256i f = _mm256_set1_epi8(static_cast<char>(fill));
+    for (size_t i = 0; i < blocks; ++i) {
+      if (_mm256_movemask_epi8(_mm256_cmpeq_epi8(load(p + i * BYTES), f)) != -1) {
+        return i;
+      }
+    }
+    return blocks;
+  }
+};
+#endif
+
+// 以下三个函数先按块处理，剩下不足一块的部分按 64 位字处理，最后逐字节处理
+
+template <typename Block> uint64_t popcount(const uint8_t *p, size_t n) {
+  uint64_t count = 0;
+  size_t i = 0;
+  if constexpr (Block::BYTES > 0) {
+    size_t blocks = n / Block::BYTES;
+    count += Block::popcount(p, blocks);
+    i = blocks * Block::BYTES;
+  }
+  for (; i + 8 <= n; i += 8) {
+    count += static_cast<uint64_t>(std::popcount(load64(p + i)));
+  }
+  for (; i < n; ++i) {
+    count += static_cast<uint64_t>(std::popcount(p[i]));
+  }
+  return count;
+}
+
+uint64_t apply_word(BitOp op, uint64_t a, uint64_t b) {
+  switch (op) {
+  case BitOp::And:
+    return a & b;
+  case BitOp::Or:
+    return a | b;
+  case BitOp::Xor:
+    return a ^ b;
+  case BitOp::Not:
+    break;
+  }
+  return ~b;
+}
+
+template <typename Block> void apply(BitOp op, uint8_t *dst, const uint8_t *src, size_t n) {
+  size_t i = 0;
+  if constexpr (Block::BYTES > 0) {
+    size_t blocks = n / Block::BYTES;
+    Block::apply(op, dst, src, blocks);
+    i = blocks * Block::BYTES;
+  }
+  for (; i + 8 <= n; i += 8) {
+    store64(dst + i, apply_word(op, load64(dst + i), load64(src + i)));
+  }
+  for (; i < n; ++i) {
+    dst[i] = static_cast<uint8_t>(apply_word(op, dst[i], src[i]));
+  }
+}
+
+template <typename Block> size_t find_byte_not(const uint8_t *p, size_t n, uint8_t fill) {
+  size_t i = 0;
+  if constexpr (Block::BYTES > 0) {
+    i = Block::find_block_not(p, n / Block::BYTES, fill) * Block::BYTES;
+  }
+  const uint64_t fill_word = 0x0101010101010101ULL * fill;
+  while (i + 8 <= n && load64(p + i) == fill_word) {
+    i += 8;
+  }
+  while (i < n && p[i] == fill) {
+    ++i;
+  }
+  return i;
+}
+
+struct Kernels {
+  uint64_t (*popcount)(const uint8_t *, size_t);
+  void (*apply)(BitOp, uint8_t *, const uint8_t *, size_t);
+  size_t (*find_byte_not)(const uint8_t *, size_t, uint8_t);
+  const char *name;
+};
+
+uint64_t popcount_scalar(const uint8_t *p, size_t n) { return popcount<Scalar>(p, n); }
+void apply_scalar(BitOp op, uint8_t *dst, const uint8_t *src, size_t n) { apply<Scalar>(op, dst, src, n); }
+size_t find_byte_not_scalar(const uint8_t *p, size_t n, uint8_t fill) { return find_byte_not<Scalar>(p, n, fill); }
+
+#if defined(__x86_64__) || defined(__i386__)
+// flatten 把整个调用链内联进带 target 属性的入口，std::popcount 在其中编译为 POPCNT 指令，
+// 块处理的内建函数也才能在其中使用
+__attribute__((target("popcnt"), flatten)) uint64_t popcount_popcnt(const uint8_t *p, size_t n) {
+  return popcount<Scalar>(p, n);
+}
+
+__attribute__((target("avx2,popcnt"), flatten)) uint64_t popcount_avx2(const uint8_t *p, size_t n) {
+  return popcount<Avx2>(p, n);
+}
+
+__attribute__((target("avx2"), flatten)) void apply_avx2(BitOp op, uint8_t *dst, const uint8_t *src, size_t n) {
+  apply<Avx2>(op, dst, src, n);
+}
+
+__attribute__((target("avx2"), flatten)) size_t find_byte_not_avx2(const uint8_t *p, size_t n, uint8_t fill) {
+  return find_byte_not<Avx2>(p, n, fill);
+}
+#endif
+
+Kernels select_kernels() {
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt")) {
+    return {popcount_avx2, apply_avx2, find_byte_not_avx2, "avx2"};
+  }
+  if (__builtin_cpu_supports("popcnt")) {
+    return {popcount_popcnt, apply_scalar, find_byte_not_scalar, "popcnt"};
+  }
+#endif
+  return {popcount_scalar, apply_scalar, find_byte_not_scalar, "scalar"};
+}
+
+inline const Kernels KERNELS = select_kernels();
+
+} // namespace bitops_detail
+
+export namespace bitops {
+
+// 值为 1 的位数
+uint64_t popcount(const uint8_t *data, size_t len) { return bitops_detail::KERNELS.popcount(data, len); }
+
+// 逐字节计算 dst[i] = dst[i] op src[i]；Not 时为 dst[i] = ~src[i]，dst 可以与 src 相同
+void apply(BitOp op, uint8_t *dst, const uint8_t *src, size_t len) {
+  bitops_detail::KERNELS.apply(op, dst, src, len);
+}
+
+// 第一个不等于 fill 的字节的下标，都等于 fill 时返回 len
+size_t find_byte_not(const uint8_t *data, size_t len, uint8_t fill) {
+  return bitops_detail::KERNELS.find_byte_not(data, len, fill);
+}
+
+// 运行时选中的内核名，基准测试和日志使用
+const char *simd_kernel() { return bitops_detail::KERNELS.name; }
+
+} // namespace bitops
@@ -1,4 +1,5 @@
 export module command;
 
+export import command_table;
 export import command_defs;
-export import command_factory;
\ No newline at end of file
+export import command_handlers;
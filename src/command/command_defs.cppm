@@ -1,83 +1,703 @@
 module;
 
+#include <algorithm>
+#include <charconv>
 #include <chrono>
+#include <cstdint>
+#include <format>
+#include <functional>
+#include <initializer_list>
+#include <limits>
 #include <memory>
 #include <optional>
+#include <utility>
+#include <span>
 #include <string>
-#include <unordered_map>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
 
 export module command_defs;
 
 import resp;
+import buffer;
 import logger;
 import aof;
 import server_stat;
+export import expires_index;
+export import dict;
+export import kv_entry;
+export import evict;
+export import lazyfree;
+export import slab;
+export import value_object;
 
-// 存储结构扩展，包含值和过期时间
-export struct KeyValue {
-  std::string value;
-  // 使用 std::optional 来表示键是否设置了过期时间
-  std::optional<std::chrono::time_point<std::chrono::steady_clock>> expires_at;
+// 键空间：开放寻址哈希表，扩容渐进完成，不会因一次性重建整张表而停顿。
+// 条目是单次分配的紧凑 KvEntry，通过 create_entry/create_int_entry/create_object_entry 创建的条目
+// 从键空间自己的 slab 分配器中分配。所有会改变条目大小的操作都经过这里，以便统计内存
+export class Storage : public Dict<KvEntry> {
+public:
+  Storage() : slabs_(std::make_unique<SlabAllocator>()) {}
+  // 条目要在 slab 分配器之前释放
+  ~Storage() { Dict::clear(); }
+  // 移动时内存统计、slab 分配器和访问信息的设置随条目一起转移，语义与 Dict 的移动相同
+  Storage(Storage &&other) noexcept
+      : Dict(std::move(other)), slabs_(std::move(other.slabs_)),
+        entry_bytes_(std::exchange(other.entry_bytes_, 0)), lfu_(other.lfu_), clock_s_(other.clock_s_),
+        random_(other.random_) {}
+  Storage &operator=(Storage &&other) noexcept {
+    Dict::operator=(std::move(other));
+    std::swap(slabs_, other.slabs_);
+    std::swap(entry_bytes_, other.entry_bytes_);
+    std::swap(lfu_, other.lfu_);
+    std::swap(clock_s_, other.clock_s_);
+    std::swap(random_, other.random_);
+    return *this;
+  }
+
+  // 创建从本键空间的 slab 中分配的条目，之后仍需 insert 或 replace
+  KvEntry create_entry(std::string_view key, std::string_view value,
+                       std::optional<std::chrono::steady_clock::time_point> expires_at = std::nullopt) {
+    return KvEntry::create(key, value, expires_at, slabs_.get());
+  }
+  KvEntry create_int_entry(std::string_view key, int64_t value) {
+    return KvEntry::create_int(key, value, std::nullopt, slabs_.get());
+  }
+  KvEntry create_object_entry(std::string_view key, std::unique_ptr<ValueObject> object) {
+    return KvEntry::create_object(key, std::move(object), std::nullopt, slabs_.get());
+  }
+  // 创建 len 字节的字符串条目，值由 fill(bytes) 直接写入条目（初始全为零），不经过临时字符串
+  template <typename Fn> KvEntry create_raw_entry(std::string_view key, size_t len, Fn fill) {
+    KvEntry entry = KvEntry::create_zeroed(key, len, slabs_.get());
+    fill(entry.writable_raw(len, slabs_.get()));
+    entry.normalize_int(slabs_.get());
+    return entry;
+  }
+
+  // 新键的访问信息初始化为当前时刻（LFU 为初始计数）
+  std::pair<iterator, bool> insert(KvEntry entry) {
+    entry.set_lru(lfu_ ? lfu_init(clock_s_) : lru_clock(clock_s_));
+    size_t bytes = entry.allocation_size();
+    auto result = Dict::insert(std::move(entry));
+    if (result.second) {
+      entry_bytes_ += bytes;
+    }
+    return result;
+  }
+
+  void erase(const_iterator it) {
+    entry_bytes_ -= it->allocation_size();
+    Dict::erase(it);
+  }
+
+  // 取出条目，由调用方决定在哪里释放
+  KvEntry extract(const_iterator it) {
+    entry_bytes_ -= it->allocation_size();
+    return Dict::extract(it);
+  }
+
+  // 用键相同的新条目替换 it 处的条目，返回旧条目
+  KvEntry replace(iterator it, KvEntry entry) {
+    entry.set_lru(it->lru());
+    entry_bytes_ -= it->allocation_size();
+    entry_bytes_ += entry.allocation_size();
+    std::swap(*it, entry);
+    return entry;
+  }
+
+  size_t erase(std::string_view key) {
+    auto it = find(key);
+    if (it == end()) {
+      return 0;
+    }
+    erase(it);
+    return 1;
+  }
+
+  void clear() {
+    Dict::clear();
+    entry_bytes_ = 0;
+  }
+
+  // 在 fn(entry) 中修改条目，修改前后的大小差计入内存统计。修改值对象的命令通过它进行
+  template <typename Fn> void update(iterator it, Fn fn) {
+    entry_bytes_ -= it->allocation_size();
+    fn(*it);
+    entry_bytes_ += it->allocation_size();
+  }
+
+  void set_value(iterator it, std::string_view value) {
+    update(it, [this, value](KvEntry &entry) { entry.set_value(value, slabs_.get()); });
+  }
+  void set_int(iterator it, int64_t value) {
+    update(it, [this, value](KvEntry &entry) { entry.set_int(value, slabs_.get()); });
+  }
+  // 在 fn(bytes) 中原地修改字符串值的字节，值先扩展到至少 len 字节。修改位图的命令通过它进行
+  template <typename Fn> void update_raw(iterator it, size_t len, Fn fn) {
+    update(it, [&](KvEntry &entry) {
+      fn(entry.writable_raw(len, slabs_.get()));
+      entry.normalize_int(slabs_.get());
+    });
+  }
+  void set_expire(iterator it, std::chrono::steady_clock::time_point when) {
+    update(it, [this, when](KvEntry &entry) { entry.set_expire(when, slabs_.get()); });
+  }
+  void clear_expire(iterator it) {
+    update(it, [this](KvEntry &entry) { entry.clear_expire(slabs_.get()); });
+  }
+
+  // --- 访问信息 ---
+  // LFU 策略下条目记录访问频率，否则记录最近一次访问的时刻
+  void set_lfu(bool lfu) { lfu_ = lfu; }
+  bool lfu() const { return lfu_; }
+  // 访问键时不读系统时钟，而是使用缓存的秒级时钟，由事件循环定期刷新
+  void update_clock() { clock_s_ = now_seconds(); }
+  uint64_t clock() const { return clock_s_; }
+  // 记录一次访问
+  void touch(iterator it) {
+    it->set_lru(lfu_ ? lfu_touch(it->lru(), clock_s_, next_random()) : lru_clock(clock_s_));
+  }
+
+  // 所有条目占用的字节数
+  size_t entry_bytes() const { return entry_bytes_; }
+  // 键空间总占用：哈希表本身加上所有条目
+  size_t memory_bytes() const { return table_bytes() + entry_bytes_; }
+
+  // --- slab 与碎片整理 ---
+  const SlabAllocator &slabs() const { return *slabs_; }
+  // 条目实际占用的内存：slab 总大小加上堆上的条目
+  size_t allocated_entry_bytes() const {
+    return slabs_->slab_bytes() + (entry_bytes_ - slabs_->requested_bytes());
+  }
+  // 碎片率：条目实际占用的内存与条目逻辑大小之比，没有条目时为 1
+  double fragmentation_ratio() const {
+    return entry_bytes_ == 0 ? 1.0 : static_cast<double>(allocated_entry_bytes()) / entry_bytes_;
+  }
+  // 开始一遍碎片整理：标记占用率不超过 max_occupancy 的 slab，返回是否有需要搬迁的条目
+  bool begin_defrag(double max_occupancy) {
+    slabs_->mark_sparse_slabs(max_occupancy);
+    return slabs_->evacuating_slabs() > 0;
+  }
+  // 从游标 cursor 开始扫描最多 max_slots 个槽位，把位于正在清空的 slab 中的条目搬走。
+  // 返回下一个游标，0 表示这一遍扫描完成。hits 计搬迁的条目，misses 计扫描到但无需搬迁的条目
+  size_t defrag_slots(size_t cursor, size_t max_slots, size_t &hits, size_t &misses) {
+    return walk_slots(cursor, max_slots, [&](KvEntry &entry) {
+      if (entry.in_evacuating_slab()) {
+        entry.relocate(slabs_.get());
+        ++hits;
+      } else {
+        ++misses;
+      }
+    });
+  }
+
+private:
+  static uint64_t now_seconds() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::seconds>(
+                                     std::chrono::steady_clock::now().time_since_epoch())
+                                     .count());
+  }
+
+  // xorshift32，只用于 LFU 计数器的概率递增
+  uint32_t next_random() {
+    random_ ^= random_ << 13;
+    random_ ^= random_ >> 17;
+    random_ ^= random_ << 5;
+    return random_;
+  }
+
+  std::unique_ptr<SlabAllocator> slabs_;
+  size_t entry_bytes_ = 0;
+  bool lfu_ = false;
+  uint64_t clock_s_ = now_seconds();
+  uint32_t random_ = 2463534242u;
 };
 
-// 定义存储类型别名
-export using Storage = std::unordered_map<std::string, KeyValue>;
+// 命令参数：指向请求数据的视图，不含命令名
+export using CommandArgs = std::span<const std::string_view>;
 
-// 命令接口
-export class Command {
-public:
-  virtual ~Command() = default;
-  virtual std::string execute() = 0;
-  virtual bool should_replicate() const { return false; }
-  virtual const resp::RespValue &get_original_command() const = 0;
+// 过期时间在内存中以 steady_clock 保存，不受系统时间调整影响；
+// 写入 AOF 和 EXAT/PXAT 参数使用 Unix 毫秒时间戳，两者按当前时刻换算。
+// 把过期时间换算为 Unix 毫秒时间戳
+export int64_t to_unix_ms(std::chrono::steady_clock::time_point when) {
+  auto remaining = when - std::chrono::steady_clock::now();
+  auto unix_now = std::chrono::system_clock::now().time_since_epoch();
+  return std::chrono::duration_cast<std::chrono::milliseconds>(unix_now + remaining).count();
+}
+
+// 过期时间参数的单位：EX/PX 为相对时间，EXAT/PXAT 为 Unix 时间戳
+export enum class ExpireUnit { Seconds, Milliseconds, UnixSeconds, UnixMilliseconds };
+
+export enum class ExpireParseResult {
+  Ok,
+  NotInteger, // 参数不是整数
+  Invalid,    // 不是正数，或超出可表示的范围
 };
 
-// 命令工厂接口
-export class CommandFactory {
-public:
-  virtual ~CommandFactory() = default;
-  virtual std::unique_ptr<Command>
-  create_command(const resp::RespValue &command_variant, bool from_aof) = 0;
+// 解析过期时间参数，结果换算为 steady_clock 时间点
+export ExpireParseResult parse_expire_time(std::string_view arg, ExpireUnit unit,
+                                           std::chrono::steady_clock::time_point &when) {
+  int64_t value;
+  if (!parse_canonical_int(arg, value)) {
+    return ExpireParseResult::NotInteger;
+  }
+  bool seconds = unit == ExpireUnit::Seconds || unit == ExpireUnit::UnixSeconds;
+  if (value <= 0 || (seconds && value > std::numeric_limits<int64_t>::max() / 1000)) {
+    return ExpireParseResult::Invalid;
+  }
+  int64_t ms = seconds ? value * 1000 : value;
+  // 时间点精度为纳秒，剩余时间限制在约 139 年内以免溢出；时间戳早于当前时刻时剩余时间为负，键立即过期
+  constexpr int64_t MAX_REMAINING_MS = int64_t{1} << 42;
+  int64_t remaining = ms;
+  if (unit == ExpireUnit::UnixSeconds || unit == ExpireUnit::UnixMilliseconds) {
+    remaining = ms - std::chrono::duration_cast<std::chrono::milliseconds>(
+                         std::chrono::system_clock::now().time_since_epoch())
+                         .count();
+  }
+  if (remaining > MAX_REMAINING_MS) {
+    return ExpireParseResult::Invalid;
+  }
+  when = std::chrono::steady_clock::now() + std::chrono::milliseconds(remaining);
+  return ExpireParseResult::Ok;
+}
+
+// 过期时间参数解析失败时写出错误回复，command 为小写命令名
+export void write_expire_error(Buffer &out, ExpireParseResult result, std::string_view command) {
+  if (result == ExpireParseResult::NotInteger) {
+    resp::write_error(out, "ERR value is not an integer or out of range");
+  } else {
+    resp::write_error(out, std::format("ERR invalid expire time in '{}' command", command));
+  }
+}
+
+// 命令选项按不区分大小写的方式匹配，option 为大写形式
+export bool option_is(std::string_view arg, std::string_view option) {
+  if (arg.size() != option.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < arg.size(); ++i) {
+    char c = arg[i];
+    if (c >= 'a' && c <= 'z') {
+      c = static_cast<char>(c - 'a' + 'A');
+    }
+    if (c != option[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// glob 风格的模式匹配：* 匹配任意串，? 匹配任意单个字符，[abc]、[^a]、[a-z] 匹配字符集合，
+// \ 转义下一个字符。'*' 失配时回到上一个 '*' 多吞一个字符重试，不递归
+export bool glob_match(std::string_view pattern, std::string_view str) {
+  size_t p = 0;
+  size_t s = 0;
+  size_t star_p = std::string_view::npos; // 上一个 '*' 之后的模式位置
+  size_t star_s = 0;                      // 上一个 '*' 已吞到的字符串位置
+  while (s < str.size()) {
+    if (p < pattern.size()) {
+      char c = pattern[p];
+      if (c == '*') {
+        while (p < pattern.size() && pattern[p] == '*') {
+          ++p;
+        }
+        if (p == pattern.size()) {
+          return true;
+        }
+        star_p = p;
+        star_s = s;
+        continue;
+      }
+      bool matched = false;
+      size_t next = p + 1;
+      if (c == '?') {
+        matched = true;
+      } else if (c == '[') {
+        size_t i = p + 1;
+        bool negate = i < pattern.size() && pattern[i] == '^';
+        if (negate) {
+          ++i;
+        }
+        bool in_set = false;
+        while (i < pattern.size() && pattern[i] != ']') {
+          if (pattern[i] == '\\' && i + 1 < pattern.size()) {
+            in_set = in_set || pattern[i + 1] == str[s];
+            i += 2;
+          } else if (i + 2 < pattern.size() && pattern[i + 1] == '-' && pattern[i + 2] != ']') {
+            char lo = std::min(pattern[i], pattern[i + 2]);
+            char hi = std::max(pattern[i], pattern[i + 2]);
+            in_set = in_set || (str[s] >= lo && str[s] <= hi);
+            i += 3;
+          } else {
+            in_set = in_set || pattern[i] == str[s];
+            ++i;
+          }
+        }
+        next = i < pattern.size() ? i + 1 : i; // 没有 ']' 时把模式末尾当作集合结束
+        matched = in_set != negate;
+      } else {
+        if (c == '\\' && p + 1 < pattern.size()) {
+          c = pattern[++p];
+          next = p + 1;
+        }
+        matched = c == str[s];
+      }
+      if (matched) {
+        p = next;
+        ++s;
+        continue;
+      }
+    }
+    if (star_p == std::string_view::npos) {
+      return false;
+    }
+    p = star_p;
+    s = ++star_s;
+  }
+  while (p < pattern.size() && pattern[p] == '*') {
+    ++p;
+  }
+  return p == pattern.size();
+}
+
+// 解析 SCAN 游标：无符号 64 位十进制整数
+export bool parse_scan_cursor(std::string_view arg, uint64_t &cursor) {
+  if (arg.empty()) {
+    return false;
+  }
+  auto [ptr, ec] = std::from_chars(arg.data(), arg.data() + arg.size(), cursor);
+  return ec == std::errc() && ptr == arg.data() + arg.size();
+}
+
+// 按 Redis 的规则规范化下标区间（LRANGE、ZRANGE 等）：负数从尾部计数，超出两端的部分截掉。区间为空时返回 false
+export bool normalize_range(int64_t start, int64_t stop, size_t size, size_t &first, size_t &last) {
+  int64_t n = static_cast<int64_t>(size);
+  if (start < 0) {
+    start += n;
+  }
+  if (stop < 0) {
+    stop += n;
+  }
+  if (start < 0) {
+    start = 0;
+  }
+  if (start > stop || start >= n) {
+    return false;
+  }
+  if (stop >= n) {
+    stop = n - 1;
+  }
+  first = static_cast<size_t>(start);
+  last = static_cast<size_t>(stop);
+  return true;
+}
+
+// 键的值类型与命令不符时的错误
+export constexpr std::string_view WRONGTYPE_ERROR =
+    "WRONGTYPE Operation against a key holding the wrong kind of value";
+
+// 取出条目的值对象并转换为具体类型，调用方需先检查类型
+export template <typename T> T &object_cast(const KvEntry &entry) { return static_cast<T &>(*entry.object()); }
+
+// 以批量字符串写出条目的值，整数编码的值在这里才格式化
+export void write_entry_value(Buffer &out, const KvEntry &entry) {
+  if (entry.is_int()) {
+    resp::write_bulk_integer(out, entry.int_value());
+  } else {
+    resp::write_bulk_string(out, entry.raw_value());
+  }
+}
+
+// 命令写入 AOF 的方式
+export enum class Propagation {
+  Verbatim,   // 原样追加请求
+  Rewritten,  // 追加处理函数改写后的等价命令
+  Suppressed, // 命令没有修改数据，不追加
+};
+
+// 阻塞命令没有可操作的元素时向连接层提出的挂起请求
+export struct BlockRequest {
+  std::vector<std::string> keys;        // 等待的键，其中任一键被压入元素时重新执行命令
+  std::chrono::milliseconds timeout{0}; // 等待的时长，0 表示一直等待
 };
 
+// 默认的惰性释放阈值（字节）
+export constexpr size_t DEFAULT_LAZYFREE_THRESHOLD = 64 * 1024;
+
 // KVServer命令上下文 - 提供给命令访问数据库和其他资源的接口
 export class KVServerContext {
 public:
-  KVServerContext(Storage &db, Aof *aof, ServerStat &stats)
-      : db_(db), aof_(aof), stats_(stats) {}
+  KVServerContext(Storage &db, ExpiresIndex &expires, Aof *aof, ServerStat &stats)
+      : db_(db), expires_(expires), aof_(aof), stats_(stats) {}
+
+  void set_aof(Aof *aof) { aof_ = aof; }
+  // 条目或键空间的占用不小于该字节数时交给后台线程释放
+  void set_lazyfree_threshold(size_t bytes) { lazyfree_threshold_ = bytes; }
+  // 内存上限与淘汰策略，LFU 策略同时切换键空间记录的访问信息
+  void set_maxmemory_config(const MaxmemoryConfig &config) {
+    maxmemory_ = config;
+    db_.set_lfu(config.policy == EvictionPolicy::AllKeysLfu);
+  }
+  const MaxmemoryConfig &maxmemory_config() const { return maxmemory_; }
+  // 各类型紧凑编码的转换阈值
+  void set_encoding_config(const EncodingConfig &config) { encoding_ = config; }
+  const EncodingConfig &encoding_config() const { return encoding_; }
+  // 本键空间在分片组中的编号和分片总数。SCAN 的游标中编码了分片号，按它依次遍历所有分片
+  void set_shard(size_t index, size_t count) {
+    shard_index_ = index;
+    shard_count_ = count;
+  }
+  size_t shard_index() const { return shard_index_; }
+  size_t shard_count() const { return shard_count_; }
+  // 碎片整理是否正在进行，由 KVServer 的碎片整理任务维护，供 INFO 读取
+  void set_active_defrag_running(bool running) { active_defrag_running_ = running; }
+  bool active_defrag_running() const { return active_defrag_running_; }
+  // 计入内存上限的占用：键空间（哈希表和条目）加上过期索引，写入时增量维护
+  size_t used_memory() const { return db_.memory_bytes() + expires_.memory_bytes(); }
 
   // 数据库操作
   Storage &get_db() { return db_; }
+  ExpiresIndex &get_expires() { return expires_; }
   Aof *get_aof() { return aof_; }
   ServerStat &get_stats() { return stats_; }
 
   // 键操作辅助函数
-  bool is_key_expired(const std::string &key, const KeyValue &kv) {
-    if (!kv.expires_at.has_value()) {
+  bool is_key_expired(const KvEntry &entry) {
+    auto expires_at = entry.expires_at();
+    if (!expires_at.has_value()) {
       return false; // 没有设置过期时间
     }
 
-    auto now = std::chrono::steady_clock::now();
-    return now >= kv.expires_at.value();
+    // 命令执行期间使用命令开始时的时间：同一条命令中重复出现的键不会在两次查找之间过期，
+    // 否则第二次查找会释放条目，第一次取得的值对象指针和值视图随之失效
+    auto now = command_time_.value_or(std::chrono::steady_clock::now());
+    return now >= expires_at.value();
+  }
+
+  // --- AOF 传播控制 ---
+  // 默认原样追加请求。处理函数可以把命令改写为重放结果确定的等价命令
+  // （如把相对过期时间换算为绝对时间），或在没有修改数据时取消追加
+  void propagate_as(std::initializer_list<std::string_view> argv) {
+    propagation_ = Propagation::Rewritten;
+    if (!aof_) {
+      return; // 没有开启 AOF 时不必保存改写结果
+    }
+    propagated_args_.assign(argv.begin(), argv.end());
+    propagated_views_.assign(propagated_args_.begin(), propagated_args_.end());
+  }
+  void suppress_propagation() { propagation_ = Propagation::Suppressed; }
+  // 设置过期时间的命令统一改写为 "PEXPIREAT key <Unix 毫秒>"
+  void propagate_pexpireat(std::string_view key, std::chrono::steady_clock::time_point when) {
+    std::string unix_ms = std::to_string(to_unix_ms(when));
+    propagate_as({"PEXPIREAT", key, unix_ms});
+  }
+
+  // 由 KVServer 在每条命令执行前重置、执行后读取
+  void begin_command() {
+    propagation_ = Propagation::Verbatim;
+    block_request_.reset();
+    command_time_ = std::chrono::steady_clock::now();
+  }
+  // 命令结束后定期删除等任务重新按当前时间判断过期
+  void end_command() { command_time_.reset(); }
+  Propagation propagation() const { return propagation_; }
+  std::span<const std::string_view> propagated_argv() const { return propagated_views_; }
+
+  // --- 阻塞命令 ---
+  // 阻塞命令在所有键上都没有元素时调用，并照常写出超时时的空回复。
+  // 直接来自客户端的命令由连接层挂起，回复留到超时时发送；事务和 AOF 重放中的命令直接得到空回复
+  void block_on(std::span<const std::string_view> keys, std::chrono::milliseconds timeout) {
+    block_request_.emplace(std::vector<std::string>(keys.begin(), keys.end()), timeout);
+  }
+  const std::optional<BlockRequest> &block_request() const { return block_request_; }
+
+  // 有客户端在等待的键，由连接层在键的等待队列变为非空和变空时维护
+  void watch_blocking_key(std::string_view key) { blocking_keys_.emplace(key); }
+  void unwatch_blocking_key(std::string_view key) {
+    if (auto it = blocking_keys_.find(key); it != blocking_keys_.end()) {
+      blocking_keys_.erase(it);
+    }
+  }
+  // 向列表压入元素后调用。有客户端在等待该键时记为就绪，连接层在本轮事件循环内依次唤醒等待者。
+  // 没有客户端阻塞时只是一次空集合检查
+  void signal_key_ready(std::string_view key) {
+    if (!blocking_keys_.empty() && blocking_keys_.contains(key)) {
+      ready_keys_.emplace_back(key);
+    }
+  }
+  bool has_ready_keys() const { return !ready_keys_.empty(); }
+  std::vector<std::string> take_ready_keys() { return std::exchange(ready_keys_, {}); }
+
+  // 查找键，已过期的键在这里惰性删除并按不存在处理；找到的键记录一次访问
+  Storage::iterator find_live_key(std::string_view key) {
+    auto it = db_.find(key);
+    if (it != db_.end()) {
+      if (is_key_expired(*it)) {
+        LOG_DEBUG("删除过期键: {}", key);
+        expire_key(it);
+        return db_.end();
+      }
+      db_.touch(it);
+    }
+    return it;
+  }
+
+  // 批量查找 count 个键（key_at(i) 给出第 i 个键），按顺序对每个键调用 fn(i, iterator)。
+  // 查找经过预取流水线，已过期的键惰性删除并按不存在处理
+  template <typename KeyAt, typename Fn> void find_live_keys(size_t count, KeyAt &&key_at, Fn &&fn) {
+    db_.find_batch(count, key_at, [&](size_t i, Storage::iterator it) {
+      if (it != db_.end()) {
+        if (is_key_expired(*it)) {
+          LOG_DEBUG("删除过期键: {}", it->key());
+          expire_key(it);
+          it = db_.end();
+        } else {
+          db_.touch(it);
+        }
+      }
+      fn(i, it);
+    });
+  }
+
+  // 设置键的过期时间，同时更新过期索引
+  void set_expire(Storage::iterator it, std::chrono::steady_clock::time_point when) {
+    db_.set_expire(it, when);
+    expires_.set(it->key(), when);
+  }
+
+  // 移除键的过期时间，键原本没有过期时间时返回 false
+  bool persist(Storage::iterator it) {
+    if (!it->has_expire()) {
+      return false;
+    }
+    expires_.erase(it->key());
+    db_.clear_expire(it);
+    return true;
+  }
+
+  // 删除一个键，带过期时间的键同时从过期索引中移除
+  void erase_key(Storage::iterator it) {
+    if (it->has_expire()) {
+      expires_.erase(it->key());
+    }
+    db_.erase(it);
+  }
+
+  // 删除一个键，值不小于惰性释放阈值时交给后台线程释放
+  void unlink_key(Storage::iterator it) {
+    if (it->has_expire()) {
+      expires_.erase(it->key());
+    }
+    free_entry(db_.extract(it));
+  }
+
+  // 覆盖键的值。旧值不小于惰性释放阈值时不原地改写，而是换上新条目，旧条目交给后台线程释放
+  void overwrite_value(Storage::iterator it, std::string_view value) {
+    if (it->allocation_size() < lazyfree_threshold_) {
+      db_.set_value(it, value);
+      return;
+    }
+    free_entry(db_.replace(it, db_.create_entry(it->key(), value, it->expires_at())));
   }
 
-  bool delete_expired_key(const std::string &key) {
+  // 清空键空间和过期索引。async 为 true 且键空间不小于惰性释放阈值时，
+  // 两者整体换成空表后交给后台线程释放，否则在当前线程同步释放
+  void flush(bool async) {
+    if (async && db_.memory_bytes() >= lazyfree_threshold_) {
+      LOG_DEBUG("键空间交给后台线程释放: {} 个键", db_.size());
+      // 新键空间沿用当前的淘汰策略设置，否则 LFU 策略下新键会被记上 LRU 时钟
+      Storage fresh;
+      fresh.set_lfu(db_.lfu());
+      fresh.update_clock();
+      LazyFree::instance().free_later(std::exchange(db_, std::move(fresh)));
+      LazyFree::instance().free_later(std::exchange(expires_, ExpiresIndex{}));
+      return;
+    }
+    db_.clear();
+    expires_.clear();
+  }
+
+  // 因内存上限淘汰一个键。AOF 中记为 DEL，重放结果与重放时的内存上限无关
+  void evict_key(Storage::iterator it) {
+    if (aof_) {
+      std::string_view argv[] = {"DEL", it->key()};
+      aof_->append(argv);
+    }
+    unlink_key(it);
+    stats_.increment_evicted_keys();
+  }
+
+  // 释放一个已从键空间取出的条目。slab 中的条目只能在键空间所在的线程释放，
+  // 其中的大对象取出后单独交给后台线程
+  void free_entry(KvEntry entry) {
+    if (entry.allocation_size() < lazyfree_threshold_) {
+      return;
+    }
+    if (!entry.in_slab()) {
+      LazyFree::instance().free_later(std::move(entry));
+    } else if (entry.is_object()) {
+      LazyFree::instance().free_later(entry.take_object());
+    }
+  }
+
+  // 删除一个已过期的键并计入过期统计
+  void expire_key(Storage::iterator it) {
+    erase_key(it);
+    stats_.increment_expired_keys();
+  }
+
+  // 查找存活的键并检查值类型。类型不符时写出 WRONGTYPE 错误并返回 false；
+  // 键不存在时 it 为 end()，返回 true
+  bool find_live_key_of(std::string_view key, ObjectType type, Storage::iterator &it, Buffer &out) {
+    it = find_live_key(key);
+    if (it != db_.end() && (!it->is_object() || it->object()->type() != type)) {
+      resp::write_error(out, WRONGTYPE_ERROR);
+      return false;
+    }
+    return true;
+  }
+
+  bool delete_expired_key(std::string_view key) {
     auto it = db_.find(key);
     if (it == db_.end()) {
       return false;
     }
 
-    if (!is_key_expired(key, it->second)) {
+    if (!is_key_expired(*it)) {
       return false; // 键未过期
     }
 
     LOG_DEBUG("删除过期键: {}", key);
-    db_.erase(it);
+    expire_key(it);
     return true;
   }
 
 private:
   Storage &db_;
+  ExpiresIndex &expires_;
   Aof *aof_;
   ServerStat &stats_;
-};
\ No newline at end of file
+  size_t lazyfree_threshold_ = DEFAULT_LAZYFREE_THRESHOLD;
+  MaxmemoryConfig maxmemory_;
+  EncodingConfig encoding_;
+  bool active_defrag_running_ = false;
+  size_t shard_index_ = 0;
+  size_t shard_count_ = 1;
+  Propagation propagation_ = Propagation::Verbatim;
+  std::vector<std::string> propagated_args_;
+  std::vector<std::string_view> propagated_views_;
+  std::optional<BlockRequest> block_request_;
+  std::optional<std::chrono::steady_clock::time_point> command_time_; // 执行中的命令开始的时间
+
+  struct KeyHash {
+    using is_transparent = void;
+    size_t operator()(std::string_view s) const noexcept { return std::hash<std::string_view>{}(s); }
+  };
+  std::unordered_set<std::string, KeyHash, std::equal_to<>> blocking_keys_;
+  std::vector<std::string> ready_keys_; // 本轮被压入元素、且有客户端在等待的键
+};
+
+// 命令处理函数：无状态，参数个数已按命令表检查过，回复直接写入输出缓冲区。
+// 是否追加到 AOF 由命令表决定，处理函数只在需要改写或取消追加时调用上下文的传播控制
+export using CommandHandler = void (*)(KVServerContext &context, CommandArgs args,
+                                       Buffer &out);
@@ -0,0 +1,135 @@
+module;
+
+#include <array>
+#include <cstddef>
+
+export module command_handlers;
+
+import command_defs;
+import command_table;
+import get_command;
+import set_command;
+import expire_command;
+import pexpire_command;
+import ttl_command;
+import pttl_command;
+import persist_command;
+import info_command;
+import incr_command;
+import incrbyfloat_command;
+import getex_command;
+import getdel_command;
+import expireat_command;
+import mget_command;
+import mset_command;
+import del_command;
+import exists_command;
+import flush_command;
+import scan_command;
+import object_command;
+import hash_command;
+import list_command;
+import set_type_command;
+import zset_command;
+import bitmap_command;
+
+// 按命令编号索引的处理函数表。命令对象不再在每次请求时创建，
+// 执行一条命令只是一次数组访问加一次函数调用，不分配内存
+constexpr std::array<CommandHandler, COMMAND_TABLE.size()> make_handler_table() {
+  std::array<CommandHandler, COMMAND_TABLE.size()> handlers{};
+  handlers[static_cast<size_t>(CommandId::Get)] = get_command;
+  handlers[static_cast<size_t>(CommandId::Set)] = set_command;
+  handlers[static_cast<size_t>(CommandId::Expire)] = expire_command;
+  handlers[static_cast<size_t>(CommandId::PExpire)] = pexpire_command;
+  handlers[static_cast<size_t>(CommandId::TTL)] = ttl_command;
+  handlers[static_cast<size_t>(CommandId::PTTL)] = pttl_command;
+  handlers[static_cast<size_t>(CommandId::Persist)] = persist_command;
+  handlers[static_cast<size_t>(CommandId::Info)] = info_command;
+  handlers[static_cast<size_t>(CommandId::Incr)] = incr_command;
+  handlers[static_cast<size_t>(CommandId::Decr)] = decr_command;
+  handlers[static_cast<size_t>(CommandId::IncrBy)] = incrby_command;
+  handlers[static_cast<size_t>(CommandId::DecrBy)] = decrby_command;
+  handlers[static_cast<size_t>(CommandId::IncrByFloat)] = incrbyfloat_command;
+  handlers[static_cast<size_t>(CommandId::SetNx)] = setnx_command;
+  handlers[static_cast<size_t>(CommandId::SetEx)] = setex_command;
+  handlers[static_cast<size_t>(CommandId::PSetEx)] = psetex_command;
+  handlers[static_cast<size_t>(CommandId::GetEx)] = getex_command;
+  handlers[static_cast<size_t>(CommandId::GetDel)] = getdel_command;
+  handlers[static_cast<size_t>(CommandId::ExpireAt)] = expireat_command;
+  handlers[static_cast<size_t>(CommandId::PExpireAt)] = pexpireat_command;
+  handlers[static_cast<size_t>(CommandId::MGet)] = mget_command;
+  handlers[static_cast<size_t>(CommandId::MSet)] = mset_command;
+  handlers[static_cast<size_t>(CommandId::MSetNx)] = msetnx_command;
+  handlers[static_cast<size_t>(CommandId::Del)] = del_command;
+  handlers[static_cast<size_t>(CommandId::Exists)] = exists_command;
+  handlers[static_cast<size_t>(CommandId::Unlink)] = unlink_command;
+  handlers[static_cast<size_t>(CommandId::FlushDb)] = flushdb_command;
+  handlers[static_cast<size_t>(CommandId::FlushAll)] = flushall_command;
+  handlers[static_cast<size_t>(CommandId::Scan)] = scan_command;
+  handlers[static_cast<size_t>(CommandId::Type)] = type_command;
+  handlers[static_cast<size_t>(CommandId::Object)] = object_command;
+  handlers[static_cast<size_t>(CommandId::HSet)] = hset_command;
+  handlers[static_cast<size_t>(CommandId::HGet)] = hget_command;
+  handlers[static_cast<size_t>(CommandId::HMGet)] = hmget_command;
+  handlers[static_cast<size_t>(CommandId::HDel)] = hdel_command;
+  handlers[static_cast<size_t>(CommandId::HIncrBy)] = hincrby_command;
+  handlers[static_cast<size_t>(CommandId::HGetAll)] = hgetall_command;
+  handlers[static_cast<size_t>(CommandId::HScan)] = hscan_command;
+  handlers[static_cast<size_t>(CommandId::LPush)] = lpush_command;
+  handlers[static_cast<size_t>(CommandId::RPush)] = rpush_command;
+  handlers[static_cast<size_t>(CommandId::LPop)] = lpop_command;
+  handlers[static_cast<size_t>(CommandId::RPop)] = rpop_command;
+  handlers[static_cast<size_t>(CommandId::LLen)] = llen_command;
+  handlers[static_cast<size_t>(CommandId::LIndex)] = lindex_command;
+  handlers[static_cast<size_t>(CommandId::LRange)] = lrange_command;
+  handlers[static_cast<size_t>(CommandId::LTrim)] = ltrim_command;
+  handlers[static_cast<size_t>(CommandId::LMove)] = lmove_command;
+  handlers[static_cast<size_t>(CommandId::BLPop)] = blpop_command;
+  handlers[static_cast<size_t>(CommandId::BRPop)] = brpop_command;
+  handlers[static_cast<size_t>(CommandId::BLMove)] = blmove_command;
+  handlers[static_cast<size_t>(CommandId::SAdd)] = sadd_command;
+  handlers[static_cast<size_t>(CommandId::SRem)] = srem_command;
+  handlers[static_cast<size_t>(CommandId::SIsMember)] = sismember_command;
+  handlers[static_cast<size_t>(CommandId::SMembers)] = smembers_command;
+  handlers[static_cast<size_t>(CommandId::SCard)] = scard_command;
+  handlers[static_cast<size_t>(CommandId::SInter)] = sinter_command;
+  handlers[static_cast<size_t>(CommandId::SUnion)] = sunion_command;
+  handlers[static_cast<size_t>(CommandId::SDiff)] = sdiff_command;
+  handlers[static_cast<size_t>(CommandId::SInterStore)] = sinterstore_command;
+  handlers[static_cast<size_t>(CommandId::SUnionStore)] = sunionstore_command;
+  handlers[static_cast<size_t>(CommandId::SDiffStore)] = sdiffstore_command;
+  handlers[static_cast<size_t>(CommandId::ZAdd)] = zadd_command;
+  handlers[static_cast<size_t>(CommandId::ZIncrBy)] = zincrby_command;
+  handlers[static_cast<size_t>(CommandId::ZScore)] = zscore_command;
+  handlers[static_cast<size_t>(CommandId::ZRank)] = zrank_command;
+  handlers[static_cast<size_t>(CommandId::ZCard)] = zcard_command;
+  handlers[static_cast<size_t>(CommandId::ZRange)] = zrange_command;
+  handlers[static_cast<size_t>(CommandId::ZRem)] = zrem_command;
+  handlers[static_cast<size_t>(CommandId::ZRemRangeByScore)] = zremrangebyscore_command;
+  handlers[static_cast<size_t>(CommandId::ZPopMin)] = zpopmin_command;
+  handlers[static_cast<size_t>(CommandId::SetBit)] = setbit_command;
+  handlers[static_cast<size_t>(CommandId::GetBit)] = getbit_command;
+  handlers[static_cast<size_t>(CommandId::BitCount)] = bitcount_command;
+  handlers[static_cast<size_t>(CommandId::BitPos)] = bitpos_command;
+  handlers[static_cast<size_t>(CommandId::BitOp)] = bitop_command;
+  handlers[static_cast<size_t>(CommandId::BitField)] = bitfield_command;
+  // 事务控制命令由连接层处理，没有处理函数
+  return handlers;
+}
+
+constexpr auto HANDLER_TABLE = make_handler_table();
+
+// 命令表中的编号与表项位置一致，处理函数表才能按编号索引
+static_assert([] {
+  for (size_t i = 0; i < COMMAND_TABLE.size(); ++i) {
+    if (static_cast<size_t>(COMMAND_TABLE[i].id) != i) {
+      return false;
+    }
+  }
+  return true;
+}());
+
+// 查找命令的处理函数，事务控制命令返回 nullptr
+export constexpr CommandHandler handler_of(const CommandSpec &spec) {
+  return HANDLER_TABLE[static_cast<size_t>(spec.id)];
+}
@@ -0,0 +1,362 @@
+module;
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+export module command_table;
+
+// 命令编号，命令表中的每一项对应一个编号
+export enum class CommandId : uint8_t {
+  Get,
+  Set,
+  Expire,
+  PExpire,
+  TTL,
+  PTTL,
+  Persist,
+  Info,
+  Incr,
+  Decr,
+  IncrBy,
+  DecrBy,
+  IncrByFloat,
+  SetNx,
+  SetEx,
+  PSetEx,
+  GetEx,
+  GetDel,
+  ExpireAt,
+  PExpireAt,
+  MGet,
+  MSet,
+  MSetNx,
+  Del,
+  Exists,
+  Unlink,
+  FlushDb,
+  FlushAll,
+  Scan,
+  Type,
+  Object,
+  HSet,
+  HGet,
+  HMGet,
+  HDel,
+  HIncrBy,
+  HGetAll,
+  HScan,
+  LPush,
+  RPush,
+  LPop,
+  RPop,
+  LLen,
+  LIndex,
+  LRange,
+  LTrim,
+  LMove,
+  BLPop,
+  BRPop,
+  BLMove,
+  SAdd,
+  SRem,
+  SIsMember,
+  SMembers,
+  SCard,
+  SInter,
+  SUnion,
+  SDiff,
+  SInterStore,
+  SUnionStore,
+  SDiffStore,
+  ZAdd,
+  ZIncrBy,
+  ZScore,
+  ZRank,
+  ZCard,
+  ZRange,
+  ZRem,
+  ZRemRangeByScore,
+  ZPopMin,
+  SetBit,
+  GetBit,
+  BitCount,
+  BitPos,
+  BitOp,
+  BitField,
+  Multi,
+  Exec,
+  Discard,
+};
+
+// 命令标志
+export enum CommandFlag : uint32_t {
+  CMD_WRITE = 1u << 0,        // 修改键空间
+  CMD_READONLY = 1u << 1,     // 只读取键空间
+  CMD_PROPAGATE = 1u << 2,    // 执行后追加到 AOF
+  CMD_CONNECTION = 1u << 3,   // 由连接层处理（事务控制），不进入键空间
+  CMD_ALL_SHARDS = 1u << 4,   // 无键命令，多分片时在每个分片上执行
+  CMD_DENYOOM = 1u << 5,      // 可能增加内存占用，超过内存上限且无法淘汰时拒绝执行
+  CMD_SHARD_CURSOR = 1u << 6, // 第一个参数是编码了分片号的游标（SCAN），多分片时按游标路由
+  CMD_BLOCKING = 1u << 7,     // 没有可操作的数据时可能挂起客户端，由连接层放入键的等待队列
+};
+
+// 命令的静态元数据
+export struct CommandSpec {
+  std::string_view name; // 大写命令名
+  CommandId id;
+  // 参数个数（含命令名）。正数表示必须恰好相等，负数 -N 表示至少 N 个
+  int arity;
+  uint32_t flags;
+  int first_key; // 第一个键的位置，0 表示命令没有键
+  int last_key;  // 最后一个键的位置，-1 表示最后一个参数
+  int key_step;  // 相邻两个键之间的距离
+
+  constexpr bool has_flag(uint32_t flag) const { return (flags & flag) != 0; }
+  constexpr bool check_arity(size_t argc) const {
+    return arity >= 0 ? argc == static_cast<size_t>(arity)
+                      : argc >= static_cast<size_t>(-arity);
+  }
+  constexpr bool has_keys() const { return first_key > 0; }
+};
+
+// 命令表
+export inline constexpr std::array COMMAND_TABLE = {
+    CommandSpec{"GET", CommandId::Get, 2, CMD_READONLY, 1, 1, 1},
+    CommandSpec{"SET", CommandId::Set, -3, CMD_WRITE | CMD_DENYOOM | CMD_PROPAGATE, 1, 1, 1},
+    CommandSpec{"EXPIRE", CommandId::Expire, 3, CMD_WRITE | CMD_PROPAGATE, 1, 1, 1},
+    CommandSpec{"PEXPIRE", CommandId::PExpire, 3, CMD_WRITE | CMD_PROPAGATE, 1, 1, 1},
+    CommandSpec{"TTL", CommandId::TTL, 2, CMD_READONLY, 1, 1, 1},
+    CommandSpec{"PTTL", CommandId::PTTL, 2, CMD_READONLY, 1, 1, 1},
+    CommandSpec{"PERSIST", CommandId::Persist, 2, CMD_WRITE | CMD_PROPAGATE, 1, 1, 1},
+    CommandSpec{"INFO", CommandId::Info, -1, 0, 0, 0, 0},
+    CommandSpec{"INCR", CommandId::Incr, 2, CMD_WRITE | CMD_DENYOOM | CMD_PROPAGATE, 1, 1, 1},
+    CommandSpec{"DECR", CommandId::Decr, 2, CMD_WRITE | CMD_DENYOOM | CMD_PROPAGATE, 1, 1, 1},
+    CommandSpec{"INCRBY", CommandId::IncrBy, 3, CMD_WRITE | CMD_DENYOOM | CMD_PROPAGATE, 1, 1, 1},
+    CommandSpec{"DECRBY", CommandId::DecrBy, 3, CMD_WRITE | CMD_DENYOOM | CMD_PROPAGATE, 1, 1, 1},
+    CommandSpec{"INCRBYFLOAT", CommandId::IncrByFloat, 3, CMD_WRITE | CMD_DENYOOM | CMD_PROPAGATE, 1, 1, 1},
+    CommandSpec{"SETNX", CommandId::SetNx, 3, CMD_WRITE | CMD_DENYOOM | CMD_PROPAGATE, 1, 1, 1},
+    CommandSpec{"SETEX", CommandId::SetEx, 4, CMD_WRITE | CMD_DENYOOM | CMD_PROPAGATE, 1, 1, 1},
+    CommandSpec{"PSETEX", CommandId::PSetEx, 4, CMD_WRITE | CMD_DENYOOM | CMD_PROPAGATE, 1, 1, 1},
+    CommandSpec{"GETEX", CommandId::GetEx, -2, CMD_WRITE | CMD_PROPAGATE, 1, 1, 1},
+    CommandSpec{"GETDEL", CommandId::GetDel, 2, CMD_WRITE | CMD_PROPAGATE, 1, 1, 1},
+    CommandSpec{"EXPIREAT", CommandId::ExpireAt, 3, CMD_WRITE | CMD_PROPAGATE, 1, 1, 1},
+    CommandSpec{"PEXPIREAT", CommandId::PExpireAt, 3, CMD_WRITE | CMD_PROPAGATE, 1, 1, 1},
+    CommandSpec{"MGET", CommandId::MGet, -2, CMD_READONLY, 1, -1, 1},
+    CommandSpec{"MSET", CommandId::MSet, -3, CMD_WRITE | CMD_DENYOOM | CMD_PROPAGATE, 1, -1, 2},
+    CommandSpec{"MSETNX", CommandId::MSetNx, -3, CMD_WRITE | CMD_DENYOOM | CMD_PROPAGATE, 1, -1, 2},
+    CommandSpec{"DEL", CommandId::Del, -2, CMD_WRITE | CMD_PROPAGATE, 1, -1, 1},
+    CommandSpec{"EXISTS", CommandId::Exists, -2, CMD_READONLY, 1, -1, 1},
+    CommandSpec{"UNLINK", CommandId::Unlink, -2, CMD_WRITE | CMD_PROPAGATE, 1, -1, 1},
+    CommandSpec{"FLUSHDB", CommandId::FlushDb, -1, CMD_WRITE | CMD_PROPAGATE | CMD_ALL_SHARDS, 0, 0, 0},
+    CommandSpec{"FLUSHALL", CommandId::FlushAll, -1, CMD_WRITE | CMD_PROPAGATE | CMD_ALL_SHARDS, 0, 0, 0},
+    CommandSpec{"SCAN", CommandId::Scan, -2, CMD_READONLY | CMD_SHARD_CURSOR, 0, 0, 0},
+    CommandSpec{"TYPE", CommandId::Type, 2, CMD_READONLY, 1, 1, 1},
+    CommandSpec{"OBJECT", CommandId::Object, -2, CMD_READONLY, 2, 2, 1},
+    CommandSpec{"HSET", CommandId::HSet, -4, CMD_WRITE | CMD_DENYOOM | CMD_PROPAGATE, 1, 1, 1},
+    CommandSpec{"HGET", CommandId::HGet, 3, CMD_READONLY, 1, 1, 1},
+    CommandSpec{"HMGET", CommandId::HMGet, -3, CMD_READONLY, 1, 1, 1},
+    CommandSpec{"HDEL", CommandId::HDel, -3, CMD_WRITE | CMD_PROPAGATE, 1, 1, 1},
+    CommandSpec{"HINCRBY", CommandId::HIncrBy, 4, CMD_WRITE | CMD_DENYOOM | CMD_PROPAGATE, 1, 1, 1},
+    CommandSpec{"HGETALL", CommandId::HGetAll, 2, CMD_READONLY, 1, 1, 1},
+    CommandSpec{"HSCAN", CommandId::HScan, -3, CMD_READONLY, 1, 1, 1},
+    CommandSpec{"LPUSH", CommandId::LPush, -3, CMD_WRITE | CMD_DENYOOM | CMD_PROPAGATE, 1, 1, 1},
+    CommandSpec{"RPUSH", CommandId::RPush, -3, CMD_WRITE | CMD_DENYOOM | CMD_PROPAGATE, 1, 1, 1},
+    CommandSpec{"LPOP", CommandId::LPop, -2, CMD_WRITE | CMD_PROPAGATE, 1, 1, 1},
+    CommandSpec{"RPOP", CommandId::RPop, -2, CMD_WRITE | CMD_PROPAGATE, 1, 1, 1},
+    CommandSpec{"LLEN", CommandId::LLen, 2, CMD_READONLY, 1, 1, 1},
+    CommandSpec{"LINDEX", CommandId::LIndex, 3, CMD_READONLY, 1, 1, 1},
+    CommandSpec{"LRANGE", CommandId::LRange, 4, CMD_READONLY, 1, 1, 1},
+    CommandSpec{"LTRIM", CommandId::LTrim, 4, CMD_WRITE | CMD_PROPAGATE, 1, 1, 1},
+    CommandSpec{"LMOVE", CommandId::LMove, 5, CMD_WRITE | CMD_DENYOOM | CMD_PROPAGATE, 1, 2, 1},
+    CommandSpec{"BLPOP", CommandId::BLPop, -3, CMD_WRITE | CMD_PROPAGATE | CMD_BLOCKING, 1, -2, 1},
+    CommandSpec{"BRPOP", CommandId::BRPop, -3, CMD_WRITE | CMD_PROPAGATE | CMD_BLOCKING, 1, -2, 1},
+    CommandSpec{"BLMOVE", CommandId::BLMove, 6, CMD_WRITE | CMD_DENYOOM | CMD_PROPAGATE | CMD_BLOCKING, 1, 2, 1},
+    CommandSpec{"SADD", CommandId::SAdd, -3, CMD_WRITE | CMD_DENYOOM | CMD_PROPAGATE, 1, 1, 1},
+    CommandSpec{"SREM", CommandId::SRem, -3, CMD_WRITE | CMD_PROPAGATE, 1, 1, 1},
+    CommandSpec{"SISMEMBER", CommandId::SIsMember, 3, CMD_READONLY, 1, 1, 1},
+    CommandSpec{"SMEMBERS", CommandId::SMembers, 2, CMD_READONLY, 1, 1, 1},
+    CommandSpec{"SCARD", CommandId::SCard, 2, CMD_READONLY, 1, 1, 1},
+    CommandSpec{"SINTER", CommandId::SInter, -2, CMD_READONLY, 1, -1, 1},
+    CommandSpec{"SUNION", CommandId::SUnion, -2, CMD_READONLY, 1, -1, 1},
+    CommandSpec{"SDIFF", CommandId::SDiff, -2, CMD_READONLY, 1, -1, 1},
+    CommandSpec{"SINTERSTORE", CommandId::SInterStore, -3, CMD_WRITE | CMD_DENYOOM | CMD_PROPAGATE, 1, -1, 1},
+    CommandSpec{"SUNIONSTORE", CommandId::SUnionStore, -3, CMD_WRITE | CMD_DENYOOM | CMD_PROPAGATE, 1, -1, 1},
+    CommandSpec{"SDIFFSTORE", CommandId::SDiffStore, -3, CMD_WRITE | CMD_DENYOOM | CMD_PROPAGATE, 1, -1, 1},
+    CommandSpec{"ZADD", CommandId::ZAdd, -4, CMD_WRITE | CMD_DENYOOM | CMD_PROPAGATE, 1, 1, 1},
+    CommandSpec{"ZINCRBY", CommandId::ZIncrBy, 4, CMD_WRITE | CMD_DENYOOM | CMD_PROPAGATE, 1, 1, 1},
+    CommandSpec{"ZSCORE", CommandId::ZScore, 3, CMD_READONLY, 1, 1, 1},
+    CommandSpec{"ZRANK", CommandId::ZRank, -3, CMD_READONLY, 1, 1, 1},
+    CommandSpec{"ZCARD", CommandId::ZCard, 2, CMD_READONLY, 1, 1, 1},
+    CommandSpec{"ZRANGE", CommandId::ZRange, -4, CMD_READONLY, 1, 1, 1},
+    CommandSpec{"ZREM", CommandId::ZRem, -3, CMD_WRITE | CMD_PROPAGATE, 1, 1, 1},
+    CommandSpec{"ZREMRANGEBYSCORE", CommandId::ZRemRangeByScore, 4, CMD_WRITE | CMD_PROPAGATE, 1, 1, 1},
+    CommandSpec{"ZPOPMIN", CommandId::ZPopMin, -2, CMD_WRITE | CMD_PROPAGATE, 1, 1, 1},
+    CommandSpec{"SETBIT", CommandId::SetBit, 4, CMD_WRITE | CMD_DENYOOM | CMD_PROPAGATE, 1, 1, 1},
+    CommandSpec{"GETBIT", CommandId::GetBit, 3, CMD_READONLY, 1, 1, 1},
+    CommandSpec{"BITCOUNT", CommandId::BitCount, -2, CMD_READONLY, 1, 1, 1},
+    CommandSpec{"BITPOS", CommandId::BitPos, -3, CMD_READONLY, 1, 1, 1},
+    CommandSpec{"BITOP", CommandId::BitOp, -4, CMD_WRITE | CMD_DENYOOM | CMD_PROPAGATE, 2, -1, 1},
+    CommandSpec{"BITFIELD", CommandId::BitField, -2, CMD_WRITE | CMD_DENYOOM | CMD_PROPAGATE, 1, 1, 1},
+    CommandSpec{"MULTI", CommandId::Multi, 1, CMD_CONNECTION, 0, 0, 0},
+    CommandSpec{"EXEC", CommandId::Exec, 1, CMD_CONNECTION, 0, 0, 0},
+    CommandSpec{"DISCARD", CommandId::Discard, 1, CMD_CONNECTION, 0, 0, 0},
+};
+
+// --- 编译期生成的完美哈希 ---
+// 采用“哈希加位移”的两级方案：命令名先做一次忽略大小写的 FNV-1a 哈希，
+// 低位选出桶，桶对应的位移值与哈希混合后得到槽位。位移值在编译期搜索，
+// 保证表中每个命令落在不同的槽位。查找时只需一次哈希、一次槽位访问和一次名字比较，
+// 不分配内存，也不需要先把命令名转换为大写。
+namespace command_hash {
+
+constexpr size_t COMMAND_COUNT = COMMAND_TABLE.size();
+constexpr size_t SLOT_COUNT = std::bit_ceil(COMMAND_COUNT) * 2;
+constexpr size_t BUCKET_COUNT = std::bit_ceil(COMMAND_COUNT) / 2;
+constexpr uint8_t EMPTY_SLOT = 0xFF;
+static_assert(COMMAND_COUNT < EMPTY_SLOT, "命令数量超出槽位编码范围");
+
+constexpr char fold_case(char c) {
+  return (c >= 'a' && c <= 'z') ? static_cast<char>(c - 'a' + 'A') : c;
+}
+
+constexpr uint64_t hash_name(std::string_view name) {
+  uint64_t h = 0xcbf29ce484222325ULL;
+  for (char c : name) {
+    h ^= static_cast<unsigned char>(fold_case(c));
+    h *= 0x100000001b3ULL;
+  }
+  return h;
+}
+
+constexpr size_t slot_of(uint64_t h, uint32_t displacement) {
+  uint64_t x = h ^ (displacement * 0x9E3779B97F4A7C15ULL);
+  x ^= x >> 33;
+  x *= 0xff51afd7ed558ccdULL;
+  x ^= x >> 33;
+  return static_cast<size_t>(x & (SLOT_COUNT - 1));
+}
+
+struct PerfectHash {
+  std::array<uint32_t, BUCKET_COUNT> displacements{};
+  std::array<uint8_t, SLOT_COUNT> slots{};
+  bool ok = true;
+};
+
+constexpr PerfectHash build() {
+  PerfectHash table;
+  for (auto &slot : table.slots) {
+    slot = EMPTY_SLOT;
+  }
+
+  std::array<uint64_t, COMMAND_COUNT> hashes{};
+  std::array<size_t, BUCKET_COUNT> bucket_sizes{};
+  for (size_t i = 0; i < COMMAND_COUNT; ++i) {
+    hashes[i] = hash_name(COMMAND_TABLE[i].name);
+    ++bucket_sizes[hashes[i] & (BUCKET_COUNT - 1)];
+  }
+
+  // 先处理命令多的桶，它们最难放置
+  std::array<bool, BUCKET_COUNT> done{};
+  for (size_t round = 0; round < BUCKET_COUNT; ++round) {
+    size_t bucket = 0;
+    size_t largest = 0;
+    bool found = false;
+    for (size_t b = 0; b < BUCKET_COUNT; ++b) {
+      if (!done[b] && (!found || bucket_sizes[b] > largest)) {
+        bucket = b;
+        largest = bucket_sizes[b];
+        found = true;
+      }
+    }
+    done[bucket] = true;
+    if (largest == 0) {
+      continue;
+    }
+
+    bool placed = false;
+    for (uint32_t d = 0; d < (1u << 16) && !placed; ++d) {
+      std::array<uint8_t, SLOT_COUNT> trial = table.slots;
+      bool fits = true;
+      for (size_t i = 0; i < COMMAND_COUNT && fits; ++i) {
+        if ((hashes[i] & (BUCKET_COUNT - 1)) != bucket) {
+          continue;
+        }
+        size_t slot = slot_of(hashes[i], d);
+        if (trial[slot] != EMPTY_SLOT) {
+          fits = false;
+        } else {
+          trial[slot] = static_cast<uint8_t>(i);
+        }
+      }
+      if (fits) {
+        table.slots = trial;
+        table.displacements[bucket] = d;
+        placed = true;
+      }
+    }
+    if (!placed) {
+      table.ok = false;
+      return table;
+    }
+  }
+  return table;
+}
+
+constexpr PerfectHash TABLE = build();
+static_assert(TABLE.ok, "无法为命令表生成完美哈希");
+
+constexpr bool equals_ignore_case(std::string_view upper, std::string_view name) {
+  if (upper.size() != name.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < name.size(); ++i) {
+    if (upper[i] != fold_case(name[i])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+} // namespace command_hash
+
+// 按命令名（忽略大小写）查找命令，未知命令返回 nullptr
+export constexpr const CommandSpec *lookup_command(std::string_view name) {
+  uint64_t h = command_hash::hash_name(name);
+  uint32_t displacement =
+      command_hash::TABLE.displacements[h & (command_hash::BUCKET_COUNT - 1)];
+  uint8_t index = command_hash::TABLE.slots[command_hash::slot_of(h, displacement)];
+  if (index == command_hash::EMPTY_SLOT) {
+    return nullptr;
+  }
+  const CommandSpec &spec = COMMAND_TABLE[index];
+  return command_hash::equals_ignore_case(spec.name, name) ? &spec : nullptr;
+}
+
+// 编译期自检：每个命令都能以任意大小写查到自身
+static_assert([] {
+  for (const auto &spec : COMMAND_TABLE) {
+    if (lookup_command(spec.name) != &spec) {
+      return false;
+    }
+  }
+  return lookup_command("get") == &COMMAND_TABLE[0] && lookup_command("NOPE") == nullptr;
+}());
+
+// 按命令表中的键位置依次对每个键调用 fn，无键命令不调用
+export template <typename Fn>
+void for_each_key(const CommandSpec &spec, std::span<const std::string_view> argv,
+                  Fn &&fn) {
+  if (!spec.has_keys()) {
+    return;
+  }
+  int last = spec.last_key < 0 ? static_cast<int>(argv.size()) + spec.last_key
+                               : spec.last_key;
+  for (int i = spec.first_key; i <= last && i < static_cast<int>(argv.size());
+       i += spec.key_step) {
+    fn(argv[i]);
+  }
+}
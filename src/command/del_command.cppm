@@ -0,0 +1,47 @@
+module;
+
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+export module del_command;
+
+import command_defs;
+import resp;
+import buffer;
+import logger;
+
+// DEL/UNLINK 的公共实现：删除所有给定的键，返回实际删除的个数。已过期的键不计入。
+// lazy 为 true 时大值交给后台线程释放
+void del_generic(KVServerContext &context, CommandArgs args, bool lazy, Buffer &out) {
+  auto &db = context.get_db();
+  long long deleted = 0;
+  context.find_live_keys(
+      args.size(), [args](size_t i) { return args[i]; },
+      [&](size_t, Storage::iterator it) {
+        if (it != db.end()) {
+          if (lazy) {
+            context.unlink_key(it);
+          } else {
+            context.erase_key(it);
+          }
+          ++deleted;
+        }
+      });
+  if (deleted == 0) {
+    context.suppress_propagation();
+  }
+  LOG_DEBUG("{}命令删除 {} 个键", lazy ? "UNLINK" : "DEL", deleted);
+  resp::write_integer(out, deleted);
+}
+
+// Del命令：在当前线程同步释放被删除的值
+export void del_command(KVServerContext &context, CommandArgs args, Buffer &out) {
+  del_generic(context, args, false, out);
+}
+
+// Unlink命令：键立即从键空间移除，大值的释放交给后台线程
+export void unlink_command(KVServerContext &context, CommandArgs args, Buffer &out) {
+  del_generic(context, args, true, out);
+}
@@ -0,0 +1,626 @@
+module;
+
+#include <algorithm>
+#include <bit>
+#include <concepts>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <new>
+#include <random>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+export module dict;
+
+// 键空间使用的哈希表：开放寻址，SwissTable 风格的分组探测，渐进式扩容。
+//
+// - 每个槽位有一个控制字节：空、已删除，或哈希值的低 7 位（h2）。
+//   查找时一次比较 16 个控制字节（SSE2），只有 h2 相同的槽位才比较保存的完整哈希和键。
+// - 槽位按 16 个一组对齐，按组做三角数探测；组内有空槽位即可停止探测。
+// - 条目直接存放在槽位数组中，没有链表节点，查找通常只访问一个控制字节组和一个槽位。
+//   条目类型 T 自带键，通过 key() 取得（键空间中是指向紧凑条目的句柄，只占一个指针）。
+// - 扩容不一次性完成：分配新表后，每次写操作搬迁旧表的一组槽位，
+//   事件循环空闲时再通过 rehash_for 按时间预算继续搬迁。扩容期间查找两张表。
+//   删除使负载低于 1/8 时以同样的渐进方式缩容到较小的表。
+//
+// 注意：写操作可能搬迁条目，迭代器和条目引用在下一次 insert/erase/rehash 之后失效。
+// find 不搬迁条目，连续查找得到的迭代器可以同时使用
+
+namespace dict_detail {
+
+constexpr size_t GROUP_SIZE = 16;
+constexpr int8_t CTRL_EMPTY = -128;  // 0b10000000
+constexpr int8_t CTRL_DELETED = -2;  // 0b11111110，墓碑，探测时不停止
+constexpr size_t MIN_CAPACITY = GROUP_SIZE;
+constexpr size_t NO_REHASH = static_cast<size_t>(-1);
+
+inline size_t h1(uint64_t hash) { return static_cast<size_t>(hash >> 7); }
+inline int8_t h2(uint64_t hash) { return static_cast<int8_t>(hash & 0x7F); }
+
+// 组内控制字节等于 value 的槽位掩码
+inline uint32_t match_byte(const int8_t *group, int8_t value) {
+#if defined(__SSE2__)
+  __m128i ctrl = _mm_loadu_si128(reinterpret_cast<const __m128i *>(group));
+  return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8(value))));
+#else
+  uint32_t mask = 0;
+  for (size_t i = 0; i < GROUP_SIZE; ++i) {
+    if (group[i] == value) {
+      mask |= 1u << i;
+    }
+  }
+  return mask;
+#endif
+}
+
+// 组内空槽位或墓碑的掩码，二者的最高位都是 1，已占用槽位的最高位是 0
+inline uint32_t match_empty_or_deleted(const int8_t *group) {
+#if defined(__SSE2__)
+  __m128i ctrl = _mm_loadu_si128(reinterpret_cast<const __m128i *>(group));
+  return static_cast<uint32_t>(_mm_movemask_epi8(ctrl));
+#else
+  uint32_t mask = 0;
+  for (size_t i = 0; i < GROUP_SIZE; ++i) {
+    if (group[i] < 0) {
+      mask |= 1u << i;
+    }
+  }
+  return mask;
+#endif
+}
+
+inline uint32_t match_empty(const int8_t *group) { return match_byte(group, CTRL_EMPTY); }
+
+} // namespace dict_detail
+
+// 条目类型需要能移动，并通过 key() 给出自身的键
+export template <typename T>
+concept DictEntryType = std::is_nothrow_move_constructible_v<T> && requires(const T &entry) {
+  { entry.key() } -> std::convertible_to<std::string_view>;
+};
+
+export template <DictEntryType T> class Dict {
+public:
+  using value_type = T;
+
+  template <bool Const> class Iterator {
+  public:
+    using DictPtr = std::conditional_t<Const, const Dict *, Dict *>;
+    using reference = std::conditional_t<Const, const value_type &, value_type &>;
+    using pointer = std::conditional_t<Const, const value_type *, value_type *>;
+
+    Iterator() = default;
+    Iterator(DictPtr dict, int table, size_t index) : dict_(dict), table_(table), index_(index) {}
+    // 普通迭代器可以转换为常量迭代器
+    template <bool C = Const, typename = std::enable_if_t<C>>
+    Iterator(const Iterator<false> &other)
+        : dict_(other.dict_), table_(other.table_), index_(other.index_) {}
+
+    reference operator*() const { return dict_->tables_[table_].slots[index_]; }
+    pointer operator->() const { return &dict_->tables_[table_].slots[index_]; }
+    Iterator &operator++() {
+      ++index_;
+      dict_->skip_to_full(table_, index_);
+      return *this;
+    }
+    bool operator==(const Iterator &other) const {
+      return table_ == other.table_ && index_ == other.index_;
+    }
+
+  private:
+    friend class Dict;
+    template <bool> friend class Iterator;
+    DictPtr dict_ = nullptr;
+    int table_ = 2; // 2 表示 end
+    size_t index_ = 0;
+  };
+
+  using iterator = Iterator<false>;
+  using const_iterator = Iterator<true>;
+
+  Dict() = default;
+  ~Dict() {
+    free_table(tables_[0]);
+    free_table(tables_[1]);
+  }
+  Dict(const Dict &) = delete;
+  Dict &operator=(const Dict &) = delete;
+  // 移动只交换表指针，不搬迁条目。移动赋值与 other 交换内容，
+  // 原有条目由 other 负责释放（惰性释放把整张表移交给后台线程时用到）
+  Dict(Dict &&other) noexcept { swap(other); }
+  Dict &operator=(Dict &&other) noexcept {
+    swap(other);
+    return *this;
+  }
+  void swap(Dict &other) noexcept {
+    std::swap(tables_[0], other.tables_[0]);
+    std::swap(tables_[1], other.tables_[1]);
+    std::swap(rehash_index_, other.rehash_index_);
+  }
+
+  size_t size() const { return tables_[0].size + tables_[1].size; }
+  bool empty() const { return size() == 0; }
+  bool rehashing() const { return rehash_index_ != dict_detail::NO_REHASH; }
+  // 槽位总数（扩容期间包括两张表）
+  size_t bucket_count() const { return tables_[0].capacity + tables_[1].capacity; }
+  // 哈希表自身占用的内存（控制字节、保存的哈希和槽位），不含键值指向的堆内存
+  size_t table_bytes() const { return bucket_count() * SLOT_BYTES; }
+
+  iterator begin() { return first_full<iterator>(this); }
+  iterator end() { return iterator(this, 2, 0); }
+  const_iterator begin() const { return first_full<const_iterator>(this); }
+  const_iterator end() const { return const_iterator(this, 2, 0); }
+
+  iterator find(std::string_view key) {
+    auto [table, index] = locate(key, hash_of(key));
+    return table < 0 ? end() : iterator(this, table, index);
+  }
+  const_iterator find(std::string_view key) const {
+    auto [table, index] = locate(key, hash_of(key));
+    return table < 0 ? end() : const_iterator(this, table, index);
+  }
+  bool contains(std::string_view key) const { return locate(key, hash_of(key)).first >= 0; }
+
+  // 批量查找 count 个键，key_at(i) 给出第 i 个键，fn(i, iterator) 按顺序对每个键调用一次，
+  // 不存在的键得到 end()。键按窗口分几遍处理：先计算哈希并预取控制字节组，
+  // 再匹配控制字节并预取候选槽位，然后预取槽位指向的条目，最后才逐个比较键。
+  // 一个窗口内各个键的缓存未命中因此相互重叠，而不是一个接一个地等待内存。
+  // 预取只是提示，每个键在调用 fn 之前才完成定位，fn 中可以修改 Dict
+  template <typename KeyAt, typename Fn> void find_batch(size_t count, KeyAt &&key_at, Fn &&fn) {
+    constexpr size_t WINDOW = 16;
+    if (count == 1) {
+      fn(0, find(key_at(0))); // 单个键没有可以重叠的访问，预取只会增加开销
+      return;
+    }
+    uint64_t hashes[WINDOW];
+    for (size_t base = 0; base < count; base += WINDOW) {
+      size_t n = std::min(WINDOW, count - base);
+      for (size_t i = 0; i < n; ++i) {
+        hashes[i] = hash_of(key_at(base + i));
+        prefetch_group(hashes[i]);
+      }
+      for (size_t i = 0; i < n; ++i) {
+        prefetch_candidates(hashes[i], false);
+      }
+      if constexpr (requires(const value_type &entry) { entry.prefetch(); }) {
+        for (size_t i = 0; i < n; ++i) {
+          prefetch_candidates(hashes[i], true);
+        }
+      }
+      for (size_t i = 0; i < n; ++i) {
+        auto [table, index] = locate(key_at(base + i), hashes[i]);
+        fn(base + i, table < 0 ? end() : iterator(this, table, index));
+      }
+    }
+  }
+
+  // 插入条目，键已存在时丢弃 entry 并返回已有条目
+  std::pair<iterator, bool> insert(T entry) {
+    std::string_view key = entry.key();
+    uint64_t hash = hash_of(key);
+    rehash_step(1);
+    if (auto [table, index] = locate(key, hash); table >= 0) {
+      return {iterator(this, table, index), false};
+    }
+    reserve_for_insert();
+    int table = rehashing() ? 1 : 0;
+    size_t index = insert_new(tables_[table], hash, std::move(entry));
+    return {iterator(this, table, index), true};
+  }
+
+  void erase(const_iterator it) {
+    Table &t = tables_[it.table_];
+    erase_slot(t, it.index_);
+    rehash_step(1);
+    shrink_if_sparse();
+  }
+
+  // 从表中取出条目并删除其槽位，条目的所有权交给调用方
+  value_type extract(const_iterator it) {
+    Table &t = tables_[it.table_];
+    value_type entry = std::move(t.slots[it.index_]);
+    erase_slot(t, it.index_);
+    rehash_step(1);
+    shrink_if_sparse();
+    return entry;
+  }
+
+  size_t erase(std::string_view key) {
+    auto [table, index] = locate(key, hash_of(key));
+    if (table < 0) {
+      return 0;
+    }
+    erase_slot(tables_[table], index);
+    rehash_step(1);
+    shrink_if_sparse();
+    return 1;
+  }
+
+  void clear() {
+    free_table(tables_[0]);
+    free_table(tables_[1]);
+    rehash_index_ = dict_detail::NO_REHASH;
+  }
+
+  // 从随机位置开始顺序扫描槽位，对最多 count 个条目调用 fn(entry)，最多检查 max_slots 个槽位，
+  // 返回实际取到的条目数。只访问连续的内存，样本不完全均匀，用于内存淘汰的采样已经足够
+  template <typename Rng, typename Fn> size_t sample(Rng &rng, size_t count, size_t max_slots, Fn &&fn) const {
+    size_t total = bucket_count();
+    if (empty()) {
+      return 0;
+    }
+    size_t pos = std::uniform_int_distribution<size_t>(0, total - 1)(rng);
+    size_t found = 0;
+    for (size_t step = 0; step < total && step < max_slots && found < count; ++step) {
+      int table = pos < tables_[0].capacity ? 0 : 1;
+      const Table &t = tables_[table];
+      size_t index = table == 0 ? pos : pos - tables_[0].capacity;
+      if (t.ctrl[index] >= 0) {
+        fn(t.slots[index]);
+        ++found;
+      }
+      pos = pos + 1 == total ? 0 : pos + 1;
+    }
+    return found;
+  }
+
+  // 游标遍历：每次调用访问一个“起始组”（哈希值决定的首个探测组）的全部条目，
+  // 对每个条目调用 fn(entry)，返回下一个游标，返回 0 表示遍历完成。
+  // 游标按反向二进制递增（高位先加一），表在两次调用之间扩容或缩小时，
+  // 小表中组 g 的所有条目在大表中只会落在低位等于 g 的组里，这些组在反向二进制顺序中连续，
+  // 因此从开始到结束一直存在的条目至少返回一次，扩容期间可能重复返回。
+  // 条目不一定存放在起始组中：沿探测序列查找起始组相同的条目，遇到有空槽位的组停止（与 find 相同）。
+  // 扩容期间先访问小表中的组，再访问大表中由它扩展出的所有组。fn 中不能修改 Dict
+  template <typename Fn> size_t scan(size_t cursor, Fn &&fn) const {
+    if (empty()) {
+      return 0;
+    }
+    if (!rehashing()) {
+      size_t mask = group_mask(tables_[0]);
+      visit_home_group(tables_[0], cursor & mask, fn);
+      return next_cursor(cursor, mask);
+    }
+    const Table *small = &tables_[0];
+    const Table *large = &tables_[1];
+    if (small->capacity > large->capacity) {
+      std::swap(small, large);
+    }
+    size_t small_mask = group_mask(*small);
+    size_t large_mask = group_mask(*large);
+    visit_home_group(*small, cursor & small_mask, fn);
+    // 大表中低位与小表的组相同的所有组
+    do {
+      visit_home_group(*large, cursor & large_mask, fn);
+      cursor = next_cursor(cursor, large_mask);
+    } while (cursor & (small_mask ^ large_mask));
+    return cursor;
+  }
+
+  // 从游标 cursor 开始按顺序访问最多 max_slots 个槽位，对其中的条目调用 fn(entry)，
+  // 返回下一个游标，0 表示已访问到末尾。游标是两张表拼接后的槽位下标，
+  // 两次调用之间发生扩容时可能漏掉或重复访问条目，只适合可以重复进行的后台扫描。
+  // fn 可以修改条目的内容，但不能改变它的键，也不能插入或删除条目
+  template <typename Fn> size_t walk_slots(size_t cursor, size_t max_slots, Fn &&fn) {
+    size_t total = bucket_count();
+    size_t stop = std::min(total, cursor + max_slots);
+    for (size_t pos = cursor; pos < stop; ++pos) {
+      int table = pos < tables_[0].capacity ? 0 : 1;
+      Table &t = tables_[table];
+      size_t index = table == 0 ? pos : pos - tables_[0].capacity;
+      if (t.ctrl[index] >= 0) {
+        fn(t.slots[index]);
+      }
+    }
+    return stop >= total ? 0 : stop;
+  }
+
+  // 搬迁旧表中最多 groups 组槽位，扩容未进行时什么也不做
+  void rehash_step(size_t groups) {
+    if (!rehashing()) {
+      return;
+    }
+    Table &old = tables_[0];
+    size_t stop = std::min(old.capacity, rehash_index_ + groups * dict_detail::GROUP_SIZE);
+    for (size_t i = rehash_index_; i < stop; ++i) {
+      if (old.ctrl[i] >= 0) {
+        value_type &entry = old.slots[i];
+        insert_new(tables_[1], old.hashes[i], std::move(entry));
+        std::destroy_at(&entry);
+        // 旧表中的其余键可能探测经过这里，只能标记为墓碑
+        old.ctrl[i] = dict_detail::CTRL_DELETED;
+        --old.size;
+      }
+    }
+    rehash_index_ = stop;
+    if (rehash_index_ == old.capacity) {
+      free_table(old);
+      old = tables_[1];
+      tables_[1] = Table{};
+      rehash_index_ = dict_detail::NO_REHASH;
+    }
+  }
+
+  // 在时间预算内持续搬迁，返回扩容是否仍在进行
+  bool rehash_for(std::chrono::microseconds budget) {
+    auto deadline = std::chrono::steady_clock::now() + budget;
+    while (rehashing()) {
+      rehash_step(64);
+      if (std::chrono::steady_clock::now() >= deadline) {
+        break;
+      }
+    }
+    return rehashing();
+  }
+
+private:
+  template <bool> friend class Iterator;
+
+  struct Table {
+    int8_t *ctrl = nullptr;
+    uint64_t *hashes = nullptr; // 保存的完整哈希，比较键之前先比较哈希，扩容时无需重新计算
+    value_type *slots = nullptr;
+    size_t capacity = 0;
+    size_t size = 0;
+    size_t tombstones = 0;
+  };
+
+  static constexpr size_t SLOT_BYTES = sizeof(int8_t) + sizeof(uint64_t) + sizeof(value_type);
+
+  static uint64_t hash_of(std::string_view key) { return std::hash<std::string_view>{}(key); }
+
+  // 负载上限为 7/8，墓碑也占用探测长度，一并计入
+  static bool over_load(const Table &t, size_t extra) {
+    return (t.size + t.tombstones + extra) * 8 > t.capacity * 7;
+  }
+
+  static void allocate_table(Table &t, size_t capacity) {
+    t.capacity = capacity;
+    t.size = 0;
+    t.tombstones = 0;
+    t.ctrl = new int8_t[capacity];
+    std::memset(t.ctrl, static_cast<unsigned char>(dict_detail::CTRL_EMPTY), capacity);
+    t.hashes = new uint64_t[capacity];
+    t.slots = std::allocator<value_type>().allocate(capacity);
+  }
+
+  static void free_table(Table &t) {
+    if (t.capacity == 0) {
+      return;
+    }
+    for (size_t i = 0; i < t.capacity; ++i) {
+      if (t.ctrl[i] >= 0) {
+        std::destroy_at(&t.slots[i]);
+      }
+    }
+    std::allocator<value_type>().deallocate(t.slots, t.capacity);
+    delete[] t.hashes;
+    delete[] t.ctrl;
+    t = Table{};
+  }
+
+  // 在一张表中查找键，返回槽位下标，不存在时返回 capacity
+  static size_t find_in(const Table &t, std::string_view key, uint64_t hash) {
+    if (t.size == 0) {
+      return t.capacity;
+    }
+    size_t groups_mask = t.capacity / dict_detail::GROUP_SIZE - 1;
+    size_t group = dict_detail::h1(hash) & groups_mask;
+    int8_t tag = dict_detail::h2(hash);
+    for (size_t step = 0; step <= groups_mask; ++step) {
+      const int8_t *ctrl = t.ctrl + group * dict_detail::GROUP_SIZE;
+      for (uint32_t mask = dict_detail::match_byte(ctrl, tag); mask != 0; mask &= mask - 1) {
+        size_t index = group * dict_detail::GROUP_SIZE + std::countr_zero(mask);
+        if (t.hashes[index] == hash && std::string_view(t.slots[index].key()) == key) {
+          return index;
+        }
+      }
+      // 组内有空槽位，说明键从未被放到更远的组
+      if (dict_detail::match_empty(ctrl) != 0) {
+        break;
+      }
+      group = (group + step + 1) & groups_mask; // 三角数探测，能遍历所有组
+    }
+    return t.capacity;
+  }
+
+  static size_t group_mask(const Table &t) { return t.capacity / dict_detail::GROUP_SIZE - 1; }
+
+  // 反向二进制游标加一：掩码以外的位置一后把游标按位反转、加一、再反转回来
+  static size_t next_cursor(size_t cursor, size_t mask) {
+    cursor |= ~mask;
+    cursor = reverse_bits(cursor);
+    ++cursor;
+    return reverse_bits(cursor);
+  }
+
+  static size_t reverse_bits(size_t v) {
+    static_assert(sizeof(size_t) == 8);
+    v = ((v >> 1) & 0x5555555555555555ull) | ((v & 0x5555555555555555ull) << 1);
+    v = ((v >> 2) & 0x3333333333333333ull) | ((v & 0x3333333333333333ull) << 2);
+    v = ((v >> 4) & 0x0F0F0F0F0F0F0F0Full) | ((v & 0x0F0F0F0F0F0F0F0Full) << 4);
+    return std::byteswap(v);
+  }
+
+  // 访问一张表中起始组为 group 的所有条目：沿探测序列逐组检查保存的哈希，
+  // 插入时只有前面的组都没有空位才会继续探测，所以遇到有空槽位的组即可停止
+  template <typename Fn> static void visit_home_group(const Table &t, size_t group, Fn &fn) {
+    if (t.size == 0) {
+      return;
+    }
+    size_t groups_mask = group_mask(t);
+    size_t home = group;
+    for (size_t step = 0; step <= groups_mask; ++step) {
+      const int8_t *ctrl = t.ctrl + group * dict_detail::GROUP_SIZE;
+      for (size_t i = 0; i < dict_detail::GROUP_SIZE; ++i) {
+        size_t index = group * dict_detail::GROUP_SIZE + i;
+        if (ctrl[i] >= 0 && (dict_detail::h1(t.hashes[index]) & groups_mask) == home) {
+          fn(t.slots[index]);
+        }
+      }
+      if (dict_detail::match_empty(ctrl) != 0) {
+        break;
+      }
+      group = (group + step + 1) & groups_mask;
+    }
+  }
+
+  // 扩容期间键只会存在于其中一张表
+  std::pair<int, size_t> locate(std::string_view key, uint64_t hash) const {
+    for (int table = 0; table < (rehashing() ? 2 : 1); ++table) {
+      size_t index = find_in(tables_[table], key, hash);
+      if (index != tables_[table].capacity) {
+        return {table, index};
+      }
+    }
+    return {-1, 0};
+  }
+
+  // 预取键在各张表中首个探测组的控制字节
+  void prefetch_group(uint64_t hash) const {
+    for (int table = 0; table < (rehashing() ? 2 : 1); ++table) {
+      const Table &t = tables_[table];
+      if (t.capacity != 0) {
+        size_t group = dict_detail::h1(hash) & (t.capacity / dict_detail::GROUP_SIZE - 1);
+        __builtin_prefetch(t.ctrl + group * dict_detail::GROUP_SIZE);
+      }
+    }
+  }
+
+  // 预取首个探测组中 h2 匹配的槽位。entries 为 false 时预取保存的哈希和槽位本身，
+  // 为 true 时读取槽位（上一遍已预取）并预取条目指向的数据
+  void prefetch_candidates(uint64_t hash, bool entries) const {
+    for (int table = 0; table < (rehashing() ? 2 : 1); ++table) {
+      const Table &t = tables_[table];
+      if (t.size == 0) {
+        continue;
+      }
+      size_t group = dict_detail::h1(hash) & (t.capacity / dict_detail::GROUP_SIZE - 1);
+      const int8_t *ctrl = t.ctrl + group * dict_detail::GROUP_SIZE;
+      for (uint32_t mask = dict_detail::match_byte(ctrl, dict_detail::h2(hash)); mask != 0; mask &= mask - 1) {
+        size_t index = group * dict_detail::GROUP_SIZE + std::countr_zero(mask);
+        if constexpr (requires(const value_type &entry) { entry.prefetch(); }) {
+          if (entries) {
+            t.slots[index].prefetch();
+            continue;
+          }
+        }
+        __builtin_prefetch(&t.hashes[index]);
+        __builtin_prefetch(&t.slots[index]);
+      }
+    }
+  }
+
+  // 插入一个确定不存在的键，调用方保证表中有空位
+  static size_t insert_new(Table &t, uint64_t hash, T &&entry) {
+    size_t groups_mask = t.capacity / dict_detail::GROUP_SIZE - 1;
+    size_t group = dict_detail::h1(hash) & groups_mask;
+    for (size_t step = 0;; ++step) {
+      uint32_t mask = dict_detail::match_empty_or_deleted(t.ctrl + group * dict_detail::GROUP_SIZE);
+      if (mask != 0) {
+        size_t index = group * dict_detail::GROUP_SIZE + std::countr_zero(mask);
+        if (t.ctrl[index] == dict_detail::CTRL_DELETED) {
+          --t.tombstones;
+        }
+        t.ctrl[index] = dict_detail::h2(hash);
+        t.hashes[index] = hash;
+        std::construct_at(&t.slots[index], std::move(entry));
+        ++t.size;
+        return index;
+      }
+      group = (group + step + 1) & groups_mask;
+    }
+  }
+
+  static void erase_slot(Table &t, size_t index) {
+    std::destroy_at(&t.slots[index]);
+    --t.size;
+    // 组内已有空槽位时，任何探测都不会越过这一组，可以直接标记为空而不留墓碑
+    const int8_t *group = t.ctrl + index / dict_detail::GROUP_SIZE * dict_detail::GROUP_SIZE;
+    if (dict_detail::match_empty(group) != 0) {
+      t.ctrl[index] = dict_detail::CTRL_EMPTY;
+    } else {
+      t.ctrl[index] = dict_detail::CTRL_DELETED;
+      ++t.tombstones;
+    }
+  }
+
+  // 保证接下来插入一个键时目标表不超过负载上限，必要时开始扩容
+  void reserve_for_insert() {
+    if (rehashing()) {
+      // 新表容量按旧表搬迁完成前的插入量留足了余量，这里只是兜底
+      if (!over_load(tables_[1], 1)) {
+        return;
+      }
+      while (rehashing()) {
+        rehash_step(tables_[0].capacity / dict_detail::GROUP_SIZE);
+      }
+    }
+    Table &t = tables_[0];
+    if (t.capacity == 0) {
+      allocate_table(t, dict_detail::MIN_CAPACITY);
+      return;
+    }
+    if (!over_load(t, 1)) {
+      return;
+    }
+    // 有效键不多时原容量重建，只清理墓碑；否则容量翻倍
+    size_t capacity = (t.size + 1) * 16 <= t.capacity * 7 ? t.capacity : t.capacity * 2;
+    allocate_table(tables_[1], capacity);
+    rehash_index_ = 0;
+    // 旧表只有墓碑时直接切换
+    if (t.size == 0) {
+      rehash_step(t.capacity / dict_detail::GROUP_SIZE);
+    }
+  }
+
+  // 删除后负载低于 1/8 时开始缩容：新表容量取能让现有键负载不超过 1/2 的最小值，
+  // 与 7/8 的扩容阈值之间留足间隔，避免在阈值附近反复扩容和缩容。
+  // 这里只分配新表，条目和扩容一样由之后的写操作和 rehash_for 逐组搬迁
+  void shrink_if_sparse() {
+    const Table &t = tables_[0];
+    if (rehashing() || t.capacity <= dict_detail::MIN_CAPACITY || t.size * 8 >= t.capacity) {
+      return;
+    }
+    size_t capacity = std::max(dict_detail::MIN_CAPACITY, std::bit_ceil(t.size * 2));
+    allocate_table(tables_[1], capacity);
+    rehash_index_ = 0;
+  }
+
+  // 把 (table, index) 前进到下一个已占用的槽位，没有时变为 end
+  void skip_to_full(int &table, size_t &index) const {
+    while (table < 2) {
+      const Table &t = tables_[table];
+      while (index < t.capacity && t.ctrl[index] < 0) {
+        ++index;
+      }
+      if (index < t.capacity) {
+        return;
+      }
+      ++table;
+      index = 0;
+      if (table == 1 && !rehashing()) {
+        table = 2;
+      }
+    }
+    index = 0;
+  }
+
+  template <typename It, typename Self> static It first_full(Self *self) {
+    int table = 0;
+    size_t index = 0;
+    self->skip_to_full(table, index);
+    return It(self, table, index);
+  }
+
+  Table tables_[2];
+  size_t rehash_index_ = dict_detail::NO_REHASH; // 旧表中下一个待搬迁的槽位
+};
@@ -0,0 +1,184 @@
+module;
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <string>
+#include <string_view>
+
+export module evict;
+
+import kv_entry;
+
+// 内存淘汰：键空间超过 maxmemory 时按策略选出并删除键。
+//
+// 每个条目的头部有 24 位访问信息，由键空间在访问时更新：
+// - LRU 策略下是最近一次访问时的 LRU 时钟（秒，24 位回绕，约 194 天）
+// - LFU 策略下高 16 位是上次衰减计数器的时刻（分钟），低 8 位是对数访问计数器，
+//   访问次数越多计数器增长越慢，空闲每满一分钟计数器减一
+// 淘汰不维护全局的 LRU 链表，而是每次随机采样若干个键放入淘汰池，
+// 池中按“空闲度”排序保留历次采样中最值得淘汰的候选，再从最佳候选开始删除。
+
+// 内存淘汰策略
+export enum class EvictionPolicy {
+  NoEviction,  // 不淘汰，超过上限时拒绝会增加内存的命令
+  AllKeysLru,  // 在所有键中淘汰最久未访问的
+  AllKeysLfu,  // 在所有键中淘汰访问频率最低的
+  VolatileLru, // 在设置了过期时间的键中淘汰最久未访问的
+  VolatileTtl, // 在设置了过期时间的键中淘汰最先过期的
+};
+
+struct PolicyName {
+  EvictionPolicy policy;
+  std::string_view name;
+};
+
+constexpr std::array POLICY_NAMES = {
+    PolicyName{EvictionPolicy::NoEviction, "noeviction"},
+    PolicyName{EvictionPolicy::AllKeysLru, "allkeys-lru"},
+    PolicyName{EvictionPolicy::AllKeysLfu, "allkeys-lfu"},
+    PolicyName{EvictionPolicy::VolatileLru, "volatile-lru"},
+    PolicyName{EvictionPolicy::VolatileTtl, "volatile-ttl"},
+};
+
+export std::optional<EvictionPolicy> parse_eviction_policy(std::string_view name) {
+  for (const auto &entry : POLICY_NAMES) {
+    if (entry.name == name) {
+      return entry.policy;
+    }
+  }
+  return std::nullopt;
+}
+
+export std::string_view eviction_policy_name(EvictionPolicy policy) {
+  for (const auto &entry : POLICY_NAMES) {
+    if (entry.policy == policy) {
+      return entry.name;
+    }
+  }
+  return "unknown";
+}
+
+// 只在设置了过期时间的键中淘汰
+export bool is_volatile_policy(EvictionPolicy policy) {
+  return policy == EvictionPolicy::VolatileLru || policy == EvictionPolicy::VolatileTtl;
+}
+
+// 内存上限配置
+export struct MaxmemoryConfig {
+  size_t maxmemory = 0; // 字节，0 表示不限制；多分片时为本分片承担的份额
+  EvictionPolicy policy = EvictionPolicy::NoEviction;
+  int samples = 5; // 每轮采样的键数，越大越接近精确的 LRU/LFU，代价也越高
+  size_t configured_maxmemory = 0; // 配置的总上限，INFO 报告该值；为 0 时与 maxmemory 相同
+};
+
+// --- 24 位访问信息 ---
+export constexpr uint32_t LRU_CLOCK_MAX = (1u << 24) - 1;
+export constexpr uint8_t LFU_INIT_VAL = 5; // 新键的计数器初值，避免刚写入就被淘汰
+constexpr uint32_t LFU_LOG_FACTOR = 10;
+constexpr uint64_t LFU_DECAY_MINUTES = 1;
+
+export uint32_t lru_clock(uint64_t now_s) { return static_cast<uint32_t>(now_s) & LRU_CLOCK_MAX; }
+
+// 条目自上次访问以来的空闲秒数，处理时钟回绕
+export uint64_t lru_idle_seconds(uint32_t lru, uint64_t now_s) {
+  return (lru_clock(now_s) - lru) & LRU_CLOCK_MAX;
+}
+
+uint32_t lfu_minutes(uint64_t now_s) { return static_cast<uint32_t>(now_s / 60) & 0xFFFF; }
+
+export uint32_t lfu_init(uint64_t now_s) { return (lfu_minutes(now_s) << 8) | LFU_INIT_VAL; }
+
+// 按空闲的分钟数衰减后的计数器，不修改条目
+export uint8_t lfu_counter(uint32_t lfu, uint64_t now_s) {
+  uint32_t last = lfu >> 8;
+  uint32_t now = lfu_minutes(now_s);
+  uint32_t elapsed = (now - last) & 0xFFFF;
+  uint32_t counter = lfu & 0xFF;
+  uint64_t periods = elapsed / LFU_DECAY_MINUTES;
+  return periods >= counter ? 0 : static_cast<uint8_t>(counter - periods);
+}
+
+// 一次访问后的 LFU 信息：先衰减，再以 1/((counter - LFU_INIT_VAL) * LFU_LOG_FACTOR + 1) 的概率加一。
+// random 是均匀分布的 32 位随机数
+export uint32_t lfu_touch(uint32_t lfu, uint64_t now_s, uint32_t random) {
+  uint32_t counter = lfu_counter(lfu, now_s);
+  if (counter < 255) {
+    uint32_t base = counter > LFU_INIT_VAL ? counter - LFU_INIT_VAL : 0;
+    if (static_cast<uint64_t>(random) * (base * LFU_LOG_FACTOR + 1) < (uint64_t{1} << 32)) {
+      ++counter;
+    }
+  }
+  return (lfu_minutes(now_s) << 8) | counter;
+}
+
+// 条目的空闲度：越大越应该淘汰。LRU 为空闲秒数，LFU 为 255 减去衰减后的计数器，
+// TTL 为过期时间的反序（越早过期越大）
+export uint64_t eviction_idle(const KvEntry &entry, EvictionPolicy policy, uint64_t now_s) {
+  switch (policy) {
+  case EvictionPolicy::AllKeysLfu:
+    return 255 - lfu_counter(entry.lru(), now_s);
+  case EvictionPolicy::VolatileTtl: {
+    auto expires_at = entry.expires_at();
+    if (!expires_at) {
+      return 0;
+    }
+    return std::numeric_limits<uint64_t>::max() - static_cast<uint64_t>(expires_at->time_since_epoch().count());
+  }
+  default:
+    return lru_idle_seconds(entry.lru(), now_s);
+  }
+}
+
+// 淘汰池：按空闲度从小到大保存候选键，空闲度越大越应该淘汰。
+// 槽位中的字符串在多次淘汰之间复用，键不长时不重新分配
+export class EvictionPool {
+public:
+  static constexpr size_t SIZE = 16;
+
+  // 加入一个候选键。池满时只接受比池中最小空闲度更大的键，挤掉最小的那个
+  void insert(uint64_t idle, std::string_view key) {
+    size_t k = 0;
+    while (k < size_ && entries_[k].idle < idle) {
+      ++k;
+    }
+    for (size_t i = 0; i < size_; ++i) {
+      if (entries_[i].key == key) {
+        return; // 重复采样到的键
+      }
+    }
+    if (size_ < SIZE) {
+      // 末尾的空槽位移到 k，[k, size_) 右移一位
+      std::rotate(entries_.begin() + k, entries_.begin() + size_, entries_.begin() + size_ + 1);
+      ++size_;
+    } else {
+      if (k == 0) {
+        return;
+      }
+      // 丢弃空闲度最小的第 0 个，[1, k) 左移一位
+      std::rotate(entries_.begin(), entries_.begin() + 1, entries_.begin() + k);
+      --k;
+    }
+    entries_[k].idle = idle;
+    entries_[k].key.assign(key);
+  }
+
+  bool empty() const { return size_ == 0; }
+  size_t size() const { return size_; }
+  // 空闲度最大的候选键，在下一次 insert 之前有效
+  std::string_view best() const { return entries_[size_ - 1].key; }
+  void pop_best() { --size_; }
+  void clear() { size_ = 0; }
+
+private:
+  struct Candidate {
+    uint64_t idle = 0;
+    std::string key;
+  };
+
+  std::array<Candidate, SIZE> entries_;
+  size_t size_ = 0;
+};
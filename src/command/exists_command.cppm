@@ -0,0 +1,23 @@
+module;
+
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+export module exists_command;
+
+import command_defs;
+import resp;
+import buffer;
+import logger;
+
+// Exists命令：返回给定键中存在的个数，重复的键重复计数
+export void exists_command(KVServerContext &context, CommandArgs args, Buffer &out) {
+  auto &db = context.get_db();
+  long long count = 0;
+  context.find_live_keys(
+      args.size(), [args](size_t i) { return args[i]; },
+      [&](size_t, Storage::iterator it) { count += it != db.end(); });
+  resp::write_integer(out, count);
+}
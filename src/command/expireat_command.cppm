@@ -0,0 +1,72 @@
+module;
+
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+export module expireat_command;
+
+import command_defs;
+import resp;
+import buffer;
+import logger;
+
+// EXPIREAT/PEXPIREAT 的公共实现，unix_ms 为过期的 Unix 毫秒时间戳。
+// 时间戳不晚于当前时刻时直接删除键；AOF 中的过期时间统一以 PEXPIREAT 记录
+void expireat_generic(KVServerContext &context, std::string_view key, int64_t unix_ms, Buffer &out) {
+  auto &db = context.get_db();
+  auto it = context.find_live_key(key);
+  if (it == db.end()) {
+    LOG_DEBUG("EXPIREAT命令的键不存在: {}", key);
+    context.suppress_propagation();
+    resp::write_integer(out, 0); // 键不存在返回0
+    return;
+  }
+
+  int64_t now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                       std::chrono::system_clock::now().time_since_epoch())
+                       .count();
+  // 时间点精度为纳秒，剩余时间限制在约 139 年内以免溢出
+  constexpr int64_t MAX_REMAINING_MS = int64_t{1} << 42;
+  if (unix_ms > now_ms && unix_ms - now_ms > MAX_REMAINING_MS) {
+    resp::write_error(out, "ERR invalid expire time in 'expireat' command");
+    return;
+  }
+
+  std::string unix_ms_str = std::to_string(unix_ms);
+  if (unix_ms <= now_ms) {
+    context.erase_key(it);
+    LOG_DEBUG("EXPIREAT命令的时间已过，删除键: {}", key);
+  } else {
+    context.set_expire(it, std::chrono::steady_clock::now() + std::chrono::milliseconds(unix_ms - now_ms));
+    LOG_DEBUG("设置键 {} 在 Unix 时间 {} 毫秒过期", key, unix_ms);
+  }
+  context.propagate_as({"PEXPIREAT", key, unix_ms_str});
+  resp::write_integer(out, 1); // 成功设置返回1
+}
+
+// ExpireAt命令：EXPIREAT key unix-seconds
+export void expireat_command(KVServerContext &context, CommandArgs args, Buffer &out) {
+  int64_t seconds;
+  if (!parse_canonical_int(args[1], seconds) ||
+      seconds > std::numeric_limits<int64_t>::max() / 1000 ||
+      seconds < std::numeric_limits<int64_t>::min() / 1000) {
+    resp::write_error(out, "ERR value is not an integer or out of range");
+    return;
+  }
+  expireat_generic(context, args[0], seconds * 1000, out);
+}
+
+// PExpireAt命令：PEXPIREAT key unix-milliseconds
+export void pexpireat_command(KVServerContext &context, CommandArgs args, Buffer &out) {
+  int64_t milliseconds;
+  if (!parse_canonical_int(args[1], milliseconds)) {
+    resp::write_error(out, "ERR value is not an integer or out of range");
+    return;
+  }
+  expireat_generic(context, args[0], milliseconds, out);
+}
@@ -0,0 +1,117 @@
+module;
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <random>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+export module expires_index;
+
+// 过期索引：只记录设置了过期时间的键，供主动过期采样和 INFO 统计使用。
+// 键按紧凑数组存放，另用哈希表记录每个键在数组中的位置，
+// 因此插入、删除（与末尾交换）和随机取样都是 O(1)，与键空间大小无关。
+// 键的过期时间仍以 KvEntry 中保存的为准，这里的时间只用于统计平均 TTL
+export class ExpiresIndex {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  // 记录或更新键的过期时间
+  void set(std::string_view key, Clock::time_point when) {
+    int64_t when_ms = to_ms(when);
+    if (auto it = positions_.find(key); it != positions_.end()) {
+      Entry &entry = entries_[it->second];
+      sum_expires_ms_ += when_ms - entry.expires_ms;
+      entry.expires_ms = when_ms;
+      return;
+    }
+    auto [it, _] = positions_.emplace(std::string(key), entries_.size());
+    entries_.push_back(Entry{&it->first, when_ms});
+    sum_expires_ms_ += when_ms;
+    key_bytes_ += heap_key_bytes(key.size());
+  }
+
+  // 移除键，键不在索引中时返回 false
+  bool erase(std::string_view key) {
+    auto it = positions_.find(key);
+    if (it == positions_.end()) {
+      return false;
+    }
+    size_t pos = it->second;
+    sum_expires_ms_ -= entries_[pos].expires_ms;
+    // 用末尾元素填补空位，保持数组紧凑
+    if (pos != entries_.size() - 1) {
+      entries_[pos] = entries_.back();
+      positions_.find(*entries_[pos].key)->second = pos;
+    }
+    entries_.pop_back();
+    key_bytes_ -= heap_key_bytes(key.size());
+    positions_.erase(it);
+    return true;
+  }
+
+  void clear() {
+    entries_.clear();
+    positions_.clear();
+    sum_expires_ms_ = 0;
+    key_bytes_ = 0;
+  }
+
+  size_t size() const { return entries_.size(); }
+  bool empty() const { return entries_.empty(); }
+
+  // 等概率随机取一个设置了过期时间的键，调用方需保证索引非空
+  template <typename Rng> std::string_view random_key(Rng &rng) const {
+    std::uniform_int_distribution<size_t> dist(0, entries_.size() - 1);
+    return *entries_[dist(rng)].key;
+  }
+
+  // 索引占用内存的估算值：数组、哈希表的桶和节点，以及超出短字符串缓冲区、单独分配的键
+  size_t memory_bytes() const {
+    return entries_.capacity() * sizeof(Entry) + positions_.bucket_count() * sizeof(void *) +
+           positions_.size() * NODE_BYTES + key_bytes_;
+  }
+
+  // 所有带过期时间的键的平均剩余生存时间（毫秒），没有这样的键时返回 0
+  int64_t average_ttl_ms(Clock::time_point now = Clock::now()) const {
+    if (entries_.empty()) {
+      return 0;
+    }
+    int64_t avg = sum_expires_ms_ / static_cast<int64_t>(entries_.size()) - to_ms(now);
+    return avg > 0 ? avg : 0;
+  }
+
+private:
+  struct Entry {
+    const std::string *key; // 指向 positions_ 中的键，节点式哈希表保证地址稳定
+    int64_t expires_ms;
+  };
+
+  struct KeyHash {
+    using is_transparent = void;
+    size_t operator()(std::string_view s) const noexcept {
+      return std::hash<std::string_view>{}(s);
+    }
+  };
+
+  static int64_t to_ms(Clock::time_point t) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(t.time_since_epoch()).count();
+  }
+
+  // 哈希表节点：next 指针、键值对和缓存的哈希值
+  static constexpr size_t NODE_BYTES =
+      sizeof(void *) + sizeof(std::pair<const std::string, size_t>) + sizeof(size_t);
+  static constexpr size_t SSO_CAPACITY = 15;
+
+  static size_t heap_key_bytes(size_t len) { return len > SSO_CAPACITY ? len + 1 : 0; }
+
+  std::vector<Entry> entries_;
+  std::unordered_map<std::string, size_t, KeyHash, std::equal_to<>> positions_;
+  int64_t sum_expires_ms_ = 0; // 所有过期时间之和，用于 O(1) 计算平均 TTL
+  size_t key_bytes_ = 0;       // 单独分配的键占用的字节数
+};
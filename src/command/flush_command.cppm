@@ -0,0 +1,44 @@
+module;
+
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+export module flush_command;
+
+import command_defs;
+import resp;
+import buffer;
+import logger;
+
+// FLUSHDB/FLUSHALL 的公共实现：FLUSHDB [ASYNC|SYNC]，默认同步释放。
+// 服务器只有一个数据库，两个命令的效果相同；多分片时由连接层在每个分片上执行
+void flush_generic(KVServerContext &context, CommandArgs args, std::string_view command, Buffer &out) {
+  bool async = false;
+  if (args.size() > 1) {
+    resp::write_error(out, "ERR syntax error");
+    return;
+  }
+  if (args.size() == 1) {
+    if (option_is(args[0], "ASYNC")) {
+      async = true;
+    } else if (!option_is(args[0], "SYNC")) {
+      resp::write_error(out, "ERR syntax error");
+      return;
+    }
+  }
+  LOG_INFO("{}命令清空键空间: {} 个键{}", command, context.get_db().size(), async ? "（后台释放）" : "");
+  context.flush(async);
+  resp::write_ok(out);
+}
+
+// FlushDb命令
+export void flushdb_command(KVServerContext &context, CommandArgs args, Buffer &out) {
+  flush_generic(context, args, "FLUSHDB", out);
+}
+
+// FlushAll命令
+export void flushall_command(KVServerContext &context, CommandArgs args, Buffer &out) {
+  flush_generic(context, args, "FLUSHALL", out);
+}
@@ -0,0 +1,39 @@
+module;
+
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+export module getdel_command;
+
+import command_defs;
+import resp;
+import buffer;
+import logger;
+
+// GetDel命令：返回值并删除键
+export void getdel_command(KVServerContext &context, CommandArgs args, Buffer &out) {
+  std::string_view key = args[0];
+
+  auto &db = context.get_db();
+  auto &stats = context.get_stats();
+  auto it = context.find_live_key(key);
+  if (it == db.end()) {
+    LOG_DEBUG("GETDEL命令键不存在: {}", key);
+    stats.increment_keyspace_misses();
+    context.suppress_propagation();
+    resp::write_null_bulk_string(out);
+    return;
+  }
+
+  if (it->is_object()) {
+    resp::write_error(out, WRONGTYPE_ERROR);
+    return;
+  }
+
+  stats.increment_keyspace_hits();
+  write_entry_value(out, *it);
+  context.erase_key(it);
+  LOG_DEBUG("GETDEL命令删除键: {}", key);
+}
@@ -0,0 +1,77 @@
+module;
+
+#include <chrono>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+export module getex_command;
+
+import command_defs;
+import resp;
+import buffer;
+import logger;
+
+// GetEx命令：GETEX key [EX s|PX ms|EXAT ts|PXAT ms-ts|PERSIST]
+// 读取值的同时修改过期时间，写入 AOF 时改写为 PEXPIREAT 或 PERSIST；不带选项时只读，不写入 AOF
+export void getex_command(KVServerContext &context, CommandArgs args, Buffer &out) {
+  std::string_view key = args[0];
+
+  std::optional<ExpireUnit> unit;
+  bool persist = false;
+  if (args.size() == 2 && option_is(args[1], "PERSIST")) {
+    persist = true;
+  } else if (args.size() == 3 && option_is(args[1], "EX")) {
+    unit = ExpireUnit::Seconds;
+  } else if (args.size() == 3 && option_is(args[1], "PX")) {
+    unit = ExpireUnit::Milliseconds;
+  } else if (args.size() == 3 && option_is(args[1], "EXAT")) {
+    unit = ExpireUnit::UnixSeconds;
+  } else if (args.size() == 3 && option_is(args[1], "PXAT")) {
+    unit = ExpireUnit::UnixMilliseconds;
+  } else if (args.size() != 1) {
+    LOG_WARN("GETEX命令的选项无效: {}", args[1]);
+    resp::write_error(out, "ERR syntax error");
+    return;
+  }
+
+  std::chrono::steady_clock::time_point when;
+  if (unit) {
+    if (auto result = parse_expire_time(args[2], *unit, when); result != ExpireParseResult::Ok) {
+      write_expire_error(out, result, "getex");
+      return;
+    }
+  }
+
+  auto &db = context.get_db();
+  auto &stats = context.get_stats();
+  auto it = context.find_live_key(key);
+  if (it == db.end()) {
+    LOG_DEBUG("GETEX命令键不存在: {}", key);
+    stats.increment_keyspace_misses();
+    context.suppress_propagation();
+    resp::write_null_bulk_string(out);
+    return;
+  }
+
+  if (it->is_object()) {
+    resp::write_error(out, WRONGTYPE_ERROR);
+    return;
+  }
+
+  stats.increment_keyspace_hits();
+  write_entry_value(out, *it);
+
+  if (unit) {
+    context.set_expire(it, when);
+    context.propagate_pexpireat(key, when);
+    LOG_DEBUG("GETEX命令设置键 {} 的过期时间", key);
+  } else if (persist && context.persist(it)) {
+    context.propagate_as({"PERSIST", key});
+    LOG_DEBUG("GETEX命令移除键 {} 的过期时间", key);
+  } else {
+    context.suppress_propagation();
+  }
+}
@@ -0,0 +1,249 @@
+module;
+
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+export module hash_command;
+
+import command_defs;
+import hash_object;
+import listpack;
+import resp;
+import buffer;
+import logger;
+
+// 查找哈希键用于写入，键不存在时创建空哈希。类型不符时写出错误并返回 false
+bool find_or_create_hash(KVServerContext &context, std::string_view key, Storage::iterator &it, Buffer &out) {
+  if (!context.find_live_key_of(key, ObjectType::Hash, it, out)) {
+    return false;
+  }
+  auto &db = context.get_db();
+  if (it == db.end()) {
+    it = db.insert(db.create_object_entry(key, std::make_unique<HashObject>())).first;
+  }
+  return true;
+}
+
+// HSet命令：HSET key field value [field value ...]，返回新增的字段数
+export void hset_command(KVServerContext &context, CommandArgs args, Buffer &out) {
+  if (args.size() % 2 == 0) {
+    resp::write_error(out, "ERR wrong number of arguments for 'HSET' command");
+    return;
+  }
+  Storage::iterator it;
+  if (!find_or_create_hash(context, args[0], it, out)) {
+    return;
+  }
+  int64_t created = 0;
+  const auto &config = context.encoding_config();
+  context.get_db().update(it, [&](KvEntry &entry) {
+    auto &hash = object_cast<HashObject>(entry);
+    for (size_t i = 1; i < args.size(); i += 2) {
+      created += hash.set(args[i], args[i + 1], config) ? 1 : 0;
+    }
+  });
+  LOG_DEBUG("HSET命令写入键 {} 的 {} 个字段", args[0], args.size() / 2);
+  resp::write_integer(out, created);
+}
+
+// HGet命令：字段或键不存在时返回 nil
+export void hget_command(KVServerContext &context, CommandArgs args, Buffer &out) {
+  Storage::iterator it;
+  if (!context.find_live_key_of(args[0], ObjectType::Hash, it, out)) {
+    return;
+  }
+  if (it == context.get_db().end()) {
+    resp::write_null_bulk_string(out);
+    return;
+  }
+  Listpack::ValueBuffer buf;
+  auto value = object_cast<HashObject>(*it).get(args[1], buf);
+  if (value) {
+    resp::write_bulk_string(out, *value);
+  } else {
+    resp::write_null_bulk_string(out);
+  }
+}
+
+// HMGet命令：按顺序返回每个字段的值，不存在的字段返回 nil
+export void hmget_command(KVServerContext &context, CommandArgs args, Buffer &out) {
+  Storage::iterator it;
+  if (!context.find_live_key_of(args[0], ObjectType::Hash, it, out)) {
+    return;
+  }
+  const HashObject *hash = it == context.get_db().end() ? nullptr : &object_cast<HashObject>(*it);
+  resp::write_array_header(out, args.size() - 1);
+  Listpack::ValueBuffer buf;
+  for (size_t i = 1; i < args.size(); ++i) {
+    auto value = hash ? hash->get(args[i], buf) : std::nullopt;
+    if (value) {
+      resp::write_bulk_string(out, *value);
+    } else {
+      resp::write_null_bulk_string(out);
+    }
+  }
+}
+
+// HDel命令：返回删除的字段数，哈希变空时删除键
+export void hdel_command(KVServerContext &context, CommandArgs args, Buffer &out) {
+  Storage::iterator it;
+  if (!context.find_live_key_of(args[0], ObjectType::Hash, it, out)) {
+    return;
+  }
+  auto &db = context.get_db();
+  int64_t removed = 0;
+  if (it != db.end()) {
+    db.update(it, [&](KvEntry &entry) {
+      auto &hash = object_cast<HashObject>(entry);
+      for (size_t i = 1; i < args.size(); ++i) {
+        removed += hash.erase(args[i]) ? 1 : 0;
+      }
+    });
+    if (object_cast<HashObject>(*it).empty()) {
+      LOG_DEBUG("HDEL命令删除空哈希: {}", args[0]);
+      context.erase_key(it);
+    }
+  }
+  if (removed == 0) {
+    context.suppress_propagation();
+  }
+  resp::write_integer(out, removed);
+}
+
+// HIncrBy命令：字段不存在时从 0 开始，字段的值必须是 64 位整数
+export void hincrby_command(KVServerContext &context, CommandArgs args, Buffer &out) {
+  int64_t increment;
+  if (!parse_canonical_int(args[2], increment)) {
+    resp::write_error(out, "ERR value is not an integer or out of range");
+    return;
+  }
+  Storage::iterator it;
+  if (!find_or_create_hash(context, args[0], it, out)) {
+    return;
+  }
+  auto &hash = object_cast<HashObject>(*it);
+  int64_t current = 0;
+  Listpack::ValueBuffer buf;
+  if (auto value = hash.get(args[1], buf)) {
+    if (!parse_canonical_int(*value, current)) {
+      resp::write_error(out, "ERR hash value is not an integer");
+      return;
+    }
+  }
+  if ((increment < 0 && current < std::numeric_limits<int64_t>::min() - increment) ||
+      (increment > 0 && current > std::numeric_limits<int64_t>::max() - increment)) {
+    resp::write_error(out, "ERR increment or decrement would overflow");
+    return;
+  }
+  int64_t result = current + increment;
+  char formatted[24];
+  char *end = std::to_chars(formatted, formatted + sizeof(formatted), result).ptr;
+  std::string_view value(formatted, static_cast<size_t>(end - formatted));
+  context.get_db().update(it, [&](KvEntry &entry) {
+    object_cast<HashObject>(entry).set(args[1], value, context.encoding_config());
+  });
+  resp::write_integer(out, result);
+}
+
+// HGetAll命令：字段名和值交替返回
+export void hgetall_command(KVServerContext &context, CommandArgs args, Buffer &out) {
+  Storage::iterator it;
+  if (!context.find_live_key_of(args[0], ObjectType::Hash, it, out)) {
+    return;
+  }
+  if (it == context.get_db().end()) {
+    resp::write_array_header(out, 0);
+    return;
+  }
+  const auto &hash = object_cast<HashObject>(*it);
+  resp::write_array_header(out, hash.size() * 2);
+  hash.for_each([&](std::string_view field, std::string_view value) {
+    resp::write_bulk_string(out, field);
+    resp::write_bulk_string(out, value);
+  });
+}
+
+// HSCAN key cursor [MATCH pattern] [COUNT count] [NOVALUES]
+//
+// 与 SCAN 相同的游标语义。紧凑编码的哈希一次返回全部字段，游标为 0；
+// 哈希表编码按 Dict::scan 遍历，COUNT 是工作量提示。MATCH 只匹配字段名
+export void hscan_command(KVServerContext &context, CommandArgs args, Buffer &out) {
+  uint64_t cursor;
+  if (!parse_scan_cursor(args[1], cursor)) {
+    resp::write_error(out, "ERR invalid cursor");
+    return;
+  }
+  std::string_view pattern;
+  bool has_pattern = false;
+  bool values = true;
+  long long count = 10;
+  for (size_t i = 2; i < args.size(); i += 2) {
+    if (option_is(args[i], "NOVALUES")) {
+      values = false;
+      --i; // 没有选项值
+      continue;
+    }
+    if (i + 1 >= args.size()) {
+      resp::write_error(out, "ERR syntax error");
+      return;
+    }
+    if (option_is(args[i], "MATCH")) {
+      pattern = args[i + 1];
+      has_pattern = !(pattern.size() == 1 && pattern[0] == '*');
+    } else if (option_is(args[i], "COUNT")) {
+      int64_t n;
+      if (!parse_canonical_int(args[i + 1], n)) {
+        resp::write_error(out, "ERR value is not an integer or out of range");
+        return;
+      }
+      if (n < 1) {
+        resp::write_error(out, "ERR syntax error");
+        return;
+      }
+      count = n;
+    } else {
+      resp::write_error(out, "ERR syntax error");
+      return;
+    }
+  }
+
+  Storage::iterator it;
+  if (!context.find_live_key_of(args[0], ObjectType::Hash, it, out)) {
+    return;
+  }
+  std::vector<std::pair<std::string, std::string>> fields;
+  if (it == context.get_db().end()) {
+    cursor = 0;
+  } else {
+    const auto &hash = object_cast<HashObject>(*it);
+    long long max_groups = std::min(count, 1LL << 40) * 10;
+    long long visited = 0;
+    do {
+      cursor = hash.scan(cursor, [&](std::string_view field, std::string_view value) {
+        ++visited;
+        if (!has_pattern || glob_match(pattern, field)) {
+          fields.emplace_back(field, values ? value : std::string_view{});
+        }
+      });
+    } while (cursor != 0 && --max_groups > 0 && visited < count);
+  }
+
+  resp::write_array_header(out, 2);
+  resp::write_bulk_string(out, std::to_string(cursor));
+  resp::write_array_header(out, fields.size() * (values ? 2 : 1));
+  for (const auto &[field, value] : fields) {
+    resp::write_bulk_string(out, field);
+    if (values) {
+      resp::write_bulk_string(out, value);
+    }
+  }
+}
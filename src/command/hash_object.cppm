@@ -0,0 +1,216 @@
+module;
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <optional>
+#include <string_view>
+#include <utility>
+
+export module hash_object;
+
+import value_object;
+import listpack;
+import dict;
+
+// 哈希表编码中的一个字段，字段名和值放在同一次分配中：
+//
+//   +----------------+------------+--------+----+
+//   | 字段名长度(4)  | 值长度(4)  | 字段名 | 值 |
+//   +----------------+------------+--------+----+
+export class HashField {
+public:
+  HashField() = default;
+  HashField(HashField &&other) noexcept : data_(std::exchange(other.data_, nullptr)) {}
+  HashField &operator=(HashField &&other) noexcept {
+    if (this != &other) {
+      release();
+      data_ = std::exchange(other.data_, nullptr);
+    }
+    return *this;
+  }
+  HashField(const HashField &) = delete;
+  HashField &operator=(const HashField &) = delete;
+  ~HashField() { release(); }
+
+  static HashField create(std::string_view field, std::string_view value) {
+    HashField f;
+    f.data_ = allocate(field, value);
+    return f;
+  }
+
+  std::string_view key() const { return {data_ + HEADER_SIZE, field_len()}; }
+  std::string_view value() const { return {data_ + HEADER_SIZE + field_len(), value_len()}; }
+  size_t allocation_size() const { return HEADER_SIZE + field_len() + value_len(); }
+
+  // 修改值，重新分配。value 不能指向本字段
+  void set_value(std::string_view value) {
+    char *data = allocate(key(), value);
+    release();
+    data_ = data;
+  }
+
+private:
+  static constexpr size_t HEADER_SIZE = 2 * sizeof(uint32_t);
+
+  static char *allocate(std::string_view field, std::string_view value) {
+    char *data = static_cast<char *>(::operator new(HEADER_SIZE + field.size() + value.size()));
+    uint32_t lens[2] = {static_cast<uint32_t>(field.size()), static_cast<uint32_t>(value.size())};
+    std::memcpy(data, lens, sizeof(lens));
+    std::memcpy(data + HEADER_SIZE, field.data(), field.size());
+    std::memcpy(data + HEADER_SIZE + field.size(), value.data(), value.size());
+    return data;
+  }
+
+  uint32_t field_len() const {
+    uint32_t len;
+    std::memcpy(&len, data_, sizeof(len));
+    return len;
+  }
+  uint32_t value_len() const {
+    uint32_t len;
+    std::memcpy(&len, data_ + sizeof(uint32_t), sizeof(len));
+    return len;
+  }
+
+  void release() {
+    ::operator delete(data_);
+    data_ = nullptr;
+  }
+
+  char *data_ = nullptr;
+};
+
+// 哈希类型的值。字段少且都较短时使用紧凑编码：字段名和值交替存放在一个 Listpack 中，
+// 查找是对连续内存的线性扫描，比指针结构更省内存，元素少时也更快。
+// 字段数或某个字段名、值的长度超过 EncodingConfig 中的阈值时转换为哈希表编码（Dict），
+// 之后不再转换回来
+export class HashObject final : public ValueObject {
+public:
+  enum class Encoding { Listpack, HashTable };
+
+  HashObject() : ValueObject(ObjectType::Hash) {}
+
+  Encoding encoding() const { return encoding_; }
+  std::string_view encoding_name() const override {
+    return encoding_ == Encoding::Listpack ? "listpack" : "hashtable";
+  }
+  size_t memory_bytes() const override {
+    if (encoding_ == Encoding::Listpack) {
+      return sizeof(*this) + listpack_.memory_bytes();
+    }
+    return sizeof(*this) + table_.table_bytes() + field_bytes_;
+  }
+
+  size_t size() const { return encoding_ == Encoding::Listpack ? listpack_.size() / 2 : table_.size(); }
+  bool empty() const { return size() == 0; }
+
+  // 读取字段的值。紧凑编码中的整数值格式化到 buf 中；返回的视图在下次修改前有效
+  std::optional<std::string_view> get(std::string_view field, Listpack::ValueBuffer &buf) const {
+    if (encoding_ == Encoding::Listpack) {
+      size_t pos = listpack_.find(listpack_.first(), field, 1);
+      if (pos == Listpack::npos) {
+        return std::nullopt;
+      }
+      return listpack_.get(listpack_.next(pos)).as_string(buf);
+    }
+    auto it = table_.find(field);
+    if (it == table_.end()) {
+      return std::nullopt;
+    }
+    return it->value();
+  }
+
+  // 设置字段的值，返回是否新增了字段。超过紧凑编码的阈值时先转换编码
+  bool set(std::string_view field, std::string_view value, const EncodingConfig &config) {
+    if (encoding_ == Encoding::Listpack) {
+      if (field.size() > config.hash_max_listpack_value || value.size() > config.hash_max_listpack_value) {
+        convert_to_table();
+      } else {
+        size_t pos = listpack_.find(listpack_.first(), field, 1);
+        if (pos != Listpack::npos) {
+          listpack_.replace(listpack_.next(pos), value);
+          return false;
+        }
+        if (size() < config.hash_max_listpack_entries) {
+          listpack_.push_back(field);
+          listpack_.push_back(value);
+          return true;
+        }
+        convert_to_table();
+      }
+    }
+    auto it = table_.find(field);
+    if (it != table_.end()) {
+      field_bytes_ -= it->allocation_size();
+      it->set_value(value);
+      field_bytes_ += it->allocation_size();
+      return false;
+    }
+    insert_field(field, value);
+    return true;
+  }
+
+  // 删除字段，返回字段是否存在
+  bool erase(std::string_view field) {
+    if (encoding_ == Encoding::Listpack) {
+      size_t pos = listpack_.find(listpack_.first(), field, 1);
+      if (pos == Listpack::npos) {
+        return false;
+      }
+      listpack_.erase_range(pos, 2);
+      return true;
+    }
+    auto it = table_.find(field);
+    if (it == table_.end()) {
+      return false;
+    }
+    field_bytes_ -= it->allocation_size();
+    table_.erase(it);
+    return true;
+  }
+
+  // 对每个字段调用 fn(field, value)，fn 中不能修改对象
+  template <typename Fn> void for_each(Fn &&fn) const {
+    if (encoding_ == Encoding::Listpack) {
+      Listpack::ValueBuffer field_buf;
+      Listpack::ValueBuffer value_buf;
+      for (size_t pos = listpack_.first(); pos != Listpack::npos; pos = listpack_.next(listpack_.next(pos))) {
+        fn(listpack_.get(pos).as_string(field_buf), listpack_.get(listpack_.next(pos)).as_string(value_buf));
+      }
+      return;
+    }
+    for (const auto &f : table_) {
+      fn(f.key(), f.value());
+    }
+  }
+
+  // 游标遍历，对访问到的字段调用 fn(field, value)，返回下一个游标，0 表示结束。
+  // 紧凑编码的哈希很小，一次返回全部字段；哈希表编码按 Dict::scan 的反向二进制游标遍历
+  template <typename Fn> size_t scan(size_t cursor, Fn &&fn) const {
+    if (encoding_ == Encoding::Listpack) {
+      for_each(fn);
+      return 0;
+    }
+    return table_.scan(cursor, [&](const HashField &f) { fn(f.key(), f.value()); });
+  }
+
+private:
+  void insert_field(std::string_view field, std::string_view value) {
+    HashField f = HashField::create(field, value);
+    field_bytes_ += f.allocation_size();
+    table_.insert(std::move(f));
+  }
+
+  void convert_to_table() {
+    for_each([this](std::string_view field, std::string_view value) { insert_field(field, value); });
+    listpack_.clear();
+    encoding_ = Encoding::HashTable;
+  }
+
+  Encoding encoding_ = Encoding::Listpack;
+  Listpack listpack_;
+  Dict<HashField> table_;
+  size_t field_bytes_ = 0; // 哈希表编码中所有字段占用的字节数
+};
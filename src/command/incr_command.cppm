@@ -0,0 +1,90 @@
+module;
+
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <string>
+#include <string_view>
+
+export module incr_command;
+
+import command_defs;
+import resp;
+import buffer;
+import logger;
+
+// INCR/DECR/INCRBY/DECRBY 的公共实现：键不存在时从 0 开始，值必须是 64 位整数。
+// 整数编码的值直接在条目中修改，不分配内存，也不经过字符串转换；原有的过期时间保持不变
+void incr_generic(KVServerContext &context, std::string_view key, int64_t increment, Buffer &out) {
+  auto &db = context.get_db();
+  auto it = context.find_live_key(key);
+  if (it == db.end()) {
+    db.insert(db.create_int_entry(key, increment));
+    LOG_DEBUG("INCR类命令创建新键: {} = {}", key, increment);
+    resp::write_integer(out, increment);
+    return;
+  }
+
+  if (it->is_object()) {
+    resp::write_error(out, WRONGTYPE_ERROR);
+    return;
+  }
+  // 字符串编码的值都无法解析为规范整数（否则创建时就已经是整数编码）
+  if (!it->is_int()) {
+    resp::write_error(out, "ERR value is not an integer or out of range");
+    return;
+  }
+
+  int64_t current = it->int_value();
+  if ((increment < 0 && current < std::numeric_limits<int64_t>::min() - increment) ||
+      (increment > 0 && current > std::numeric_limits<int64_t>::max() - increment)) {
+    resp::write_error(out, "ERR increment or decrement would overflow");
+    return;
+  }
+
+  int64_t value = current + increment;
+  db.set_int(it, value);
+  LOG_DEBUG("INCR类命令更新键: {} = {}", key, value);
+  resp::write_integer(out, value);
+}
+
+// 解析增量参数，失败时写出错误回复
+bool parse_increment(std::string_view arg, int64_t &increment, Buffer &out) {
+  if (!parse_canonical_int(arg, increment)) {
+    resp::write_error(out, "ERR value is not an integer or out of range");
+    return false;
+  }
+  return true;
+}
+
+// Incr命令
+export void incr_command(KVServerContext &context, CommandArgs args, Buffer &out) {
+  incr_generic(context, args[0], 1, out);
+}
+
+// Decr命令
+export void decr_command(KVServerContext &context, CommandArgs args, Buffer &out) {
+  incr_generic(context, args[0], -1, out);
+}
+
+// IncrBy命令
+export void incrby_command(KVServerContext &context, CommandArgs args, Buffer &out) {
+  int64_t increment;
+  if (parse_increment(args[1], increment, out)) {
+    incr_generic(context, args[0], increment, out);
+  }
+}
+
+// DecrBy命令
+export void decrby_command(KVServerContext &context, CommandArgs args, Buffer &out) {
+  int64_t decrement;
+  if (!parse_increment(args[1], decrement, out)) {
+    return;
+  }
+  // 最小值取反会溢出
+  if (decrement == std::numeric_limits<int64_t>::min()) {
+    resp::write_error(out, "ERR decrement would overflow");
+    return;
+  }
+  incr_generic(context, args[0], -decrement, out);
+}
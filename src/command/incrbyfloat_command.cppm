@@ -0,0 +1,84 @@
+module;
+
+#include <charconv>
+#include <cmath>
+#include <span>
+#include <string>
+#include <string_view>
+
+export module incrbyfloat_command;
+
+import command_defs;
+import resp;
+import buffer;
+import logger;
+
+// 按 Redis 的规则解析浮点数：必须整体是一个有限或无穷的数，不接受 NaN
+bool parse_long_double(std::string_view s, long double &value) {
+  if (s.empty()) {
+    return false;
+  }
+  auto [ptr, ec] = std::from_chars(s.data(), s.data() + s.size(), value);
+  return ec == std::errc() && ptr == s.data() + s.size() && !std::isnan(value);
+}
+
+// IncrByFloat命令
+// 结果以 17 位小数格式化并去掉末尾的零，整数结果（如 "3"）仍会按整数编码保存
+export void incrbyfloat_command(KVServerContext &context, CommandArgs args, Buffer &out) {
+  std::string_view key = args[0];
+
+  long double increment;
+  if (!parse_long_double(args[1], increment)) {
+    resp::write_error(out, "ERR value is not a valid float");
+    return;
+  }
+
+  auto &db = context.get_db();
+  auto it = context.find_live_key(key);
+  long double current = 0;
+  if (it != db.end()) {
+    if (it->is_object()) {
+      resp::write_error(out, WRONGTYPE_ERROR);
+      return;
+    } else if (it->is_int()) {
+      current = static_cast<long double>(it->int_value());
+    } else if (!parse_long_double(it->raw_value(), current)) {
+      resp::write_error(out, "ERR value is not a valid float");
+      return;
+    }
+  }
+
+  long double value = current + increment;
+  if (std::isnan(value) || std::isinf(value)) {
+    resp::write_error(out, "ERR increment would produce NaN or Infinity");
+    return;
+  }
+
+  char buf[5 * 1024];
+  auto [end, ec] = std::to_chars(buf, buf + sizeof(buf), value, std::chars_format::fixed, 17);
+  if (ec != std::errc()) {
+    resp::write_error(out, "ERR increment would produce NaN or Infinity");
+    return;
+  }
+  // 去掉小数部分末尾的零，小数部分全为零时连小数点一起去掉
+  while (end[-1] == '0') {
+    --end;
+  }
+  if (end[-1] == '.') {
+    --end;
+  }
+  std::string_view formatted(buf, static_cast<size_t>(end - buf));
+  if (formatted == "-0") {
+    formatted = "0";
+  }
+
+  if (it == db.end()) {
+    db.insert(db.create_entry(key, formatted));
+  } else {
+    context.overwrite_value(it, formatted);
+  }
+  // 浮点运算的结果与平台相关，写入 AOF 时改写为 SET，保证重放得到相同的值
+  context.propagate_as({"SET", key, formatted, "KEEPTTL"});
+  LOG_DEBUG("INCRBYFLOAT命令更新键: {} = {}", key, formatted);
+  resp::write_bulk_string(out, formatted);
+}
@@ -6,25 +6,41 @@ export module info_command;
 
 import command_defs;
 import resp;
+import buffer;
+import server_stat;
+import lazyfree;
+import slab;
 
-// INFO命令
-export class InfoCommand : public Command {
-public:
-  InfoCommand(const resp::RespValue &original_command, KVServerContext &context)
-      : original_command_(original_command), context_(context) {}
-
-  std::string execute() override {
-    auto &stats = context_.get_stats();
-    auto &db = context_.get_db();
-    return resp::serialize_bulk_string(stats.get_info(db.size()));
-  }
-
-  bool should_replicate() const override { return false; }
-  const resp::RespValue &get_original_command() const override {
-    return original_command_;
+// 收集本分片的键空间信息
+export KeyspaceInfo keyspace_info(KVServerContext &context) {
+  auto &db = context.get_db();
+  auto &expires = context.get_expires();
+  KeyspaceInfo keyspace;
+  keyspace.keys = db.size();
+  keyspace.expires = expires.size();
+  keyspace.avg_ttl_ms = expires.average_ttl_ms();
+  keyspace.table_bytes = db.table_bytes();
+  keyspace.entry_bytes = db.entry_bytes();
+  keyspace.used_memory = context.used_memory();
+  const MaxmemoryConfig &maxmemory = context.maxmemory_config();
+  keyspace.maxmemory = maxmemory.configured_maxmemory > 0 ? maxmemory.configured_maxmemory : maxmemory.maxmemory;
+  keyspace.maxmemory_policy = eviction_policy_name(maxmemory.policy);
+  keyspace.lazyfree_pending_objects = LazyFree::instance().pending_objects();
+  keyspace.lazyfreed_objects = LazyFree::instance().freed_objects();
+  const SlabAllocator &slabs = db.slabs();
+  keyspace.mem_fragmentation_ratio = db.fragmentation_ratio();
+  keyspace.slab_bytes = slabs.slab_bytes();
+  keyspace.slab_used_bytes = slabs.used_bytes();
+  keyspace.active_defrag_running = context.active_defrag_running();
+  for (const auto &cls : slabs.class_stats()) {
+    if (cls.slabs > 0) {
+      keyspace.slab_classes.push_back({cls.object_size, cls.slabs, cls.used, cls.capacity});
+    }
   }
+  return keyspace;
+}
 
-private:
-  const resp::RespValue &original_command_;
-  KVServerContext &context_;
-};
\ No newline at end of file
+// INFO命令。只报告本分片；多分片时连接层不经过这里，而是汇总所有分片的快照
+export void info_command(KVServerContext &context, CommandArgs, Buffer &out) {
+  resp::write_bulk_string(out, context.get_stats().get_info(keyspace_info(context)));
+}
@@ -0,0 +1,355 @@
+module;
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <span>
+#include <vector>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+export module intset;
+
+// 整数集合：有序、去重的整数数组，所有元素按同一宽度（2、4 或 8 字节）紧凑存放在一块连续内存中。
+// 宽度由当前元素中绝对值最大的一个决定，插入放不下的整数时整体升级到更宽的编码，不会降级。
+// 查找是二分查找；交集按块比较，块内的比较使用 SIMD 指令（AVX2 / SSE4.1，运行时按 CPU 选择，
+// 都不支持时使用标量归并）
+
+namespace intset_detail {
+
+template <typename T> T load(const uint8_t *data, size_t index) {
+  T v;
+  std::memcpy(&v, data + index * sizeof(T), sizeof(T));
+  return v;
+}
+
+// 块比较：一次比较 B 中连续 BYTES 字节的元素是否有等于 value 的
+struct Scalar {
+  static constexpr size_t BYTES = 0; // 不按块比较，逐个归并
+};
+
+#if defined(__x86_64__) || defined(__i386__)
+struct Sse41 {
+  static constexpr size_t BYTES = 16;
+  template <typename T> __attribute__((target("sse4.1"))) static bool contains(const uint8_t *block, T value) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(block));
+    __m128i eq;
+    if constexpr (sizeof(T) == 2) {
+      eq = _mm_cmpeq_epi16(v, _mm_set1_epi16(value));
+    } else if constexpr (sizeof(T) == 4) {
+      eq = _mm_cmpeq_epi32(v, _mm_set1_epi32(value));
+    } else {
+      eq = _mm_cmpeq_epi64(v, _mm_set1_epi64x(value));
+    }
+    return !_mm_testz_si128(eq, eq);
+  }
+};
+
+struct Avx2 {
+  static constexpr size_t BYTES = 32;
+  template <typename T> __attribute__((target("avx2"))) static bool contains(const uint8_t *block, T value) {
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(block));
+    __m256i eq;
+    if constexpr (sizeof(T) == 2) {
+      eq = _mm256_cmpeq_epi16(v, _mm256_set1_epi16(value));
+    } else if constexpr (sizeof(T) == 4) {
+      eq = _mm256_cmpeq_epi32(v, _mm256_set1_epi32(value));
+    } else {
+      eq = _mm256_cmpeq_epi64(v, _mm256_set1_epi64x(value));
+    }
+    return !_mm256_testz_si256(eq, eq);
+  }
+};
+#endif
+
+// 有序数组 A、B 的交集写入 out，返回元素个数。逐个取 A 的元素 x，B 按块前进：
+// 块的最后一个元素小于 x 时整块跳过，否则 x 若在 B 中必定落在当前块内，用一次块比较判断。
+// 不足一块的尾部逐个归并。out 可以与 A 是同一块 int64 数组（写入位置不超过读取位置）
+template <typename Probe, typename TA, typename TB>
+size_t intersect_sorted(const uint8_t *a, size_t na, const uint8_t *b, size_t nb, int64_t *out) {
+  constexpr size_t LANES = Probe::BYTES / sizeof(TB);
+  size_t j = 0;
+  size_t n = 0;
+  for (size_t i = 0; i < na; ++i) {
+    int64_t v = load<TA>(a, i);
+    if (v < std::numeric_limits<TB>::min()) {
+      continue;
+    }
+    if (v > std::numeric_limits<TB>::max()) {
+      break;
+    }
+    TB x = static_cast<TB>(v);
+    if constexpr (LANES > 0) {
+      while (j + LANES <= nb && load<TB>(b, j + LANES - 1) < x) {
+        j += LANES;
+      }
+      if (j + LANES <= nb) {
+        if (Probe::contains(b + j * sizeof(TB), x)) {
+          out[n++] = v;
+        }
+        continue;
+      }
+    }
+    while (j < nb && load<TB>(b, j) < x) {
+      ++j;
+    }
+    if (j == nb) {
+      break;
+    }
+    if (load<TB>(b, j) == x) {
+      out[n++] = v;
+    }
+  }
+  return n;
+}
+
+// 按两边的宽度选择实例
+template <typename Probe>
+size_t intersect_widths(const uint8_t *a, size_t na, unsigned wa, const uint8_t *b, size_t nb, unsigned wb,
+                        int64_t *out) {
+  auto with_b = [&]<typename TA>() {
+    switch (wb) {
+    case 2:
+      return intersect_sorted<Probe, TA, int16_t>(a, na, b, nb, out);
+    case 4:
+      return intersect_sorted<Probe, TA, int32_t>(a, na, b, nb, out);
+    default:
+      return intersect_sorted<Probe, TA, int64_t>(a, na, b, nb, out);
+    }
+  };
+  switch (wa) {
+  case 2:
+    return with_b.template operator()<int16_t>();
+  case 4:
+    return with_b.template operator()<int32_t>();
+  default:
+    return with_b.template operator()<int64_t>();
+  }
+}
+
+using IntersectKernel = size_t (*)(const uint8_t *, size_t, unsigned, const uint8_t *, size_t, unsigned, int64_t *);
+
+size_t intersect_scalar(const uint8_t *a, size_t na, unsigned wa, const uint8_t *b, size_t nb, unsigned wb,
+                        int64_t *out) {
+  return intersect_widths<Scalar>(a, na, wa, b, nb, wb, out);
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+// flatten 把整个调用链内联进带 target 属性的入口，块比较的内建函数才能在其中使用
+__attribute__((target("sse4.1"), flatten)) size_t intersect_sse41(const uint8_t *a, size_t na, unsigned wa,
+                                                                  const uint8_t *b, size_t nb, unsigned wb,
+                                                                  int64_t *out) {
+  return intersect_widths<Sse41>(a, na, wa, b, nb, wb, out);
+}
+
+__attribute__((target("avx2"), flatten)) size_t intersect_avx2(const uint8_t *a, size_t na, unsigned wa,
+                                                               const uint8_t *b, size_t nb, unsigned wb,
+                                                               int64_t *out) {
+  return intersect_widths<Avx2>(a, na, wa, b, nb, wb, out);
+}
+#endif
+
+// 启动时按 CPU 支持的指令集选定一次
+IntersectKernel select_kernel() {
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) {
+    return intersect_avx2;
+  }
+  if (__builtin_cpu_supports("sse4.1")) {
+    return intersect_sse41;
+  }
+#endif
+  return intersect_scalar;
+}
+
+inline const IntersectKernel INTERSECT_KERNEL = select_kernel();
+
+const char *kernel_name(IntersectKernel kernel) {
+#if defined(__x86_64__) || defined(__i386__)
+  if (kernel == intersect_avx2) {
+    return "avx2";
+  }
+  if (kernel == intersect_sse41) {
+    return "sse4.1";
+  }
+#endif
+  return "scalar";
+}
+
+} // namespace intset_detail
+
+export class Intset {
+public:
+  size_t size() const { return buf_.size() / width_; }
+  bool empty() const { return buf_.empty(); }
+  // 每个元素的字节数：2、4 或 8
+  unsigned width() const { return width_; }
+  size_t memory_bytes() const { return buf_.capacity(); }
+
+  int64_t at(size_t index) const {
+    switch (width_) {
+    case 2:
+      return intset_detail::load<int16_t>(buf_.data(), index);
+    case 4:
+      return intset_detail::load<int32_t>(buf_.data(), index);
+    default:
+      return intset_detail::load<int64_t>(buf_.data(), index);
+    }
+  }
+
+  bool contains(int64_t value) const {
+    if (width_for(value) > width_) {
+      return false;
+    }
+    size_t pos;
+    return search(value, pos);
+  }
+
+  // 插入整数，返回是否新增。放不下时先升级编码
+  bool insert(int64_t value) {
+    unsigned width = width_for(value);
+    if (width > width_) {
+      // 比当前所有元素都宽的整数只能是最小值或最大值
+      upgrade(width);
+      size_t pos = value < 0 ? 0 : size();
+      buf_.insert(buf_.begin() + static_cast<std::ptrdiff_t>(pos * width_), width_, 0);
+      store(pos, value);
+      return true;
+    }
+    size_t pos;
+    if (search(value, pos)) {
+      return false;
+    }
+    buf_.insert(buf_.begin() + static_cast<std::ptrdiff_t>(pos * width_), width_, 0);
+    store(pos, value);
+    return true;
+  }
+
+  // 删除整数，返回是否存在
+  bool erase(int64_t value) {
+    size_t pos;
+    if (width_for(value) > width_ || !search(value, pos)) {
+      return false;
+    }
+    auto first = buf_.begin() + static_cast<std::ptrdiff_t>(pos * width_);
+    buf_.erase(first, first + width_);
+    if (buf_.capacity() > 64 && buf_.size() < buf_.capacity() / 4) {
+      buf_.shrink_to_fit();
+    }
+    return true;
+  }
+
+  // 按从小到大的顺序对每个元素调用 fn(value)
+  template <typename Fn> void for_each(Fn &&fn) const {
+    for (size_t i = 0, n = size(); i < n; ++i) {
+      fn(at(i));
+    }
+  }
+
+  // 由升序、去重的整数构造
+  static Intset from_sorted(std::span<const int64_t> values) {
+    Intset set;
+    if (!values.empty()) {
+      set.width_ = std::max(width_for(values.front()), width_for(values.back()));
+    }
+    set.buf_.resize(values.size() * set.width_);
+    for (size_t i = 0; i < values.size(); ++i) {
+      set.store(i, values[i]);
+    }
+    return set;
+  }
+
+  // 多个整数集合的交集，结果升序。从最小的集合开始逐个相交，中间结果为空时提前结束。
+  // 一边比另一边大得多时对小的一边逐个二分查找，否则用按块比较的归并
+  static std::vector<int64_t> intersect(std::span<const Intset *const> sets) {
+    std::vector<const Intset *> order(sets.begin(), sets.end());
+    std::sort(order.begin(), order.end(), [](const Intset *a, const Intset *b) { return a->size() < b->size(); });
+    std::vector<int64_t> result;
+    if (order.empty()) {
+      return result;
+    }
+    result.resize(order[0]->size());
+    order[0]->for_each([&, i = size_t{0}](int64_t v) mutable { result[i++] = v; });
+    for (size_t k = 1; k < order.size() && !result.empty(); ++k) {
+      const Intset &other = *order[k];
+      if (other.size() / 64 > result.size()) {
+        std::erase_if(result, [&](int64_t v) { return !other.contains(v); });
+        continue;
+      }
+      size_t n = intset_detail::INTERSECT_KERNEL(reinterpret_cast<const uint8_t *>(result.data()), result.size(),
+                                                 sizeof(int64_t), other.buf_.data(), other.size(), other.width_,
+                                                 result.data());
+      result.resize(n);
+    }
+    return result;
+  }
+
+  // 交集使用的指令集，INFO 和基准测试输出
+  static const char *simd_kernel() { return intset_detail::kernel_name(intset_detail::INTERSECT_KERNEL); }
+
+private:
+  static unsigned width_for(int64_t value) {
+    if (value >= INT16_MIN && value <= INT16_MAX) {
+      return 2;
+    }
+    if (value >= INT32_MIN && value <= INT32_MAX) {
+      return 4;
+    }
+    return 8;
+  }
+
+  void store(size_t index, int64_t value) {
+    uint8_t *p = buf_.data() + index * width_;
+    if (width_ == 2) {
+      int16_t v = static_cast<int16_t>(value);
+      std::memcpy(p, &v, sizeof(v));
+    } else if (width_ == 4) {
+      int32_t v = static_cast<int32_t>(value);
+      std::memcpy(p, &v, sizeof(v));
+    } else {
+      std::memcpy(p, &value, sizeof(value));
+    }
+  }
+
+  // 二分查找，找到时返回 true；否则 pos 为应插入的位置
+  bool search(int64_t value, size_t &pos) const {
+    size_t lo = 0;
+    size_t hi = size();
+    while (lo < hi) {
+      size_t mid = lo + (hi - lo) / 2;
+      int64_t v = at(mid);
+      if (v == value) {
+        pos = mid;
+        return true;
+      }
+      if (v < value) {
+        lo = mid + 1;
+      } else {
+        hi = mid;
+      }
+    }
+    pos = lo;
+    return false;
+  }
+
+  // 所有元素改为更宽的编码，从后向前搬动，原地完成
+  void upgrade(unsigned width) {
+    size_t n = size();
+    unsigned old_width = width_;
+    buf_.resize(n * width);
+    for (size_t i = n; i-- > 0;) {
+      width_ = old_width;
+      int64_t v = at(i);
+      width_ = width;
+      store(i, v);
+    }
+    width_ = width;
+  }
+
+  std::vector<uint8_t> buf_;
+  unsigned width_ = 2;
+};
@@ -0,0 +1,409 @@
+module;
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <new>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <utility>
+
+export module kv_entry;
+
+import slab;
+import value_object;
+
+// 按 Redis 的规则把字符串解析为 64 位整数：不允许前导空白、'+'、多余的前导零和 "-0"，
+// 因此解析成功的字符串与整数格式化后的结果逐字节相同，整数编码不会改变 GET 的结果
+export bool parse_canonical_int(std::string_view s, int64_t &value) {
+  if (s.empty() || s.size() > 20) {
+    return false;
+  }
+  if (s[0] == '0') {
+    if (s.size() != 1) {
+      return false;
+    }
+  } else if (s[0] == '-') {
+    if (s.size() == 1 || s[1] == '0') {
+      return false;
+    }
+  } else if (s[0] < '1' || s[0] > '9') {
+    return false;
+  }
+  auto [ptr, ec] = std::from_chars(s.data(), s.data() + s.size(), value);
+  return ec == std::errc() && ptr == s.data() + s.size();
+}
+
+// 键空间中的一个键值对，键、值和可选的过期时间放在同一次分配中：
+//
+//   +--------+-----------------+--------+------------------+
+//   | Header | 过期时间(8，可选) | 键字节 | 值字节(容量 cap) |
+//   +--------+-----------------+--------+------------------+
+//
+// 过期时间只在设置了 TTL 时存在。值能解析为 64 位整数时使用整数编码，
+// 整数直接存放在 Header 中，没有值字节，读取时再按需格式化。
+// 哈希等其他类型的值是堆上的 ValueObject，Header 中保存指向它的指针，条目持有其所有权。
+// KvEntry 本身只是一个指针大小的句柄，放在哈希表槽位中；一次查找只需访问槽位和这一块连续内存。
+// 分配时传入键空间的 SlabAllocator 则优先从 slab 中分配，超过最大尺寸类别或未传入时使用堆；
+// 头部标志记录块的来源，释放时据此归还，不需要知道分配器
+export class KvEntry {
+public:
+  using Clock = std::chrono::steady_clock;
+  // 格式化整数值所需的缓冲区，能容纳任意 int64
+  using ValueBuffer = std::array<char, 24>;
+
+  KvEntry() = default;
+  KvEntry(KvEntry &&other) noexcept : data_(std::exchange(other.data_, nullptr)) {}
+  KvEntry &operator=(KvEntry &&other) noexcept {
+    if (this != &other) {
+      release();
+      data_ = std::exchange(other.data_, nullptr);
+    }
+    return *this;
+  }
+  KvEntry(const KvEntry &) = delete;
+  KvEntry &operator=(const KvEntry &) = delete;
+  ~KvEntry() { release(); }
+
+  // 创建条目，值为规范整数时自动使用整数编码
+  static KvEntry create(std::string_view key, std::string_view value,
+                        std::optional<Clock::time_point> expires_at = std::nullopt,
+                        SlabAllocator *slabs = nullptr) {
+    int64_t n;
+    if (parse_canonical_int(value, n)) {
+      return create_int(key, n, expires_at, slabs);
+    }
+    KvEntry entry;
+    entry.data_ = allocate_raw(slabs, key, value, static_cast<uint32_t>(value.size()), expires_at);
+    return entry;
+  }
+
+  static KvEntry create_int(std::string_view key, int64_t value,
+                            std::optional<Clock::time_point> expires_at = std::nullopt,
+                            SlabAllocator *slabs = nullptr) {
+    KvEntry entry;
+    entry.data_ = allocate(slabs, key, 0, expires_at);
+    entry.header()->flags |= FLAG_INT;
+    entry.header()->payload = static_cast<uint64_t>(value);
+    return entry;
+  }
+
+  // 创建值为 len 个零字节的字符串条目，值由调用方之后通过 writable_raw 原地写入
+  static KvEntry create_zeroed(std::string_view key, size_t len, SlabAllocator *slabs = nullptr) {
+    KvEntry entry;
+    entry.data_ = allocate(slabs, key, static_cast<uint32_t>(len), std::nullopt);
+    std::memset(entry.value_data(), 0, len);
+    entry.set_raw_size(static_cast<uint32_t>(len), static_cast<uint32_t>(len));
+    return entry;
+  }
+
+  // 创建值为对象的条目，条目取得对象的所有权
+  static KvEntry create_object(std::string_view key, std::unique_ptr<ValueObject> object,
+                               std::optional<Clock::time_point> expires_at = std::nullopt,
+                               SlabAllocator *slabs = nullptr) {
+    KvEntry entry;
+    entry.data_ = allocate(slabs, key, 0, expires_at);
+    entry.header()->flags |= FLAG_OBJECT;
+    entry.header()->payload = reinterpret_cast<uintptr_t>(object.release());
+    return entry;
+  }
+
+  std::string_view key() const { return {key_data(), header()->key_len}; }
+  // 预取条目数据的开头（头部、过期时间和键通常在同一缓存行），供哈希表批量查找使用
+  void prefetch() const { __builtin_prefetch(data_); }
+
+  // 值的类型名，TYPE 和 SCAN TYPE 使用
+  std::string_view type_name() const { return is_object() ? object()->type_name() : "string"; }
+  // 值的编码名，OBJECT ENCODING 使用。字符串总是与键放在同一次分配中，对应 Redis 的 embstr
+  std::string_view encoding_name() const {
+    if (is_object()) {
+      return object()->encoding_name();
+    }
+    return is_int() ? "int" : "embstr";
+  }
+
+  // 值是否为对象（字符串以外的类型）
+  bool is_object() const { return (header()->flags & FLAG_OBJECT) != 0; }
+  // 值对象，调用方需先检查 is_object()
+  ValueObject *object() const { return reinterpret_cast<ValueObject *>(header()->payload); }
+  // 取出值对象的所有权，之后条目只剩键，只能释放。用于把大对象交给后台线程释放
+  std::unique_ptr<ValueObject> take_object() {
+    auto *object = reinterpret_cast<ValueObject *>(std::exchange(header()->payload, 0));
+    return std::unique_ptr<ValueObject>(object);
+  }
+
+  bool is_int() const { return (header()->flags & FLAG_INT) != 0; }
+  // 整数编码的值，调用方需先检查 is_int()
+  int64_t int_value() const { return static_cast<int64_t>(header()->payload); }
+  // 字符串编码的值，调用方需先检查 !is_int()
+  std::string_view raw_value() const { return {value_data(), value_len()}; }
+  // 以字符串形式读取值，整数编码的值格式化到 buf 中
+  std::string_view value(ValueBuffer &buf) const {
+    if (!is_int()) {
+      return raw_value();
+    }
+    char *end = std::to_chars(buf.data(), buf.data() + buf.size(), int_value()).ptr;
+    return {buf.data(), static_cast<size_t>(end - buf.data())};
+  }
+
+  bool has_expire() const { return (header()->flags & FLAG_EXPIRE) != 0; }
+  std::optional<Clock::time_point> expires_at() const {
+    if (!has_expire()) {
+      return std::nullopt;
+    }
+    int64_t ticks;
+    std::memcpy(&ticks, data_ + sizeof(Header), sizeof(ticks));
+    return Clock::time_point(Clock::duration(ticks));
+  }
+
+  // 24 位的访问信息（LRU 时钟或 LFU 计数器），由键空间维护，供内存淘汰使用。
+  // 重新分配条目时保留
+  uint32_t lru() const {
+    const uint8_t *b = header()->lru;
+    return b[0] | (static_cast<uint32_t>(b[1]) << 8) | (static_cast<uint32_t>(b[2]) << 16);
+  }
+  void set_lru(uint32_t lru) { store_lru(header(), lru); }
+
+  // 这个条目占用的字节数，值为对象时包括对象占用的内存
+  size_t allocation_size() const {
+    size_t size = block_size();
+    if (is_object() && object()) {
+      size += object()->memory_bytes();
+    }
+    return size;
+  }
+
+  // 条目是否分配在 slab 中
+  bool in_slab() const { return (header()->flags & FLAG_SLAB) != 0; }
+  // 条目所在的 slab 正在被碎片整理清空，应当搬迁
+  bool in_evacuating_slab() const { return in_slab() && SlabAllocator::should_relocate(data_); }
+  // 把条目搬到 slabs 中新分配的块，内容不变（碎片整理用）
+  void relocate(SlabAllocator *slabs) {
+    size_t size = block_size();
+    char *data = alloc_block(slabs, size);
+    uint8_t slab_flag = reinterpret_cast<Header *>(data)->flags & FLAG_SLAB;
+    std::memcpy(data, data_, size);
+    Header *h = reinterpret_cast<Header *>(data);
+    h->flags = static_cast<uint8_t>((h->flags & ~FLAG_SLAB) | slab_flag);
+    release_block();
+    data_ = data;
+  }
+
+  // 修改值。整数值按整数编码保存；字符串值放得下且不会浪费过半空间时原地覆盖，否则重新分配。
+  // 原来的值是对象时释放对象，条目变为字符串。
+  // 需要重新分配时从 slabs 中分配（为空时使用堆），以下修改函数相同
+  void set_value(std::string_view value, SlabAllocator *slabs = nullptr) {
+    int64_t n;
+    if (parse_canonical_int(value, n)) {
+      set_int(n, slabs);
+      return;
+    }
+    if (!is_int() && !is_object() && value.size() <= value_cap() && value.size() * 2 >= value_cap()) {
+      std::memmove(value_data(), value.data(), value.size());
+      set_raw_size(static_cast<uint32_t>(value.size()), value_cap());
+      return;
+    }
+    rebuild_raw(slabs, value, expires_at());
+  }
+
+  // 把值扩展为至少 len 字节的字符串编码并返回可原地修改的值字节，新增的字节补零（SETBIT、BITFIELD 使用）。
+  // 整数编码的值先格式化为字符串。容量不足时重新分配，并预留与新长度相当（至多 1MB）的余量，
+  // 逐步增大偏移量的写入不必每次复制整个值。修改后应调用 normalize_int
+  std::span<char> writable_raw(size_t len, SlabAllocator *slabs = nullptr) {
+    if (is_int() || len > value_cap()) {
+      ValueBuffer buf;
+      std::string_view current = value(buf);
+      size_t cap = std::max(len, current.size());
+      if (len > current.size() && !is_int()) {
+        cap += std::min(cap, MAX_PREALLOC);
+      }
+      cap = std::min<size_t>(cap, std::numeric_limits<uint32_t>::max());
+      char *data = allocate_raw(slabs, key(), current, static_cast<uint32_t>(cap), expires_at(), lru());
+      release();
+      data_ = data;
+    }
+    if (len > value_len()) {
+      std::memset(value_data() + value_len(), 0, len - value_len());
+      set_raw_size(static_cast<uint32_t>(len), value_cap());
+    }
+    return {value_data(), value_len()};
+  }
+
+  // 原地修改后的字符串值恰好是规范整数时改为整数编码，保持字符串编码的值都不是规范整数
+  void normalize_int(SlabAllocator *slabs = nullptr) {
+    int64_t n;
+    if (!is_int() && !is_object() && parse_canonical_int(raw_value(), n)) {
+      set_int(n, slabs);
+    }
+  }
+
+  // 修改为整数值。已是整数编码时原地修改，不分配内存
+  void set_int(int64_t value, SlabAllocator *slabs = nullptr) {
+    if (!is_int()) {
+      char *data = allocate(slabs, key(), 0, expires_at(), lru());
+      release();
+      data_ = data;
+      header()->flags |= FLAG_INT;
+    }
+    header()->payload = static_cast<uint64_t>(value);
+  }
+
+  // 设置过期时间。原来没有过期时间的条目需要重新分配以放入过期时间字段
+  void set_expire(Clock::time_point when, SlabAllocator *slabs = nullptr) {
+    if (has_expire()) {
+      int64_t ticks = when.time_since_epoch().count();
+      std::memcpy(data_ + sizeof(Header), &ticks, sizeof(ticks));
+      return;
+    }
+    relayout(slabs, when);
+  }
+
+  // 移除过期时间，条目随之缩小
+  void clear_expire(SlabAllocator *slabs = nullptr) {
+    if (has_expire()) {
+      relayout(slabs, std::nullopt);
+    }
+  }
+
+private:
+  struct Header {
+    uint32_t key_len;
+    uint8_t flags;
+    uint8_t lru[3];
+    // 字符串编码时低 32 位是值长度、高 32 位是值容量；整数编码时就是值本身；对象时是对象指针
+    uint64_t payload;
+  };
+  static_assert(sizeof(Header) == 16);
+
+  static constexpr uint8_t FLAG_EXPIRE = 1u << 0;
+  static constexpr uint8_t FLAG_INT = 1u << 1;
+  static constexpr uint8_t FLAG_SLAB = 1u << 2;   // 块分配在 slab 中
+  static constexpr uint8_t FLAG_OBJECT = 1u << 3; // payload 是 ValueObject 指针
+  // writable_raw 扩容时预留余量的上限
+  static constexpr size_t MAX_PREALLOC = 1024 * 1024;
+
+  static size_t layout_size(size_t key_len, size_t value_cap, bool has_expire) {
+    return sizeof(Header) + (has_expire ? sizeof(int64_t) : 0) + key_len + value_cap;
+  }
+
+  static void store_lru(Header *h, uint32_t lru) {
+    h->lru[0] = static_cast<uint8_t>(lru);
+    h->lru[1] = static_cast<uint8_t>(lru >> 8);
+    h->lru[2] = static_cast<uint8_t>(lru >> 16);
+  }
+
+  // 分配 size 字节的块，slabs 放不下时使用堆。只设置块头部的 FLAG_SLAB 标志
+  static char *alloc_block(SlabAllocator *slabs, size_t size) {
+    if (slabs) {
+      if (void *p = slabs->allocate(size)) {
+        reinterpret_cast<Header *>(p)->flags = FLAG_SLAB;
+        return static_cast<char *>(p);
+      }
+    }
+    char *data = static_cast<char *>(::operator new(size));
+    reinterpret_cast<Header *>(data)->flags = 0;
+    return data;
+  }
+
+  // 分配并写入 Header、过期时间和键，值部分留给调用方
+  static char *allocate(SlabAllocator *slabs, std::string_view key, uint32_t value_cap,
+                        std::optional<Clock::time_point> expires_at, uint32_t lru = 0) {
+    char *data = alloc_block(slabs, layout_size(key.size(), value_cap, expires_at.has_value()));
+    Header *h = reinterpret_cast<Header *>(data);
+    h->key_len = static_cast<uint32_t>(key.size());
+    h->flags = static_cast<uint8_t>((h->flags & FLAG_SLAB) | (expires_at ? FLAG_EXPIRE : 0));
+    store_lru(h, lru);
+    h->payload = 0;
+    char *p = data + sizeof(Header);
+    if (expires_at) {
+      int64_t ticks = expires_at->time_since_epoch().count();
+      std::memcpy(p, &ticks, sizeof(ticks));
+      p += sizeof(ticks);
+    }
+    std::memcpy(p, key.data(), key.size());
+    return data;
+  }
+
+  static char *allocate_raw(SlabAllocator *slabs, std::string_view key, std::string_view value,
+                            uint32_t value_cap, std::optional<Clock::time_point> expires_at,
+                            uint32_t lru = 0) {
+    char *data = allocate(slabs, key, value_cap, expires_at, lru);
+    Header *h = reinterpret_cast<Header *>(data);
+    h->payload = value.size() | (static_cast<uint64_t>(value_cap) << 32);
+    std::memcpy(data + layout_size(key.size(), 0, expires_at.has_value()), value.data(), value.size());
+    return data;
+  }
+
+  // 以新的字符串值重建条目。先分配新块再释放旧块，value 可以指向旧块
+  void rebuild_raw(SlabAllocator *slabs, std::string_view value, std::optional<Clock::time_point> expires_at) {
+    char *data = allocate_raw(slabs, key(), value, static_cast<uint32_t>(value.size()), expires_at, lru());
+    release();
+    data_ = data;
+  }
+
+  // 保持值不变，按新的过期时间重新布局
+  void relayout(SlabAllocator *slabs, std::optional<Clock::time_point> expires_at) {
+    if (is_object()) {
+      uint64_t object = header()->payload;
+      char *data = allocate(slabs, key(), 0, expires_at, lru());
+      release_block();
+      data_ = data;
+      header()->flags |= FLAG_OBJECT;
+      header()->payload = object;
+      return;
+    }
+    if (is_int()) {
+      int64_t n = int_value();
+      char *data = allocate(slabs, key(), 0, expires_at, lru());
+      release();
+      data_ = data;
+      header()->flags |= FLAG_INT;
+      header()->payload = static_cast<uint64_t>(n);
+      return;
+    }
+    rebuild_raw(slabs, raw_value(), expires_at);
+  }
+
+  // 块本身的大小，不含值对象
+  size_t block_size() const {
+    return layout_size(header()->key_len, is_int() || is_object() ? 0 : value_cap(), has_expire());
+  }
+
+  void release() {
+    if (data_) {
+      if (is_object()) {
+        delete object();
+      }
+      release_block();
+    }
+  }
+
+  // 只释放块，值对象（如果有）的所有权已经转移
+  void release_block() {
+    if (in_slab()) {
+      SlabAllocator::deallocate(data_, block_size());
+    } else {
+      ::operator delete(data_);
+    }
+    data_ = nullptr;
+  }
+
+  uint32_t value_len() const { return static_cast<uint32_t>(header()->payload); }
+  uint32_t value_cap() const { return static_cast<uint32_t>(header()->payload >> 32); }
+  void set_raw_size(uint32_t len, uint32_t cap) {
+    header()->payload = len | (static_cast<uint64_t>(cap) << 32);
+  }
+
+  Header *header() const { return reinterpret_cast<Header *>(data_); }
+  char *key_data() const { return data_ + sizeof(Header) + (has_expire() ? sizeof(int64_t) : 0); }
+  char *value_data() const { return key_data() + header()->key_len; }
+
+  char *data_ = nullptr;
+};
@@ -0,0 +1,101 @@
+module;
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <utility>
+
+export module lazyfree;
+
+// 惰性释放：把大对象（大值、整张键空间表）的析构交给后台线程，
+// 事件循环只需把对象移入一个节点并入队，命令耗时与对象大小无关。
+//
+// 队列是无锁的多生产者单消费者栈：各事件循环用 CAS 把节点压入链表头，
+// 后台线程一次取走整条链表后逐个析构。释放顺序无关紧要，所以不需要反转链表。
+// 待释放对象数同时用作后台线程的等待条件（std::atomic::wait），入队不加锁。
+export class LazyFree {
+public:
+  static LazyFree &instance() {
+    static LazyFree lazyfree;
+    return lazyfree;
+  }
+
+  LazyFree(const LazyFree &) = delete;
+  LazyFree &operator=(const LazyFree &) = delete;
+
+  // 把对象移交给后台线程析构，可在任意线程调用
+  template <typename T> void free_later(T object) { push(new Holder<T>(std::move(object))); }
+
+  // 已入队但尚未释放的对象数
+  size_t pending_objects() const {
+    int64_t pending = pending_.load(std::memory_order_relaxed);
+    return pending > 0 ? static_cast<size_t>(pending) : 0;
+  }
+  // 后台线程累计释放的对象数
+  size_t freed_objects() const { return freed_.load(std::memory_order_relaxed); }
+
+  // 等待已入队的对象全部释放完，用于测试和基准测试
+  void wait_idle() const {
+    while (pending_.load(std::memory_order_acquire) > 0) {
+      std::this_thread::yield();
+    }
+  }
+
+private:
+  struct Node {
+    Node *next = nullptr;
+    virtual ~Node() = default;
+  };
+
+  template <typename T> struct Holder final : Node {
+    explicit Holder(T &&value) : object(std::move(value)) {}
+    T object;
+  };
+
+  LazyFree() : thread_([this] { run(); }) {}
+
+  ~LazyFree() {
+    stop_.store(true, std::memory_order_release);
+    // 计数加一唤醒后台线程，它在退出前释放剩余的对象
+    pending_.fetch_add(1, std::memory_order_release);
+    pending_.notify_one();
+    thread_.join();
+  }
+
+  void push(Node *node) {
+    // 先增加计数再入队：后台线程看到计数时节点可能还没挂上链表，此时它会重新检查
+    pending_.fetch_add(1, std::memory_order_release);
+    node->next = head_.load(std::memory_order_relaxed);
+    while (!head_.compare_exchange_weak(node->next, node, std::memory_order_release,
+                                        std::memory_order_relaxed)) {
+    }
+    pending_.notify_one();
+  }
+
+  void run() {
+    for (;;) {
+      pending_.wait(0, std::memory_order_acquire);
+      Node *list = head_.exchange(nullptr, std::memory_order_acquire);
+      while (list) {
+        Node *next = list->next;
+        delete list;
+        freed_.fetch_add(1, std::memory_order_relaxed);
+        pending_.fetch_sub(1, std::memory_order_release);
+        list = next;
+      }
+      if (stop_.load(std::memory_order_acquire)) {
+        return;
+      }
+      if (pending_.load(std::memory_order_acquire) > 0) {
+        std::this_thread::yield(); // 有节点正在入队
+      }
+    }
+  }
+
+  std::atomic<Node *> head_{nullptr};
+  std::atomic<int64_t> pending_{0};
+  std::atomic<size_t> freed_{0};
+  std::atomic<bool> stop_{false};
+  std::thread thread_;
+};
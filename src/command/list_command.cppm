@@ -0,0 +1,404 @@
+module;
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <format>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+export module list_command;
+
+import command_defs;
+import list_object;
+import listpack;
+import resp;
+import buffer;
+import logger;
+
+// LPUSH/RPUSH 的公共实现：键不存在时创建列表，依次压入所有元素，返回列表长度
+void push_generic(KVServerContext &context, CommandArgs args, bool front, Buffer &out) {
+  Storage::iterator it;
+  if (!context.find_live_key_of(args[0], ObjectType::List, it, out)) {
+    return;
+  }
+  auto &db = context.get_db();
+  if (it == db.end()) {
+    it = db.insert(db.create_object_entry(args[0], std::make_unique<ListObject>())).first;
+  }
+  const auto &config = context.encoding_config();
+  db.update(it, [&](KvEntry &entry) {
+    auto &list = object_cast<ListObject>(entry);
+    for (size_t i = 1; i < args.size(); ++i) {
+      if (front) {
+        list.push_front(args[i], config);
+      } else {
+        list.push_back(args[i], config);
+      }
+    }
+  });
+  context.signal_key_ready(args[0]);
+  resp::write_integer(out, static_cast<long long>(object_cast<ListObject>(*it).size()));
+}
+
+// LPOP/RPOP 的公共实现：LPOP key [count]，command 为命令名。
+// 不带 count 时返回一个元素，带 count 时返回数组，列表弹空时删除键
+void pop_generic(KVServerContext &context, CommandArgs args, bool front, std::string_view command,
+                 Buffer &out) {
+  std::optional<int64_t> count;
+  if (args.size() > 2) {
+    resp::write_error(out, std::format("ERR wrong number of arguments for '{}' command", command));
+    return;
+  }
+  if (args.size() == 2) {
+    int64_t n;
+    if (!parse_canonical_int(args[1], n)) {
+      resp::write_error(out, "ERR value is not an integer or out of range");
+      return;
+    }
+    if (n < 0) {
+      resp::write_error(out, "ERR value is out of range, must be positive");
+      return;
+    }
+    count = n;
+  }
+  Storage::iterator it;
+  if (!context.find_live_key_of(args[0], ObjectType::List, it, out)) {
+    return;
+  }
+  auto &db = context.get_db();
+  if (it == db.end()) {
+    context.suppress_propagation();
+    if (count) {
+      resp::write_null_array(out);
+    } else {
+      resp::write_null_bulk_string(out);
+    }
+    return;
+  }
+
+  std::vector<std::string> values;
+  db.update(it, [&](KvEntry &entry) {
+    auto &list = object_cast<ListObject>(entry);
+    size_t n = count ? static_cast<size_t>(std::min<uint64_t>(*count, list.size())) : 1;
+    values.resize(n);
+    for (auto &value : values) {
+      if (front) {
+        list.pop_front(value);
+      } else {
+        list.pop_back(value);
+      }
+    }
+  });
+  if (object_cast<ListObject>(*it).empty()) {
+    LOG_DEBUG("{} 命令删除空列表: {}", command, args[0]);
+    context.erase_key(it);
+  }
+  if (values.empty()) {
+    context.suppress_propagation();
+  }
+
+  if (!count) {
+    resp::write_bulk_string(out, values[0]);
+    return;
+  }
+  resp::write_array_header(out, values.size());
+  for (const auto &value : values) {
+    resp::write_bulk_string(out, value);
+  }
+}
+
+// LPush命令：LPUSH key element [element ...]，元素依次压入头部
+export void lpush_command(KVServerContext &context, CommandArgs args, Buffer &out) {
+  push_generic(context, args, true, out);
+}
+
+// RPush命令：RPUSH key element [element ...]，元素依次压入尾部
+export void rpush_command(KVServerContext &context, CommandArgs args, Buffer &out) {
+  push_generic(context, args, false, out);
+}
+
+// LPop命令
+export void lpop_command(KVServerContext &context, CommandArgs args, Buffer &out) {
+  pop_generic(context, args, true, "LPOP", out);
+}
+
+// RPop命令
+export void rpop_command(KVServerContext &context, CommandArgs args, Buffer &out) {
+  pop_generic(context, args, false, "RPOP", out);
+}
+
+// LLen命令：键不存在时返回 0
+export void llen_command(KVServerContext &context, CommandArgs args, Buffer &out) {
+  Storage::iterator it;
+  if (!context.find_live_key_of(args[0], ObjectType::List, it, out)) {
+    return;
+  }
+  size_t size = it == context.get_db().end() ? 0 : object_cast<ListObject>(*it).size();
+  resp::write_integer(out, static_cast<long long>(size));
+}
+
+// LIndex命令：LINDEX key index，负数从尾部计数，越界时返回 nil
+export void lindex_command(KVServerContext &context, CommandArgs args, Buffer &out) {
+  int64_t index;
+  if (!parse_canonical_int(args[1], index)) {
+    resp::write_error(out, "ERR value is not an integer or out of range");
+    return;
+  }
+  Storage::iterator it;
+  if (!context.find_live_key_of(args[0], ObjectType::List, it, out)) {
+    return;
+  }
+  if (it == context.get_db().end()) {
+    resp::write_null_bulk_string(out);
+    return;
+  }
+  Listpack::ValueBuffer buf;
+  auto value = object_cast<ListObject>(*it).index(index, buf);
+  if (value) {
+    resp::write_bulk_string(out, *value);
+  } else {
+    resp::write_null_bulk_string(out);
+  }
+}
+
+// 解析 LRANGE/LTRIM 的 start 和 stop，失败时写出错误回复
+bool parse_range_args(CommandArgs args, int64_t &start, int64_t &stop, Buffer &out) {
+  if (!parse_canonical_int(args[1], start) || !parse_canonical_int(args[2], stop)) {
+    resp::write_error(out, "ERR value is not an integer or out of range");
+    return false;
+  }
+  return true;
+}
+
+// LRange命令：LRANGE key start stop，两端都包含在内
+export void lrange_command(KVServerContext &context, CommandArgs args, Buffer &out) {
+  int64_t start;
+  int64_t stop;
+  if (!parse_range_args(args, start, stop, out)) {
+    return;
+  }
+  Storage::iterator it;
+  if (!context.find_live_key_of(args[0], ObjectType::List, it, out)) {
+    return;
+  }
+  size_t first;
+  size_t last;
+  if (it == context.get_db().end() ||
+      !normalize_range(start, stop, object_cast<ListObject>(*it).size(), first, last)) {
+    resp::write_array_header(out, 0);
+    return;
+  }
+  resp::write_array_header(out, last - first + 1);
+  object_cast<ListObject>(*it).range(first, last, [&](std::string_view value) { resp::write_bulk_string(out, value); });
+}
+
+// LTrim命令：LTRIM key start stop，只保留区间内的元素，区间为空时删除键
+export void ltrim_command(KVServerContext &context, CommandArgs args, Buffer &out) {
+  int64_t start;
+  int64_t stop;
+  if (!parse_range_args(args, start, stop, out)) {
+    return;
+  }
+  Storage::iterator it;
+  if (!context.find_live_key_of(args[0], ObjectType::List, it, out)) {
+    return;
+  }
+  auto &db = context.get_db();
+  if (it == db.end()) {
+    context.suppress_propagation();
+    resp::write_ok(out);
+    return;
+  }
+  size_t first;
+  size_t last;
+  if (!normalize_range(start, stop, object_cast<ListObject>(*it).size(), first, last)) {
+    LOG_DEBUG("LTRIM命令删除空列表: {}", args[0]);
+    context.erase_key(it);
+  } else {
+    db.update(it, [&](KvEntry &entry) { object_cast<ListObject>(entry).trim(first, last); });
+  }
+  resp::write_ok(out);
+}
+
+// 从列表的一端弹出一个元素，列表弹空时删除键
+std::string pop_one(KVServerContext &context, Storage::iterator it, bool front) {
+  std::string value;
+  context.get_db().update(it, [&](KvEntry &entry) {
+    auto &list = object_cast<ListObject>(entry);
+    if (front) {
+      list.pop_front(value);
+    } else {
+      list.pop_back(value);
+    }
+  });
+  if (object_cast<ListObject>(*it).empty()) {
+    context.erase_key(it);
+  }
+  return value;
+}
+
+// 解析 LEFT/RIGHT 方向参数，LEFT 时 left 为 true
+bool parse_direction(std::string_view arg, bool &left, Buffer &out) {
+  if (option_is(arg, "LEFT")) {
+    left = true;
+  } else if (option_is(arg, "RIGHT")) {
+    left = false;
+  } else {
+    resp::write_error(out, "ERR syntax error");
+    return false;
+  }
+  return true;
+}
+
+// 解析阻塞命令的超时参数：秒数，可以带小数，0 表示一直等待。失败时写出错误回复
+bool parse_block_timeout(std::string_view arg, std::chrono::milliseconds &timeout, Buffer &out) {
+  constexpr double MAX_TIMEOUT_SECONDS = 1e12; // 保证换算成毫秒后与当前时间相加不会溢出
+  double seconds;
+  auto [ptr, ec] = std::from_chars(arg.data(), arg.data() + arg.size(), seconds);
+  if (ec != std::errc{} || ptr != arg.data() + arg.size() || !std::isfinite(seconds)) {
+    resp::write_error(out, "ERR timeout is not a float or out of range");
+    return false;
+  }
+  if (seconds < 0) {
+    resp::write_error(out, "ERR timeout is negative");
+    return false;
+  }
+  if (seconds > MAX_TIMEOUT_SECONDS) {
+    resp::write_error(out, "ERR timeout is out of range");
+    return false;
+  }
+  timeout = std::chrono::milliseconds(static_cast<long long>(std::ceil(seconds * 1000)));
+  return true;
+}
+
+// LMOVE/BLMOVE 的公共实现：从 source 的一端弹出元素，压入 destination 的一端，回复被移动的元素。
+// source 不存在时返回 false 且不写回复；其余情况（包括类型错误）已写出回复，返回 true
+bool move_element(KVServerContext &context, std::string_view source, std::string_view destination,
+                  bool from_left, bool to_left, Buffer &out) {
+  Storage::iterator src;
+  if (!context.find_live_key_of(source, ObjectType::List, src, out)) {
+    return true;
+  }
+  auto &db = context.get_db();
+  if (src == db.end()) {
+    return false;
+  }
+  Storage::iterator dst;
+  if (!context.find_live_key_of(destination, ObjectType::List, dst, out)) {
+    return true;
+  }
+  // 查找 destination 时可能惰性删除过期键，删除会推进渐进式扩容而移动条目，重新定位 source
+  src = db.find(source);
+
+  const auto &config = context.encoding_config();
+  auto push = [&](KvEntry &entry, const std::string &value) {
+    auto &list = object_cast<ListObject>(entry);
+    if (to_left) {
+      list.push_front(value, config);
+    } else {
+      list.push_back(value, config);
+    }
+  };
+  std::string value;
+  if (source == destination) {
+    // 同一个列表内轮转，先弹出再压入，列表不会中途变空被删除
+    db.update(src, [&](KvEntry &entry) {
+      auto &list = object_cast<ListObject>(entry);
+      if (from_left) {
+        list.pop_front(value);
+      } else {
+        list.pop_back(value);
+      }
+      push(entry, value);
+    });
+  } else {
+    value = pop_one(context, src, from_left);
+    // 删除 source 同样可能移动条目，重新查找 destination
+    dst = db.find(destination);
+    if (dst == db.end()) {
+      dst = db.insert(db.create_object_entry(destination, std::make_unique<ListObject>())).first;
+    }
+    db.update(dst, [&](KvEntry &entry) { push(entry, value); });
+  }
+  context.signal_key_ready(destination);
+  resp::write_bulk_string(out, value);
+  return true;
+}
+
+// BLPOP/BRPOP 的公共实现：按顺序找到第一个非空列表，弹出一个元素并回复 [键, 元素]。
+// 所有列表都为空时请求阻塞，AOF 中记为对应的 LPOP/RPOP
+void bpop_generic(KVServerContext &context, CommandArgs args, bool front, Buffer &out) {
+  std::chrono::milliseconds timeout;
+  if (!parse_block_timeout(args.back(), timeout, out)) {
+    return;
+  }
+  auto keys = args.first(args.size() - 1);
+  for (std::string_view key : keys) {
+    Storage::iterator it;
+    if (!context.find_live_key_of(key, ObjectType::List, it, out)) {
+      return;
+    }
+    if (it == context.get_db().end()) {
+      continue;
+    }
+    std::string value = pop_one(context, it, front);
+    context.propagate_as({front ? "LPOP" : "RPOP", key});
+    resp::write_array_header(out, 2);
+    resp::write_bulk_string(out, key);
+    resp::write_bulk_string(out, value);
+    return;
+  }
+  context.suppress_propagation();
+  context.block_on(keys, timeout);
+  resp::write_null_array(out);
+}
+
+// LMove命令：LMOVE source destination LEFT|RIGHT LEFT|RIGHT，source 不存在时返回 nil
+export void lmove_command(KVServerContext &context, CommandArgs args, Buffer &out) {
+  bool from_left;
+  bool to_left;
+  if (!parse_direction(args[2], from_left, out) || !parse_direction(args[3], to_left, out)) {
+    return;
+  }
+  if (!move_element(context, args[0], args[1], from_left, to_left, out)) {
+    context.suppress_propagation();
+    resp::write_null_bulk_string(out);
+  }
+}
+
+// BLPop命令：BLPOP key [key ...] timeout
+export void blpop_command(KVServerContext &context, CommandArgs args, Buffer &out) {
+  bpop_generic(context, args, true, out);
+}
+
+// BRPop命令：BRPOP key [key ...] timeout
+export void brpop_command(KVServerContext &context, CommandArgs args, Buffer &out) {
+  bpop_generic(context, args, false, out);
+}
+
+// BLMove命令：BLMOVE source destination LEFT|RIGHT LEFT|RIGHT timeout，
+// 只在 source 上等待，AOF 中记为 LMOVE
+export void blmove_command(KVServerContext &context, CommandArgs args, Buffer &out) {
+  bool from_left;
+  bool to_left;
+  std::chrono::milliseconds timeout;
+  if (!parse_direction(args[2], from_left, out) || !parse_direction(args[3], to_left, out) ||
+      !parse_block_timeout(args[4], timeout, out)) {
+    return;
+  }
+  if (move_element(context, args[0], args[1], from_left, to_left, out)) {
+    context.propagate_as({"LMOVE", args[0], args[1], args[2], args[3]});
+    return;
+  }
+  context.suppress_propagation();
+  context.block_on(args.first(1), timeout);
+  resp::write_null_bulk_string(out);
+}
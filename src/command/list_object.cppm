@@ -0,0 +1,222 @@
+module;
+
+#include <algorithm>
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+
+export module list_object;
+
+import value_object;
+import listpack;
+
+// 列表类型的值：quicklist，即由紧凑节点组成的双向链表。每个节点是一个 Listpack，
+// 节点大小受 EncodingConfig::list_max_listpack_size 限制。两端的压入和弹出只修改首尾节点，
+// 是 O(1) 的（节点内移动的字节数有上限）；元素连续存放，每个元素只有编码头和反向长度几个字节的开销，
+// 链表指针和节点头由一个节点内的所有元素分摊。写满的节点归还多余的容量，只有首尾节点留有增长空间
+export class ListObject final : public ValueObject {
+public:
+  ListObject() : ValueObject(ObjectType::List) {}
+  ~ListObject() override {
+    while (head_) {
+      Node *next = head_->next;
+      delete head_;
+      head_ = next;
+    }
+  }
+
+  std::string_view encoding_name() const override { return "quicklist"; }
+  size_t memory_bytes() const override { return sizeof(*this) + node_bytes_; }
+
+  size_t size() const { return count_; }
+  bool empty() const { return count_ == 0; }
+  // 节点数，供测试和基准检查节点的填充情况
+  size_t node_count() const { return node_count_; }
+
+  void push_front(std::string_view value, const EncodingConfig &config) {
+    if (!head_ || !node_allows(head_, value.size(), config)) {
+      link_front(new Node());
+    }
+    update_node(head_, [&] { head_->entries.push_front(value); });
+    ++count_;
+  }
+  void push_back(std::string_view value, const EncodingConfig &config) {
+    if (!tail_ || !node_allows(tail_, value.size(), config)) {
+      link_back(new Node());
+    }
+    update_node(tail_, [&] { tail_->entries.push_back(value); });
+    ++count_;
+  }
+
+  // 弹出首个或最后一个元素，值复制到 out。列表为空时返回 false
+  bool pop_front(std::string &out) { return pop(head_, true, out); }
+  bool pop_back(std::string &out) { return pop(tail_, false, out); }
+
+  // 第 index 个元素（负数从尾部计数），越界时返回 nullopt。整数元素格式化到 buf 中，
+  // 返回的视图在下次修改前有效
+  std::optional<std::string_view> index(long long index, Listpack::ValueBuffer &buf) const {
+    long long n = static_cast<long long>(count_);
+    if (index < 0) {
+      index += n;
+    }
+    if (index < 0 || index >= n) {
+      return std::nullopt;
+    }
+    auto [node, offset] = locate(static_cast<size_t>(index));
+    return node->entries.get(node->entries.seek(static_cast<long long>(offset))).as_string(buf);
+  }
+
+  // 对下标 [start, stop] 中的元素依次调用 fn(value)，下标已规范化且不越界
+  template <typename Fn> void range(size_t start, size_t stop, Fn &&fn) const {
+    auto [node, offset] = locate(start);
+    size_t pos = node->entries.seek(static_cast<long long>(offset));
+    Listpack::ValueBuffer buf;
+    for (size_t i = start; i <= stop; ++i) {
+      if (pos == Listpack::npos) {
+        node = node->next;
+        pos = node->entries.first();
+      }
+      fn(node->entries.get(pos).as_string(buf));
+      pos = node->entries.next(pos);
+    }
+  }
+
+  // 只保留下标 [start, stop] 中的元素，下标已规范化且不越界。整个节点被裁掉时直接释放
+  void trim(size_t start, size_t stop) {
+    erase_front(start);
+    erase_back(count_ - (stop - start + 1));
+  }
+
+private:
+  struct Node {
+    Node *prev = nullptr;
+    Node *next = nullptr;
+    Listpack entries;
+  };
+
+  // 节点还能否放入长度为 value_size 的元素。按字节限制时预留编码头和反向长度的开销；
+  // 空节点总能放入，超过上限的单个大元素独占一个节点
+  static bool node_allows(const Node *node, size_t value_size, const EncodingConfig &config) {
+    if (node->entries.empty()) {
+      return true;
+    }
+    int fill = config.list_max_listpack_size;
+    if (fill > 0) {
+      return node->entries.size() < static_cast<size_t>(fill);
+    }
+    size_t limit = size_t{4096} << std::min(-fill - 1, 4);
+    return node->entries.bytes() + value_size + 11 <= limit;
+  }
+
+  // 在 fn 中修改节点的元素，修改前后的容量差计入内存统计
+  template <typename Fn> void update_node(Node *node, Fn fn) {
+    node_bytes_ -= node->entries.memory_bytes();
+    fn();
+    node_bytes_ += node->entries.memory_bytes();
+  }
+
+  // 新节点接到链表一端。原来的端点节点已写满，归还多余的容量
+  void link_front(Node *node) {
+    if (head_) {
+      update_node(head_, [this] { head_->entries.shrink_to_fit(); });
+      head_->prev = node;
+    } else {
+      tail_ = node;
+    }
+    node->next = head_;
+    head_ = node;
+    node_bytes_ += sizeof(Node);
+    ++node_count_;
+  }
+  void link_back(Node *node) {
+    if (tail_) {
+      update_node(tail_, [this] { tail_->entries.shrink_to_fit(); });
+      tail_->next = node;
+    } else {
+      head_ = node;
+    }
+    node->prev = tail_;
+    tail_ = node;
+    node_bytes_ += sizeof(Node);
+    ++node_count_;
+  }
+
+  void unlink(Node *node) {
+    (node->prev ? node->prev->next : head_) = node->next;
+    (node->next ? node->next->prev : tail_) = node->prev;
+    node_bytes_ -= sizeof(Node) + node->entries.memory_bytes();
+    --node_count_;
+    delete node;
+  }
+
+  bool pop(Node *node, bool front, std::string &out) {
+    if (!node) {
+      return false;
+    }
+    size_t pos = front ? node->entries.first() : node->entries.last();
+    Listpack::ValueBuffer buf;
+    out.assign(node->entries.get(pos).as_string(buf));
+    update_node(node, [&] { node->entries.erase(pos); });
+    --count_;
+    if (node->entries.empty()) {
+      unlink(node);
+    }
+    return true;
+  }
+
+  // 第 index 个元素所在的节点和节点内的偏移，从较近的一端开始找
+  std::pair<Node *, size_t> locate(size_t index) const {
+    if (index < count_ / 2) {
+      Node *node = head_;
+      while (index >= node->entries.size()) {
+        index -= node->entries.size();
+        node = node->next;
+      }
+      return {node, index};
+    }
+    size_t from_back = count_ - 1 - index;
+    Node *node = tail_;
+    while (from_back >= node->entries.size()) {
+      from_back -= node->entries.size();
+      node = node->prev;
+    }
+    return {node, node->entries.size() - 1 - from_back};
+  }
+
+  void erase_front(size_t n) {
+    while (n > 0) {
+      size_t in_node = head_->entries.size();
+      if (in_node <= n) {
+        n -= in_node;
+        count_ -= in_node;
+        unlink(head_);
+        continue;
+      }
+      update_node(head_, [&] { head_->entries.erase_range(head_->entries.first(), n); });
+      count_ -= n;
+      n = 0;
+    }
+  }
+  void erase_back(size_t n) {
+    while (n > 0) {
+      size_t in_node = tail_->entries.size();
+      if (in_node <= n) {
+        n -= in_node;
+        count_ -= in_node;
+        unlink(tail_);
+        continue;
+      }
+      update_node(tail_, [&] { tail_->entries.erase_range(tail_->entries.seek(-static_cast<long long>(n)), n); });
+      count_ -= n;
+      n = 0;
+    }
+  }
+
+  Node *head_ = nullptr;
+  Node *tail_ = nullptr;
+  size_t count_ = 0;
+  size_t node_count_ = 0;
+  size_t node_bytes_ = 0; // 所有节点的节点头和元素缓冲区占用的字节数
+};
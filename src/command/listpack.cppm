@@ -0,0 +1,321 @@
+module;
+
+#include <array>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+export module listpack;
+
+import kv_entry;
+
+// 紧凑列表：元素依次存放在一块连续内存中，元素少的集合类型用它代替指针结构，
+// 遍历只访问连续内存，每个元素只有几个字节的额外开销。每个元素的布局：
+//
+//   +--------+------+---------------+
+//   | 编码头 | 内容 | 反向长度(1-5) |
+//   +--------+------+---------------+
+//
+// 能解析为规范 64 位整数的元素按整数保存，连同编码头占 1、3、5 或 9 字节；其他元素保存字符串字节。
+// 反向长度记录编码头加内容的字节数，每字节 7 位，从元素末尾向前读取，因此可以从尾部反向遍历。
+// 位置是元素开头在缓冲区中的偏移。插入和删除会移动其后的元素，之前取得的位置和字符串视图随之失效
+export class Listpack {
+public:
+  static constexpr size_t npos = static_cast<size_t>(-1);
+  // 格式化整数元素所需的缓冲区，能容纳任意 int64
+  using ValueBuffer = std::array<char, 24>;
+
+  // 一个元素的内容：整数或字符串
+  struct Value {
+    bool is_int = false;
+    int64_t integer = 0;
+    std::string_view str;
+
+    // 以字符串形式读取，整数格式化到 buf 中
+    std::string_view as_string(ValueBuffer &buf) const {
+      if (!is_int) {
+        return str;
+      }
+      char *end = std::to_chars(buf.data(), buf.data() + buf.size(), integer).ptr;
+      return {buf.data(), static_cast<size_t>(end - buf.data())};
+    }
+  };
+
+  size_t size() const { return count_; }
+  bool empty() const { return count_ == 0; }
+  // 元素占用的字节数
+  size_t bytes() const { return buf_.size(); }
+  // 占用的堆内存
+  size_t memory_bytes() const { return buf_.capacity(); }
+
+  size_t first() const { return buf_.empty() ? npos : 0; }
+  size_t last() const { return prev(npos); }
+  // 下一个元素的位置，pos 是最后一个元素时返回 npos
+  size_t next(size_t pos) const {
+    size_t n = pos + entry_size(pos);
+    return n == buf_.size() ? npos : n;
+  }
+  // 上一个元素的位置，pos 为 npos 时返回最后一个元素
+  size_t prev(size_t pos) const {
+    if (pos == npos) {
+      pos = buf_.size();
+    }
+    return pos == 0 ? npos : pos - back_entry_size(pos);
+  }
+
+  Value get(size_t pos) const { return decode(buf_.data() + pos); }
+
+  // 第 index 个元素的位置，负数从尾部计数（-1 为最后一个），越界时返回 npos。从较近的一端开始走
+  size_t seek(long long index) const {
+    long long n = static_cast<long long>(count_);
+    if (index < 0) {
+      index += n;
+    }
+    if (index < 0 || index >= n) {
+      return npos;
+    }
+    if (index < n / 2) {
+      size_t pos = first();
+      for (long long i = 0; i < index; ++i) {
+        pos = next(pos);
+      }
+      return pos;
+    }
+    size_t pos = last();
+    for (long long i = n - 1; i > index; --i) {
+      pos = prev(pos);
+    }
+    return pos;
+  }
+
+  // 从 pos 开始查找等于 value 的元素，每比较一个元素后跳过 skip 个（哈希中跳过值只比较字段名）。
+  // 整数元素总是规范格式，value 是规范整数时只需与整数元素比较，否则只需与字符串元素比较
+  size_t find(size_t pos, std::string_view value, size_t skip = 0) const {
+    int64_t n;
+    bool as_int = parse_canonical_int(value, n);
+    while (pos != npos) {
+      Value v = get(pos);
+      if (v.is_int ? as_int && v.integer == n : !as_int && v.str == value) {
+        return pos;
+      }
+      for (size_t i = 0; i <= skip && pos != npos; ++i) {
+        pos = next(pos);
+      }
+    }
+    return npos;
+  }
+
+  // 在 pos 之前插入元素，pos 为 npos 时追加到末尾，返回新元素的位置。value 不能指向本列表
+  size_t insert(size_t pos, std::string_view value) {
+    if (pos == npos) {
+      pos = buf_.size();
+    }
+    int64_t n;
+    bool is_int = parse_canonical_int(value, n);
+    size_t enc = is_int ? int_size(n) : str_header_size(value.size()) + value.size();
+    size_t total = enc + backlen_size(enc);
+    buf_.insert(buf_.begin() + static_cast<std::ptrdiff_t>(pos), total, 0);
+    uint8_t *p = buf_.data() + pos;
+    if (is_int) {
+      write_int(p, n);
+    } else {
+      write_str(p, value);
+    }
+    write_backlen(p + enc, enc);
+    ++count_;
+    return pos;
+  }
+  void push_front(std::string_view value) { insert(0, value); }
+  void push_back(std::string_view value) { insert(npos, value); }
+
+  // 删除 pos 处的元素，返回其后元素的位置（没有时为 npos）
+  size_t erase(size_t pos) {
+    erase_range(pos, 1);
+    return pos == buf_.size() ? npos : pos;
+  }
+  // 从 pos 开始删除 count 个元素，count 不能超过 pos 之后的元素数
+  void erase_range(size_t pos, size_t count) {
+    size_t end = pos;
+    for (size_t i = 0; i < count; ++i) {
+      end += entry_size(end);
+    }
+    buf_.erase(buf_.begin() + static_cast<std::ptrdiff_t>(pos), buf_.begin() + static_cast<std::ptrdiff_t>(end));
+    count_ -= count;
+    // 删除大量元素后归还多余的容量
+    if (buf_.capacity() > 64 && buf_.size() < buf_.capacity() / 4) {
+      buf_.shrink_to_fit();
+    }
+  }
+  // 替换 pos 处的元素，返回新元素的位置（不变）。value 不能指向本列表
+  size_t replace(size_t pos, std::string_view value) {
+    erase_range(pos, 1);
+    return insert(pos == buf_.size() ? npos : pos, value);
+  }
+
+  // 归还多余的容量，不再追加元素时调用
+  void shrink_to_fit() { buf_.shrink_to_fit(); }
+
+  void clear() {
+    std::vector<uint8_t>().swap(buf_);
+    count_ = 0;
+  }
+
+private:
+  // 编码头：
+  //   0xxxxxxx             0..127 的整数
+  //   10xxxxxx             长度小于 64 的字符串
+  //   1100xxxx xxxxxxxx    长度小于 4096 的字符串
+  //   0xF0 + 4 字节长度    更长的字符串
+  //   0xF1/0xF2/0xF3       之后是 16/32/64 位整数
+  static constexpr uint8_t STR6 = 0x80;
+  static constexpr uint8_t STR12 = 0xC0;
+  static constexpr uint8_t STR32 = 0xF0;
+  static constexpr uint8_t INT16 = 0xF1;
+  static constexpr uint8_t INT32 = 0xF2;
+  static constexpr uint8_t INT64 = 0xF3;
+
+  static size_t int_size(int64_t n) {
+    if (n >= 0 && n < 128) {
+      return 1;
+    }
+    if (n >= INT16_MIN && n <= INT16_MAX) {
+      return 3;
+    }
+    if (n >= INT32_MIN && n <= INT32_MAX) {
+      return 5;
+    }
+    return 9;
+  }
+  static size_t str_header_size(size_t len) { return len < 64 ? 1 : len < 4096 ? 2 : 5; }
+  static size_t backlen_size(size_t enc) {
+    size_t size = 1;
+    while (enc >= 128) {
+      enc >>= 7;
+      ++size;
+    }
+    return size;
+  }
+
+  static void write_int(uint8_t *p, int64_t n) {
+    if (n >= 0 && n < 128) {
+      p[0] = static_cast<uint8_t>(n);
+    } else if (n >= INT16_MIN && n <= INT16_MAX) {
+      p[0] = INT16;
+      int16_t v = static_cast<int16_t>(n);
+      std::memcpy(p + 1, &v, sizeof(v));
+    } else if (n >= INT32_MIN && n <= INT32_MAX) {
+      p[0] = INT32;
+      int32_t v = static_cast<int32_t>(n);
+      std::memcpy(p + 1, &v, sizeof(v));
+    } else {
+      p[0] = INT64;
+      std::memcpy(p + 1, &n, sizeof(n));
+    }
+  }
+  static void write_str(uint8_t *p, std::string_view s) {
+    size_t len = s.size();
+    if (len < 64) {
+      *p++ = static_cast<uint8_t>(STR6 | len);
+    } else if (len < 4096) {
+      *p++ = static_cast<uint8_t>(STR12 | (len >> 8));
+      *p++ = static_cast<uint8_t>(len);
+    } else {
+      *p++ = STR32;
+      uint32_t v = static_cast<uint32_t>(len);
+      std::memcpy(p, &v, sizeof(v));
+      p += sizeof(v);
+    }
+    std::memcpy(p, s.data(), len);
+  }
+  // 反向长度：最后一个字节是最低 7 位，除最前面的字节外都带有继续标志
+  static void write_backlen(uint8_t *p, size_t enc) {
+    size_t size = backlen_size(enc);
+    for (size_t i = 0; i < size; ++i) {
+      p[size - 1 - i] = static_cast<uint8_t>(((enc >> (7 * i)) & 0x7F) | (i + 1 < size ? 0x80 : 0));
+    }
+  }
+
+  // 编码头加内容的字节数
+  static size_t encoded_size(const uint8_t *p) {
+    uint8_t b = p[0];
+    if (b < 0x80) {
+      return 1;
+    }
+    if ((b & 0xC0) == STR6) {
+      return 1 + (b & 0x3F);
+    }
+    if ((b & 0xF0) == STR12) {
+      return 2 + ((static_cast<size_t>(b & 0x0F) << 8) | p[1]);
+    }
+    switch (b) {
+    case INT16:
+      return 3;
+    case INT32:
+      return 5;
+    case INT64:
+      return 9;
+    default: {
+      uint32_t len;
+      std::memcpy(&len, p + 1, sizeof(len));
+      return 5 + len;
+    }
+    }
+  }
+
+  static Value decode(const uint8_t *p) {
+    Value v;
+    uint8_t b = p[0];
+    const char *data = reinterpret_cast<const char *>(p);
+    if (b < 0x80) {
+      v.is_int = true;
+      v.integer = b;
+    } else if ((b & 0xC0) == STR6) {
+      v.str = {data + 1, static_cast<size_t>(b & 0x3F)};
+    } else if ((b & 0xF0) == STR12) {
+      v.str = {data + 2, (static_cast<size_t>(b & 0x0F) << 8) | p[1]};
+    } else if (b == INT16) {
+      int16_t n;
+      std::memcpy(&n, p + 1, sizeof(n));
+      v.is_int = true;
+      v.integer = n;
+    } else if (b == INT32) {
+      int32_t n;
+      std::memcpy(&n, p + 1, sizeof(n));
+      v.is_int = true;
+      v.integer = n;
+    } else if (b == INT64) {
+      v.is_int = true;
+      std::memcpy(&v.integer, p + 1, sizeof(v.integer));
+    } else {
+      uint32_t len;
+      std::memcpy(&len, p + 1, sizeof(len));
+      v.str = {data + 5, len};
+    }
+    return v;
+  }
+
+  // pos 处元素的总字节数
+  size_t entry_size(size_t pos) const {
+    size_t enc = encoded_size(buf_.data() + pos);
+    return enc + backlen_size(enc);
+  }
+  // 结束于 end 的元素的总字节数，从反向长度读出
+  size_t back_entry_size(size_t end) const {
+    size_t enc = 0;
+    size_t i = 1;
+    for (unsigned shift = 0;; shift += 7, ++i) {
+      uint8_t b = buf_[end - i];
+      enc |= static_cast<size_t>(b & 0x7F) << shift;
+      if (!(b & 0x80)) {
+        break;
+      }
+    }
+    return enc + i;
+  }
+
+  std::vector<uint8_t> buf_;
+  size_t count_ = 0;
+};
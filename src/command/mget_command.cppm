@@ -0,0 +1,38 @@
+module;
+
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+export module mget_command;
+
+import command_defs;
+import resp;
+import buffer;
+import logger;
+
+// MGet命令：按顺序返回每个键的值，不存在的键和值不是字符串的键返回 nil。
+// 所有键经过批量查找，哈希计算和内存访问按窗口流水进行
+export void mget_command(KVServerContext &context, CommandArgs args, Buffer &out) {
+  auto &db = context.get_db();
+  auto &stats = context.get_stats();
+
+  resp::write_array_header(out, args.size());
+  context.find_live_keys(
+      args.size(), [args](size_t i) { return args[i]; },
+      [&](size_t, Storage::iterator it) {
+        if (it == db.end()) {
+          stats.increment_keyspace_misses();
+          resp::write_null_bulk_string(out);
+          return;
+        }
+        stats.increment_keyspace_hits();
+        if (it->is_object()) {
+          resp::write_null_bulk_string(out);
+        } else {
+          write_entry_value(out, *it);
+        }
+      });
+  LOG_DEBUG("MGET命令查找 {} 个键", args.size());
+}
@@ -0,0 +1,69 @@
+module;
+
+#include <format>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+export module mset_command;
+
+import command_defs;
+import resp;
+import buffer;
+import logger;
+
+// 批量写入所有键值对，覆盖已有值并清除过期时间。查找经过批量预取
+void mset_generic(KVServerContext &context, CommandArgs args) {
+  auto &db = context.get_db();
+  context.find_live_keys(
+      args.size() / 2, [args](size_t i) { return args[i * 2]; },
+      [&](size_t i, Storage::iterator it) {
+        std::string_view value = args[i * 2 + 1];
+        if (it == db.end()) {
+          db.insert(db.create_entry(args[i * 2], value));
+          return;
+        }
+        context.persist(it);
+        context.overwrite_value(it, value);
+      });
+}
+
+// 键值参数必须成对出现
+bool check_pairs(CommandArgs args, std::string_view command, Buffer &out) {
+  if (args.size() % 2 != 0) {
+    resp::write_error(out, std::format("ERR wrong number of arguments for '{}' command", command));
+    return false;
+  }
+  return true;
+}
+
+// MSet命令：MSET key value [key value ...]
+export void mset_command(KVServerContext &context, CommandArgs args, Buffer &out) {
+  if (!check_pairs(args, "MSET", out)) {
+    return;
+  }
+  mset_generic(context, args);
+  LOG_DEBUG("MSET命令写入 {} 个键", args.size() / 2);
+  resp::write_ok(out);
+}
+
+// MSetNx命令：所有键都不存在时才全部写入，返回是否写入
+export void msetnx_command(KVServerContext &context, CommandArgs args, Buffer &out) {
+  if (!check_pairs(args, "MSETNX", out)) {
+    return;
+  }
+  auto &db = context.get_db();
+  bool any_exists = false;
+  context.find_live_keys(
+      args.size() / 2, [args](size_t i) { return args[i * 2]; },
+      [&](size_t, Storage::iterator it) { any_exists = any_exists || it != db.end(); });
+  if (any_exists) {
+    LOG_DEBUG("MSETNX命令有键已存在，不写入");
+    context.suppress_propagation();
+    resp::write_integer(out, 0);
+    return;
+  }
+  mset_generic(context, args);
+  resp::write_integer(out, 1);
+}
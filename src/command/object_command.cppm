@@ -0,0 +1,36 @@
+module;
+
+#include <format>
+#include <span>
+#include <string_view>
+
+export module object_command;
+
+import command_defs;
+import resp;
+import buffer;
+import logger;
+
+// Type命令：返回值的类型名，键不存在时返回 none
+export void type_command(KVServerContext &context, CommandArgs args, Buffer &out) {
+  auto it = context.find_live_key(args[0]);
+  resp::write_simple_string(out, it == context.get_db().end() ? "none" : it->type_name());
+}
+
+// Object命令：OBJECT ENCODING key，返回值的内部编码，键不存在时返回 nil
+export void object_command(KVServerContext &context, CommandArgs args, Buffer &out) {
+  if (!option_is(args[0], "ENCODING")) {
+    resp::write_error(out, std::format("ERR unknown subcommand '{}'", args[0]));
+    return;
+  }
+  if (args.size() != 2) {
+    resp::write_error(out, "ERR wrong number of arguments for 'object|encoding' command");
+    return;
+  }
+  auto it = context.find_live_key(args[1]);
+  if (it == context.get_db().end()) {
+    resp::write_null_bulk_string(out);
+    return;
+  }
+  resp::write_bulk_string(out, it->encoding_name());
+}
@@ -0,0 +1,114 @@
+module;
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+export module scan_command;
+
+import command_defs;
+import resp;
+import buffer;
+import logger;
+
+// SCAN cursor [MATCH pattern] [COUNT count] [TYPE type]
+//
+// 每次调用从游标处继续遍历键空间，返回下一个游标和这一段中的键，游标为 0 表示遍历结束。
+// 键空间按反向二进制游标遍历（见 Dict::scan），遍历期间表扩容也不会漏掉一直存在的键，但可能重复返回。
+// COUNT 是工作量提示：访问的起始组累计取到 COUNT 个键即停止，最多访问 COUNT * 10 个组，
+// 稀疏的表也不会在一次调用中扫描过多槽位。MATCH 和 TYPE 在取到键之后过滤，不减少工作量。
+//
+// 多分片时游标同时编码分片号：client_cursor = table_cursor * shard_count + shard，
+// 连接层按 client_cursor % shard_count 把命令路由到对应分片，一个分片遍历完后游标指向下一个分片的开头
+export void scan_command(KVServerContext &context, CommandArgs args, Buffer &out) {
+  uint64_t client_cursor;
+  if (!parse_scan_cursor(args[0], client_cursor)) {
+    resp::write_error(out, "ERR invalid cursor");
+    return;
+  }
+  std::string_view pattern;
+  std::string type; // 小写的类型名，为空表示不按类型过滤
+  bool has_pattern = false;
+  long long count = 10;
+  for (size_t i = 1; i < args.size(); i += 2) {
+    if (i + 1 >= args.size()) {
+      resp::write_error(out, "ERR syntax error");
+      return;
+    }
+    if (option_is(args[i], "MATCH")) {
+      pattern = args[i + 1];
+      has_pattern = !(pattern.size() == 1 && pattern[0] == '*');
+    } else if (option_is(args[i], "COUNT")) {
+      int64_t n;
+      if (!parse_canonical_int(args[i + 1], n)) {
+        resp::write_error(out, "ERR value is not an integer or out of range");
+        return;
+      }
+      if (n < 1) {
+        resp::write_error(out, "ERR syntax error");
+        return;
+      }
+      count = n;
+    } else if (option_is(args[i], "TYPE")) {
+      type.assign(args[i + 1]);
+      for (char &c : type) {
+        c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+      }
+    } else {
+      resp::write_error(out, "ERR syntax error");
+      return;
+    }
+  }
+
+  size_t shard_count = context.shard_count();
+  uint64_t cursor = client_cursor / shard_count;
+  auto &db = context.get_db();
+
+  // 先收集键再处理过期：遍历过程中不能修改表
+  std::vector<std::string> keys;
+  long long max_groups = std::min(count, 1LL << 40) * 10;
+  do {
+    cursor = db.scan(cursor, [&](const KvEntry &entry) { keys.emplace_back(entry.key()); });
+  } while (cursor != 0 && --max_groups > 0 && static_cast<long long>(keys.size()) < count);
+
+  // 过滤：已过期的键在这里惰性删除，不返回
+  size_t kept = 0;
+  for (size_t i = 0; i < keys.size(); ++i) {
+    if (has_pattern && !glob_match(pattern, keys[i])) {
+      continue;
+    }
+    if (context.delete_expired_key(keys[i])) {
+      continue;
+    }
+    if (!type.empty()) {
+      auto it = db.find(keys[i]);
+      if (it == db.end() || it->type_name() != type) {
+        continue;
+      }
+    }
+    if (kept != i) {
+      keys[kept] = std::move(keys[i]);
+    }
+    ++kept;
+  }
+  keys.resize(kept);
+
+  // 本分片遍历完成后转到下一个分片，最后一个分片完成时返回 0
+  uint64_t next;
+  if (cursor != 0) {
+    next = cursor * shard_count + context.shard_index();
+  } else {
+    next = context.shard_index() + 1 < shard_count ? context.shard_index() + 1 : 0;
+  }
+
+  resp::write_array_header(out, 2);
+  resp::write_bulk_string(out, std::to_string(next));
+  resp::write_array_header(out, keys.size());
+  for (const auto &key : keys) {
+    resp::write_bulk_string(out, key);
+  }
+}
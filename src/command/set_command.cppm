@@ -1,69 +1,169 @@
 module;
 
+#include <chrono>
 #include <optional>
 #include <span>
 #include <string>
 #include <string_view>
-#include <variant>
 #include <vector>
 
 export module set_command;
 
 import command_defs;
 import resp;
+import buffer;
 import logger;
 
-// Set命令
-export class SetCommand : public Command {
-public:
-  SetCommand(std::span<const resp::RespValue> args,
-             const resp::RespValue &original_command, KVServerContext &context,
-             bool from_aof)
-      : args_(args), original_command_(original_command), context_(context),
-        from_aof_(from_aof) {}
-
-  std::string execute() override {
-    if (args_.size() != 2) {
-      LOG_WARN("SET命令参数数量错误: {}", args_.size());
-      return resp::serialize_error(
-          "ERR wrong number of arguments for 'SET' command");
+// SET 的写入条件
+enum class SetCondition {
+  None,
+  IfNotExists, // NX
+  IfExists,    // XX
+};
+
+// SET 系列命令的公共实现，条件不满足时返回 false。
+// 写入 AOF 的记录统一改写为 "SET key value [PXAT ms|KEEPTTL]"：条件已在这里判定，
+// 过期时间换算为绝对时间，一次写入只产生一条记录，重放结果与执行时间无关。
+// get 为 true 时先写出旧值（不存在时为 nil），否则不写回复
+bool set_generic(KVServerContext &context, std::string_view key, std::string_view value,
+                 SetCondition condition, std::optional<std::chrono::steady_clock::time_point> expires_at,
+                 bool keep_ttl, bool get, Buffer &out) {
+  auto &db = context.get_db();
+  auto it = context.find_live_key(key);
+  bool found = it != db.end();
+
+  if (get) {
+    if (found && it->is_object()) {
+      resp::write_error(out, WRONGTYPE_ERROR);
+      return false;
     }
+    if (found) {
+      write_entry_value(out, *it);
+    } else {
+      resp::write_null_bulk_string(out);
+    }
+  }
 
-    const auto *key_variant = std::get_if<resp::RespBulkString>(&args_[0]);
-    const auto *value_variant = std::get_if<resp::RespBulkString>(&args_[1]);
+  if ((condition == SetCondition::IfNotExists && found) ||
+      (condition == SetCondition::IfExists && !found)) {
+    LOG_DEBUG("SET命令的写入条件不满足: {}", key);
+    context.suppress_propagation();
+    return false;
+  }
 
-    if (!key_variant || !key_variant->value.has_value() || !value_variant ||
-        !value_variant->value.has_value()) {
-      LOG_WARN("SET命令的键或值参数无效");
-      return resp::serialize_error(
-          "ERR key and value must be non-null bulk strings");
+  // 已有键原地覆盖值（放得下时不重新分配，旧值很大时交给后台线程释放），新键一次分配存放键、值和过期时间
+  if (found) {
+    if (expires_at) {
+      context.set_expire(it, *expires_at);
+    } else if (!keep_ttl) {
+      context.persist(it); // 清除任何过期时间
+    }
+    context.overwrite_value(it, value);
+    LOG_DEBUG("SET命令更新键: {}", key);
+  } else {
+    db.insert(db.create_entry(key, value, expires_at));
+    if (expires_at) {
+      context.get_expires().set(key, *expires_at);
     }
+    LOG_DEBUG("SET命令创建新键: {}", key);
+  }
 
-    const std::string &key = *key_variant->value;
-    const std::string &value = *value_variant->value;
-    auto &db = context_.get_db();
-    bool is_new = db.find(key) == db.end();
+  if (expires_at) {
+    std::string unix_ms = std::to_string(to_unix_ms(*expires_at));
+    context.propagate_as({"SET", key, value, "PXAT", unix_ms});
+  } else if (keep_ttl) {
+    context.propagate_as({"SET", key, value, "KEEPTTL"});
+  } else {
+    context.propagate_as({"SET", key, value});
+  }
+  return true;
+}
 
-    // 保存值并清除任何过期时间
-    db[key] = KeyValue{value, std::nullopt};
+// Set命令：SET key value [NX|XX] [GET] [EX s|PX ms|EXAT ts|PXAT ms-ts|KEEPTTL]
+export void set_command(KVServerContext &context, CommandArgs args, Buffer &out) {
+  std::string_view key = args[0];
+  std::string_view value = args[1];
 
-    if (is_new) {
-      LOG_DEBUG("SET命令创建新键: {}", key);
+  SetCondition condition = SetCondition::None;
+  bool get = false;
+  bool keep_ttl = false;
+  std::optional<ExpireUnit> unit;
+  std::string_view expire_arg;
+  for (size_t i = 2; i < args.size(); ++i) {
+    std::string_view option = args[i];
+    bool has_next = i + 1 < args.size();
+    if (option_is(option, "NX") && condition == SetCondition::None) {
+      condition = SetCondition::IfNotExists;
+    } else if (option_is(option, "XX") && condition == SetCondition::None) {
+      condition = SetCondition::IfExists;
+    } else if (option_is(option, "GET") && !get) {
+      get = true;
+    } else if (option_is(option, "KEEPTTL") && !keep_ttl && !unit) {
+      keep_ttl = true;
+    } else if (option_is(option, "EX") && !keep_ttl && !unit && has_next) {
+      unit = ExpireUnit::Seconds;
+      expire_arg = args[++i];
+    } else if (option_is(option, "PX") && !keep_ttl && !unit && has_next) {
+      unit = ExpireUnit::Milliseconds;
+      expire_arg = args[++i];
+    } else if (option_is(option, "EXAT") && !keep_ttl && !unit && has_next) {
+      unit = ExpireUnit::UnixSeconds;
+      expire_arg = args[++i];
+    } else if (option_is(option, "PXAT") && !keep_ttl && !unit && has_next) {
+      unit = ExpireUnit::UnixMilliseconds;
+      expire_arg = args[++i];
     } else {
-      LOG_DEBUG("SET命令更新键: {}", key);
+      LOG_WARN("SET命令的选项无效: {}", option);
+      resp::write_error(out, "ERR syntax error");
+      return;
     }
+  }
+
+  std::optional<std::chrono::steady_clock::time_point> expires_at;
+  if (unit) {
+    std::chrono::steady_clock::time_point when;
+    if (auto result = parse_expire_time(expire_arg, *unit, when); result != ExpireParseResult::Ok) {
+      write_expire_error(out, result, "set");
+      return;
+    }
+    expires_at = when;
+  }
 
-    return resp::serialize_ok();
+  bool done = set_generic(context, key, value, condition, expires_at, keep_ttl, get, out);
+  if (!get) {
+    if (done) {
+      resp::write_ok(out);
+    } else {
+      resp::write_null_bulk_string(out);
+    }
   }
+}
 
-  bool should_replicate() const override { return !from_aof_; }
-  const resp::RespValue &get_original_command() const override {
-    return original_command_;
+// SetNx命令：键不存在时才写入，返回是否写入
+export void setnx_command(KVServerContext &context, CommandArgs args, Buffer &out) {
+  bool done = set_generic(context, args[0], args[1], SetCondition::IfNotExists, std::nullopt,
+                          false, false, out);
+  resp::write_integer(out, done ? 1 : 0);
+}
+
+// SETEX/PSETEX 的公共实现：SETEX key seconds value
+void setex_generic(KVServerContext &context, CommandArgs args, ExpireUnit unit,
+                   std::string_view command, Buffer &out) {
+  std::chrono::steady_clock::time_point when;
+  if (auto result = parse_expire_time(args[1], unit, when); result != ExpireParseResult::Ok) {
+    write_expire_error(out, result, command);
+    return;
   }
+  set_generic(context, args[0], args[2], SetCondition::None, when, false, false, out);
+  resp::write_ok(out);
+}
+
+// SetEx命令
+export void setex_command(KVServerContext &context, CommandArgs args, Buffer &out) {
+  setex_generic(context, args, ExpireUnit::Seconds, "setex", out);
+}
 
-private:
-  std::span<const resp::RespValue> args_;
-  const resp::RespValue &original_command_;
-  KVServerContext &context_;
-  bool from_aof_;
-};
\ No newline at end of file
+// PSetEx命令
+export void psetex_command(KVServerContext &context, CommandArgs args, Buffer &out) {
+  setex_generic(context, args, ExpireUnit::Milliseconds, "psetex", out);
+}
@@ -0,0 +1,170 @@
+module;
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <charconv>
+#include <new>
+#include <string_view>
+#include <utility>
+
+export module set_object;
+
+import value_object;
+import intset;
+import dict;
+import kv_entry;
+
+// 哈希表编码中的一个成员，长度和内容放在同一次分配中：
+//
+//   +-----------+------+
+//   | 长度(4)   | 内容 |
+//   +-----------+------+
+export class SetMember {
+public:
+  SetMember() = default;
+  SetMember(SetMember &&other) noexcept : data_(std::exchange(other.data_, nullptr)) {}
+  SetMember &operator=(SetMember &&other) noexcept {
+    if (this != &other) {
+      release();
+      data_ = std::exchange(other.data_, nullptr);
+    }
+    return *this;
+  }
+  SetMember(const SetMember &) = delete;
+  SetMember &operator=(const SetMember &) = delete;
+  ~SetMember() { release(); }
+
+  static SetMember create(std::string_view member) {
+    SetMember m;
+    m.data_ = static_cast<char *>(::operator new(HEADER_SIZE + member.size()));
+    uint32_t len = static_cast<uint32_t>(member.size());
+    std::memcpy(m.data_, &len, sizeof(len));
+    std::memcpy(m.data_ + HEADER_SIZE, member.data(), member.size());
+    return m;
+  }
+
+  std::string_view key() const {
+    uint32_t len;
+    std::memcpy(&len, data_, sizeof(len));
+    return {data_ + HEADER_SIZE, len};
+  }
+  size_t allocation_size() const { return HEADER_SIZE + key().size(); }
+
+private:
+  static constexpr size_t HEADER_SIZE = sizeof(uint32_t);
+
+  void release() {
+    ::operator delete(data_);
+    data_ = nullptr;
+  }
+
+  char *data_ = nullptr;
+};
+
+// 集合类型的值。成员都是规范的 64 位整数且个数不超过 EncodingConfig::set_max_intset_entries 时
+// 使用整数集合编码（Intset），否则转换为哈希表编码（Dict），之后不再转换回来。
+// 整数集合有序，SMEMBERS 等按从小到大的顺序返回；哈希表编码的顺序不确定
+export class SetObject final : public ValueObject {
+public:
+  enum class Encoding { Intset, HashTable };
+
+  SetObject() : ValueObject(ObjectType::Set) {}
+  explicit SetObject(Intset intset) : ValueObject(ObjectType::Set), intset_(std::move(intset)) {}
+
+  Encoding encoding() const { return encoding_; }
+  std::string_view encoding_name() const override { return encoding_ == Encoding::Intset ? "intset" : "hashtable"; }
+  size_t memory_bytes() const override {
+    if (encoding_ == Encoding::Intset) {
+      return sizeof(*this) + intset_.memory_bytes();
+    }
+    return sizeof(*this) + table_.table_bytes() + member_bytes_;
+  }
+
+  size_t size() const { return encoding_ == Encoding::Intset ? intset_.size() : table_.size(); }
+  bool empty() const { return size() == 0; }
+  // 整数集合编码时的元素，供交集走整数集合的快速路径
+  const Intset *intset() const { return encoding_ == Encoding::Intset ? &intset_ : nullptr; }
+
+  bool contains(std::string_view member) const {
+    if (encoding_ == Encoding::Intset) {
+      int64_t n;
+      return parse_canonical_int(member, n) && intset_.contains(n);
+    }
+    return table_.contains(member);
+  }
+
+  // 加入成员，返回是否新增。成员不是整数或个数超过阈值时先转换编码
+  bool add(std::string_view member, const EncodingConfig &config) {
+    if (encoding_ == Encoding::Intset) {
+      int64_t n;
+      if (parse_canonical_int(member, n)) {
+        if (intset_.contains(n)) {
+          return false;
+        }
+        if (intset_.size() < config.set_max_intset_entries) {
+          intset_.insert(n);
+          return true;
+        }
+      }
+      convert_to_table();
+    }
+    if (table_.contains(member)) {
+      return false;
+    }
+    insert_member(member);
+    return true;
+  }
+
+  // 删除成员，返回成员是否存在
+  bool remove(std::string_view member) {
+    if (encoding_ == Encoding::Intset) {
+      int64_t n;
+      return parse_canonical_int(member, n) && intset_.erase(n);
+    }
+    auto it = table_.find(member);
+    if (it == table_.end()) {
+      return false;
+    }
+    member_bytes_ -= it->allocation_size();
+    table_.erase(it);
+    return true;
+  }
+
+  // 对每个成员调用 fn(member)，fn 中不能修改对象
+  template <typename Fn> void for_each(Fn &&fn) const {
+    if (encoding_ == Encoding::Intset) {
+      char buf[24];
+      intset_.for_each([&](int64_t v) {
+        char *end = std::to_chars(buf, buf + sizeof(buf), v).ptr;
+        fn(std::string_view(buf, static_cast<size_t>(end - buf)));
+      });
+      return;
+    }
+    for (const auto &m : table_) {
+      fn(m.key());
+    }
+  }
+
+private:
+  void insert_member(std::string_view member) {
+    SetMember m = SetMember::create(member);
+    member_bytes_ += m.allocation_size();
+    table_.insert(std::move(m));
+  }
+
+  void convert_to_table() {
+    intset_.for_each([this](int64_t v) {
+      char buf[24];
+      char *end = std::to_chars(buf, buf + sizeof(buf), v).ptr;
+      insert_member(std::string_view(buf, static_cast<size_t>(end - buf)));
+    });
+    intset_ = Intset();
+    encoding_ = Encoding::HashTable;
+  }
+
+  Encoding encoding_ = Encoding::Intset;
+  Intset intset_;
+  Dict<SetMember> table_;
+  size_t member_bytes_ = 0; // 哈希表编码中所有成员占用的字节数
+};
@@ -0,0 +1,241 @@
+module;
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+export module set_type_command;
+
+import command_defs;
+import set_object;
+import intset;
+import resp;
+import buffer;
+import logger;
+
+// 集合类型的命令。模块名避开字符串的 set_command
+
+// 查找集合键用于写入，键不存在时创建空集合。类型不符时写出错误并返回 false
+bool find_or_create_set(KVServerContext &context, std::string_view key, Storage::iterator &it, Buffer &out) {
+  if (!context.find_live_key_of(key, ObjectType::Set, it, out)) {
+    return false;
+  }
+  auto &db = context.get_db();
+  if (it == db.end()) {
+    it = db.insert(db.create_object_entry(key, std::make_unique<SetObject>())).first;
+  }
+  return true;
+}
+
+// 依次查找各个键的集合，键不存在时为 nullptr。任一键类型不符时写出错误并返回 false。
+// 集合对象在堆上，哈希表扩容移动条目不影响取得的指针；过期按命令开始时的时间判断，
+// 同一个键重复出现时后面的查找不会删除前面已取得的集合
+bool collect_sets(KVServerContext &context, CommandArgs keys, std::vector<const SetObject *> &sets, Buffer &out) {
+  sets.clear();
+  sets.reserve(keys.size());
+  for (std::string_view key : keys) {
+    Storage::iterator it;
+    if (!context.find_live_key_of(key, ObjectType::Set, it, out)) {
+      return false;
+    }
+    sets.push_back(it == context.get_db().end() ? nullptr : &object_cast<SetObject>(*it));
+  }
+  return true;
+}
+
+// 多个集合的交集。都是整数集合编码时走 Intset::intersect 的块比较路径，
+// 否则遍历最小的集合，逐个检查其余集合是否包含
+std::unique_ptr<SetObject> intersect_sets(std::span<const SetObject *const> sets, const EncodingConfig &config) {
+  if (std::ranges::any_of(sets, [](const SetObject *s) { return s == nullptr || s->empty(); })) {
+    return std::make_unique<SetObject>();
+  }
+  std::vector<const Intset *> intsets;
+  for (const SetObject *s : sets) {
+    if (const Intset *intset = s->intset()) {
+      intsets.push_back(intset);
+    }
+  }
+  if (intsets.size() == sets.size()) {
+    return std::make_unique<SetObject>(Intset::from_sorted(Intset::intersect(intsets)));
+  }
+  std::vector<const SetObject *> order(sets.begin(), sets.end());
+  std::ranges::sort(order, [](const SetObject *a, const SetObject *b) { return a->size() < b->size(); });
+  auto result = std::make_unique<SetObject>();
+  order[0]->for_each([&](std::string_view member) {
+    bool in_all = std::all_of(order.begin() + 1, order.end(), [&](const SetObject *s) { return s->contains(member); });
+    if (in_all) {
+      result->add(member, config);
+    }
+  });
+  return result;
+}
+
+std::unique_ptr<SetObject> union_sets(std::span<const SetObject *const> sets, const EncodingConfig &config) {
+  auto result = std::make_unique<SetObject>();
+  for (const SetObject *s : sets) {
+    if (s) {
+      s->for_each([&](std::string_view member) { result->add(member, config); });
+    }
+  }
+  return result;
+}
+
+// 第一个集合中不属于其余任何集合的成员
+std::unique_ptr<SetObject> diff_sets(std::span<const SetObject *const> sets, const EncodingConfig &config) {
+  auto result = std::make_unique<SetObject>();
+  if (!sets[0]) {
+    return result;
+  }
+  sets[0]->for_each([&](std::string_view member) {
+    bool in_other = std::any_of(sets.begin() + 1, sets.end(), [&](const SetObject *s) { return s && s->contains(member); });
+    if (!in_other) {
+      result->add(member, config);
+    }
+  });
+  return result;
+}
+
+using SetAlgebra = std::unique_ptr<SetObject> (*)(std::span<const SetObject *const>, const EncodingConfig &);
+
+void write_members(const SetObject &set, Buffer &out) {
+  resp::write_array_header(out, set.size());
+  set.for_each([&](std::string_view member) { resp::write_bulk_string(out, member); });
+}
+
+// SINTER/SUNION/SDIFF 的公共实现：回复运算结果的成员
+void algebra_generic(KVServerContext &context, CommandArgs keys, SetAlgebra op, Buffer &out) {
+  std::vector<const SetObject *> sets;
+  if (!collect_sets(context, keys, sets, out)) {
+    return;
+  }
+  write_members(*op(sets, context.encoding_config()), out);
+}
+
+// *STORE 的公共实现：运算结果写入 args[0]，覆盖原有的任意类型的值（不保留过期时间），
+// 结果为空时删除目标键。回复结果的成员数
+void algebra_store_generic(KVServerContext &context, CommandArgs args, SetAlgebra op, Buffer &out) {
+  std::vector<const SetObject *> sets;
+  if (!collect_sets(context, args.subspan(1), sets, out)) {
+    return;
+  }
+  // 先算出结果，目标键可能也是源键之一
+  std::unique_ptr<SetObject> result = op(sets, context.encoding_config());
+  size_t size = result->size();
+  auto &db = context.get_db();
+  auto it = context.find_live_key(args[0]);
+  if (it != db.end()) {
+    context.unlink_key(it);
+  }
+  if (size > 0) {
+    db.insert(db.create_object_entry(args[0], std::move(result)));
+  }
+  LOG_DEBUG("集合运算结果写入键 {}: {} 个成员", args[0], size);
+  resp::write_integer(out, static_cast<int64_t>(size));
+}
+
+// SAdd命令：SADD key member [member ...]，返回新增的成员数
+export void sadd_command(KVServerContext &context, CommandArgs args, Buffer &out) {
+  Storage::iterator it;
+  if (!find_or_create_set(context, args[0], it, out)) {
+    return;
+  }
+  int64_t added = 0;
+  const auto &config = context.encoding_config();
+  context.get_db().update(it, [&](KvEntry &entry) {
+    auto &set = object_cast<SetObject>(entry);
+    for (size_t i = 1; i < args.size(); ++i) {
+      added += set.add(args[i], config) ? 1 : 0;
+    }
+  });
+  if (added == 0) {
+    context.suppress_propagation();
+  }
+  resp::write_integer(out, added);
+}
+
+// SRem命令：返回删除的成员数，集合变空时删除键
+export void srem_command(KVServerContext &context, CommandArgs args, Buffer &out) {
+  Storage::iterator it;
+  if (!context.find_live_key_of(args[0], ObjectType::Set, it, out)) {
+    return;
+  }
+  auto &db = context.get_db();
+  int64_t removed = 0;
+  if (it != db.end()) {
+    db.update(it, [&](KvEntry &entry) {
+      auto &set = object_cast<SetObject>(entry);
+      for (size_t i = 1; i < args.size(); ++i) {
+        removed += set.remove(args[i]) ? 1 : 0;
+      }
+    });
+    if (object_cast<SetObject>(*it).empty()) {
+      LOG_DEBUG("SREM命令删除空集合: {}", args[0]);
+      context.erase_key(it);
+    }
+  }
+  if (removed == 0) {
+    context.suppress_propagation();
+  }
+  resp::write_integer(out, removed);
+}
+
+// SIsMember命令：成员存在返回 1，否则返回 0
+export void sismember_command(KVServerContext &context, CommandArgs args, Buffer &out) {
+  Storage::iterator it;
+  if (!context.find_live_key_of(args[0], ObjectType::Set, it, out)) {
+    return;
+  }
+  bool found = it != context.get_db().end() && object_cast<SetObject>(*it).contains(args[1]);
+  resp::write_integer(out, found ? 1 : 0);
+}
+
+// SMembers命令：整数集合编码按从小到大的顺序返回
+export void smembers_command(KVServerContext &context, CommandArgs args, Buffer &out) {
+  Storage::iterator it;
+  if (!context.find_live_key_of(args[0], ObjectType::Set, it, out)) {
+    return;
+  }
+  if (it == context.get_db().end()) {
+    resp::write_array_header(out, 0);
+    return;
+  }
+  write_members(object_cast<SetObject>(*it), out);
+}
+
+// SCard命令：键不存在时返回 0
+export void scard_command(KVServerContext &context, CommandArgs args, Buffer &out) {
+  Storage::iterator it;
+  if (!context.find_live_key_of(args[0], ObjectType::Set, it, out)) {
+    return;
+  }
+  size_t size = it == context.get_db().end() ? 0 : object_cast<SetObject>(*it).size();
+  resp::write_integer(out, static_cast<int64_t>(size));
+}
+
+export void sinter_command(KVServerContext &context, CommandArgs args, Buffer &out) {
+  algebra_generic(context, args, intersect_sets, out);
+}
+
+export void sunion_command(KVServerContext &context, CommandArgs args, Buffer &out) {
+  algebra_generic(context, args, union_sets, out);
+}
+
+export void sdiff_command(KVServerContext &context, CommandArgs args, Buffer &out) {
+  algebra_generic(context, args, diff_sets, out);
+}
+
+export void sinterstore_command(KVServerContext &context, CommandArgs args, Buffer &out) {
+  algebra_store_generic(context, args, intersect_sets, out);
+}
+
+export void sunionstore_command(KVServerContext &context, CommandArgs args, Buffer &out) {
+  algebra_store_generic(context, args, union_sets, out);
+}
+
+export void sdiffstore_command(KVServerContext &context, CommandArgs args, Buffer &out) {
+  algebra_store_generic(context, args, diff_sets, out);
+}
@@ -0,0 +1,294 @@
+module;
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+export module slab;
+
+// 键空间条目的 slab 分配器：按尺寸类别把小对象放在 64 KiB 的 slab 中，
+// 由键空间独占，只在键空间所在的线程上使用，不加锁。
+//
+// - 每个 slab 按 SLAB_SIZE 对齐，开头是 slab 头，释放时按地址向下取整即可找到所属 slab，
+//   内存块本身不需要额外的头部。
+// - 每个类别维护一个“有空位”的 slab 链表，分配总是从链表头取；
+//   写满的 slab 移出链表，有对象释放后重新挂回链表头，优先填补已有的空洞。
+// - 对象全部释放的 slab 归还给系统（每个类别保留最后一个，避免反复申请释放）。
+// - 碎片整理：把占用率低的 slab 标记为“正在清空”，移出链表不再分配，
+//   由调用方把其中的对象逐个搬迁到其他 slab，清空后自然归还。
+//
+// 超过最大类别的对象不由 slab 分配，allocate 返回 nullptr，调用方改用堆分配。
+export class SlabAllocator {
+public:
+  static constexpr size_t SLAB_SIZE = 64 * 1024;
+  static constexpr std::array<uint32_t, 19> CLASS_SIZES = {
+      32, 48, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320, 384, 448, 512, 640, 768, 896, 1024};
+  static constexpr size_t MAX_SIZE = CLASS_SIZES.back();
+
+  // 一个类别的占用情况
+  struct ClassStats {
+    size_t object_size = 0;
+    size_t slabs = 0;
+    size_t used = 0;     // 已分配的对象数
+    size_t capacity = 0; // 所有 slab 能容纳的对象数
+  };
+
+  SlabAllocator() {
+    for (size_t i = 0; i < CLASS_COUNT; ++i) {
+      classes_[i].object_size = CLASS_SIZES[i];
+      classes_[i].owner = this;
+    }
+  }
+
+  // 所有对象应已释放；仍未释放的对象所在的 slab 一并归还
+  ~SlabAllocator() {
+    for (void *slab : all_slabs()) {
+      std::free(slab);
+    }
+  }
+
+  SlabAllocator(const SlabAllocator &) = delete;
+  SlabAllocator &operator=(const SlabAllocator &) = delete;
+
+  // 分配 size 字节，超过最大类别时返回 nullptr
+  void *allocate(size_t size) {
+    if (size > MAX_SIZE) {
+      return nullptr;
+    }
+    SizeClass &cls = classes_[class_index(size)];
+    Slab *slab = cls.partial;
+    if (!slab) {
+      slab = new_slab(cls);
+    }
+    void *ptr;
+    if (slab->free_list) {
+      ptr = slab->free_list;
+      slab->free_list = *static_cast<void **>(ptr);
+    } else {
+      ptr = slab->objects() + static_cast<size_t>(slab->bump++) * cls.object_size;
+    }
+    ++slab->used;
+    ++cls.used;
+    requested_bytes_ += size;
+    if (slab->used == slab->capacity) {
+      unlink(cls, slab);
+    }
+    return ptr;
+  }
+
+  // 释放 allocate 返回的内存块，size 为申请时的字节数。按地址找到所属的 slab 和分配器
+  static void deallocate(void *ptr, size_t size) {
+    Slab *slab = slab_of(ptr);
+    SizeClass &cls = *slab->cls;
+    *static_cast<void **>(ptr) = slab->free_list;
+    slab->free_list = ptr;
+    bool was_full = slab->used == slab->capacity;
+    --slab->used;
+    --cls.used;
+    cls.owner->requested_bytes_ -= size;
+
+    if (slab->evacuating) {
+      if (slab->used == 0) {
+        --cls.owner->evacuating_slabs_;
+        cls.owner->release_slab(cls, slab);
+      }
+      return;
+    }
+    if (was_full) {
+      link_front(cls, slab);
+    }
+    // 类别中还有其他 slab 时归还空的 slab
+    if (slab->used == 0 && cls.slabs > 1) {
+      unlink(cls, slab);
+      cls.owner->release_slab(cls, slab);
+    }
+  }
+
+  // 申请 size 字节实际占用的字节数（所属类别的大小）
+  static size_t usable_size(size_t size) { return CLASS_SIZES[class_index(size)]; }
+
+  // ptr 所在的 slab 正在清空，其中的对象应当搬迁
+  static bool should_relocate(const void *ptr) { return slab_of(ptr)->evacuating; }
+
+  // 标记占用率低于 max_occupancy 的 slab 为正在清空，返回新标记的数量。
+  // 只有其中的对象能全部放进同类别其他 slab 的空位时才标记，保证搬迁后确实能归还 slab
+  size_t mark_sparse_slabs(double max_occupancy) {
+    size_t marked = 0;
+    std::vector<Slab *> candidates;
+    for (SizeClass &cls : classes_) {
+      candidates.clear();
+      size_t free_slots = 0;
+      for (Slab *slab = cls.partial; slab; slab = slab->next) {
+        candidates.push_back(slab);
+        free_slots += slab->capacity - slab->used;
+      }
+      // 最稀疏的 slab 最先清空
+      std::sort(candidates.begin(), candidates.end(),
+                [](const Slab *a, const Slab *b) { return a->used < b->used; });
+      size_t to_move = 0;
+      for (Slab *slab : candidates) {
+        if (slab->used > slab->capacity * max_occupancy) {
+          break;
+        }
+        size_t remaining = free_slots - (slab->capacity - slab->used);
+        if (to_move + slab->used > remaining) {
+          break;
+        }
+        free_slots = remaining;
+        to_move += slab->used;
+        unlink(cls, slab);
+        slab->evacuating = true;
+        ++evacuating_slabs_;
+        ++marked;
+        if (slab->used == 0) {
+          --evacuating_slabs_;
+          release_slab(cls, slab);
+        }
+      }
+    }
+    return marked;
+  }
+
+  // 正在清空的 slab 数量
+  size_t evacuating_slabs() const { return evacuating_slabs_; }
+
+  // --- 统计 ---
+  // 从系统申请的 slab 总字节数
+  size_t slab_bytes() const { return slab_count_ * SLAB_SIZE; }
+  // 已分配对象按类别大小计算的字节数
+  size_t used_bytes() const {
+    size_t bytes = 0;
+    for (const SizeClass &cls : classes_) {
+      bytes += cls.used * cls.object_size;
+    }
+    return bytes;
+  }
+  // 已分配对象申请的字节数
+  size_t requested_bytes() const { return requested_bytes_; }
+
+  std::vector<ClassStats> class_stats() const {
+    std::vector<ClassStats> stats;
+    for (const SizeClass &cls : classes_) {
+      stats.push_back({cls.object_size, cls.slabs, cls.used, cls.capacity});
+    }
+    return stats;
+  }
+
+private:
+  static constexpr size_t CLASS_COUNT = CLASS_SIZES.size();
+
+  struct SizeClass;
+
+  struct alignas(16) Slab {
+    SizeClass *cls;
+    Slab *prev;
+    Slab *next;
+    Slab *all_next; // 所有 slab 组成的链表，用于析构
+    Slab *all_prev;
+    void *free_list;
+    uint32_t used;
+    uint32_t bump; // 从未分配过的第一个对象
+    uint32_t capacity;
+    bool evacuating;
+    bool linked; // 是否在类别的有空位链表中
+
+    char *objects() { return reinterpret_cast<char *>(this) + sizeof(Slab); }
+  };
+
+  struct SizeClass {
+    uint32_t object_size = 0;
+    SlabAllocator *owner = nullptr;
+    Slab *partial = nullptr; // 有空位且不在清空中的 slab
+    size_t slabs = 0;
+    size_t used = 0;
+    size_t capacity = 0;
+  };
+
+  static size_t class_index(size_t size) {
+    return static_cast<size_t>(std::lower_bound(CLASS_SIZES.begin(), CLASS_SIZES.end(), size) -
+                               CLASS_SIZES.begin());
+  }
+
+  static Slab *slab_of(const void *ptr) {
+    return reinterpret_cast<Slab *>(reinterpret_cast<uintptr_t>(ptr) & ~(uintptr_t{SLAB_SIZE} - 1));
+  }
+
+  static void link_front(SizeClass &cls, Slab *slab) {
+    slab->prev = nullptr;
+    slab->next = cls.partial;
+    if (cls.partial) {
+      cls.partial->prev = slab;
+    }
+    cls.partial = slab;
+    slab->linked = true;
+  }
+
+  static void unlink(SizeClass &cls, Slab *slab) {
+    if (!slab->linked) {
+      return;
+    }
+    if (slab->prev) {
+      slab->prev->next = slab->next;
+    } else {
+      cls.partial = slab->next;
+    }
+    if (slab->next) {
+      slab->next->prev = slab->prev;
+    }
+    slab->prev = slab->next = nullptr;
+    slab->linked = false;
+  }
+
+  Slab *new_slab(SizeClass &cls) {
+    void *memory = std::aligned_alloc(SLAB_SIZE, SLAB_SIZE);
+    if (!memory) {
+      throw std::bad_alloc();
+    }
+    Slab *slab = new (memory) Slab{};
+    slab->cls = &cls;
+    slab->capacity = static_cast<uint32_t>((SLAB_SIZE - sizeof(Slab)) / cls.object_size);
+    slab->all_next = all_head_;
+    if (all_head_) {
+      all_head_->all_prev = slab;
+    }
+    all_head_ = slab;
+    ++cls.slabs;
+    cls.capacity += slab->capacity;
+    ++slab_count_;
+    link_front(cls, slab);
+    return slab;
+  }
+
+  void release_slab(SizeClass &cls, Slab *slab) {
+    if (slab->all_prev) {
+      slab->all_prev->all_next = slab->all_next;
+    } else {
+      all_head_ = slab->all_next;
+    }
+    if (slab->all_next) {
+      slab->all_next->all_prev = slab->all_prev;
+    }
+    --cls.slabs;
+    cls.capacity -= slab->capacity;
+    --slab_count_;
+    std::free(slab);
+  }
+
+  std::vector<void *> all_slabs() const {
+    std::vector<void *> slabs;
+    for (Slab *slab = all_head_; slab; slab = slab->all_next) {
+      slabs.push_back(slab);
+    }
+    return slabs;
+  }
+
+  std::array<SizeClass, CLASS_COUNT> classes_;
+  Slab *all_head_ = nullptr;
+  size_t slab_count_ = 0;
+  size_t evacuating_slabs_ = 0;
+  size_t requested_bytes_ = 0;
+};
@@ -4,75 +4,50 @@ module;
 #include <span>
 #include <string>
 #include <string_view>
-#include <variant>
 #include <vector>
 
 export module ttl_command;
 
 import command_defs;
 import resp;
+import buffer;
 import logger;
 
 // TTL命令
-export class TTLCommand : public Command {
-public:
-  TTLCommand(std::span<const resp::RespValue> args,
-             const resp::RespValue &original_command, KVServerContext &context)
-      : args_(args), original_command_(original_command), context_(context) {}
-
-  std::string execute() override {
-    if (args_.size() != 1) {
-      LOG_WARN("TTL命令参数数量错误: {}", args_.size());
-      return resp::serialize_error(
-          "ERR wrong number of arguments for 'TTL' command");
-    }
-
-    // 解析键名
-    const auto *key_variant = std::get_if<resp::RespBulkString>(&args_[0]);
-    if (!key_variant || !key_variant->value.has_value()) {
-      LOG_WARN("TTL命令的键参数无效");
-      return resp::serialize_error("ERR key must be a non-null bulk string");
-    }
-    const std::string &key = *key_variant->value;
-
-    // 查找键
-    auto &db = context_.get_db();
-    auto it = db.find(key);
-    if (it == db.end()) {
-      LOG_DEBUG("TTL命令的键不存在: {}", key);
-      return resp::serialize_integer(-2); // 键不存在返回-2
-    }
-
-    // 检查键是否有过期时间
-    if (!it->second.expires_at.has_value()) {
-      LOG_DEBUG("TTL命令的键没有设置过期时间: {}", key);
-      return resp::serialize_integer(-1); // 键存在但没有过期时间返回-1
-    }
-
-    // 计算剩余时间（秒）
-    auto now = std::chrono::steady_clock::now();
-    auto ttl = std::chrono::duration_cast<std::chrono::seconds>(
-                   it->second.expires_at.value() - now)
-                   .count();
-
-    // 如果键已过期，先删除它
-    if (ttl <= 0) {
-      LOG_DEBUG("TTL命令发现过期键: {}", key);
-      db.erase(it);
-      return resp::serialize_integer(-2); // 已经过期的键视为不存在
-    }
+export void ttl_command(KVServerContext &context, CommandArgs args, Buffer &out) {
+  std::string_view key = args[0];
+
+  // 查找键
+  auto &db = context.get_db();
+  auto it = db.find(key);
+  if (it == db.end()) {
+    LOG_DEBUG("TTL命令的键不存在: {}", key);
+    resp::write_integer(out, -2); // 键不存在返回-2
+    return;
+  }
 
-    LOG_DEBUG("键 {} 的剩余生存时间: {} 秒", key, ttl);
-    return resp::serialize_integer(ttl);
+  // 检查键是否有过期时间
+  auto expires_at = it->expires_at();
+  if (!expires_at.has_value()) {
+    LOG_DEBUG("TTL命令的键没有设置过期时间: {}", key);
+    resp::write_integer(out, -1); // 键存在但没有过期时间返回-1
+    return;
   }
 
-  bool should_replicate() const override { return false; }
-  const resp::RespValue &get_original_command() const override {
-    return original_command_;
+  // 计算剩余时间（秒）
+  auto now = std::chrono::steady_clock::now();
+  auto ttl = std::chrono::duration_cast<std::chrono::seconds>(
+                 expires_at.value() - now)
+                 .count();
+
+  // 如果键已过期，先删除它
+  if (ttl <= 0) {
+    LOG_DEBUG("TTL命令发现过期键: {}", key);
+    context.expire_key(it);
+    resp::write_integer(out, -2); // 已经过期的键视为不存在
+    return;
   }
 
-private:
-  std::span<const resp::RespValue> args_;
-  const resp::RespValue &original_command_;
-  KVServerContext &context_;
-};
\ No newline at end of file
+  LOG_DEBUG("键 {} 的剩余生存时间: {} 秒", key, ttl);
+  resp::write_integer(out, ttl);
+}
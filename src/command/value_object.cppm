@@ -0,0 +1,54 @@
+module;
+
+#include <cstddef>
+#include <string_view>
+
+export module value_object;
+
+// 字符串以外的值类型。字符串直接存放在 KvEntry 中，其他类型的值是堆上的对象，
+// KvEntry 只保存指向它的指针
+export enum class ObjectType { Hash, List, Set, ZSet };
+
+// 各类型在紧凑编码与通用结构之间转换的阈值，超过任一阈值时转换为通用结构，不会转换回来
+export struct EncodingConfig {
+  size_t hash_max_listpack_entries = 128; // 紧凑编码的哈希最多容纳的字段数
+  size_t hash_max_listpack_value = 64;    // 紧凑编码的哈希中字段名和值的最大长度
+  // 列表每个节点的大小上限：正数为元素个数，-1 到 -5 为字节数 4/8/16/32/64 KiB
+  int list_max_listpack_size = -2;
+  size_t set_max_intset_entries = 512; // 整数集合编码最多容纳的成员数
+  size_t zset_max_listpack_entries = 128; // 紧凑编码的有序集合最多容纳的成员数
+  size_t zset_max_listpack_value = 64;    // 紧凑编码的有序集合中成员的最大长度
+};
+
+// 非字符串值的基类。KvEntry 持有对象的所有权，通过虚析构函数释放，
+// 命令按 type() 检查类型后再转换为具体类型
+export class ValueObject {
+public:
+  explicit ValueObject(ObjectType type) : type_(type) {}
+  virtual ~ValueObject() = default;
+  ValueObject(const ValueObject &) = delete;
+  ValueObject &operator=(const ValueObject &) = delete;
+
+  ObjectType type() const { return type_; }
+  // 类型名，TYPE 和 SCAN TYPE 使用
+  std::string_view type_name() const {
+    switch (type_) {
+    case ObjectType::Hash:
+      return "hash";
+    case ObjectType::List:
+      return "list";
+    case ObjectType::Set:
+      return "set";
+    case ObjectType::ZSet:
+      return "zset";
+    }
+    return "none";
+  }
+  // 当前编码的名称，OBJECT ENCODING 使用
+  virtual std::string_view encoding_name() const = 0;
+  // 对象占用的堆内存，计入键空间的内存统计。实现需要增量维护，不能遍历对象
+  virtual size_t memory_bytes() const = 0;
+
+private:
+  ObjectType type_;
+};
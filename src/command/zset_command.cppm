@@ -0,0 +1,500 @@
+module;
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+export module zset_command;
+
+import command_defs;
+import zset_object;
+import resp;
+import buffer;
+import logger;
+
+constexpr std::string_view NOT_FLOAT_ERROR = "ERR value is not a valid float";
+constexpr std::string_view NOT_INTEGER_ERROR = "ERR value is not an integer or out of range";
+
+void write_score(Buffer &out, double score) {
+  ScoreBuffer buf;
+  resp::write_bulk_string(out, format_score(score, buf));
+}
+
+// 解析分数区间的一端："(" 前缀表示开区间。失败时写出错误回复
+bool parse_score_bound(std::string_view arg, double &value, bool &exclusive) {
+  exclusive = !arg.empty() && arg[0] == '(';
+  if (exclusive) {
+    arg.remove_prefix(1);
+  }
+  return parse_score(arg, value);
+}
+
+bool parse_score_range(std::string_view min, std::string_view max, ScoreRange &range, Buffer &out) {
+  if (!parse_score_bound(min, range.min, range.min_exclusive) ||
+      !parse_score_bound(max, range.max, range.max_exclusive)) {
+    resp::write_error(out, "ERR min or max is not a float");
+    return false;
+  }
+  return true;
+}
+
+// 解析字典序区间的一端：必须是 "-"、"+" 或以 "[" / "(" 开头
+bool parse_lex_bound(std::string_view arg, LexBound &bound) {
+  if (arg == "-") {
+    bound.kind = LexBound::Kind::NegInf;
+  } else if (arg == "+") {
+    bound.kind = LexBound::Kind::PosInf;
+  } else if (!arg.empty() && (arg[0] == '[' || arg[0] == '(')) {
+    bound.kind = arg[0] == '[' ? LexBound::Kind::Inclusive : LexBound::Kind::Exclusive;
+    bound.value.assign(arg.substr(1));
+  } else {
+    return false;
+  }
+  return true;
+}
+
+bool parse_lex_range(std::string_view min, std::string_view max, LexRange &range, Buffer &out) {
+  if (!parse_lex_bound(min, range.min) || !parse_lex_bound(max, range.max)) {
+    resp::write_error(out, "ERR min or max not valid string range item");
+    return false;
+  }
+  return true;
+}
+
+struct ZAddFlags {
+  bool nx = false;
+  bool xx = false;
+  bool gt = false;
+  bool lt = false;
+  bool ch = false;
+  bool incr = false;
+};
+
+// ZADD/ZINCRBY 的公共实现。pairs 是 score member 交替的参数，scores 是已解析的分数。
+// 回复新增的成员数（CH 时加上分数被修改的成员数）；INCR 时回复新分数，被条件拦下时回复 nil
+void zadd_generic(KVServerContext &context, std::string_view key, CommandArgs pairs, const std::vector<double> &scores,
+                  const ZAddFlags &flags, Buffer &out) {
+  Storage::iterator it;
+  if (!context.find_live_key_of(key, ObjectType::ZSet, it, out)) {
+    return;
+  }
+  auto &db = context.get_db();
+  if (it == db.end()) {
+    if (flags.xx) {
+      context.suppress_propagation();
+      if (flags.incr) {
+        resp::write_null_bulk_string(out);
+      } else {
+        resp::write_integer(out, 0);
+      }
+      return;
+    }
+    it = db.insert(db.create_object_entry(key, std::make_unique<ZSetObject>())).first;
+  }
+
+  int64_t added = 0;
+  int64_t changed = 0;
+  bool nan = false;
+  std::optional<double> incr_result;
+  const auto &config = context.encoding_config();
+  db.update(it, [&](KvEntry &entry) {
+    auto &zset = object_cast<ZSetObject>(entry);
+    for (size_t i = 0; i < scores.size(); ++i) {
+      std::string_view member = pairs[i * 2 + 1];
+      double score = scores[i];
+      if (auto current = zset.score(member)) {
+        if (flags.nx) {
+          continue;
+        }
+        if (flags.incr) {
+          score += *current;
+          if (std::isnan(score)) {
+            nan = true;
+            return;
+          }
+        }
+        if ((flags.gt && score <= *current) || (flags.lt && score >= *current)) {
+          continue;
+        }
+        if (score != *current) {
+          zset.set(member, score, config);
+          ++changed;
+        }
+      } else {
+        if (flags.xx) {
+          continue;
+        }
+        zset.set(member, score, config);
+        ++added;
+      }
+      if (flags.incr) {
+        incr_result = score;
+      }
+    }
+  });
+  if (nan) {
+    resp::write_error(out, "ERR resulting score is not a number (NaN)");
+    return;
+  }
+  if (added + changed == 0) {
+    context.suppress_propagation();
+  }
+  if (flags.incr) {
+    if (incr_result) {
+      write_score(out, *incr_result);
+    } else {
+      resp::write_null_bulk_string(out);
+    }
+    return;
+  }
+  resp::write_integer(out, added + (flags.ch ? changed : 0));
+}
+
+// 有序遍历中的当前元素是否仍在区间内：正序检查上界，逆序检查下界
+bool within(const ScoreRange &range, ZSetObject::Cursor &c, bool rev) {
+  return rev ? range.above_min(c.score()) : range.below_max(c.score());
+}
+bool within(const LexRange &range, ZSetObject::Cursor &c, bool rev) {
+  return rev ? range.above_min(c.member()) : range.below_max(c.member());
+}
+
+void step(ZSetObject::Cursor &c, bool rev) {
+  if (rev) {
+    c.prev();
+  } else {
+    c.next();
+  }
+}
+
+// 写出从 c 开始的 count 个元素
+void write_elements(ZSetObject::Cursor c, size_t count, bool rev, bool withscores, Buffer &out) {
+  resp::write_array_header(out, count * (withscores ? 2 : 1));
+  for (size_t i = 0; i < count; ++i, step(c, rev)) {
+    resp::write_bulk_string(out, c.member());
+    if (withscores) {
+      write_score(out, c.score());
+    }
+  }
+}
+
+// 按分数或字典序区间回复元素：先跳过 offset 个，最多回复 limit 个（负数不限）。
+// 先数出元素个数再写出，不需要暂存元素
+template <typename Range>
+void write_range(const ZSetObject &zset, const Range &range, bool rev, int64_t offset, int64_t limit, bool withscores,
+                 Buffer &out) {
+  ZSetObject::Cursor start = rev ? zset.last_in_range(range) : zset.first_in_range(range);
+  for (; start.valid() && offset > 0 && within(range, start, rev); --offset) {
+    step(start, rev);
+  }
+  size_t count = 0;
+  for (ZSetObject::Cursor c = start; c.valid() && within(range, c, rev); step(c, rev)) {
+    if (limit >= 0 && count == static_cast<size_t>(limit)) {
+      break;
+    }
+    ++count;
+  }
+  write_elements(start, count, rev, withscores, out);
+}
+
+bool parse_int64(std::string_view arg, int64_t &value) {
+  auto [ptr, ec] = std::from_chars(arg.data(), arg.data() + arg.size(), value);
+  return !arg.empty() && ec == std::errc() && ptr == arg.data() + arg.size();
+}
+
+// ZAdd命令：ZADD key [NX|XX] [GT|LT] [CH] [INCR] score member [score member ...]
+export void zadd_command(KVServerContext &context, CommandArgs args, Buffer &out) {
+  ZAddFlags flags;
+  size_t i = 1;
+  for (; i < args.size(); ++i) {
+    if (option_is(args[i], "NX")) {
+      flags.nx = true;
+    } else if (option_is(args[i], "XX")) {
+      flags.xx = true;
+    } else if (option_is(args[i], "GT")) {
+      flags.gt = true;
+    } else if (option_is(args[i], "LT")) {
+      flags.lt = true;
+    } else if (option_is(args[i], "CH")) {
+      flags.ch = true;
+    } else if (option_is(args[i], "INCR")) {
+      flags.incr = true;
+    } else {
+      break;
+    }
+  }
+  CommandArgs pairs = args.subspan(i);
+  if (pairs.empty() || pairs.size() % 2 != 0) {
+    resp::write_error(out, "ERR syntax error");
+    return;
+  }
+  if (flags.nx && flags.xx) {
+    resp::write_error(out, "ERR XX and NX options at the same time are not compatible");
+    return;
+  }
+  if ((flags.gt && flags.nx) || (flags.lt && flags.nx) || (flags.gt && flags.lt)) {
+    resp::write_error(out, "ERR GT, LT, and/or NX options at the same time are not compatible");
+    return;
+  }
+  if (flags.incr && pairs.size() > 2) {
+    resp::write_error(out, "ERR INCR option supports a single increment-element pair");
+    return;
+  }
+  // 先解析全部分数，任一分数无效时不做任何修改
+  std::vector<double> scores(pairs.size() / 2);
+  for (size_t k = 0; k < scores.size(); ++k) {
+    if (!parse_score(pairs[k * 2], scores[k])) {
+      resp::write_error(out, NOT_FLOAT_ERROR);
+      return;
+    }
+  }
+  zadd_generic(context, args[0], pairs, scores, flags, out);
+}
+
+// ZIncrBy命令：ZINCRBY key increment member，成员不存在时从 0 开始
+export void zincrby_command(KVServerContext &context, CommandArgs args, Buffer &out) {
+  std::vector<double> scores(1);
+  if (!parse_score(args[1], scores[0])) {
+    resp::write_error(out, NOT_FLOAT_ERROR);
+    return;
+  }
+  ZAddFlags flags;
+  flags.incr = true;
+  zadd_generic(context, args[0], args.subspan(1), scores, flags, out);
+}
+
+// ZScore命令：成员或键不存在时返回 nil
+export void zscore_command(KVServerContext &context, CommandArgs args, Buffer &out) {
+  Storage::iterator it;
+  if (!context.find_live_key_of(args[0], ObjectType::ZSet, it, out)) {
+    return;
+  }
+  auto score = it == context.get_db().end() ? std::nullopt : object_cast<ZSetObject>(*it).score(args[1]);
+  if (score) {
+    write_score(out, *score);
+  } else {
+    resp::write_null_bulk_string(out);
+  }
+}
+
+// ZRank命令：ZRANK key member [WITHSCORE]，返回按分数升序的排名（从 0 开始）
+export void zrank_command(KVServerContext &context, CommandArgs args, Buffer &out) {
+  bool withscore = false;
+  if (args.size() > 2) {
+    if (args.size() > 3 || !option_is(args[2], "WITHSCORE")) {
+      resp::write_error(out, "ERR syntax error");
+      return;
+    }
+    withscore = true;
+  }
+  Storage::iterator it;
+  if (!context.find_live_key_of(args[0], ObjectType::ZSet, it, out)) {
+    return;
+  }
+  const ZSetObject *zset = it == context.get_db().end() ? nullptr : &object_cast<ZSetObject>(*it);
+  auto rank = zset ? zset->rank(args[1]) : std::nullopt;
+  if (!rank) {
+    resp::write_null_bulk_string(out);
+    return;
+  }
+  if (withscore) {
+    resp::write_array_header(out, 2);
+    resp::write_integer(out, static_cast<int64_t>(*rank));
+    write_score(out, *zset->score(args[1]));
+    return;
+  }
+  resp::write_integer(out, static_cast<int64_t>(*rank));
+}
+
+// ZCard命令：键不存在时返回 0
+export void zcard_command(KVServerContext &context, CommandArgs args, Buffer &out) {
+  Storage::iterator it;
+  if (!context.find_live_key_of(args[0], ObjectType::ZSet, it, out)) {
+    return;
+  }
+  size_t size = it == context.get_db().end() ? 0 : object_cast<ZSetObject>(*it).size();
+  resp::write_integer(out, static_cast<int64_t>(size));
+}
+
+// ZRANGE key start stop [BYSCORE|BYLEX] [REV] [LIMIT offset count] [WITHSCORES]
+//
+// 默认按排名区间；BYSCORE/BYLEX 时 start/stop 是分数或字典序区间，REV 时先写上界再写下界。
+// 跳表编码按排名定位是 O(log n)，按区间定位同样沿跳表查找，之后沿底层链表顺序或逆序遍历
+export void zrange_command(KVServerContext &context, CommandArgs args, Buffer &out) {
+  enum class By { Rank, Score, Lex };
+  By by = By::Rank;
+  bool rev = false;
+  bool withscores = false;
+  bool has_limit = false;
+  int64_t offset = 0;
+  int64_t limit = -1;
+  for (size_t i = 3; i < args.size(); ++i) {
+    if (option_is(args[i], "BYSCORE")) {
+      by = By::Score;
+    } else if (option_is(args[i], "BYLEX")) {
+      by = By::Lex;
+    } else if (option_is(args[i], "REV")) {
+      rev = true;
+    } else if (option_is(args[i], "WITHSCORES")) {
+      withscores = true;
+    } else if (option_is(args[i], "LIMIT") && i + 2 < args.size()) {
+      if (!parse_int64(args[i + 1], offset) || !parse_int64(args[i + 2], limit)) {
+        resp::write_error(out, NOT_INTEGER_ERROR);
+        return;
+      }
+      has_limit = true;
+      i += 2;
+    } else {
+      resp::write_error(out, "ERR syntax error");
+      return;
+    }
+  }
+  if (has_limit && by == By::Rank) {
+    resp::write_error(out, "ERR syntax error, LIMIT is only supported in combination with either BYSCORE or BYLEX");
+    return;
+  }
+  if (withscores && by == By::Lex) {
+    resp::write_error(out, "ERR syntax error, WITHSCORES not supported in combination with BYLEX");
+    return;
+  }
+
+  // REV 时参数先上界后下界
+  std::string_view min = rev ? args[2] : args[1];
+  std::string_view max = rev ? args[1] : args[2];
+  ScoreRange score_range;
+  LexRange lex_range;
+  int64_t start = 0;
+  int64_t stop = 0;
+  if (by == By::Score && !parse_score_range(min, max, score_range, out)) {
+    return;
+  }
+  if (by == By::Lex && !parse_lex_range(min, max, lex_range, out)) {
+    return;
+  }
+  if (by == By::Rank && (!parse_int64(args[1], start) || !parse_int64(args[2], stop))) {
+    resp::write_error(out, NOT_INTEGER_ERROR);
+    return;
+  }
+
+  Storage::iterator it;
+  if (!context.find_live_key_of(args[0], ObjectType::ZSet, it, out)) {
+    return;
+  }
+  if (it == context.get_db().end() || offset < 0) {
+    resp::write_array_header(out, 0);
+    return;
+  }
+  const auto &zset = object_cast<ZSetObject>(*it);
+  if (by == By::Score) {
+    write_range(zset, score_range, rev, offset, limit, withscores, out);
+  } else if (by == By::Lex) {
+    write_range(zset, lex_range, rev, offset, limit, withscores, out);
+  } else {
+    size_t first;
+    size_t last;
+    if (!normalize_range(start, stop, zset.size(), first, last)) {
+      resp::write_array_header(out, 0);
+      return;
+    }
+    // REV 时排名从最高分数算起
+    size_t from = rev ? zset.size() - 1 - first : first;
+    write_elements(zset.at_rank(from), last - first + 1, rev, withscores, out);
+  }
+}
+
+// ZRem命令：返回删除的成员数，有序集合变空时删除键
+export void zrem_command(KVServerContext &context, CommandArgs args, Buffer &out) {
+  Storage::iterator it;
+  if (!context.find_live_key_of(args[0], ObjectType::ZSet, it, out)) {
+    return;
+  }
+  auto &db = context.get_db();
+  int64_t removed = 0;
+  if (it != db.end()) {
+    db.update(it, [&](KvEntry &entry) {
+      auto &zset = object_cast<ZSetObject>(entry);
+      for (size_t i = 1; i < args.size(); ++i) {
+        removed += zset.erase(args[i]) ? 1 : 0;
+      }
+    });
+    if (object_cast<ZSetObject>(*it).empty()) {
+      LOG_DEBUG("ZREM命令删除空有序集合: {}", args[0]);
+      context.erase_key(it);
+    }
+  }
+  if (removed == 0) {
+    context.suppress_propagation();
+  }
+  resp::write_integer(out, removed);
+}
+
+// ZRemRangeByScore命令：删除分数在区间内的成员，返回删除的个数
+export void zremrangebyscore_command(KVServerContext &context, CommandArgs args, Buffer &out) {
+  ScoreRange range;
+  if (!parse_score_range(args[1], args[2], range, out)) {
+    return;
+  }
+  Storage::iterator it;
+  if (!context.find_live_key_of(args[0], ObjectType::ZSet, it, out)) {
+    return;
+  }
+  auto &db = context.get_db();
+  size_t removed = 0;
+  if (it != db.end() && !range.empty()) {
+    db.update(it, [&](KvEntry &entry) { removed = object_cast<ZSetObject>(entry).erase_range(range); });
+    if (object_cast<ZSetObject>(*it).empty()) {
+      context.erase_key(it);
+    }
+  }
+  if (removed == 0) {
+    context.suppress_propagation();
+  }
+  resp::write_integer(out, static_cast<int64_t>(removed));
+}
+
+// ZPopMin命令：ZPOPMIN key [count]，按分数从低到高弹出，成员和分数交替返回
+export void zpopmin_command(KVServerContext &context, CommandArgs args, Buffer &out) {
+  int64_t count = 1;
+  if (args.size() > 2) {
+    resp::write_error(out, "ERR syntax error");
+    return;
+  }
+  if (args.size() == 2) {
+    if (!parse_int64(args[1], count)) {
+      resp::write_error(out, NOT_INTEGER_ERROR);
+      return;
+    }
+    if (count < 0) {
+      resp::write_error(out, "ERR value is out of range, must be positive");
+      return;
+    }
+  }
+  Storage::iterator it;
+  if (!context.find_live_key_of(args[0], ObjectType::ZSet, it, out)) {
+    return;
+  }
+  auto &db = context.get_db();
+  if (it == db.end() || count == 0) {
+    context.suppress_propagation();
+    resp::write_array_header(out, 0);
+    return;
+  }
+  size_t n = std::min(static_cast<size_t>(count), object_cast<ZSetObject>(*it).size());
+  resp::write_array_header(out, n * 2);
+  db.update(it, [&](KvEntry &entry) {
+    object_cast<ZSetObject>(entry).pop_min(n, [&](std::string_view member, double score) {
+      resp::write_bulk_string(out, member);
+      write_score(out, score);
+    });
+  });
+  if (object_cast<ZSetObject>(*it).empty()) {
+    LOG_DEBUG("ZPOPMIN命令删除空有序集合: {}", args[0]);
+    context.erase_key(it);
+  }
+}
@@ -0,0 +1,668 @@
+module;
+
+#include <array>
+#include <charconv>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <optional>
+#include <random>
+#include <string>
+#include <string_view>
+#include <utility>
+
+export module zset_object;
+
+import value_object;
+import listpack;
+import dict;
+
+// 按 Redis 的规则解析分数：有限的数或 inf/+inf/-inf，允许前导 +，不接受 NaN
+export bool parse_score(std::string_view s, double &value) {
+  if (s.size() > 1 && s[0] == '+' && s[1] != '-') {
+    s.remove_prefix(1);
+  }
+  if (s.empty()) {
+    return false;
+  }
+  auto [ptr, ec] = std::from_chars(s.data(), s.data() + s.size(), value);
+  return ec == std::errc() && ptr == s.data() + s.size() && !std::isnan(value);
+}
+
+// 分数的回复格式：能精确还原的最短十进制表示，无穷为 inf/-inf
+export using ScoreBuffer = std::array<char, 32>;
+export std::string_view format_score(double score, ScoreBuffer &buf) {
+  char *end = std::to_chars(buf.data(), buf.data() + buf.size(), score).ptr;
+  return {buf.data(), static_cast<size_t>(end - buf.data())};
+}
+
+// 分数区间，min_exclusive/max_exclusive 对应 "(" 前缀
+export struct ScoreRange {
+  double min = 0;
+  double max = 0;
+  bool min_exclusive = false;
+  bool max_exclusive = false;
+
+  bool above_min(double score) const { return min_exclusive ? score > min : score >= min; }
+  bool below_max(double score) const { return max_exclusive ? score < max : score <= max; }
+  bool contains(double score) const { return above_min(score) && below_max(score); }
+  bool empty() const { return min > max || (min == max && (min_exclusive || max_exclusive)); }
+};
+
+// 字典序区间的一端："-"、"+" 为无穷，"[" 为闭区间，"(" 为开区间
+export struct LexBound {
+  enum class Kind { NegInf, PosInf, Inclusive, Exclusive };
+  Kind kind = Kind::NegInf;
+  std::string value;
+};
+
+export struct LexRange {
+  LexBound min;
+  LexBound max;
+
+  bool above_min(std::string_view member) const {
+    switch (min.kind) {
+    case LexBound::Kind::NegInf:
+      return true;
+    case LexBound::Kind::PosInf:
+      return false;
+    case LexBound::Kind::Inclusive:
+      return member >= min.value;
+    case LexBound::Kind::Exclusive:
+      return member > min.value;
+    }
+    return false;
+  }
+  bool below_max(std::string_view member) const {
+    switch (max.kind) {
+    case LexBound::Kind::NegInf:
+      return false;
+    case LexBound::Kind::PosInf:
+      return true;
+    case LexBound::Kind::Inclusive:
+      return member <= max.value;
+    case LexBound::Kind::Exclusive:
+      return member < max.value;
+    }
+    return false;
+  }
+  bool contains(std::string_view member) const { return above_min(member) && below_max(member); }
+};
+
+// 跳表：按 (分数, 成员) 升序排列的多层链表。每一层的前进指针带有跨度（跨过的底层节点数），
+// 沿查找路径累加跨度即可得到节点的排名，按排名定位也只需 O(log n)。
+// 节点是单次分配：节点头、各层的 {前进指针, 跨度}、成员字节依次存放
+export class Skiplist {
+public:
+  class Node;
+  struct Level {
+    Node *forward;
+    size_t span;
+  };
+
+  class Node {
+  public:
+    double score;
+    Node *backward;
+
+    Level *levels() { return reinterpret_cast<Level *>(this + 1); }
+    const Level *levels() const { return reinterpret_cast<const Level *>(this + 1); }
+    int height() const { return height_; }
+    std::string_view member() const { return {reinterpret_cast<const char *>(levels() + height_), length_}; }
+    Node *next() const { return levels()[0].forward; }
+    Node *prev() const { return backward; }
+    size_t allocation_size() const { return allocation_size(height_, length_); }
+
+    static size_t allocation_size(int height, size_t length) {
+      return sizeof(Node) + static_cast<size_t>(height) * sizeof(Level) + length;
+    }
+
+  private:
+    friend class Skiplist;
+    uint32_t length_;
+    int height_;
+  };
+
+  static constexpr int MAX_LEVEL = 32;
+
+  Skiplist() : head_(create_node(MAX_LEVEL, 0, {})) {
+    for (int i = 0; i < MAX_LEVEL; ++i) {
+      head_->levels()[i] = {nullptr, 0};
+    }
+    head_->backward = nullptr;
+  }
+  ~Skiplist() {
+    Node *node = head_->next();
+    while (node) {
+      Node *next = node->next();
+      free_node(node);
+      node = next;
+    }
+    free_node(head_);
+  }
+  Skiplist(const Skiplist &) = delete;
+  Skiplist &operator=(const Skiplist &) = delete;
+
+  size_t size() const { return length_; }
+  // 跳表占用的堆内存，包括表头和所有节点
+  size_t memory_bytes() const { return sizeof(*this) + head_->allocation_size() + node_bytes_; }
+  Node *first() const { return head_->next(); }
+  Node *last() const { return tail_; }
+
+  // 插入新节点，调用方保证成员不存在
+  Node *insert(double score, std::string_view member) {
+    Node *update[MAX_LEVEL];
+    size_t rank[MAX_LEVEL];
+    Node *x = head_;
+    for (int i = level_ - 1; i >= 0; --i) {
+      rank[i] = i == level_ - 1 ? 0 : rank[i + 1];
+      while (x->levels()[i].forward && less(x->levels()[i].forward, score, member)) {
+        rank[i] += x->levels()[i].span;
+        x = x->levels()[i].forward;
+      }
+      update[i] = x;
+    }
+    int height = random_level();
+    if (height > level_) {
+      for (int i = level_; i < height; ++i) {
+        rank[i] = 0;
+        update[i] = head_;
+        update[i]->levels()[i].span = length_;
+      }
+      level_ = height;
+    }
+    x = create_node(height, score, member);
+    for (int i = 0; i < height; ++i) {
+      x->levels()[i].forward = update[i]->levels()[i].forward;
+      update[i]->levels()[i].forward = x;
+      // update[i] 到新节点之间跨过 rank[0] - rank[i] 个节点
+      x->levels()[i].span = update[i]->levels()[i].span - (rank[0] - rank[i]);
+      update[i]->levels()[i].span = (rank[0] - rank[i]) + 1;
+    }
+    for (int i = height; i < level_; ++i) {
+      ++update[i]->levels()[i].span;
+    }
+    x->backward = update[0] == head_ ? nullptr : update[0];
+    if (x->next()) {
+      x->next()->backward = x;
+    } else {
+      tail_ = x;
+    }
+    ++length_;
+    node_bytes_ += x->allocation_size();
+    return x;
+  }
+
+  // 删除节点并释放
+  void erase(Node *node) {
+    Node *update[MAX_LEVEL];
+    find_update(node->score, node->member(), update);
+    unlink(node, update);
+    free_node(node);
+  }
+
+  // 修改节点的分数。排序位置不变时原地修改，否则删除后重新插入，返回新节点
+  Node *update_score(Node *node, double score) {
+    Node *prev = node->backward;
+    Node *next = node->next();
+    if ((!prev || prev->score < score || (prev->score == score && prev->member() < node->member())) &&
+        (!next || score < next->score || (next->score == score && node->member() < next->member()))) {
+      node->score = score;
+      return node;
+    }
+    std::string member(node->member());
+    erase(node);
+    return insert(score, member);
+  }
+
+  // 节点的排名，从 1 开始
+  size_t rank(const Node *node) const {
+    size_t rank = 0;
+    const Node *x = head_;
+    for (int i = level_ - 1; i >= 0; --i) {
+      while (x->levels()[i].forward && !less(node, x->levels()[i].forward)) {
+        rank += x->levels()[i].span;
+        x = x->levels()[i].forward;
+      }
+      if (x == node) {
+        return rank;
+      }
+    }
+    return rank;
+  }
+
+  // 排名为 rank（从 1 开始）的节点，越界时返回 nullptr
+  Node *by_rank(size_t rank) const {
+    if (rank == 0 || rank > length_) {
+      return nullptr;
+    }
+    size_t traversed = 0;
+    Node *x = head_;
+    for (int i = level_ - 1; i >= 0; --i) {
+      while (x->levels()[i].forward && traversed + x->levels()[i].span <= rank) {
+        traversed += x->levels()[i].span;
+        x = x->levels()[i].forward;
+      }
+      if (traversed == rank) {
+        return x;
+      }
+    }
+    return nullptr;
+  }
+
+  // 区间内的第一个和最后一个节点，没有时返回 nullptr
+  Node *first_in_range(const ScoreRange &range) const {
+    return first_where([&](const Node *n) { return !range.above_min(n->score); },
+                       [&](const Node *n) { return range.below_max(n->score); });
+  }
+  Node *last_in_range(const ScoreRange &range) const {
+    return last_where([&](const Node *n) { return range.below_max(n->score); },
+                      [&](const Node *n) { return range.above_min(n->score); });
+  }
+  Node *first_in_range(const LexRange &range) const {
+    return first_where([&](const Node *n) { return !range.above_min(n->member()); },
+                       [&](const Node *n) { return range.below_max(n->member()); });
+  }
+  Node *last_in_range(const LexRange &range) const {
+    return last_where([&](const Node *n) { return range.below_max(n->member()); },
+                      [&](const Node *n) { return range.above_min(n->member()); });
+  }
+
+  // 删除分数在区间内的节点，删除前对每个节点调用 fn(node)，返回删除的个数
+  template <typename Fn> size_t erase_range(const ScoreRange &range, Fn &&fn) {
+    Node *update[MAX_LEVEL];
+    Node *x = head_;
+    for (int i = level_ - 1; i >= 0; --i) {
+      while (x->levels()[i].forward && !range.above_min(x->levels()[i].forward->score)) {
+        x = x->levels()[i].forward;
+      }
+      update[i] = x;
+    }
+    size_t removed = 0;
+    x = x->next();
+    while (x && range.below_max(x->score)) {
+      Node *next = x->next();
+      fn(x);
+      unlink(x, update);
+      free_node(x);
+      ++removed;
+      x = next;
+    }
+    return removed;
+  }
+
+private:
+  static Node *create_node(int height, double score, std::string_view member) {
+    void *p = ::operator new(Node::allocation_size(height, member.size()));
+    Node *node = static_cast<Node *>(p);
+    node->score = score;
+    node->backward = nullptr;
+    node->length_ = static_cast<uint32_t>(member.size());
+    node->height_ = height;
+    if (!member.empty()) {
+      std::memcpy(reinterpret_cast<char *>(node->levels() + height), member.data(), member.size());
+    }
+    return node;
+  }
+  static void free_node(Node *node) { ::operator delete(node); }
+
+  // (score, member) 是否排在节点之前
+  static bool less(const Node *node, double score, std::string_view member) {
+    return node->score < score || (node->score == score && node->member() < member);
+  }
+  static bool less(const Node *a, const Node *b) { return less(a, b->score, b->member()); }
+
+  // 层高按 1/4 的概率逐层增加，平均每个节点 1.33 层
+  static int random_level() {
+    thread_local std::minstd_rand rng(std::random_device{}());
+    int level = 1;
+    while (level < MAX_LEVEL && (rng() & 3) == 0) {
+      ++level;
+    }
+    return level;
+  }
+
+  void find_update(double score, std::string_view member, Node **update) {
+    Node *x = head_;
+    for (int i = level_ - 1; i >= 0; --i) {
+      while (x->levels()[i].forward && less(x->levels()[i].forward, score, member)) {
+        x = x->levels()[i].forward;
+      }
+      update[i] = x;
+    }
+  }
+
+  void unlink(Node *x, Node **update) {
+    for (int i = 0; i < level_; ++i) {
+      if (update[i]->levels()[i].forward == x) {
+        update[i]->levels()[i].span += x->levels()[i].span - 1;
+        update[i]->levels()[i].forward = x->levels()[i].forward;
+      } else {
+        --update[i]->levels()[i].span;
+      }
+    }
+    if (x->next()) {
+      x->next()->backward = x->backward;
+    } else {
+      tail_ = x->backward;
+    }
+    while (level_ > 1 && !head_->levels()[level_ - 1].forward) {
+      --level_;
+    }
+    --length_;
+    node_bytes_ -= x->allocation_size();
+  }
+
+  // 第一个不满足 before 的节点，且满足 in_range 时返回
+  template <typename Before, typename InRange> Node *first_where(Before before, InRange in_range) const {
+    Node *x = head_;
+    for (int i = level_ - 1; i >= 0; --i) {
+      while (x->levels()[i].forward && before(x->levels()[i].forward)) {
+        x = x->levels()[i].forward;
+      }
+    }
+    x = x->next();
+    return x && in_range(x) ? x : nullptr;
+  }
+  // 最后一个满足 not_after 的节点，且满足 in_range 时返回
+  template <typename NotAfter, typename InRange> Node *last_where(NotAfter not_after, InRange in_range) const {
+    Node *x = head_;
+    for (int i = level_ - 1; i >= 0; --i) {
+      while (x->levels()[i].forward && not_after(x->levels()[i].forward)) {
+        x = x->levels()[i].forward;
+      }
+    }
+    return x != head_ && in_range(x) ? x : nullptr;
+  }
+
+  Node *head_;
+  Node *tail_ = nullptr;
+  size_t length_ = 0;
+  int level_ = 1;
+  size_t node_bytes_ = 0; // 所有节点（不含表头）占用的字节数
+};
+
+// 哈希表中的一项：指向跳表节点，键是节点中的成员，按成员 O(1) 查到分数和节点
+export struct ZSetIndexEntry {
+  Skiplist::Node *node = nullptr;
+  std::string_view key() const { return node->member(); }
+};
+
+// 有序集合类型的值。成员数和成员长度都不超过 EncodingConfig 中的阈值时使用紧凑编码：
+// 成员和分数交替存放在一个 Listpack 中，按 (分数, 成员) 升序排列，所有操作都是线性扫描；
+// 超过任一阈值后转换为跳表加哈希表：跳表负责按分数和排名的有序访问，哈希表按成员查分数，
+// 之后不再转换回来
+export class ZSetObject final : public ValueObject {
+public:
+  enum class Encoding { Listpack, Skiplist };
+
+  // 有序遍历中的一个元素。紧凑编码中的整数成员格式化到内部缓冲区，视图在下次取值前有效
+  class Cursor {
+  public:
+    bool valid() const { return owner_->encoding_ == Encoding::Listpack ? pos_ != Listpack::npos : node_ != nullptr; }
+    std::string_view member() {
+      if (node_) {
+        return node_->member();
+      }
+      return owner_->listpack_.get(pos_).as_string(buf_);
+    }
+    double score() const { return node_ ? node_->score : owner_->listpack_score(pos_); }
+    void next() {
+      if (owner_->encoding_ == Encoding::Skiplist) {
+        node_ = node_->next();
+      } else {
+        pos_ = owner_->listpack_.next(owner_->listpack_.next(pos_));
+      }
+    }
+    void prev() {
+      if (owner_->encoding_ == Encoding::Skiplist) {
+        node_ = node_->prev();
+      } else {
+        pos_ = pos_ == 0 ? Listpack::npos : owner_->listpack_.prev(owner_->listpack_.prev(pos_));
+      }
+    }
+
+  private:
+    friend class ZSetObject;
+    const ZSetObject *owner_ = nullptr;
+    size_t pos_ = Listpack::npos;
+    Skiplist::Node *node_ = nullptr;
+    Listpack::ValueBuffer buf_;
+  };
+
+  ZSetObject() : ValueObject(ObjectType::ZSet) {}
+
+  Encoding encoding() const { return encoding_; }
+  std::string_view encoding_name() const override { return encoding_ == Encoding::Listpack ? "listpack" : "skiplist"; }
+  size_t memory_bytes() const override {
+    if (encoding_ == Encoding::Listpack) {
+      return sizeof(*this) + listpack_.memory_bytes();
+    }
+    return sizeof(*this) + skiplist_->memory_bytes() + index_.table_bytes();
+  }
+
+  size_t size() const { return encoding_ == Encoding::Listpack ? listpack_.size() / 2 : skiplist_->size(); }
+  bool empty() const { return size() == 0; }
+
+  std::optional<double> score(std::string_view member) const {
+    if (encoding_ == Encoding::Listpack) {
+      size_t pos = listpack_.find(listpack_.first(), member, 1);
+      if (pos == Listpack::npos) {
+        return std::nullopt;
+      }
+      return listpack_score(pos);
+    }
+    auto it = index_.find(member);
+    if (it == index_.end()) {
+      return std::nullopt;
+    }
+    return it->node->score;
+  }
+
+  // 设置成员的分数，成员不存在时加入，返回是否新增。超过紧凑编码的阈值时先转换编码
+  bool set(std::string_view member, double score, const EncodingConfig &config) {
+    if (encoding_ == Encoding::Listpack) {
+      size_t pos = listpack_.find(listpack_.first(), member, 1);
+      if (pos != Listpack::npos) {
+        if (listpack_score(pos) != score) {
+          listpack_.erase_range(pos, 2);
+          listpack_insert(member, score);
+        }
+        return false;
+      }
+      if (member.size() <= config.zset_max_listpack_value && size() < config.zset_max_listpack_entries) {
+        listpack_insert(member, score);
+        return true;
+      }
+      convert_to_skiplist();
+    }
+    auto it = index_.find(member);
+    if (it != index_.end()) {
+      if (it->node->score != score) {
+        it->node = skiplist_->update_score(it->node, score);
+      }
+      return false;
+    }
+    index_.insert(ZSetIndexEntry{skiplist_->insert(score, member)});
+    return true;
+  }
+
+  // 删除成员，返回成员是否存在
+  bool erase(std::string_view member) {
+    if (encoding_ == Encoding::Listpack) {
+      size_t pos = listpack_.find(listpack_.first(), member, 1);
+      if (pos == Listpack::npos) {
+        return false;
+      }
+      listpack_.erase_range(pos, 2);
+      return true;
+    }
+    auto it = index_.find(member);
+    if (it == index_.end()) {
+      return false;
+    }
+    Skiplist::Node *node = it->node;
+    index_.erase(it);
+    skiplist_->erase(node);
+    return true;
+  }
+
+  // 成员按升序的排名（从 0 开始）
+  std::optional<size_t> rank(std::string_view member) const {
+    if (encoding_ == Encoding::Listpack) {
+      size_t rank = 0;
+      Listpack::ValueBuffer buf;
+      for (size_t pos = listpack_.first(); pos != Listpack::npos; pos = listpack_.next(listpack_.next(pos))) {
+        if (listpack_.get(pos).as_string(buf) == member) {
+          return rank;
+        }
+        ++rank;
+      }
+      return std::nullopt;
+    }
+    auto it = index_.find(member);
+    if (it == index_.end()) {
+      return std::nullopt;
+    }
+    return skiplist_->rank(it->node) - 1;
+  }
+
+  // 升序排名为 rank（从 0 开始，不越界）的元素
+  Cursor at_rank(size_t rank) const {
+    Cursor c = cursor();
+    if (encoding_ == Encoding::Listpack) {
+      c.pos_ = listpack_.seek(static_cast<long long>(rank * 2));
+    } else {
+      c.node_ = skiplist_->by_rank(rank + 1);
+    }
+    return c;
+  }
+
+  // 区间内的第一个（升序）或最后一个元素，没有时返回无效的游标
+  template <typename Range> Cursor first_in_range(const Range &range) const {
+    Cursor c = cursor();
+    if (encoding_ == Encoding::Skiplist) {
+      c.node_ = skiplist_->first_in_range(range);
+      return c;
+    }
+    for (c.pos_ = listpack_.first(); c.valid(); c.next()) {
+      if (in_range(range, c)) {
+        return c;
+      }
+      if (!below_max(range, c)) {
+        break;
+      }
+    }
+    c.pos_ = Listpack::npos;
+    return c;
+  }
+  template <typename Range> Cursor last_in_range(const Range &range) const {
+    Cursor c = cursor();
+    if (encoding_ == Encoding::Skiplist) {
+      c.node_ = skiplist_->last_in_range(range);
+      return c;
+    }
+    if (empty()) {
+      return c;
+    }
+    for (c.pos_ = listpack_.prev(listpack_.last()); c.valid(); c.prev()) {
+      if (in_range(range, c)) {
+        return c;
+      }
+      if (!above_min(range, c)) {
+        break;
+      }
+    }
+    c.pos_ = Listpack::npos;
+    return c;
+  }
+
+  // 删除分数在区间内的成员，返回删除的个数
+  size_t erase_range(const ScoreRange &range) {
+    if (encoding_ == Encoding::Skiplist) {
+      return skiplist_->erase_range(range, [this](Skiplist::Node *node) { index_.erase(node->member()); });
+    }
+    Cursor c = first_in_range(range);
+    if (!c.valid()) {
+      return 0;
+    }
+    size_t start = c.pos_;
+    size_t count = 0;
+    for (; c.valid() && range.below_max(c.score()); c.next()) {
+      ++count;
+    }
+    listpack_.erase_range(start, count * 2);
+    return count;
+  }
+
+  // 删除分数最低的 count 个成员，删除前依次调用 fn(member, score)
+  template <typename Fn> size_t pop_min(size_t count, Fn &&fn) {
+    size_t popped = 0;
+    while (popped < count && !empty()) {
+      Cursor c = at_rank(0);
+      std::string member(c.member());
+      fn(std::string_view(member), c.score());
+      erase(member);
+      ++popped;
+    }
+    return popped;
+  }
+
+private:
+  Cursor cursor() const {
+    Cursor c;
+    c.owner_ = this;
+    return c;
+  }
+
+  static bool in_range(const ScoreRange &range, Cursor &c) { return range.contains(c.score()); }
+  static bool in_range(const LexRange &range, Cursor &c) { return range.contains(c.member()); }
+  static bool below_max(const ScoreRange &range, Cursor &c) { return range.below_max(c.score()); }
+  static bool below_max(const LexRange &range, Cursor &c) { return range.below_max(c.member()); }
+  static bool above_min(const ScoreRange &range, Cursor &c) { return range.above_min(c.score()); }
+  static bool above_min(const LexRange &range, Cursor &c) { return range.above_min(c.member()); }
+
+  // member_pos 处成员对应的分数
+  double listpack_score(size_t member_pos) const {
+    Listpack::Value v = listpack_.get(listpack_.next(member_pos));
+    if (v.is_int) {
+      return static_cast<double>(v.integer);
+    }
+    double score = 0;
+    parse_score(v.str, score);
+    return score;
+  }
+
+  // 按 (分数, 成员) 的顺序插入，调用方保证成员不存在
+  void listpack_insert(std::string_view member, double score) {
+    size_t pos = listpack_.first();
+    Listpack::ValueBuffer buf;
+    while (pos != Listpack::npos) {
+      double s = listpack_score(pos);
+      if (s > score || (s == score && listpack_.get(pos).as_string(buf) > member)) {
+        break;
+      }
+      pos = listpack_.next(listpack_.next(pos));
+    }
+    ScoreBuffer score_buf;
+    pos = listpack_.insert(pos, member);
+    listpack_.insert(listpack_.next(pos), format_score(score, score_buf));
+  }
+
+  void convert_to_skiplist() {
+    skiplist_ = std::make_unique<Skiplist>();
+    for (Cursor c = at_rank(0); c.valid(); c.next()) {
+      index_.insert(ZSetIndexEntry{skiplist_->insert(c.score(), c.member())});
+    }
+    listpack_.clear();
+    encoding_ = Encoding::Skiplist;
+  }
+
+  Encoding encoding_ = Encoding::Listpack;
+  Listpack listpack_;
+  std::unique_ptr<Skiplist> skiplist_; // 转换编码时才创建，紧凑编码不需要表头节点
+  Dict<ZSetIndexEntry> index_;
+};
@@ -0,0 +1,274 @@
+module;
+
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <functional>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+export module epoll_backend;
+
+import event_backend;
+import buffer;
+import logger;
+
+const int MAX_EVENTS = 1024; // 最大事件数量
+
+const uint32_t CONN_EVENTS = EPOLLIN | EPOLLRDHUP | EPOLLET; // 客户端连接始终关注的事件
+
+// 基于 epoll 的事件后端：边缘触发，readv 读取，write 发送，写不完时注册 EPOLLOUT
+export class EpollBackend : public EventBackend {
+public:
+    EpollBackend() = default;
+    ~EpollBackend() override;
+
+    const char *name() const override { return "epoll"; }
+    bool init(int listen_fd, ConnectionHandler &handler) override;
+    bool watch(int fd, std::function<void()> on_readable) override;
+    bool send(int fd, Buffer &output) override;
+    void resume_reading(int fd) override;
+    void close_connection(int fd) override;
+    void run() override;
+
+private:
+    bool set_non_blocking(int fd); // 设置文件描述符为非阻塞
+    void handle_new_connection(); // 处理新连接
+    void handle_read(int fd, uint32_t ready); // 处理连接可读事件，ready 为就绪的事件
+
+    int epoll_fd_ = -1;  // epoll实例的文件描述符
+    int listen_fd_ = -1; // 监听socket，由服务器创建和关闭
+    ConnectionHandler *handler_ = nullptr;
+    std::unordered_map<int, std::function<void()>> watchers_; // 内部文件描述符及其回调
+    std::unordered_set<int> watching_write_;                  // 已注册 EPOLLOUT 的连接
+    // 服务器暂停接收输入时停止读取的连接。边缘触发下内核中剩余的数据不会再有通知，
+    // 恢复时必须主动读取：恢复的连接先放进 resumed_，在本轮事件处理结束后读取
+    std::unordered_set<int> stalled_;
+    std::vector<int> resumed_;
+};
+
+EpollBackend::~EpollBackend() {
+    if (epoll_fd_ != -1) {
+        LOG_DEBUG("关闭epoll实例 {}", epoll_fd_);
+        close(epoll_fd_);
+    }
+}
+
+bool EpollBackend::init(int listen_fd, ConnectionHandler &handler) {
+    listen_fd_ = listen_fd;
+    handler_ = &handler;
+
+    // 将监听的socket设置为非阻塞
+    if (!set_non_blocking(listen_fd_)) {
+        return false;
+    }
+
+    // 创建epoll实例
+    epoll_fd_ = epoll_create1(0);
+    if (epoll_fd_ == -1) {
+        LOG_ERROR("创建epoll实例失败: {}", strerror(errno));
+        return false;
+    }
+
+    // 将监听socket添加到epoll中
+    epoll_event event;
+    event.events = EPOLLIN | EPOLLET;
+    event.data.fd = listen_fd_;
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, listen_fd_, &event) == -1) {
+        LOG_ERROR("将监听socket加入epoll失败: {}", strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+bool EpollBackend::watch(int fd, std::function<void()> on_readable) {
+    epoll_event event;
+    event.events = EPOLLIN; // 对于内部事件，使用电平触发更安全
+    event.data.fd = fd;
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event) == -1) {
+        LOG_ERROR("将文件描述符 {} 加入epoll失败: {}", fd, strerror(errno));
+        return false;
+    }
+    watchers_[fd] = std::move(on_readable);
+    return true;
+}
+
+// 运行事件循环
+void EpollBackend::run() {
+    std::vector<epoll_event> events(MAX_EVENTS); // 用于接收就绪事件
+    while (true) {
+        handler_->before_wait();
+        // 阻塞程序，直到有事件发生或者超时,n为就绪事件的数量。有恢复读取的连接时不阻塞
+        int n = epoll_wait(epoll_fd_, events.data(), MAX_EVENTS, resumed_.empty() ? -1 : 0);
+        if (n == -1) {
+            if (errno == EINTR) continue; // 若是被信号中断,继续循环
+            LOG_ERROR("epoll_wait错误: {}", strerror(errno));
+            break;
+        }
+        // 遍历所有就绪事件
+        for (int i = 0; i < n; ++i) {
+            int fd = events[i].data.fd;
+            // 判断就绪事件是否发生在监听socket上
+            if (fd == listen_fd_) {
+                handle_new_connection(); // 是则说明有新连接请求
+            } else if (auto it = watchers_.find(fd); it != watchers_.end()) {
+                it->second();
+            } else {
+                // 不是则说明已连接的客户端可读或可写
+                uint32_t ready = events[i].events;
+                if (ready & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) {
+                    handle_read(fd, ready);
+                }
+                if (ready & EPOLLOUT) {
+                    handler_->on_writable(fd);
+                }
+            }
+        }
+        // 读取恢复解析的连接在暂停期间积压在内核中的数据
+        for (int fd : std::exchange(resumed_, {})) {
+            handle_read(fd, EPOLLIN);
+        }
+    }
+}
+
+// 设置文件描述符为非阻塞
+bool EpollBackend::set_non_blocking(int fd) {
+    int flags = fcntl(fd, F_GETFL, 0); // 获得fd当前的状态标志
+    if (flags == -1) {
+        LOG_ERROR("设置非阻塞模式失败(F_GETFL): {}", strerror(errno));
+        return false;
+    }
+    // 设置fd为非阻塞
+    if (fcntl(fd, F_SETFL, flags | O_NONBLOCK) == -1) {
+        LOG_ERROR("设置非阻塞模式失败(F_SETFL): {}", strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+// 处理新连接
+void EpollBackend::handle_new_connection() {
+    // ET 模式下，多个连接到来时，epoll 可能只通知一次。
+    // 所以必须用循环把所有等待的连接都 accept 掉。
+    while (true) {
+        int conn_fd = accept(listen_fd_, nullptr, nullptr);
+        if (conn_fd == -1) {
+            // 如果 errno 是 EAGAIN 或 EWOULDBLOCK，说明所有等待的连接都已处理完毕
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+                break;
+            // 其他错误则打印并退出
+            LOG_ERROR("接受连接失败: {}", strerror(errno));
+            break;
+        }
+
+        // 将新连接也设置为非阻塞模式
+        set_non_blocking(conn_fd);
+
+        // 准备新连接的 epoll 事件
+        epoll_event event;
+        event.events = CONN_EVENTS; // 同样关心可读事件和使用 ET 模式，另外关注对端关闭
+        event.data.fd = conn_fd;
+
+        // 将新连接的文件描述符添加到 epoll 的监控中
+        if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, conn_fd, &event) == -1) {
+            LOG_ERROR("将客户端 {} 加入epoll失败: {}", conn_fd, strerror(errno));
+            close(conn_fd); // 添加失败，关闭这个连接
+            continue;
+        }
+        handler_->on_accept(conn_fd);
+    }
+}
+
+// 处理连接可读事件。边缘触发下一次通知之后不会再有通知，必须读到 EAGAIN 为止，
+// 否则留在内核中的数据（例如一次发来超过一次读取量的管道请求）再也不会被读取。
+// 服务器暂停解析时停止读取，数据留在内核中由 TCP 流量控制反压客户端，恢复时经 resumed_ 继续读取
+void EpollBackend::handle_read(int fd, uint32_t ready) {
+    while (true) {
+        // 每轮重新查找：上一轮的 on_input 可能已经关闭了连接
+        Buffer *input = handler_->input_buffer(fd);
+        if (!input) {
+            return;
+        }
+        if (!handler_->accepts_input(fd)) {
+            if (ready & (EPOLLRDHUP | EPOLLHUP | EPOLLERR)) {
+                // 暂停期间对端关闭：不再读取剩余数据，与读到 EOF 一样关闭连接（例如挂起的阻塞命令客户端断开）
+                int err = 0;
+                socklen_t len = sizeof(err);
+                if (ready & EPOLLERR) {
+                    getsockopt(fd, SOL_SOCKET, SO_ERROR, &err, &len);
+                }
+                handler_->on_peer_closed(fd, err);
+            } else {
+                stalled_.insert(fd);
+            }
+            return;
+        }
+
+        int saved_errno = 0;
+        ssize_t n = input->read_fd(fd, &saved_errno);
+        if (n == 0) {
+            // 客户端关闭连接
+            handler_->on_peer_closed(fd, 0);
+            return;
+        }
+        if (n < 0) {
+            // 读取出错
+            if (saved_errno != EAGAIN && saved_errno != EWOULDBLOCK) {
+                handler_->on_peer_closed(fd, saved_errno);
+            }
+            return;
+        }
+        LOG_DEBUG("从客户端 #{} 读取了 {} 字节数据", fd, n);
+        handler_->on_input(fd);
+    }
+}
+
+// 发送输出缓冲区中积压的数据
+bool EpollBackend::send(int fd, Buffer &output) {
+    if (output.readable_bytes() > 0) {
+        int saved_errno = 0;
+        ssize_t n = output.write_fd(fd, &saved_errno);
+        if (n < 0 && saved_errno != EAGAIN && saved_errno != EWOULDBLOCK) {
+            LOG_ERROR("向客户端 #{} 写入数据失败: {}", fd, strerror(saved_errno));
+            return false;
+        }
+    }
+    // 只在有未写完的数据时关注可写事件，避免空转
+    bool pending = output.readable_bytes() > 0;
+    if (pending != watching_write_.contains(fd)) {
+        epoll_event event;
+        event.events = CONN_EVENTS | (pending ? EPOLLOUT : 0);
+        event.data.fd = fd;
+        if (epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, fd, &event) == -1) {
+            LOG_ERROR("修改客户端 #{} 的epoll事件失败: {}", fd, strerror(errno));
+        } else if (pending) {
+            watching_write_.insert(fd);
+        } else {
+            watching_write_.erase(fd);
+        }
+    }
+    return true;
+}
+
+// 恢复读取：只有因暂停而停止读取的连接需要主动读取，其余连接仍会收到可读通知
+void EpollBackend::resume_reading(int fd) {
+    if (stalled_.erase(fd) > 0) {
+        resumed_.push_back(fd);
+    }
+}
+
+// 关闭客户端连接
+void EpollBackend::close_connection(int fd) {
+    epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+    watching_write_.erase(fd);
+    stalled_.erase(fd); // resumed_ 中残留的编号在读取时因连接不存在或无数据而被忽略
+    close(fd);
+}
@@ -2,32 +2,51 @@ module;
 //包含了所有网络编程、epoll、文件控制等所需的Linux/POsIX系统头文件
 #include <arpa/inet.h>
 #include <array>
+#include <cctype>
 #include <cerrno>
 #include <chrono>
+#include <condition_variable>
+#include <cstdint>
 #include <cstring>
+#include <deque>
 #include <expected>
 #include <fcntl.h>
+#include <functional>
 #include <iostream>
+#include <list>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <optional>
+#include <span>
 #include <string>
-#include <sys/epoll.h>
+#include <string_view>
 #include <sys/socket.h>
 #include <unistd.h>
 #include <unordered_map>
+#include <utility>
 #include <variant>
 #include <vector>
 
 export module epoll_server;
 
 import kv_server;
+import server_stat;
+import command_table;
 import resp;
 import buffer;
 import logger;
 import timer;
+import mailbox;
+import event_backend;
+import epoll_backend;
+import uring_backend;
 
-const int MAX_EVENTS = 1024; // 最大事件数量
-const int BUFFER_SIZE = 1024; // 缓冲区大小
+const size_t OUTPUT_HIGH_WATERMARK = 1024 * 1024; // 输出缓冲区积压超过该值时暂停解析新命令
+const size_t MAX_PENDING_REPLIES = 1024;          // 单个连接等待跨分片回复的命令数上限，达到时暂停解析
+const size_t MAX_QUERY_BUFFER = 1024 * 1024 * 1024; // 输入缓冲区的硬上限，超过时关闭连接（与 Redis 的 client-query-buffer-limit 默认值相同）
 
 // 连接状态，用于表示客户端当前是否在事务中
 enum class ConnectionState {
@@ -35,61 +54,181 @@ enum class ConnectionState {
     InTransaction // 事务中
 };
 
+// 同一连接在一轮解析中转发到同一分片的命令，一次投递、一次送回回复
+struct ForwardBatch {
+    std::vector<std::vector<std::string>> commands; // 拷贝出的命令参数
+    std::vector<uint64_t> slots;                    // 各命令的回复在 pending_replies 中的序号
+};
+
 // 定义TCP连接类，封装客户端连接的状态和数据
 struct TcpConnection {
-    Buffer buffer;                                   // 客户端读写缓冲区
+    Buffer buffer;                                   // 客户端输入缓冲区
+    Buffer output;                                   // 输出缓冲区，一轮读取产生的所有回复合并后一次写出
     ConnectionState state = ConnectionState::Normal; // 连接状态
-    std::vector<resp::RespValue> transaction_queue;  // 事务命令队列
+    resp::RequestParser parser;                      // 增量请求解析器，保存未完成请求的解析进度
+    resp::RequestArgv argv;                          // 当前请求的参数，指向输入缓冲区，随连接复用
+    std::vector<std::vector<std::string>> transaction_queue; // 事务命令队列，排队的命令需要拷贝出来
+    uint64_t id = 0;                                 // 连接编号，fd 可能被复用，用于校验跨分片回复的归属
+    bool awaiting_reply = false;                     // 是否暂停解析，等待转发的命令返回（事务、阻塞命令等）
+    std::optional<size_t> blocked_shard;             // 阻塞命令挂起在哪个分片的等待队列中，挂起期间同样等待回复
+    // 流水线中转发到其他分片的命令不暂停解析：每条命令在 pending_replies 中按请求顺序占一个位置，
+    // 转发的命令回复到达前为空，之后本分片执行的命令回复也排在其中；队首就绪的回复依次移入 output
+    std::deque<std::optional<std::string>> pending_replies;
+    uint64_t pending_base = 0;                       // pending_replies 队首位置的序号
+    std::vector<ForwardBatch> forward_batches;       // 本轮解析中按目标分片攒批、尚未投递的命令，下标为分片编号
 };
 
-export class EpollServer {
+// 在目标分片上执行的任务，返回序列化后的回复
+using ShardJob = std::function<std::string(KVServer &)>;
+
+// 服务器：监听端口、管理连接并执行命令。
+// 网络 I/O 由可替换的事件后端（epoll 或 io_uring）完成，命令路径两者共用
+export class EpollServer : public ConnectionHandler {
 public:
     EpollServer() = delete;
-    explicit EpollServer(int port, KVServer &kv_server) : port_(port), kv_server_(kv_server) {}
-    ~EpollServer();
+    explicit EpollServer(int port, KVServer &kv_server, size_t loop_index = 0,
+                         EventBackendType backend_type = EventBackendType::Epoll)
+        : port_(port), loop_index_(loop_index), backend_type_(backend_type),
+          timer_queue_(std::make_unique<TimerQueue>()), kv_server_(kv_server) {}
+    ~EpollServer() override;
     bool init(int port);
     void run();
-    void start() {
+    // 初始化（如果尚未初始化）并运行事件循环，初始化失败时返回 false
+    bool start() {
         if (!initialized_) {
             if (!init(port_)) {
                 LOG_FATAL("服务器初始化失败");
-                return;
+                return false;
             }
         }
         run();
+        return true;
     }
 
+    // 设置同一进程内的全部事件循环，下标即分片编号。
+    // 多于一个事件循环时，监听 socket 使用 SO_REUSEPORT 由内核分摊新连接
+    void set_shard_group(std::vector<EpollServer *> group) { shard_group_ = std::move(group); }
+    // 向本事件循环投递任务，可在任意线程调用
+    void post(MailboxTask task) { mailbox_.post(std::move(task)); }
+
     // 添加定时器，返回定时器指针
     Timer * add_timer(std::chrono::milliseconds when, TimerCallback cb, bool repeat = false,
                      std::chrono::milliseconds interval = std::chrono::milliseconds(0));
     // 获取定时器队列指针，供外部使用
     TimerQueue * get_time_queue() { return timer_queue_.get(); }
+    // 实际使用的事件后端名称（io_uring 不可用时为回退后的 epoll），init 之后有效
+    std::string_view backend_name() const { return backend_->name(); }
+
+    // --- 事件后端回调 ---
+    void on_accept(int fd) override;
+    Buffer *input_buffer(int fd) override;
+    void on_input(int fd) override;
+    bool accepts_input(int fd) override;
+    void on_peer_closed(int fd, int err) override;
+    void on_writable(int fd) override;
+    void before_wait() override;
+
 private:
-    bool set_non_blocking(int fd); // 设置文件描述符为非阻塞
-    void handle_new_connection(); // 处理新连接
-    void handle_client_data(int clients_fd); // 处理客户端数据
     void close_client_connection(int client_fd); // 关闭客户端连接
     void handle_timer_event(); // 处理定时器事件
 
+    // 解析并执行缓冲区中的命令，直到数据不足或等待跨分片回复
+    void process_input(int client_fd, TcpConnection &conn);
+    // 连接是否暂停解析：等待转发的命令返回、回复积压过多或等待回复的命令过多。
+    // 暂停期间事件后端同样停止读取，输入缓冲区不会无限增长
+    static bool parsing_paused(const TcpConnection &conn);
+    // 连接恢复解析后通知事件后端继续读取
+    void resume_input(int client_fd, const TcpConnection &conn);
+    // 将输出缓冲区交给事件后端发送；连接因错误被关闭时返回 false
+    bool flush_output(int client_fd, TcpConnection &conn);
+    // 处理一条命令，回复写入 out；命令被转发到其他分片时回复稍后送达
+    void process_command(int client_fd, TcpConnection &conn, const CommandSpec *spec,
+                         std::span<const std::string_view> argv, Buffer &out);
+    // 命令能否排在尚未返回的跨分片回复之后执行。事务、阻塞和全分片命令需要等之前转发的命令都返回
+    static bool can_pipeline(const CommandSpec *spec);
+    // 计算命令所属的分片，无键命令属于当前分片；多键命令的键不在同一分片时返回 nullopt
+    std::optional<size_t> shard_for(const CommandSpec *spec, std::span<const std::string_view> argv) const;
+    // 在事件循环 #0 上以屏障方式对所有分片执行全分片命令，回复写入 out
+    void run_on_all_shards(std::span<const std::string_view> argv, Buffer &out);
+    // 将任务转发到目标分片执行并暂停解析，回复经由本事件循环的邮箱送回
+    void forward_to_shard(int client_fd, TcpConnection &conn, size_t shard, ShardJob job);
+    // 多分片时的 INFO：收集所有分片的统计信息和键空间信息，汇总后回复
+    void gather_info(int client_fd, TcpConnection &conn);
+    // 跨分片回复到达后写回客户端，并继续处理积压的输入
+    void deliver_reply(int client_fd, uint64_t conn_id, const std::string &response);
+    // 把普通命令加入发往目标分片的批次，在 pending_replies 中为回复占位，不暂停解析
+    void queue_forward(TcpConnection &conn, size_t shard, std::span<const std::string_view> argv);
+    // 本轮解析结束时，每个目标分片投递一个批次
+    void post_forward_batches(int client_fd, TcpConnection &conn);
+    // 一个批次的回复到达：replies 依次拼接了各命令的回复，ends 为各回复的结束位置
+    void deliver_replies(int client_fd, uint64_t conn_id, const std::vector<uint64_t> &slots,
+                         const std::string &replies, const std::vector<size_t> &ends);
+
+    // --- 阻塞命令 ---
+    // 挂起在本分片等待队列中的客户端。客户端可能连接在其他事件循环上，回复经由 origin 的邮箱送回
+    struct BlockedClient;
+    using WaitQueue = std::list<BlockedClient *>;
+    using BlockedClientKey = std::pair<const EpollServer *, uint64_t>; // 连接所在的事件循环和连接编号
+    struct BlockedClient {
+        EpollServer *origin = nullptr;
+        int fd = -1;
+        uint64_t conn_id = 0;
+        uint64_t block_id = 0;                  // 本次挂起的编号，超时回调据此忽略已被唤醒过的挂起
+        std::vector<std::string> argv;          // 阻塞命令，等待的键就绪时重新执行
+        std::vector<std::string> keys;          // 等待的键
+        std::vector<WaitQueue::iterator> positions; // 在各个键的等待队列中的位置，与 keys 一一对应
+        std::string timeout_reply;              // 超时时发送的空回复
+        Timer *timer = nullptr;                 // 超时定时器，一直等待时为空
+    };
+    // 在本分片执行阻塞命令。能立即完成时回复写入 out 并返回 true；
+    // 否则把客户端挂起到所等待的键的队列末尾，返回 false，回复在唤醒或超时时送回
+    bool execute_blocking(EpollServer *origin, int client_fd, uint64_t conn_id,
+                          std::span<const std::string_view> argv, Buffer &out);
+    // 按 FIFO 顺序重新执行等待就绪键的客户端的命令，直到键再次为空或没有等待者
+    void serve_ready_keys();
+    // 把客户端从所有等待队列中摘下并取消超时定时器，返回其所有权
+    std::unique_ptr<BlockedClient> unpark(BlockedClient *client);
+    // 超时定时器到期：回复空值
+    void timeout_blocked_client(BlockedClientKey key, uint64_t block_id);
+    // 挂起的客户端断开：从等待队列中移除
+    void cancel_blocked_client(BlockedClientKey key);
+    // 回复被唤醒或超时的客户端：本事件循环的连接直接写出，其他事件循环的经由邮箱送回
+    void reply_blocked_client(const BlockedClient &client, std::string_view reply);
+    // 在连接所在的事件循环上写出阻塞命令的回复，积压的输入留到本轮等待事件之前处理
+    void unblock_client(int client_fd, uint64_t conn_id, std::string_view reply);
+    // 分片编号对应的事件循环
+    EpollServer *shard_server(size_t shard) { return shard == loop_index_ ? this : shard_group_[shard]; }
+
     int listen_fd_ = -1; // 服务器监听socket文件描述符
-    int epoll_fd_ = -1; // epoll实例的文件描述符
     int port_ = 6379;          // 服务器端口
+    size_t loop_index_ = 0;    // 事件循环编号，同时也是所负责的分片编号
+    EventBackendType backend_type_; // 期望使用的事件后端
     bool initialized_ = false; // 是否已初始化
+    uint64_t next_conn_id_ = 1; // 下一个连接编号
 
     std::unique_ptr<TimerQueue> timer_queue_; // 定时器队列
+    Mailbox mailbox_;                         // 跨线程消息邮箱
+    std::unique_ptr<EventBackend> backend_;   // 事件后端
+    std::vector<EpollServer *> shard_group_;  // 所有事件循环（含自身）
     std::unordered_map<int, TcpConnection> connections_; // 存储每个客户端的连接信息
-    KVServer &kv_server_; // 共享的KVServer实例
+    KVServer &kv_server_; // 本分片的KVServer实例
+
+    std::unordered_map<std::string, WaitQueue> wait_queues_;                // 键的等待队列，只含有等待者的键
+    std::map<BlockedClientKey, std::unique_ptr<BlockedClient>> blocked_clients_; // 挂起在本分片的客户端
+    uint64_t next_block_id_ = 1;
+    // 有积压输入、在本轮等待事件之前继续解析的连接（fd, 编号）：被唤醒的阻塞客户端，
+    // 以及因回复积压暂停、写出后又降到高水位以下的连接
+    std::vector<std::pair<int, uint64_t>> deferred_clients_;
+    Buffer reply_scratch_; // 回复需要排在跨分片回复之后时，本分片命令的回复先写在这里
 };
 
 EpollServer::~EpollServer() {
+    // 先销毁后端，关闭其上的所有连接
+    backend_.reset();
     if(listen_fd_ != -1) {
         LOG_DEBUG("关闭监听套接字 {}", listen_fd_);
         close(listen_fd_);
     }
-    if(epoll_fd_ != -1) {
-        LOG_DEBUG("关闭epoll实例 {}", epoll_fd_);
-        close(epoll_fd_);
-    }
 }
 // 初始化服务器
 bool EpollServer::init(int port) {
@@ -106,6 +245,12 @@ bool EpollServer::init(int port) {
         LOG_ERROR("设置socket选项失败: {}", strerror(errno));
         return false;
     }
+    // 多个事件循环各自监听同一端口，由内核在它们之间分摊新连接
+    if (shard_group_.size() > 1 &&
+        setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEPORT, &opt, sizeof(opt))) {
+        LOG_ERROR("设置SO_REUSEPORT失败: {}", strerror(errno));
+        return false;
+    }
 
     // 准备服务器地址结构体
     sockaddr_in server_addr;
@@ -126,66 +271,36 @@ bool EpollServer::init(int port) {
         return false;
     }
 
-    // 将监听的socket设置为非阻塞
-    if (!set_non_blocking(listen_fd_)) {
-        return false;
+    // 创建事件后端，io_uring 不可用时回退到 epoll
+    if (backend_type_ == EventBackendType::IoUring) {
+        backend_ = create_uring_backend();
+        if (!backend_) {
+            LOG_WARN("io_uring 事件后端不可用，回退到 epoll");
+        }
     }
-
-    // 创建epoll实例
-    epoll_fd_ = epoll_create1(0);
-    if (epoll_fd_ == -1) {
-        LOG_ERROR("创建epoll实例失败: {}", strerror(errno));
+    if (!backend_) {
+        backend_ = std::make_unique<EpollBackend>();
+    }
+    if (!backend_->init(listen_fd_, *this)) {
         return false;
     }
 
-    // 将监听socket添加到epoll中
-    epoll_event event;
-    event.events = EPOLLIN | EPOLLET;
-    event.data.fd = listen_fd_;
-    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, listen_fd_, &event) == -1) {
-        LOG_ERROR("将监听socket加入epoll失败: {}", strerror(errno));
+    // 关注定时器和邮箱的文件描述符，由各自的处理函数负责读取
+    if (!backend_->watch(timer_queue_->timer_fd(), [this]() { handle_timer_event(); })) {
         return false;
     }
-
-    // 创建定时器队列
-    timer_queue_ = std::make_unique<TimerQueue>();
-    // 将定时器的文件描述符添加到 epoll 监控列表
-    event.events = EPOLLIN; // 对于定时器事件，使用电平触发更安全
-    event.data.fd = timer_queue_->timer_fd();
-    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, timer_queue_->timer_fd(), &event) == -1) {
-        LOG_ERROR("将定时器文件描述符加入epoll失败: {}", strerror(errno));
+    if (!backend_->watch(mailbox_.event_fd(), [this]() { mailbox_.drain(); })) {
         return false;
     }
     initialized_ = true;
-    LOG_INFO("并发K/V服务器启动成功，监听端口：{}", port_);
+    LOG_INFO("并发K/V服务器启动成功，监听端口：{}，事件循环 #{}，事件后端: {}", port_, loop_index_,
+             backend_->name());
     return true;
 }
 // 运行服务器
 void EpollServer::run() {
-    std::vector<epoll_event> events(MAX_EVENTS); // 用于接收就绪事件
     LOG_INFO("服务器开始运行");
-    while(true){
-        // 阻塞程序，直到有事件发生或者超时,n为就绪事件的数量
-        int n = epoll_wait(epoll_fd_, events.data(), MAX_EVENTS, -1);
-        if (n == -1) {
-            if(errno == EINTR) continue; // 若是被信号中断,继续循环
-            LOG_ERROR("epoll_wait错误: {}", strerror(errno));
-            break;
-        }
-        // 遍历所有就绪事件
-        for (int i = 0; i < n; ++i) {
-            int fd = events[i].data.fd;
-            // 判断就绪事件是否发生在监听socket上
-            if (fd == listen_fd_) {
-                handle_new_connection(); // 是则说明有新连接请求
-            } else if (fd == timer_queue_->timer_fd()) {
-                handle_timer_event();
-            } else {
-                handle_client_data(fd);//不是则说明已连接的客户端发来了数据
-            }
-        }
-    }
-    
+    backend_->run();
 }
 
 // 处理定时器事件
@@ -204,194 +319,122 @@ Timer *EpollServer::add_timer(std::chrono::milliseconds when, TimerCallback cb,
     return nullptr;
 }
 
-// 设置文件描述符为非阻塞
-bool EpollServer::set_non_blocking(int fd) {
-    int flags = fcntl(fd, F_GETFL, 0); // 获得fd当前的状态标志
-    if (flags == -1) {
-        LOG_ERROR("设置非阻塞模式失败(F_GETFL): {}", strerror(errno));
-        return false;
-    }
-    // 设置fd为非阻塞
-    if (fcntl(fd, F_SETFL, flags | O_NONBLOCK) == -1) {
-        LOG_ERROR("设置非阻塞模式失败(F_SETFL): {}", strerror(errno));
-        return false;
-    }
-    return true;
-}
-// 处理新连接
-void EpollServer::handle_new_connection() {
-    // ET 模式下，多个连接到来时，epoll 可能只通知一次。
-    // 所以必须用循环把所有等待的连接都 accept 掉。
-    while (true) {
-        // 接受新连接
-        sockaddr_in client_addr;
-        socklen_t client_len = sizeof(client_addr);
-        int conn_fd = accept(listen_fd_, (sockaddr *)&client_addr, &client_len);
-        if (conn_fd == -1) {
-            // 如果 errno 是 EAGAIN 或 EWOULDBLOCK，说明所有等待的连接都已处理完毕
-            if (errno == EAGAIN || errno == EWOULDBLOCK)
-                break;
-            // 其他错误则打印并退出
-            LOG_ERROR("接受连接失败: {}", strerror(errno));
-            break;
-        }
-
-        // 将新连接也设置为非阻塞模式
-        set_non_blocking(conn_fd);
-
-        // 准备新连接的 epoll 事件
-        epoll_event event;
-        event.events = EPOLLIN | EPOLLET; // 同样关心可读事件和使用 ET 模式
-        event.data.fd = conn_fd;
-
-        // 获取客户端IP地址
-        char client_ip[INET_ADDRSTRLEN];
+// 新连接建立
+void EpollServer::on_accept(int fd) {
+    // 获取客户端IP地址
+    sockaddr_in client_addr;
+    socklen_t client_len = sizeof(client_addr);
+    char client_ip[INET_ADDRSTRLEN] = "?";
+    int client_port = 0;
+    if (getpeername(fd, (sockaddr *)&client_addr, &client_len) == 0) {
         inet_ntop(AF_INET, &(client_addr.sin_addr), client_ip, INET_ADDRSTRLEN);
-        int client_port = ntohs(client_addr.sin_port);
-
-        // 将新连接的文件描述符添加到 epoll 的监控中
-        if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, conn_fd, &event) == -1) {
-            LOG_ERROR("将客户端 {} 加入epoll失败: {}", conn_fd, strerror(errno));
-            close(conn_fd); // 添加失败，关闭这个连接
-        } else {
-            LOG_INFO("新客户端连接: #{} 来自 {}:{}", conn_fd, client_ip, client_port);
-            // 为这个新客户端在 map 中创建一个专属的 Buffer 对象
-            connections_[conn_fd];
-            kv_server_.increment_clients();
-        }
+        client_port = ntohs(client_addr.sin_port);
     }
+    LOG_INFO("新客户端连接: #{} 来自 {}:{}", fd, client_ip, client_port);
+    // 关闭 Nagle 算法：跨分片回复到达后补发的一小段回复不能等对端的延迟确认
+    int nodelay = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+    // 为这个新客户端在 map 中创建一个专属的连接对象
+    connections_[fd].id = next_conn_id_++;
+    kv_server_.increment_clients();
 }
-// 关闭客户端连接
-void EpollServer::close_client_connection(int client_fd) {
-    epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, client_fd, nullptr);
-    close(client_fd);
-    connections_.erase(client_fd);
-    kv_server_.decrement_clients();
+
+// 获取客户端的输入缓冲区
+Buffer *EpollServer::input_buffer(int fd) {
+    auto it = connections_.find(fd);
+    return it == connections_.end() ? nullptr : &it->second.buffer;
 }
 
 // 处理客户端数据
-void EpollServer::handle_client_data(int client_fd) {
-    // 找到客户端的缓冲区
-    auto it = connections_.find(client_fd);
+void EpollServer::on_input(int fd) {
+    auto it = connections_.find(fd);
     if (it == connections_.end()) {
-        LOG_WARN("客户端 #{} 未找到对应的缓冲区", client_fd);
+        LOG_WARN("客户端 #{} 未找到对应的连接", fd);
         return;
     }
-    TcpConnection &conn = it->second; // 直接获取连接对象
+    // 暂停期间后端停止读取，缓冲区最多多出已经在途的一次读取；超过硬上限说明客户端异常，直接关闭
+    if (it->second.buffer.readable_bytes() > MAX_QUERY_BUFFER) {
+        LOG_WARN("客户端 #{} 的输入缓冲区超过上限 {} 字节，关闭连接", fd, MAX_QUERY_BUFFER);
+        close_client_connection(fd);
+        return;
+    }
+    process_input(fd, it->second);
+}
 
-    int saved_errno = 0;
-    ssize_t n = conn.buffer.read_fd(client_fd, &saved_errno);
+// 连接是否继续接收输入
+bool EpollServer::accepts_input(int fd) {
+    auto it = connections_.find(fd);
+    return it != connections_.end() && !parsing_paused(it->second);
+}
 
-    if (n == 0) {
-        // 客户端关闭连接
-        LOG_INFO("客户端 #{} 断开连接", client_fd);
-        close_client_connection(client_fd);
-        return;
+// 对端关闭或读写出错
+void EpollServer::on_peer_closed(int fd, int err) {
+    if (err == 0) {
+        LOG_INFO("客户端 #{} 断开连接", fd);
+    } else {
+        LOG_ERROR("客户端 #{} 读写数据失败: {}", fd, strerror(err));
     }
-    if (n < 0) {
-        // 读取出错
-        if (saved_errno != EAGAIN && saved_errno != EWOULDBLOCK) {
-            LOG_ERROR("读取客户端 #{} 数据失败: {}", client_fd, strerror(saved_errno));
-            close_client_connection(client_fd);
+    close_client_connection(fd);
+}
+
+// 关闭客户端连接
+void EpollServer::close_client_connection(int client_fd) {
+    // 挂起中的客户端从等待队列中移除。等待队列在其他分片时取消请求经邮箱送达，
+    // 在此之前元素已被弹出的话，回复会因连接已关闭而被丢弃
+    if (auto it = connections_.find(client_fd); it != connections_.end() && it->second.blocked_shard) {
+        BlockedClientKey key{this, it->second.id};
+        EpollServer *owner = shard_server(*it->second.blocked_shard);
+        if (owner == this) {
+            cancel_blocked_client(key);
+        } else {
+            owner->post([owner, key]() { owner->cancel_blocked_client(key); });
         }
-        return;
     }
-    LOG_DEBUG("从客户端 #{} 读取了 {} 字节数据", client_fd, n);
-    // 循环地从缓冲区中解析完整的RESP消息
-    while (conn.buffer.readable_bytes() > 0) {
-        // 创建一个临时的 string_view 用于解析，因为它会被 resp::parse 修改
-        auto readable_view = conn.buffer.readable_view();
-        auto result = resp::parse(readable_view);
+    backend_->close_connection(client_fd);
+    connections_.erase(client_fd);
+    kv_server_.decrement_clients();
+}
 
-        if (result.has_value()) {
-            // 解析成功，从原始缓冲区中“消费”掉已处理的数据
-            // 注意：这里不再是昂贵的 erase，而是简单的索引移动
-            conn.buffer.retrieve(conn.buffer.readable_view().size() - readable_view.size());
-            // 记录命令执行日志
-            // 修正：检查是否为数组类型，然后获取第一个元素
-            if (std::holds_alternative<std::unique_ptr<resp::RespArray>>(result.value())) {
-                auto &arr = std::get<std::unique_ptr<resp::RespArray>>(result.value());
-                if (!arr->values.empty() && std::holds_alternative<resp::RespBulkString>(arr->values[0])) {
-                    auto &cmd = std::get<resp::RespBulkString>(arr->values[0]);
-                    if (cmd.value) {
-                        LOG_INFO("客户端 #{} 执行命令: '{}'", client_fd, *cmd.value);
-                    }
-                }
-            }
+// 循环地从缓冲区中解析完整的RESP消息并执行
+void EpollServer::process_input(int client_fd, TcpConnection &conn) {
+    // 普通命令转发到其他分片后继续解析，回复按请求顺序排队写出；事务、阻塞命令等需要等待转发的
+    // 命令返回时暂停解析。等待回复的命令过多、或客户端读取过慢导致回复积压时同样暂停，之后再继续
+    while (!parsing_paused(conn) && conn.buffer.readable_bytes() > 0) {
+        // 参数直接指向输入缓冲区，不拷贝数据；请求不完整时解析器从上次的断点继续
+        auto result = conn.parser.parse(conn.buffer.readable_view(), conn.argv);
 
-            // 处理命令
-            std::string response;
-            // 检查是否是事务相关命令或者在事务中
-            if (std::holds_alternative<std::unique_ptr<resp::RespArray>>(result.value())) {
-                auto &arr = std::get<std::unique_ptr<resp::RespArray>>(result.value());
-                if (!arr->values.empty() && std::holds_alternative<resp::RespBulkString>(arr->values[0])) {
-                auto &cmd = std::get<resp::RespBulkString>(arr->values[0]);
-                if (cmd.value) {
-                    std::string cmd_str = *cmd.value;
-                    // 转换为大写进行比较
-                    std::string cmd_upper;
-                    cmd_upper.reserve(cmd_str.length());
-                    for (char c : cmd_str) {
-                        cmd_upper += std::toupper(c);
+        if (result.has_value()) {
+            // 先执行命令再消费数据：执行期间参数视图必须保持有效
+            if (!conn.argv.empty()) {
+                // 每条命令只查一次命令表，事务控制命令也通过命令表识别
+                const CommandSpec *spec = lookup_command(conn.argv[0]);
+                if (conn.pending_replies.empty()) {
+                    process_command(client_fd, conn, spec, conn.argv.view(), conn.output);
+                } else if (can_pipeline(spec)) {
+                    // 前面还有跨分片回复未到达，本条命令的回复排在它们之后
+                    process_command(client_fd, conn, spec, conn.argv.view(), reply_scratch_);
+                    if (reply_scratch_.readable_bytes() > 0) {
+                        conn.pending_replies.emplace_back(std::string(reply_scratch_.readable_view()));
+                        reply_scratch_.retrieve_all();
                     }
-
-                    if (cmd_upper == "MULTI") {
-                    // 开始事务
-                    if (conn.state == ConnectionState::Normal) {
-                        conn.state = ConnectionState::InTransaction;
-                        conn.transaction_queue.clear();
-                        response = resp::serialize_ok();
-                        LOG_INFO("客户端 #{} 开启事务", client_fd);
-                    } else {
-                        response = resp::serialize_error("ERR MULTI calls can not be nested");
-                        }
-                    } else if (cmd_upper == "EXEC") {
-                        // 执行事务
-                        if (conn.state == ConnectionState::InTransaction) {
-                            // 执行所有队列中的命令
-                            LOG_INFO("客户端 #{} 执行事务，包含 {} 条命令", client_fd, conn.transaction_queue.size());
-                            response = kv_server_.execute_transaction(conn.transaction_queue);
-                            conn.state = ConnectionState::Normal;
-                            conn.transaction_queue.clear();
-                        } else {
-                            response = resp::serialize_error("ERR EXEC without MULTI");
-                        }
-                    } else if (cmd_upper == "DISCARD") {
-                    // 丢弃事务
-                    if (conn.state == ConnectionState::InTransaction) {
-                        conn.state = ConnectionState::Normal;
-                        conn.transaction_queue.clear();
-                        response = resp::serialize_ok();
-                        LOG_INFO("客户端 #{} 丢弃事务", client_fd);
-                    } else {
-                        response = resp::serialize_error("ERR DISCARD without MULTI");
-                        }
-                    } else if (conn.state == ConnectionState::InTransaction) {
-                        // 事务中的命令，加入队列而不是立即执行
-                        conn.transaction_queue.push_back(std::move(result.value()));
-                        response = resp::serialize_simple_string("QUEUED");
-                        LOG_DEBUG("客户端 #{} 在事务中排队命令", client_fd);
-                    } else {
-                        // 普通命令执行
-                        response = kv_server_.execute_command(result.value(), false);
-                        }
-                    } else {
-                        response = kv_server_.execute_command(result.value(), false);
-                        }
                 } else {
-                    response = kv_server_.execute_command(result.value(), false);
-                    }
-            } else {
-                response = kv_server_.execute_command(result.value(), false);
+                    // 请求留在缓冲区中，之前转发的命令都返回后重新解析
+                    conn.awaiting_reply = true;
+                    break;
                 }
-
-            write(client_fd, response.c_str(), response.length());
-
+            }
+            // 从原始缓冲区中“消费”掉已处理的数据，只是简单的索引移动
+            conn.buffer.retrieve(*result);
         } else {
             // 解析失败
             const auto &error = result.error();
             if (error == resp::ParseError::Incomplete) {
-                // 数据不完整，说明需要等待更多网络数据，直接跳出循环
+                // 数据不完整，说明需要等待更多网络数据，直接跳出循环。
+                // 已经读到参数长度时按长度一次预留空间，大参数只需拷贝一次
+                size_t expected = conn.parser.expected_size();
+                if (expected > conn.buffer.readable_bytes()) {
+                    conn.buffer.reserve_writable(expected - conn.buffer.readable_bytes());
+                }
                 LOG_DEBUG("客户端 #{} 数据不完整，等待更多数据", client_fd);
                 break;
             } else {
@@ -411,8 +454,9 @@ void EpollServer::handle_client_data(int client_fd) {
                     break;
                 }
                 LOG_ERROR("客户端 #{} 协议错误: {}", client_fd, err_msg);
-                std::string serialized_err = resp::serialize_error(err_msg);
-                write(client_fd, serialized_err.c_str(), serialized_err.length());
+                // 尽力发送之前的回复和错误信息，连接随后关闭
+                resp::write_error(conn.output, err_msg);
+                backend_->send(client_fd, conn.output);
 
                 // 出于健壮性考虑，协议错误后关闭连接
                 close_client_connection(client_fd);
@@ -420,4 +464,555 @@ void EpollServer::handle_client_data(int client_fd) {
             }
         }
     }
-}
\ No newline at end of file
+    post_forward_batches(client_fd, conn);
+    bool output_full = conn.output.readable_bytes() >= OUTPUT_HIGH_WATERMARK;
+    // 本轮产生的所有回复一次性写出
+    if (!flush_output(client_fd, conn)) {
+        return;
+    }
+    // 因回复积压暂停、但已全部或大部分写出时不会再有可写通知，剩余的请求留到等待事件之前继续处理
+    if (output_full && !parsing_paused(conn) && conn.buffer.readable_bytes() > 0) {
+        deferred_clients_.emplace_back(client_fd, conn.id);
+    }
+    resume_input(client_fd, conn);
+}
+
+bool EpollServer::parsing_paused(const TcpConnection &conn) {
+    return conn.awaiting_reply || conn.output.readable_bytes() >= OUTPUT_HIGH_WATERMARK ||
+           conn.pending_replies.size() >= MAX_PENDING_REPLIES;
+}
+
+void EpollServer::resume_input(int client_fd, const TcpConnection &conn) {
+    if (!parsing_paused(conn)) {
+        backend_->resume_reading(client_fd);
+    }
+}
+
+// 将输出缓冲区交给事件后端发送
+bool EpollServer::flush_output(int client_fd, TcpConnection &conn) {
+    if (!backend_->send(client_fd, conn.output)) {
+        close_client_connection(client_fd);
+        return false;
+    }
+    return true;
+}
+
+// 之前积压的数据已发送完毕
+void EpollServer::on_writable(int client_fd) {
+    auto it = connections_.find(client_fd);
+    if (it == connections_.end()) {
+        return; // 连接已在本轮的读事件处理中关闭
+    }
+    TcpConnection &conn = it->second;
+    if (!flush_output(client_fd, conn)) {
+        return;
+    }
+    // 积压的回复已发送完，继续处理因背压暂停的输入，并恢复读取
+    if (conn.output.readable_bytes() == 0 && conn.buffer.readable_bytes() > 0) {
+        process_input(client_fd, conn);
+    } else {
+        resume_input(client_fd, conn);
+    }
+}
+
+// 等待事件前唤醒就绪键上的客户端并继续处理有积压输入的连接（含被唤醒的客户端），
+// 然后执行键空间的周期性短任务（渐进式扩容、快速过期周期）
+void EpollServer::before_wait() {
+    serve_ready_keys();
+    while (!deferred_clients_.empty()) {
+        for (auto [client_fd, conn_id] : std::exchange(deferred_clients_, {})) {
+            auto it = connections_.find(client_fd);
+            if (it != connections_.end() && it->second.id == conn_id) {
+                process_input(client_fd, it->second);
+            }
+        }
+    }
+    kv_server_.before_wait();
+}
+
+// 处理一条命令
+void EpollServer::process_command(int client_fd, TcpConnection &conn, const CommandSpec *spec,
+                                  std::span<const std::string_view> argv, Buffer &out) {
+    LOG_DEBUG("客户端 #{} 执行命令: '{}'", client_fd, argv[0]);
+    auto is = [spec](CommandId id) { return spec && spec->id == id; };
+
+    if (is(CommandId::Multi)) {
+        // 开始事务
+        if (conn.state == ConnectionState::Normal) {
+            conn.state = ConnectionState::InTransaction;
+            conn.transaction_queue.clear();
+            LOG_INFO("客户端 #{} 开启事务", client_fd);
+            resp::write_ok(out);
+            return;
+        }
+        resp::write_error(out, "ERR MULTI calls can not be nested");
+        return;
+    }
+    if (is(CommandId::Exec)) {
+        // 执行事务
+        if (conn.state != ConnectionState::InTransaction) {
+            resp::write_error(out, "ERR EXEC without MULTI");
+            return;
+        }
+        LOG_INFO("客户端 #{} 执行事务，包含 {} 条命令", client_fd, conn.transaction_queue.size());
+        auto queue = std::move(conn.transaction_queue);
+        conn.state = ConnectionState::Normal;
+        conn.transaction_queue.clear();
+
+        // 事务中的所有键必须属于同一个分片，才能在该分片上原子执行
+        std::optional<size_t> target;
+        resp::RequestArgv queued_argv;
+        for (const auto &queued : queue) {
+            queued_argv.assign(queued);
+            const CommandSpec *queued_spec = lookup_command(queued_argv[0]);
+            if (!KVServer::routing_key(queued_spec, queued_argv.view())) {
+                continue;
+            }
+            auto shard = shard_for(queued_spec, queued_argv.view());
+            if (!shard || (target && *target != *shard)) {
+                resp::write_error(out, "CROSSSLOT Keys in request don't hash to the same slot");
+                return;
+            }
+            target = shard;
+        }
+        if (!target || *target == loop_index_) {
+            kv_server_.execute_transaction(queue, out);
+            serve_ready_keys();
+            return;
+        }
+        auto shared_queue = std::make_shared<std::vector<std::vector<std::string>>>(std::move(queue));
+        forward_to_shard(client_fd, conn, *target,
+                         [shared_queue](KVServer &kv) { return kv.execute_transaction(*shared_queue); });
+        return;
+    }
+    if (is(CommandId::Discard)) {
+        // 丢弃事务
+        if (conn.state == ConnectionState::InTransaction) {
+            conn.state = ConnectionState::Normal;
+            conn.transaction_queue.clear();
+            LOG_INFO("客户端 #{} 丢弃事务", client_fd);
+            resp::write_ok(out);
+            return;
+        }
+        resp::write_error(out, "ERR DISCARD without MULTI");
+        return;
+    }
+    if (conn.state == ConnectionState::InTransaction) {
+        // 事务中的命令，拷贝后加入队列而不是立即执行
+        conn.transaction_queue.push_back(resp::to_owned(argv));
+        LOG_DEBUG("客户端 #{} 在事务中排队命令", client_fd);
+        out.append(resp::shared::QUEUED);
+        return;
+    }
+
+    if (is(CommandId::Info) && shard_group_.size() > 1) {
+        gather_info(client_fd, conn);
+        return;
+    }
+
+    // 阻塞命令在键所属的分片上执行，没有数据时客户端挂起在该分片的等待队列中，
+    // 期间不再解析该连接的后续命令，直到被唤醒或超时。事务中的阻塞命令已在上面排队，执行时不会阻塞
+    if (spec && spec->has_flag(CMD_BLOCKING)) {
+        auto shard = shard_for(spec, argv);
+        if (!shard) {
+            resp::write_error(out, "CROSSSLOT Keys in request don't hash to the same slot");
+            return;
+        }
+        if (*shard == loop_index_) {
+            if (!execute_blocking(this, client_fd, conn.id, argv, out)) {
+                conn.awaiting_reply = true;
+                conn.blocked_shard = *shard;
+            }
+            return;
+        }
+        conn.awaiting_reply = true;
+        conn.blocked_shard = *shard;
+        EpollServer *origin = this;
+        EpollServer *owner = shard_group_[*shard];
+        uint64_t conn_id = conn.id;
+        auto shared_command = std::make_shared<std::vector<std::string>>(resp::to_owned(argv));
+        owner->post([origin, owner, client_fd, conn_id, shared_command]() {
+            resp::RequestArgv forwarded;
+            forwarded.assign(*shared_command);
+            Buffer reply;
+            if (owner->execute_blocking(origin, client_fd, conn_id, forwarded.view(), reply)) {
+                origin->post([origin, client_fd, conn_id, response = std::string(reply.readable_view())]() {
+                    origin->unblock_client(client_fd, conn_id, response);
+                });
+            }
+        });
+        return;
+    }
+
+    // 普通命令执行：键属于本分片则直接在参数视图上执行，否则拷贝参数后转发给所属分片。
+    // 多键命令只能在一个分片上执行，键分布在不同分片时拒绝
+    auto shard = shard_for(spec, argv);
+    if (!shard) {
+        resp::write_error(out, "CROSSSLOT Keys in request don't hash to the same slot");
+        return;
+    }
+    // 无键的全分片命令（如 FLUSHALL）统一交给事件循环 #0 执行
+    if (spec && spec->has_flag(CMD_ALL_SHARDS) && shard_group_.size() > 1) {
+        if (loop_index_ == 0) {
+            run_on_all_shards(argv, out);
+            return;
+        }
+        EpollServer *coordinator = shard_group_[0];
+        auto shared_command = std::make_shared<std::vector<std::string>>(resp::to_owned(argv));
+        forward_to_shard(client_fd, conn, 0, [coordinator, shared_command](KVServer &) {
+            resp::RequestArgv forwarded;
+            forwarded.assign(*shared_command);
+            Buffer reply;
+            coordinator->run_on_all_shards(forwarded.view(), reply);
+            return std::string(reply.readable_view());
+        });
+        return;
+    }
+    if (*shard == loop_index_) {
+        kv_server_.execute_command(spec, argv, out);
+        serve_ready_keys();
+        return;
+    }
+    queue_forward(conn, *shard, argv);
+}
+
+bool EpollServer::can_pipeline(const CommandSpec *spec) {
+    if (!spec) {
+        return true; // 未知命令只回复错误
+    }
+    if (spec->id == CommandId::Multi || spec->id == CommandId::Exec || spec->id == CommandId::Discard ||
+        spec->id == CommandId::Info) {
+        return false;
+    }
+    return !spec->has_flag(CMD_BLOCKING) && !spec->has_flag(CMD_ALL_SHARDS);
+}
+
+// 计算命令所属的分片
+std::optional<size_t> EpollServer::shard_for(const CommandSpec *spec, std::span<const std::string_view> argv) const {
+    if (shard_group_.size() <= 1 || !spec) {
+        return loop_index_;
+    }
+    if (spec->has_flag(CMD_SHARD_CURSOR)) {
+        // 游标中编码了分片号；游标无效时在本分片执行并报错
+        auto shard = argv.size() > 1 ? KVServer::cursor_shard(argv[1], shard_group_.size()) : std::nullopt;
+        return shard.value_or(loop_index_);
+    }
+    std::optional<size_t> shard;
+    bool cross_shard = false;
+    for_each_key(*spec, argv, [&](std::string_view key) {
+        size_t s = KVServer::shard_of(key, shard_group_.size());
+        cross_shard = cross_shard || (shard && *shard != s);
+        shard = s;
+    });
+    if (cross_shard) {
+        return std::nullopt;
+    }
+    return shard.value_or(loop_index_);
+}
+
+// 全分片命令只写一条 AOF 记录，重放时在每个分片上执行。为了让每个分片上这条记录与其他写入的先后
+// 和实际执行的先后一致，命令以屏障方式执行：其余事件循环处理完邮箱中排在前面的任务后停在屏障任务中，
+// 全部到达后由本线程依次在所有分片上执行命令，执行完再放行。停下之前各分片执行的写入都已写入 AOF，
+// 放行之后的写入排在这条记录之后。屏障只由事件循环 #0 发起，不会有两个屏障互相等待
+void EpollServer::run_on_all_shards(std::span<const std::string_view> argv, Buffer &out) {
+    struct Barrier {
+        std::mutex mutex;
+        std::condition_variable cv;
+        size_t arrived = 0;
+        bool released = false;
+    };
+    auto barrier = std::make_shared<Barrier>();
+    for (size_t i = 1; i < shard_group_.size(); ++i) {
+        shard_group_[i]->post([barrier]() {
+            std::unique_lock<std::mutex> lock(barrier->mutex);
+            ++barrier->arrived;
+            barrier->cv.notify_all();
+            barrier->cv.wait(lock, [&barrier]() { return barrier->released; });
+        });
+    }
+    {
+        std::unique_lock<std::mutex> lock(barrier->mutex);
+        barrier->cv.wait(lock, [this, &barrier]() { return barrier->arrived + 1 == shard_group_.size(); });
+    }
+    // 其余分片的线程都停在屏障中，互斥锁保证它们之前的修改在这里可见；
+    // 它们不再写 AOF 也不计入命令数
+    size_t reply_offset = out.readable_bytes();
+    kv_server_.execute_command(argv, out);
+    if (out.readable_view()[reply_offset] != '-') {
+        for (size_t i = 1; i < shard_group_.size(); ++i) {
+            shard_group_[i]->kv_server_.execute_command(argv, true);
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(barrier->mutex);
+        barrier->released = true;
+    }
+    barrier->cv.notify_all();
+}
+
+// 将任务转发到目标分片。任务在目标事件循环的线程上执行，
+// 结果再以消息的形式投递回本事件循环，整个过程不对键空间加锁
+void EpollServer::forward_to_shard(int client_fd, TcpConnection &conn, size_t shard, ShardJob job) {
+    conn.awaiting_reply = true;
+    EpollServer *origin = this;
+    EpollServer *target = shard_group_[shard];
+    uint64_t conn_id = conn.id;
+    LOG_DEBUG("客户端 #{} 的命令转发到分片 #{}", client_fd, shard);
+    target->post([origin, target, client_fd, conn_id, job = std::move(job)]() {
+        std::string response = job(target->kv_server_);
+        target->serve_ready_keys();
+        origin->post([origin, client_fd, conn_id, response = std::move(response)]() {
+            origin->deliver_reply(client_fd, conn_id, response);
+        });
+    });
+}
+
+// 每个分片在自己的线程上生成快照并送回本事件循环，汇总状态只在本线程上读写，
+// 不需要加锁。统计计数都是各分片独占的普通整数，只有 INFO 时才相加
+void EpollServer::gather_info(int client_fd, TcpConnection &conn) {
+    struct InfoGather {
+        ShardInfo total;
+        size_t remaining;
+    };
+    conn.awaiting_reply = true;
+    kv_server_.increment_commands_processed();
+    auto gather = std::make_shared<InfoGather>(InfoGather{kv_server_.info_snapshot(), shard_group_.size() - 1});
+    EpollServer *origin = this;
+    uint64_t conn_id = conn.id;
+    for (size_t i = 0; i < shard_group_.size(); ++i) {
+        if (i == loop_index_) {
+            continue;
+        }
+        EpollServer *target = shard_group_[i];
+        target->post([origin, target, client_fd, conn_id, gather]() {
+            origin->post([origin, client_fd, conn_id, gather, info = target->kv_server_.info_snapshot()]() {
+                gather->total.stats.merge(info.stats);
+                gather->total.keyspace.merge(info.keyspace);
+                if (--gather->remaining > 0) {
+                    return;
+                }
+                Buffer reply;
+                resp::write_bulk_string(reply, gather->total.stats.get_info(gather->total.keyspace));
+                origin->deliver_reply(client_fd, conn_id, std::string(reply.readable_view()));
+            });
+        });
+    }
+}
+
+// 跨分片回复到达
+void EpollServer::deliver_reply(int client_fd, uint64_t conn_id, const std::string &response) {
+    auto it = connections_.find(client_fd);
+    if (it == connections_.end() || it->second.id != conn_id) {
+        LOG_DEBUG("客户端 #{} 已断开，丢弃跨分片回复", client_fd);
+        return;
+    }
+    TcpConnection &conn = it->second;
+    conn.output.append(response);
+    conn.awaiting_reply = false;
+    // 继续处理等待期间积压的命令，连同这条回复一起写出
+    process_input(client_fd, conn);
+}
+
+void EpollServer::queue_forward(TcpConnection &conn, size_t shard, std::span<const std::string_view> argv) {
+    if (conn.forward_batches.size() < shard_group_.size()) {
+        conn.forward_batches.resize(shard_group_.size());
+    }
+    ForwardBatch &batch = conn.forward_batches[shard];
+    batch.commands.push_back(resp::to_owned(argv));
+    batch.slots.push_back(conn.pending_base + conn.pending_replies.size());
+    conn.pending_replies.emplace_back();
+}
+
+// 同一批次在目标分片上连续执行，回复拼接成一个字符串送回，每批只经过两次邮箱。
+// 邮箱按投递顺序执行任务，同一连接发往同一分片的命令保持请求顺序；发往不同分片的命令之间不保证执行顺序
+void EpollServer::post_forward_batches(int client_fd, TcpConnection &conn) {
+    for (size_t shard = 0; shard < conn.forward_batches.size(); ++shard) {
+        ForwardBatch &batch = conn.forward_batches[shard];
+        if (batch.commands.empty()) {
+            continue;
+        }
+        LOG_DEBUG("客户端 #{} 的 {} 条命令转发到分片 #{}", client_fd, batch.commands.size(), shard);
+        EpollServer *origin = this;
+        EpollServer *target = shard_group_[shard];
+        uint64_t conn_id = conn.id;
+        target->post([origin, target, client_fd, conn_id, batch = std::exchange(batch, {})]() mutable {
+            Buffer out;
+            std::vector<size_t> ends;
+            ends.reserve(batch.commands.size());
+            resp::RequestArgv forwarded;
+            for (const auto &command : batch.commands) {
+                forwarded.assign(command);
+                target->kv_server_.execute_command(forwarded.view(), out);
+                ends.push_back(out.readable_bytes());
+            }
+            target->serve_ready_keys();
+            origin->post([origin, client_fd, conn_id, slots = std::move(batch.slots),
+                          replies = std::string(out.readable_view()), ends = std::move(ends)]() {
+                origin->deliver_replies(client_fd, conn_id, slots, replies, ends);
+            });
+        });
+    }
+}
+
+void EpollServer::deliver_replies(int client_fd, uint64_t conn_id, const std::vector<uint64_t> &slots,
+                                  const std::string &replies, const std::vector<size_t> &ends) {
+    auto it = connections_.find(client_fd);
+    if (it == connections_.end() || it->second.id != conn_id) {
+        LOG_DEBUG("客户端 #{} 已断开，丢弃跨分片回复", client_fd);
+        return;
+    }
+    TcpConnection &conn = it->second;
+    size_t begin = 0;
+    for (size_t i = 0; i < slots.size(); ++i) {
+        conn.pending_replies[slots[i] - conn.pending_base] = replies.substr(begin, ends[i] - begin);
+        begin = ends[i];
+    }
+    // 按请求顺序写出队首已就绪的回复
+    while (!conn.pending_replies.empty() && conn.pending_replies.front()) {
+        conn.output.append(*conn.pending_replies.front());
+        conn.pending_replies.pop_front();
+        ++conn.pending_base;
+    }
+    if (conn.pending_replies.empty()) {
+        conn.awaiting_reply = false; // 暂停解析的命令在等待之前转发的命令，现在可以执行了
+    }
+    // 继续处理等待期间积压的命令，连同这些回复一起写出
+    process_input(client_fd, conn);
+}
+
+// 执行阻塞命令，没有数据时挂起客户端
+bool EpollServer::execute_blocking(EpollServer *origin, int client_fd, uint64_t conn_id,
+                                   std::span<const std::string_view> argv, Buffer &out) {
+    size_t reply_offset = out.readable_bytes();
+    kv_server_.execute_command(argv, out);
+    const auto &request = kv_server_.block_request();
+    if (!request) {
+        serve_ready_keys(); // BLMOVE 压入的目标键上可能有客户端在等待
+        return true;
+    }
+
+    // 处理函数写出的是超时时的空回复，先收起来，挂起期间不发送
+    auto client = std::make_unique<BlockedClient>();
+    client->origin = origin;
+    client->fd = client_fd;
+    client->conn_id = conn_id;
+    client->block_id = next_block_id_++;
+    client->argv = resp::to_owned(argv);
+    client->keys = request->keys;
+    client->timeout_reply = std::string(out.readable_view().substr(reply_offset));
+    out.unwrite(out.readable_bytes() - reply_offset);
+    for (const auto &key : client->keys) {
+        WaitQueue &queue = wait_queues_[key];
+        if (queue.empty()) {
+            kv_server_.watch_blocking_key(key);
+        }
+        client->positions.push_back(queue.insert(queue.end(), client.get()));
+    }
+    BlockedClientKey key{origin, conn_id};
+    if (request->timeout.count() > 0) {
+        uint64_t block_id = client->block_id;
+        client->timer = timer_queue_->add_timer(request->timeout,
+                                                [this, key, block_id]() { timeout_blocked_client(key, block_id); });
+    }
+    LOG_DEBUG("客户端 #{} 阻塞在 {} 个键上，超时 {} 毫秒", client_fd, client->keys.size(), request->timeout.count());
+    kv_server_.increment_blocked_clients();
+    blocked_clients_[key] = std::move(client);
+    return false;
+}
+
+// 唤醒就绪键上的客户端。被唤醒的命令（如 BLMOVE）又可能让其他键就绪，处理到没有新的就绪键为止
+void EpollServer::serve_ready_keys() {
+    while (kv_server_.has_ready_keys()) {
+        for (const auto &key : kv_server_.take_ready_keys()) {
+            auto queue = wait_queues_.find(key);
+            while (queue != wait_queues_.end()) {
+                BlockedClient *client = queue->second.front();
+                resp::RequestArgv argv;
+                argv.assign(client->argv);
+                Buffer reply;
+                kv_server_.execute_command(argv.view(), reply);
+                if (kv_server_.block_request()) {
+                    break; // 键又被取空，其余客户端继续等待
+                }
+                auto served = unpark(client);
+                reply_blocked_client(*served, reply.readable_view());
+                queue = wait_queues_.find(key);
+            }
+        }
+    }
+}
+
+// 从等待队列中摘下客户端
+std::unique_ptr<EpollServer::BlockedClient> EpollServer::unpark(BlockedClient *client) {
+    for (size_t i = 0; i < client->keys.size(); ++i) {
+        auto queue = wait_queues_.find(client->keys[i]);
+        queue->second.erase(client->positions[i]);
+        if (queue->second.empty()) {
+            kv_server_.unwatch_blocking_key(queue->first);
+            wait_queues_.erase(queue);
+        }
+    }
+    if (client->timer) {
+        timer_queue_->cancel_timer(client->timer);
+    }
+    kv_server_.decrement_blocked_clients();
+    auto it = blocked_clients_.find({client->origin, client->conn_id});
+    auto owned = std::move(it->second);
+    blocked_clients_.erase(it);
+    return owned;
+}
+
+// 阻塞超时
+void EpollServer::timeout_blocked_client(BlockedClientKey key, uint64_t block_id) {
+    auto it = blocked_clients_.find(key);
+    if (it == blocked_clients_.end() || it->second->block_id != block_id) {
+        return;
+    }
+    it->second->timer = nullptr; // 定时器正在执行，不需要取消
+    auto client = unpark(it->second.get());
+    LOG_DEBUG("客户端 #{} 阻塞超时", client->fd);
+    reply_blocked_client(*client, client->timeout_reply);
+}
+
+// 挂起的客户端已断开
+void EpollServer::cancel_blocked_client(BlockedClientKey key) {
+    if (auto it = blocked_clients_.find(key); it != blocked_clients_.end()) {
+        LOG_DEBUG("客户端 #{} 断开，取消阻塞", it->second->fd);
+        unpark(it->second.get());
+    }
+}
+
+// 回复被唤醒或超时的客户端
+void EpollServer::reply_blocked_client(const BlockedClient &client, std::string_view reply) {
+    if (client.origin == this) {
+        unblock_client(client.fd, client.conn_id, reply);
+        return;
+    }
+    EpollServer *origin = client.origin;
+    int client_fd = client.fd;
+    uint64_t conn_id = client.conn_id;
+    origin->post([origin, client_fd, conn_id, response = std::string(reply)]() {
+        origin->unblock_client(client_fd, conn_id, response);
+    });
+}
+
+// 写出阻塞命令的回复。唤醒可能发生在另一个连接的命令执行过程中，
+// 这里不递归处理被唤醒连接的输入，而是记下来在 before_wait 中处理
+void EpollServer::unblock_client(int client_fd, uint64_t conn_id, std::string_view reply) {
+    auto it = connections_.find(client_fd);
+    if (it == connections_.end() || it->second.id != conn_id) {
+        LOG_DEBUG("客户端 #{} 已断开，丢弃阻塞命令的回复", client_fd);
+        return;
+    }
+    TcpConnection &conn = it->second;
+    conn.output.append(reply);
+    conn.awaiting_reply = false;
+    conn.blocked_shard.reset();
+    if (conn.buffer.readable_bytes() > 0) {
+        deferred_clients_.emplace_back(client_fd, conn_id);
+    }
+    // 有积压输入时在 before_wait 中处理后恢复读取，否则现在恢复
+    if (flush_output(client_fd, conn) && conn.buffer.readable_bytes() == 0) {
+        resume_input(client_fd, conn);
+    }
+}
@@ -0,0 +1,57 @@
+module;
+
+#include <functional>
+
+export module event_backend;
+
+import buffer;
+
+// 可选的事件后端类型
+export enum class EventBackendType {
+    Epoll,  // epoll，所有 Linux 版本可用
+    IoUring // io_uring，需要内核支持 multishot 收发（6.0+）与 liburing
+};
+
+// 事件后端回调接口，由服务器实现。
+// 后端只负责网络 I/O，命令的解析与执行（命令路径）完全在服务器中，两种后端共用。
+export class ConnectionHandler {
+public:
+    virtual ~ConnectionHandler() = default;
+    // 新连接已建立
+    virtual void on_accept(int fd) = 0;
+    // 获取连接的输入缓冲区，后端将收到的数据追加到其中；连接不存在时返回 nullptr
+    virtual Buffer *input_buffer(int fd) = 0;
+    // 输入缓冲区中有新数据
+    virtual void on_input(int fd) = 0;
+    // 连接当前是否继续接收输入。服务器暂停解析（等待回复、输出积压等）时返回 false，
+    // 后端随即停止读取，直到服务器调用 EventBackend::resume_reading
+    virtual bool accepts_input(int fd) = 0;
+    // 对端关闭或读写出错（err 为 0 表示对端正常关闭），服务器应关闭该连接
+    virtual void on_peer_closed(int fd, int err) = 0;
+    // 之前未能发完的数据已发送完毕，可以继续发送或恢复解析
+    virtual void on_writable(int fd) = 0;
+    // 事件循环即将阻塞等待新事件，可在此执行耗时很短的周期性工作
+    virtual void before_wait() {}
+};
+
+// 事件后端接口：封装事件等待、接受连接、收发数据与关闭连接
+export class EventBackend {
+public:
+    virtual ~EventBackend() = default;
+    // 后端名称，用于日志
+    virtual const char *name() const = 0;
+    // 初始化后端并开始在 listen_fd 上接受新连接
+    virtual bool init(int listen_fd, ConnectionHandler &handler) = 0;
+    // 关注内部文件描述符（timerfd、eventfd）的可读事件，可读时调用回调，由回调负责读取
+    virtual bool watch(int fd, std::function<void()> on_readable) = 0;
+    // 发送 output 中的数据。后端可能取走全部或部分数据，其余留在 output 中，
+    // 待发送完成后通过 on_writable 通知；连接出错需要关闭时返回 false
+    virtual bool send(int fd, Buffer &output) = 0;
+    // 服务器恢复解析后调用：之前因 accepts_input 返回 false 而停止读取的连接重新开始读取，
+    // 期间到达的数据不会丢失；连接没有停止读取时不做任何事
+    virtual void resume_reading(int fd) = 0;
+    // 关闭连接；已被后端取走但尚未发出的数据会尽量先发送
+    virtual void close_connection(int fd) = 0;
+    // 运行事件循环，不返回
+    virtual void run() = 0;
+};
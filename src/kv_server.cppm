@@ -1,10 +1,14 @@
 module;
 
+#include <algorithm>
 #include <atomic>
 #include <cctype>
 #include <chrono>
+#include <cstdint>
 #include <format>
+#include <functional>
 #include <memory>
+#include <optional>
 #include <random>
 #include <span>
 #include <string>
@@ -21,20 +25,85 @@ import aof;    // 导入 AOF 模块
 import server_stat;
 import timer;
 import command;
+import info_command;
+import buffer;
+
+// 主动过期周期的类型
+export enum class ExpireCycleType {
+    Fast, // 每次事件循环等待前执行，只在上一周期未清理完时运行，耗时很短
+    Slow  // 定时器按 hz 频率驱动，时间预算为每秒 CPU 时间的一定百分比
+};
+
+// 主动过期配置
+export struct ActiveExpireConfig {
+    int hz = 10;          // 每秒执行慢周期的次数
+    int cpu_percent = 25; // 慢周期最多占用的 CPU 时间百分比
+};
+
+// 碎片整理配置
+export struct ActiveDefragConfig {
+    bool enabled = false;                  // 是否开启碎片整理
+    int threshold_lower = 10;              // 碎片率超过 1 + 该百分比时开始整理
+    size_t ignore_bytes = 8 * 1024 * 1024; // 碎片字节数（实际占用减去逻辑大小）低于该值时不整理
+    int cpu_percent = 25;                  // 整理最多占用的 CPU 时间百分比
+};
 
 export class KVServer {
 public:
     KVServer() {
         LOG_INFO("KV存储服务已初始化");
-        context_ = std::make_unique<KVServerContext>(db_, nullptr, stats_);
-        command_factory_ = std::make_unique<KVCommandFactory>(*context_);
+        context_ = std::make_unique<KVServerContext>(db_, expires_, nullptr, stats_);
     }
 
-    // 设置aof对象，更新上下文和命令工厂
+    // 设置aof对象，更新上下文
     void set_aof(Aof *aof) {
         aof_ = aof;
-        context_ = std::make_unique<KVServerContext>(db_, aof_, stats_);
-        command_factory_ = std::make_unique<KVCommandFactory>(*context_);
+        context_->set_aof(aof);
+    }
+
+    // 设置本分片在分片组中的编号和分片总数，SCAN 游标据此编码分片号
+    void set_shard(size_t index, size_t count) { context_->set_shard(index, count); }
+
+    // 设置惰性释放阈值（字节）：UNLINK、FLUSHDB/FLUSHALL ASYNC 和覆盖写入时，
+    // 不小于该大小的值或键空间交给后台线程释放
+    void set_lazyfree_threshold(size_t bytes) { context_->set_lazyfree_threshold(bytes); }
+
+    // 设置内存上限和淘汰策略。多分片时每个分片各自承担上限的一份
+    void set_maxmemory_config(const MaxmemoryConfig &config) { context_->set_maxmemory_config(config); }
+
+    // 设置各类型紧凑编码的转换阈值，只影响之后的写入
+    void set_encoding_config(const EncodingConfig &config) { context_->set_encoding_config(config); }
+
+    // 超过内存上限时按策略淘汰键，直到回到上限以下或本次的时间预算用尽，
+    // 预算用尽时剩余的淘汰留给事件循环空闲时继续。
+    // 返回 false 表示超过上限且没有可淘汰的键（或策略为 noeviction）
+    bool perform_evictions();
+
+    // 设置碎片整理配置，随时生效；关闭时中止正在进行的整理
+    void set_active_defrag_config(const ActiveDefragConfig &config) { defrag_config_ = config; }
+
+    // 执行一次碎片整理周期，由定时器驱动。碎片超过阈值时把占用率低的 slab 标记为清空，
+    // 之后每个周期在时间预算内扫描一段哈希表，把其中的条目搬到其他 slab，
+    // 被清空的 slab 随最后一个条目的搬出归还给系统。整理期间命令照常执行
+    void active_defrag_cycle();
+    bool active_defrag_running() const { return defrag_running_; }
+
+    // 设置主动过期配置，需在 set_timer_queue 之前调用
+    void set_active_expire_config(ActiveExpireConfig config) { expire_config_ = config; }
+
+    // 执行一次主动过期周期。迭代采样过期索引并删除过期键，
+    // 过期比例低于阈值或时间预算用尽时结束，不会长时间阻塞事件循环
+    void active_expire_cycle(ExpireCycleType type);
+
+    // 事件循环等待前执行的短任务：推进键空间的渐进式扩容，执行快速过期周期，写出本轮积压的 AOF
+    void before_wait() {
+        db_.update_clock();
+        db_.rehash_for(REHASH_BUDGET);
+        active_expire_cycle(ExpireCycleType::Fast);
+        perform_evictions();
+        if (aof_) {
+            aof_->flush_pending();
+        }
     }
 
     // 设置定时器队列
@@ -42,87 +111,249 @@ public:
         timer_queue_ = timer_queue;
         // 创建定期清理任务
         setup_expire_cleanup_task();
+        setup_defrag_task();
     }
 
-    // 暴露给外层网络库调用的静态方法
-    static void increment_clients() { stats_.increment_clients(); }
-    static void decrement_clients() { stats_.decrement_clients(); }
+    // 供外层网络库调用，只能在本分片的事件循环线程上调用
+    void increment_clients() { stats_.increment_clients(); }
+    void decrement_clients() { stats_.decrement_clients(); }
+    void increment_blocked_clients() { stats_.increment_blocked_clients(); }
+    void decrement_blocked_clients() { stats_.decrement_blocked_clients(); }
+    // 由连接层直接处理、不经过 execute_command 的命令（多分片时的 INFO）计入命令数
+    void increment_commands_processed() { stats_.increment_commands_processed(); }
+    // 本分片的统计信息和键空间信息快照，多分片时 INFO 在各分片上生成后汇总
+    ShardInfo info_snapshot() { return {stats_, keyspace_info(*context_)}; }
+
+    // --- 阻塞命令 ---
+    // 最近一条命令是否请求挂起客户端，以及等待的键和超时。连接层执行阻塞命令后读取
+    const std::optional<BlockRequest> &block_request() const { return context_->block_request(); }
+    // 键的等待队列变为非空和变空时由连接层调用，只有被关注的键在压入元素时记为就绪
+    void watch_blocking_key(std::string_view key) { context_->watch_blocking_key(key); }
+    void unwatch_blocking_key(std::string_view key) { context_->unwatch_blocking_key(key); }
+    bool has_ready_keys() const { return context_->has_ready_keys(); }
+    std::vector<std::string> take_ready_keys() { return context_->take_ready_keys(); }
+
+    // 按命令表中的键位置提取用于分片路由的键，无键命令（如 INFO）返回 nullopt
+    static std::optional<std::string_view> routing_key(std::span<const std::string_view> argv);
+    static std::optional<std::string_view> routing_key(const CommandSpec *spec, std::span<const std::string_view> argv);
+    static std::optional<std::string_view> routing_key(const resp::RespValue &command_variant);
+    // SCAN 游标所属的分片，游标无效时返回 nullopt
+    static std::optional<size_t> cursor_shard(std::string_view cursor, size_t shard_count) {
+        uint64_t value;
+        if (!parse_scan_cursor(cursor, value)) {
+            return std::nullopt;
+        }
+        return static_cast<size_t>(value % shard_count);
+    }
+    // 命令是否需要在所有分片上执行（无键的全分片命令，如 FLUSHALL）
+    static bool runs_on_all_shards(const resp::RespValue &command_variant);
+    // 计算键所属的分片编号。取哈希的高位做区间映射，
+    // 避免与存储内部按低位分桶的哈希表产生相关性
+    static size_t shard_of(std::string_view key, size_t shard_count) {
+        uint64_t h = std::hash<std::string_view>{}(key);
+        return static_cast<size_t>((static_cast<unsigned __int128>(h) * shard_count) >> 64);
+    }
 
-    // 主命令执行入口
-    std::string execute_command(const resp::RespValue &command_variant, bool from_aof = false) {
+    // 主命令执行入口，argv 包含命令名，参数视图只在本次调用期间使用。
+    // 回复直接写入 out（通常是连接的输出缓冲区），不产生临时字符串
+    void execute_command(std::span<const std::string_view> argv, Buffer &out, bool from_aof = false) {
         if (!from_aof) {
             stats_.increment_commands_processed();
         }
+        if (argv.empty()) {
+            LOG_WARN("收到空命令");
+            resp::write_error(out, "ERR unknown command 'empty_command'");
+            return;
+        }
+        dispatch(lookup_command(argv[0]), argv, out, from_aof);
+    }
 
-        // 创建命令
-        auto command = command_factory_->create_command(command_variant, from_aof);
+    // 调用方已查过命令表时使用，避免重复查找。spec 为空表示未知命令
+    void execute_command(const CommandSpec *spec, std::span<const std::string_view> argv, Buffer &out) {
+        stats_.increment_commands_processed();
+        dispatch(spec, argv, out, false);
+    }
 
-        // 执行命令
-        std::string result = command->execute();
+    // 返回字符串形式回复的版本，用于跨分片转发、AOF 重放和测试
+    std::string execute_command(std::span<const std::string_view> argv, bool from_aof = false) {
+        Buffer out;
+        execute_command(argv, out, from_aof);
+        return std::string(out.readable_view());
+    }
+
+    // 以 RespValue 形式提交的命令（AOF 重放等），转换为参数视图后执行
+    std::string execute_command(const resp::RespValue &command_variant, bool from_aof = false) {
+        resp::RequestArgv argv;
+        if (auto error = to_argv(command_variant, argv)) {
+            if (!from_aof) {
+                stats_.increment_commands_processed();
+            }
+            return resp::serialize_error(*error);
+        }
+        return execute_command(argv.view(), from_aof);
+    }
 
-        // 处理复制
-        if (command->should_replicate() && aof_) {
-            aof_->append(command->get_original_command());
+    // 事务执行函数 - 处理一组事务命令。
+    // 每条命令的回复本身就是完整的 RESP 值，直接写在数组头之后
+    void execute_transaction(const std::vector<std::vector<std::string>> &commands, Buffer &out) {
+        LOG_INFO("执行事务，共 {} 条命令", commands.size());
+        resp::write_array_header(out, commands.size());
+        resp::RequestArgv argv;
+        for (const auto &command : commands) {
+            argv.assign(command);
+            execute_command(argv.view(), out, false);
         }
+    }
 
-        return result;
+    std::string execute_transaction(const std::vector<std::vector<std::string>> &commands) {
+        Buffer out;
+        execute_transaction(commands, out);
+        return std::string(out.readable_view());
     }
 
-    // 事务执行函数 - 处理一组事务命令
     std::string execute_transaction(const std::vector<resp::RespValue> &commands) {
-        if (commands.empty()) {
-            return resp::serialize_array(std::vector<resp::RespValue>{}); // 空事务返回空数组
-        }
         LOG_INFO("执行事务，共 {} 条命令", commands.size());
-
-        // 创建事务结果数组
-        auto result_array = std::make_unique<resp::RespArray>();
-        result_array->values.reserve(commands.size());
-
-        // 遍历执行每一条命令，并收集结果
+        std::string result;
+        resp::write_array_header(result, commands.size());
         for (const auto &command : commands) {
-            // 执行命令并获取响应
-            std::string response_str = execute_command(command, false);
-
-            // 将命令的执行结果解析为 RespValue，然后加入结果数组
-            std::string_view response_view = response_str;
-            auto resp_result = resp::parse(response_view);
-
-            if (resp_result) {
-                // 解析成功，添加到结果数组
-                result_array->values.push_back(std::move(*resp_result));
-            } else {
-                // 解析失败，添加一个错误信息
-                result_array->values.push_back(resp::RespError{"ERR failed to parse command response"});
-            }
+            result += execute_command(command, false);
         }
-
-        // 将事务执行结果序列化为RESP数组
-        resp::RespValue result_value = std::move(result_array);
-        return resp::serialize(result_value);
+        return result;
     }
 
 private:
+    static constexpr std::chrono::microseconds REHASH_BUDGET{1000}; // 每次渐进式扩容的时间预算
+    static constexpr std::chrono::microseconds EVICTION_BUDGET{500}; // 每条命令前淘汰键的时间预算
+    static constexpr std::chrono::milliseconds DEFRAG_INTERVAL{100}; // 碎片整理周期的间隔
+    static constexpr double DEFRAG_MAX_OCCUPANCY = 0.5;              // 占用率不超过该值的 slab 才会被清空
+
     Storage db_;                                            // 数据库
+    ExpiresIndex expires_;                                  // 设置了过期时间的键
     Aof *aof_ = nullptr;                                    // AOF对象
     TimerQueue *timer_queue_ = nullptr;                     // 定时器队列
-    inline static ServerStat stats_;                        // 服务器统计信息
+    ServerStat stats_;                                      // 本分片的统计信息
     std::mt19937 random_generator_{std::random_device{}()}; // 随机数生成器
+    ActiveExpireConfig expire_config_;                      // 主动过期配置
+    bool expire_time_cap_reached_ = false;                  // 上一个过期周期是否因时间预算用尽而结束
+    std::chrono::steady_clock::time_point last_fast_cycle_; // 上一个快周期的开始时间
     std::unique_ptr<KVServerContext> context_;              // KVServer上下文
-    std::unique_ptr<CommandFactory> command_factory_;       // 命令工厂
+    EvictionPool eviction_pool_;                            // 内存淘汰的候选键
+    ActiveDefragConfig defrag_config_;                      // 碎片整理配置
+    bool defrag_running_ = false;                           // 碎片整理是否正在进行
+    size_t defrag_cursor_ = 0;                              // 碎片整理扫描到的槽位
 
     // 设置清理过期键的定时任务
     void setup_expire_cleanup_task();
-    // 定期删除过期键
-    void cleanup_expired_keys();
-    // 检查一个键是否过期
-    bool is_key_expired(const std::string &key, const KeyValue &kv);
-    // 删除一个过期键
-    bool delete_expired_key(const std::string &key);
+    // 设置碎片整理的定时任务
+    void setup_defrag_task();
+    // 结束碎片整理
+    void stop_defrag();
+    // 采样并从淘汰池中取出下一个要淘汰的键，没有可淘汰的键时返回 end
+    Storage::iterator next_eviction_candidate(const MaxmemoryConfig &config);
+    // 检查参数个数后执行命令，写命令按命令表标志追加到 AOF
+    void dispatch(const CommandSpec *spec, std::span<const std::string_view> argv, Buffer &out, bool from_aof);
+    // 将 RespValue 形式的命令转换为参数视图，格式无效时返回错误信息
+    static std::optional<std::string> to_argv(const resp::RespValue &command_variant, resp::RequestArgv &argv);
 };
 
 // --- 实现 ---
 
+void KVServer::dispatch(const CommandSpec *spec, std::span<const std::string_view> argv, Buffer &out,
+                        bool from_aof) {
+    // 先重置上一条命令的传播和阻塞状态，命令在下面被拒绝时调用方读到的也是本条命令的状态
+    context_->begin_command();
+    // 命令被拒绝或执行完毕时都结束本条命令的时间快照
+    struct CommandScope {
+        KVServerContext &context;
+        ~CommandScope() { context.end_command(); }
+    } scope{*context_};
+    // 事务控制命令只在连接层有意义，在这里与未知命令同样处理
+    if (!spec || spec->has_flag(CMD_CONNECTION)) {
+        LOG_WARN("未知命令: {}", argv[0]);
+        resp::write_error(out, std::format("ERR unknown command '{}'", argv[0]));
+        return;
+    }
+    if (!spec->check_arity(argv.size())) {
+        resp::write_error(out, std::format("ERR wrong number of arguments for '{}' command", spec->name));
+        return;
+    }
+
+    // 超过内存上限时先淘汰键，无法淘汰时拒绝可能增加内存的命令。AOF 重放不受上限限制
+    if (!from_aof && !perform_evictions() && spec->has_flag(CMD_DENYOOM)) {
+        resp::write_error(out, "OOM command not allowed when used memory > 'maxmemory'.");
+        return;
+    }
+
+    // 直接调用无状态的处理函数，不为每条命令创建对象
+    size_t reply_offset = out.readable_bytes();
+    handler_of(*spec)(*context_, argv.subspan(1), out);
+
+    // 处理复制，AOF 重放的命令不再追加。错误回复说明命令没有修改数据，同样不追加
+    bool failed = out.readable_bytes() > reply_offset && out.readable_view()[reply_offset] == '-';
+    if (spec->has_flag(CMD_PROPAGATE) && !from_aof && aof_ && !failed) {
+        switch (context_->propagation()) {
+        case Propagation::Verbatim:
+            aof_->append(argv);
+            break;
+        case Propagation::Rewritten:
+            aof_->append(context_->propagated_argv());
+            break;
+        case Propagation::Suppressed:
+            break;
+        }
+    }
+}
+
+// 取第一个键作为路由键。多键命令的键由连接层保证属于同一分片
+std::optional<std::string_view> KVServer::routing_key(std::span<const std::string_view> argv) {
+    if (argv.empty()) {
+        return std::nullopt;
+    }
+    return routing_key(lookup_command(argv[0]), argv);
+}
+
+std::optional<std::string_view> KVServer::routing_key(const CommandSpec *spec, std::span<const std::string_view> argv) {
+    if (!spec || !spec->has_keys() || argv.size() <= static_cast<size_t>(spec->first_key)) {
+        return std::nullopt;
+    }
+    return argv[spec->first_key];
+}
+
+std::optional<std::string_view> KVServer::routing_key(const resp::RespValue &command_variant) {
+    resp::RequestArgv argv;
+    if (to_argv(command_variant, argv)) {
+        return std::nullopt;
+    }
+    return routing_key(argv.view());
+}
+
+bool KVServer::runs_on_all_shards(const resp::RespValue &command_variant) {
+    resp::RequestArgv argv;
+    if (to_argv(command_variant, argv) || argv.empty()) {
+        return false;
+    }
+    const CommandSpec *spec = lookup_command(argv[0]);
+    return spec && spec->has_flag(CMD_ALL_SHARDS);
+}
+
+std::optional<std::string> KVServer::to_argv(const resp::RespValue &command_variant, resp::RequestArgv &argv) {
+    const auto *arr_ptr = std::get_if<std::unique_ptr<resp::RespArray>>(&command_variant);
+    if (!arr_ptr) {
+        LOG_WARN("无效的命令格式: 不是数组类型");
+        return "ERR unknown command 'invalid_format'";
+    }
+    for (const auto &value : (*arr_ptr)->values) {
+        const auto *bulk = std::get_if<resp::RespBulkString>(&value);
+        if (!bulk || !bulk->value) {
+            LOG_WARN("命令参数不是有效的字符串");
+            return argv.empty() ? "ERR unknown command 'invalid_command_name'"
+                                : "ERR arguments must be non-null bulk strings";
+        }
+        argv.push_back(*bulk->value);
+    }
+    return std::nullopt;
+}
+
 // 设置定期清理过期键的任务
 void KVServer::setup_expire_cleanup_task() {
     if (!timer_queue_) {
@@ -130,90 +361,199 @@ void KVServer::setup_expire_cleanup_task() {
         return;
     }
 
-    // 每秒执行一次过期键清理
-    const auto interval = std::chrono::milliseconds(1000);
-    timer_queue_->add_timer(interval, [this]() { this->cleanup_expired_keys(); }, true, interval);
-    LOG_INFO("已设置每秒过期键清理任务");
+    // 每秒执行 hz 次慢周期
+    int hz = std::clamp(expire_config_.hz, 1, 500);
+    const auto interval = std::chrono::milliseconds(1000 / hz);
+    timer_queue_->add_timer(interval, [this]() {
+        db_.update_clock();
+        active_expire_cycle(ExpireCycleType::Slow);
+        // 空闲时事件循环很少醒来，定时推进未完成的扩容
+        db_.rehash_for(REHASH_BUDGET);
+    }, true, interval);
+    LOG_INFO("已设置过期键清理任务: hz={}, CPU 预算 {}%", hz, expire_config_.cpu_percent);
 }
 
-// 定期清理过期键实现
-void KVServer::cleanup_expired_keys() {
-    // 我们采用随机采样的方式，避免一次扫描所有键
-    constexpr int SAMPLE_SIZE = 20; // 每次随机采样20个键
-    constexpr double CONTINUE_THRESHOLD = 0.25; // 如果超过25%的键已过期，继续清理
-
-    if (db_.empty())
+void KVServer::setup_defrag_task() {
+    if (!timer_queue_) {
         return;
+    }
+    timer_queue_->add_timer(DEFRAG_INTERVAL, [this]() { active_defrag_cycle(); }, true, DEFRAG_INTERVAL);
+}
 
-    LOG_DEBUG("开始过期键清理任务");
-
-    // 计算本次应该采样的键数量
-    int sample_count = std::min(static_cast<int>(db_.size()), SAMPLE_SIZE);
-    int expired_count = 0; // 初始化过期键计数
+void KVServer::stop_defrag() {
+    defrag_running_ = false;
+    defrag_cursor_ = 0;
+    context_->set_active_defrag_running(false);
+}
 
-    // 随机选择键进行检查并且预先分配空间
-    std::vector<std::string> keys_to_check;
-    keys_to_check.reserve(sample_count);
+void KVServer::active_defrag_cycle() {
+    using namespace std::chrono;
+    constexpr size_t SLOTS_PER_STEP = 256; // 每扫描若干个槽位检查一次时间
 
-    // 使用随机数生成器从数据库中选择键
-    if (db_.size() <= SAMPLE_SIZE) {
-        // 如果键的总数小于等于采样数，直接检查所有键
-        for (const auto &[key, _] : db_) {
-            keys_to_check.push_back(key);
+    if (!defrag_config_.enabled) {
+        if (defrag_running_) {
+            stop_defrag();
         }
-    } else {
-        // 否则随机采样
-        std::uniform_int_distribution<size_t> dist(0, db_.size() - 1);
-        for (int i = 0; i < sample_count; ++i) {
-            size_t random_idx = dist(random_generator_);
-            auto it = db_.begin();
-            std::advance(it, random_idx);
-            keys_to_check.push_back(it->first);
-        }
-    }
-
-    // 检查并清理过期键
-    for (const auto &key : keys_to_check) {
-        auto it = db_.find(key);
-        if (it != db_.end() && is_key_expired(key, it->second)) {
-            if (delete_expired_key(key)) {
-                expired_count++;
-            }
+        return;
+    }
+    if (!defrag_running_) {
+        size_t allocated = db_.allocated_entry_bytes();
+        size_t logical = db_.entry_bytes();
+        size_t fragmented = allocated > logical ? allocated - logical : 0;
+        if (fragmented < defrag_config_.ignore_bytes ||
+            fragmented * 100 <= logical * static_cast<size_t>(std::max(defrag_config_.threshold_lower, 0))) {
+            return;
+        }
+        if (!db_.begin_defrag(DEFRAG_MAX_OCCUPANCY)) {
+            return; // 碎片分散在各个 slab 中，没有可以清空的 slab
         }
+        LOG_INFO("开始碎片整理: 碎片率 {:.2f}，{} 个 slab 待清空", db_.fragmentation_ratio(),
+                 db_.slabs().evacuating_slabs());
+        defrag_running_ = true;
+        defrag_cursor_ = 0;
+        context_->set_active_defrag_running(true);
     }
 
-    LOG_DEBUG("过期键清理任务: 采样 {} 个键，删除 {} 个过期键", keys_to_check.size(), expired_count);
+    int cpu_percent = std::clamp(defrag_config_.cpu_percent, 1, 100);
+    auto deadline = steady_clock::now() + duration_cast<microseconds>(DEFRAG_INTERVAL) * cpu_percent / 100;
+    size_t hits = 0;
+    size_t misses = 0;
+    do {
+        defrag_cursor_ = db_.defrag_slots(defrag_cursor_, SLOTS_PER_STEP, hits, misses);
+        // 一遍扫描结束。扫描期间发生扩容可能漏掉条目，还有未清空的 slab 时再扫一遍
+        if (defrag_cursor_ == 0 && db_.slabs().evacuating_slabs() == 0) {
+            LOG_INFO("碎片整理完成: 碎片率 {:.2f}", db_.fragmentation_ratio());
+            stop_defrag();
+            break;
+        }
+    } while (steady_clock::now() < deadline);
+    stats_.record_active_defrag(static_cast<long long>(hits), static_cast<long long>(misses));
+}
+
+bool KVServer::perform_evictions() {
+    const MaxmemoryConfig &config = context_->maxmemory_config();
+    if (config.maxmemory == 0 || context_->used_memory() <= config.maxmemory) {
+        return true;
+    }
+    if (config.policy == EvictionPolicy::NoEviction) {
+        return false;
+    }
 
-    // 如果过期键比例超过阈值，立即再次执行清理
-    double expired_ratio = static_cast<double>(expired_count) / keys_to_check.size();
-    if (expired_ratio >= CONTINUE_THRESHOLD) {
-        LOG_INFO("过期键比例较高 ({:.1f}%)，安排立即再次执行清理任务", expired_ratio * 100);
-        cleanup_expired_keys();
+    using namespace std::chrono;
+    constexpr int TIME_CHECK_INTERVAL = 16; // 每淘汰若干个键检查一次时间
+    auto start = steady_clock::now();
+    db_.update_clock();
+    long long evicted = 0;
+    while (context_->used_memory() > config.maxmemory) {
+        auto it = next_eviction_candidate(config);
+        if (it == db_.end()) {
+            LOG_WARN("内存占用 {} 超过上限 {}，但没有可淘汰的键", context_->used_memory(), config.maxmemory);
+            return false;
+        }
+        context_->evict_key(it);
+        ++evicted;
+        if (evicted % TIME_CHECK_INTERVAL == 0 && steady_clock::now() - start >= EVICTION_BUDGET) {
+            LOG_DEBUG("淘汰 {} 个键后时间预算用尽，内存占用 {}", evicted, context_->used_memory());
+            break;
+        }
     }
+    return true;
 }
 
-// 检查键是否过期
-bool KVServer::is_key_expired(const std::string &key, const KeyValue &kv) {
-    if (!kv.expires_at.has_value()) {
-        return false; // 没有设置过期时间
+Storage::iterator KVServer::next_eviction_candidate(const MaxmemoryConfig &config) {
+    constexpr int MAX_SAMPLE_ROUNDS = 16;  // 连续若干轮取不到候选时放弃
+    constexpr size_t SLOTS_PER_SAMPLE = 32; // 每采样一个键最多扫描的槽位数
+    bool volatile_only = is_volatile_policy(config.policy);
+    size_t samples = static_cast<size_t>(std::clamp(config.samples, 1, 64));
+    uint64_t now_s = db_.clock();
+
+    for (int round = 0; round < MAX_SAMPLE_ROUNDS; ++round) {
+        if (volatile_only ? expires_.empty() : db_.empty()) {
+            eviction_pool_.clear();
+            return db_.end();
+        }
+        if (volatile_only) {
+            for (size_t i = 0; i < samples; ++i) {
+                std::string_view key = expires_.random_key(random_generator_);
+                if (auto it = db_.find(key); it != db_.end()) {
+                    eviction_pool_.insert(eviction_idle(*it, config.policy, now_s), key);
+                }
+            }
+        } else {
+            db_.sample(random_generator_, samples, samples * SLOTS_PER_SAMPLE, [&](const KvEntry &entry) {
+                eviction_pool_.insert(eviction_idle(entry, config.policy, now_s), entry.key());
+            });
+        }
+        // 从最佳候选开始，跳过采样后已被删除或不再带过期时间的键
+        while (!eviction_pool_.empty()) {
+            auto it = db_.find(eviction_pool_.best());
+            eviction_pool_.pop_best();
+            if (it != db_.end() && (!volatile_only || it->has_expire())) {
+                return it;
+            }
+        }
     }
-
-    auto now = std::chrono::steady_clock::now();
-    return now >= kv.expires_at.value();
+    return db_.end();
 }
 
-// 删除一个过期键
-bool KVServer::delete_expired_key(const std::string &key) {
-    auto it = db_.find(key);
-    if (it == db_.end()) {
-        return false;
+// 主动过期周期实现
+void KVServer::active_expire_cycle(ExpireCycleType type) {
+    using namespace std::chrono;
+    constexpr int SAMPLE_SIZE = 20;              // 每轮随机采样20个键
+    constexpr int EXPIRED_PERCENT_THRESHOLD = 25; // 一轮中过期键不少于25%时继续下一轮
+    constexpr auto FAST_CYCLE_DURATION = microseconds(1000); // 快周期的时间预算
+    constexpr int TIME_CHECK_INTERVAL = 16;      // 每隔若干轮检查一次时间，减少读时钟的开销
+
+    if (expires_.empty()) {
+        expire_time_cap_reached_ = false;
+        return;
+    }
+
+    auto start = steady_clock::now();
+    microseconds time_limit;
+    if (type == ExpireCycleType::Fast) {
+        // 上一周期正常结束说明过期键已清理得差不多，不需要快周期；
+        // 两个快周期之间至少间隔两倍时长，避免占满事件循环
+        if (!expire_time_cap_reached_ || start < last_fast_cycle_ + FAST_CYCLE_DURATION * 2) {
+            return;
+        }
+        last_fast_cycle_ = start;
+        time_limit = FAST_CYCLE_DURATION;
+    } else {
+        int hz = std::clamp(expire_config_.hz, 1, 500);
+        int cpu_percent = std::clamp(expire_config_.cpu_percent, 1, 100);
+        time_limit = microseconds(1000000LL * cpu_percent / 100 / hz);
     }
+    auto deadline = start + time_limit;
+
+    long long expired_total = 0;
+    bool time_cap_reached = false;
+    for (int iteration = 1; !expires_.empty(); ++iteration) {
+        int sample_count = std::min(static_cast<int>(expires_.size()), SAMPLE_SIZE);
+        int expired = 0;
+        // 删除会改变索引中的位置，所以每次采样后立即处理
+        for (int i = 0; i < sample_count && !expires_.empty(); ++i) {
+            if (context_->delete_expired_key(expires_.random_key(random_generator_))) {
+                ++expired;
+            }
+        }
+        expired_total += expired;
 
-    if (!is_key_expired(key, it->second)) {
-        return false; // 键未过期
+        if (iteration % TIME_CHECK_INTERVAL == 0 && steady_clock::now() >= deadline) {
+            time_cap_reached = true;
+            break;
+        }
+        // 过期比例较低，剩余的过期键留给惰性删除和后续周期
+        if (expired * 100 < sample_count * EXPIRED_PERCENT_THRESHOLD) {
+            break;
+        }
     }
 
-    LOG_DEBUG("删除过期键: {}", key);
-    db_.erase(it);
-    return true;
-}
\ No newline at end of file
+    auto elapsed = duration_cast<microseconds>(steady_clock::now() - start).count();
+    expire_time_cap_reached_ = time_cap_reached;
+    stats_.record_expire_cycle(expired_total, elapsed, time_cap_reached);
+    if (expired_total > 0) {
+        LOG_DEBUG("{}过期周期: 删除 {} 个过期键，耗时 {} 微秒{}", type == ExpireCycleType::Fast ? "快" : "慢",
+                  expired_total, elapsed, time_cap_reached ? "，时间预算已用尽" : "");
+    }
+}
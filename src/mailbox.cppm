@@ -0,0 +1,82 @@
+module;
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+export module mailbox;
+
+import logger;
+
+// 投递到事件循环中执行的任务
+export using MailboxTask = std::function<void()>;
+
+// 事件循环之间的消息通道。
+// 其他线程通过 post 投递任务，所属的事件循环在 eventfd 可读时调用 drain 执行。
+// 锁只保护任务队列本身，键空间数据始终只被所属线程访问。
+export class Mailbox {
+public:
+    Mailbox();
+    ~Mailbox();
+    Mailbox(const Mailbox &) = delete;
+    Mailbox &operator=(const Mailbox &) = delete;
+
+    int event_fd() const { return event_fd_; } // 获取 eventfd，用于注册到 epoll
+    void post(MailboxTask task);               // 投递任务（任意线程）
+    void drain();                              // 执行所有待处理任务（所属线程）
+
+private:
+    int event_fd_ = -1;              // 唤醒用的 eventfd
+    std::mutex mutex_;               // 保护任务队列
+    std::vector<MailboxTask> tasks_; // 待执行任务
+};
+
+Mailbox::Mailbox() {
+    event_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (event_fd_ < 0) {
+        LOG_FATAL("创建 eventfd 失败: {}", std::strerror(errno));
+    }
+}
+
+Mailbox::~Mailbox() {
+    if (event_fd_ >= 0) {
+        close(event_fd_);
+    }
+}
+
+void Mailbox::post(MailboxTask task) {
+    bool was_empty;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        was_empty = tasks_.empty();
+        tasks_.push_back(std::move(task));
+    }
+    // 队列由空变为非空时才需要唤醒，避免每条消息一次 write 系统调用
+    if (was_empty) {
+        uint64_t one = 1;
+        if (write(event_fd_, &one, sizeof(one)) != sizeof(one) && errno != EAGAIN) {
+            LOG_ERROR("唤醒事件循环失败: {}", std::strerror(errno));
+        }
+    }
+}
+
+void Mailbox::drain() {
+    uint64_t count;
+    // 清除 eventfd 的可读状态，读失败（EAGAIN）说明已被清除，不影响处理
+    (void)read(event_fd_, &count, sizeof(count));
+
+    std::vector<MailboxTask> tasks;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        tasks.swap(tasks_);
+    }
+    for (auto &task : tasks) {
+        task();
+    }
+}
@@ -1,10 +1,14 @@
 module;
+#include <array>
+#include <cctype>
 #include <charconv>
+#include <cstdint>
 #include <expected>
 #include <format>
 #include <limits>
 #include <memory>
 #include <optional>
+#include <span>
 #include <string>
 #include <string_view>
 #include <variant>
@@ -57,6 +61,100 @@ enum class ParseError {
 // 主解析函数，返回一个包含 RespValue 或 ParseError 的 expected
 std::expected<RespValue, ParseError> parse(std::string_view &input);
 
+// --- 请求解析 ---
+
+// 请求参数向量，元素是指向输入缓冲区的 string_view，包含命令名。
+// 参数个数不超过内联容量时不分配内存；向量可在连接上复用，溢出部分的容量会被保留
+class RequestArgv {
+public:
+    static constexpr size_t INLINE_CAPACITY = 16;
+
+    void clear() noexcept {
+        size_ = 0;
+        overflow_.clear();
+    }
+    void push_back(std::string_view arg) {
+        if (size_ < INLINE_CAPACITY) {
+            inline_[size_++] = arg;
+            return;
+        }
+        if (size_ == INLINE_CAPACITY) {
+            overflow_.assign(inline_.begin(), inline_.end());
+        }
+        overflow_.push_back(arg);
+        ++size_;
+    }
+    // 用拥有数据的参数填充，视图指向 args 中的字符串
+    void assign(const std::vector<std::string> &args) {
+        clear();
+        for (const auto &arg : args) {
+            push_back(arg);
+        }
+    }
+    size_t size() const noexcept { return size_; }
+    bool empty() const noexcept { return size_ == 0; }
+    std::string_view operator[](size_t i) const noexcept { return view()[i]; }
+    std::span<const std::string_view> view() const noexcept {
+        if (size_ <= INLINE_CAPACITY) {
+            return {inline_.data(), size_};
+        }
+        return overflow_;
+    }
+
+private:
+    std::array<std::string_view, INLINE_CAPACITY> inline_{};
+    std::vector<std::string_view> overflow_; // 超出内联容量时保存全部参数
+    size_t size_ = 0;
+};
+
+// 可恢复的增量请求解析器，每个连接持有一个。
+// 数据不完整时记住已解析到的位置（剩余参数个数、当前参数长度、已完成参数的偏移），
+// 新数据到达后从断点继续，而不是从请求的第一个字节重新解析。
+// 进度以相对请求起点的偏移保存，因此两次调用之间缓冲区可以扩容或搬移数据
+class RequestParser {
+public:
+    // 解析一条请求（多条批量字符串组成的数组，或以空格分隔的内联命令），参数填入 argv，
+    // 不拷贝数据。input 必须从当前请求的第一个字节开始，并包含此前传入过的全部数据。
+    // 成功时返回消耗的字节数并重置解析器；argv 为空表示空请求，应直接跳过。
+    // 返回 Incomplete 时保存进度；其他错误说明协议错误，解析器同样被重置。
+    // argv 中的视图只在 input 指向的数据未被改动前有效
+    std::expected<size_t, ParseError> parse(std::string_view input, RequestArgv &argv);
+
+    // 已知的当前请求至少需要的总字节数（从请求起点算起），用于按 $len 预先分配缓冲区；
+    // 未读到参数长度时为 0
+    size_t expected_size() const noexcept {
+        return phase_ == Phase::BulkData ? pos_ + bulk_len_ + 2 : 0;
+    }
+    void reset() noexcept;
+
+private:
+    enum class Phase {
+        Begin,      // 尚未读到数组头
+        BulkHeader, // 等待下一个参数的 $len 行
+        BulkData,   // 等待参数数据及结尾的 CRLF
+    };
+    struct ArgSpan {
+        size_t offset; // 相对请求起点的偏移
+        size_t length;
+    };
+
+    Phase phase_ = Phase::Begin;
+    size_t pos_ = 0;          // 已解析到的位置（相对请求起点）
+    long long remaining_ = 0; // 还未解析的参数个数
+    size_t bulk_len_ = 0;     // 当前参数的长度
+    size_t inline_scanned_ = 0; // 内联命令中已确认不含换行符的字节数
+    std::vector<ArgSpan> args_; // 已解析的参数，随连接复用，不会反复分配
+};
+
+// 一次性解析一条完整请求，不保存进度，适用于数据已全部到达的场景
+std::expected<size_t, ParseError> parse_request(std::string_view input, RequestArgv &argv);
+
+// 将请求参数复制为拥有数据的形式，用于需要比输入缓冲区活得更久的场景（事务排队、跨分片转发）
+std::vector<std::string> to_owned(std::span<const std::string_view> argv);
+
+// 忽略大小写比较命令名
+bool equals_ignore_case(std::string_view a, std::string_view b);
+
 // --- 序列化 ---
 
 // 将任何 RespValue 变体序列化为字符串
@@ -70,23 +168,165 @@ std::string serialize_null_bulk_string();   // 用于表示 (nil)
 std::string serialize_ok();                 // "+OK\r\n"
 std::string serialize_integer(long long n); // 用于整数回复
 std::string serialize_array(const std::vector<RespValue> &values); // 用于数组回复
+std::string serialize_command(std::span<const std::string_view> argv); // 将请求参数序列化为数组，用于 AOF
+
+// --- 直接写入输出目标的回复序列化 ---
+// Out 是任何提供 append(std::string_view) 的输出目标，通常是连接的输出缓冲区 Buffer。
+// 数字用 std::to_chars 在栈上格式化，常用回复使用预先编码好的静态字节串，整个过程不分配堆内存
+
+// 预先编码好的常用回复
+namespace shared {
+inline constexpr std::string_view OK = "+OK\r\n";
+inline constexpr std::string_view QUEUED = "+QUEUED\r\n";
+inline constexpr std::string_view NULL_BULK = "$-1\r\n";
+inline constexpr std::string_view NULL_ARRAY = "*-1\r\n";
+inline constexpr std::string_view EMPTY_ARRAY = "*0\r\n";
+inline constexpr std::string_view CRLF = "\r\n";
+
+inline constexpr long long INTEGER_COUNT = 10000; // 预编码 :0 到 :9999
+inline constexpr size_t BULK_HEADER_COUNT = 32;   // 预编码 $0 到 $31
+
+// 一条预编码的长度行或整数回复，最长为 ":9999\r\n"
+struct EncodedLine {
+    char data[8];
+    uint8_t size;
+    constexpr std::string_view view() const { return {data, size}; }
+};
+
+// 编译期生成 "<prefix><n>\r\n" 的表
+template <size_t N>
+constexpr std::array<EncodedLine, N> make_encoded_lines(char prefix) {
+    std::array<EncodedLine, N> lines{};
+    for (size_t n = 0; n < N; ++n) {
+        char digits[8];
+        size_t count = 0;
+        size_t value = n;
+        do {
+            digits[count++] = static_cast<char>('0' + value % 10);
+            value /= 10;
+        } while (value > 0);
+        auto &line = lines[n];
+        line.data[0] = prefix;
+        for (size_t i = 0; i < count; ++i) {
+            line.data[1 + i] = digits[count - 1 - i];
+        }
+        line.data[1 + count] = '\r';
+        line.data[2 + count] = '\n';
+        line.size = static_cast<uint8_t>(count + 3);
+    }
+    return lines;
+}
+
+inline constexpr auto INTEGERS = make_encoded_lines<INTEGER_COUNT>(':');
+inline constexpr auto BULK_HEADERS = make_encoded_lines<BULK_HEADER_COUNT>('$');
+} // namespace shared
+
+// 写入 "<prefix><n>\r\n"，用于整数回复和各种长度行
+template <typename Out>
+void write_number_line(Out &out, char prefix, long long n) {
+    char buf[24];
+    buf[0] = prefix;
+    char *end = std::to_chars(buf + 1, buf + sizeof(buf) - 2, n).ptr;
+    *end++ = '\r';
+    *end++ = '\n';
+    out.append(std::string_view(buf, static_cast<size_t>(end - buf)));
+}
+
+template <typename Out>
+void write_ok(Out &out) {
+    out.append(shared::OK);
+}
+
+template <typename Out>
+void write_null_bulk_string(Out &out) {
+    out.append(shared::NULL_BULK);
+}
+
+template <typename Out>
+void write_null_array(Out &out) {
+    out.append(shared::NULL_ARRAY);
+}
+
+template <typename Out>
+void write_simple_string(Out &out, std::string_view s) {
+    out.append(std::string_view("+"));
+    out.append(s);
+    out.append(shared::CRLF);
+}
+
+template <typename Out>
+void write_error(Out &out, std::string_view s) {
+    out.append(std::string_view("-"));
+    out.append(s);
+    out.append(shared::CRLF);
+}
+
+template <typename Out>
+void write_integer(Out &out, long long n) {
+    if (n >= 0 && n < shared::INTEGER_COUNT) {
+        out.append(shared::INTEGERS[static_cast<size_t>(n)].view());
+        return;
+    }
+    write_number_line(out, ':', n);
+}
+
+template <typename Out>
+void write_bulk_string(Out &out, std::string_view s) {
+    if (s.size() < shared::BULK_HEADER_COUNT) {
+        out.append(shared::BULK_HEADERS[s.size()].view());
+    } else {
+        write_number_line(out, '$', static_cast<long long>(s.size()));
+    }
+    out.append(s);
+    out.append(shared::CRLF);
+}
+
+// 把整数作为批量字符串写出，用于整数编码的值。
+// 0 到 9999 直接取预编码整数回复中的数字部分，其余在栈上格式化
+template <typename Out>
+void write_bulk_integer(Out &out, long long n) {
+    if (n >= 0 && n < shared::INTEGER_COUNT) {
+        std::string_view line = shared::INTEGERS[static_cast<size_t>(n)].view();
+        write_bulk_string(out, line.substr(1, line.size() - 3));
+        return;
+    }
+    char buf[24];
+    char *end = std::to_chars(buf, buf + sizeof(buf), n).ptr;
+    write_bulk_string(out, std::string_view(buf, static_cast<size_t>(end - buf)));
+}
+
+template <typename Out>
+void write_array_header(Out &out, size_t count) {
+    write_number_line(out, '*', static_cast<long long>(count));
+}
 } // namespace resp
 
 // --- 实现 ---
 namespace resp {
 // 序列化辅助函数
 std::string serialize_simple_string(const std::string &s) {
-    return std::format("+{}\r\n", s);
+    std::string result;
+    write_simple_string(result, s);
+    return result;
 }
 std::string serialize_bulk_string(const std::string &s) {
-    return std::format("${}\r\n{}\r\n", s.length(), s);
+    std::string result;
+    result.reserve(s.size() + 16);
+    write_bulk_string(result, s);
+    return result;
 }
 std::string serialize_error(const std::string &s) {
-    return std::format("-{}\r\n", s);
+    std::string result;
+    write_error(result, s);
+    return result;
+}
+std::string serialize_null_bulk_string() { return std::string(shared::NULL_BULK); }
+std::string serialize_ok() { return std::string(shared::OK); }
+std::string serialize_integer(long long n) {
+    std::string result;
+    write_integer(result, n);
+    return result;
 }
-std::string serialize_null_bulk_string() { return "$-1\r\n"; }
-std::string serialize_ok() { return "+OK\r\n"; }
-std::string serialize_integer(long long n) { return std::format(":{}\r\n", n); }
 
 
 // 新增：序列化RESP数组的辅助函数
@@ -98,6 +338,15 @@ std::string serialize_array(const std::vector<RespValue> &values) {
     return result;
 }
 
+std::string serialize_command(std::span<const std::string_view> argv) {
+    std::string result;
+    write_array_header(result, argv.size());
+    for (std::string_view arg : argv) {
+        write_bulk_string(result, arg);
+    }
+    return result;
+}
+
 // 主序列化函数，使用 std::visit
 std::string serialize(const RespValue &value) {
     return std::visit(
@@ -153,6 +402,58 @@ std::optional<long long> to_long(std::string_view s) {
     return std::nullopt;
 }
 
+// 请求的限制，与 Redis 默认值一致
+constexpr long long MAX_MULTIBULK_COUNT = 1024 * 1024;        // 单条请求的最大参数个数
+constexpr long long MAX_BULK_LENGTH = 512LL * 1024 * 1024;   // 单个参数的最大长度
+constexpr size_t MAX_INLINE_LENGTH = 64 * 1024;               // 内联命令的最大长度
+constexpr size_t MAX_LENGTH_LINE = 32;                        // 长度行（如 "*3"、"$5"）的最大长度
+
+// 从 pos 开始读取以 CRLF 结尾的整数，成功后 pos 移到 CRLF 之后
+std::expected<long long, ParseError> read_length(std::string_view input, size_t &pos) {
+    size_t end = input.find("\r\n", pos);
+    if (end == std::string_view::npos) {
+        if (input.size() - pos > MAX_LENGTH_LINE) {
+            return std::unexpected(ParseError::InvalidLength);
+        }
+        return std::unexpected(ParseError::Incomplete);
+    }
+    auto value = to_long(input.substr(pos, end - pos));
+    if (!value) {
+        return std::unexpected(ParseError::InvalidLength);
+    }
+    pos = end + 2;
+    return *value;
+}
+
+// 解析内联命令：一行以空白分隔的参数，便于 telnet 等工具直接输入
+std::expected<size_t, ParseError> parse_inline(std::string_view input, RequestArgv &argv) {
+    size_t newline = input.find('\n');
+    if (newline == std::string_view::npos) {
+        if (input.size() > MAX_INLINE_LENGTH) {
+            return std::unexpected(ParseError::InvalidLength);
+        }
+        return std::unexpected(ParseError::Incomplete);
+    }
+    std::string_view line = input.substr(0, newline);
+    if (!line.empty() && line.back() == '\r') {
+        line.remove_suffix(1);
+    }
+    size_t pos = 0;
+    while (pos < line.size()) {
+        while (pos < line.size() && (line[pos] == ' ' || line[pos] == '\t')) {
+            ++pos;
+        }
+        size_t start = pos;
+        while (pos < line.size() && line[pos] != ' ' && line[pos] != '\t') {
+            ++pos;
+        }
+        if (pos > start) {
+            argv.push_back(line.substr(start, pos - start));
+        }
+    }
+    return newline + 1;
+}
+
 // 递归地解析单个 RESP 消息
 std::expected<RespValue, ParseError> parse_message(std::string_view &input) {
     if (input.empty()) {
@@ -226,6 +527,127 @@ std::expected<RespValue, ParseError> parse_message(std::string_view &input) {
 }
 } // namespace
 
+void RequestParser::reset() noexcept {
+    phase_ = Phase::Begin;
+    pos_ = 0;
+    remaining_ = 0;
+    bulk_len_ = 0;
+    inline_scanned_ = 0;
+    args_.clear();
+}
+
+std::expected<size_t, ParseError> RequestParser::parse(std::string_view input, RequestArgv &argv) {
+    argv.clear();
+    if (phase_ == Phase::Begin) {
+        if (input.empty()) {
+            return std::unexpected(ParseError::Incomplete);
+        }
+        if (input[0] != '*') {
+            // 内联命令只需要找到换行符，从上次查找结束的位置继续
+            size_t newline = input.find('\n', inline_scanned_);
+            if (newline == std::string_view::npos) {
+                inline_scanned_ = input.size();
+                if (input.size() > MAX_INLINE_LENGTH) {
+                    reset();
+                    return std::unexpected(ParseError::InvalidLength);
+                }
+                return std::unexpected(ParseError::Incomplete);
+            }
+            inline_scanned_ = 0;
+            return parse_inline(input, argv);
+        }
+        size_t pos = 1;
+        auto count = read_length(input, pos);
+        if (!count) {
+            if (count.error() != ParseError::Incomplete) {
+                reset();
+            }
+            return std::unexpected(count.error());
+        }
+        if (*count > MAX_MULTIBULK_COUNT) {
+            reset();
+            return std::unexpected(ParseError::InvalidLength);
+        }
+        // 元素个数小于等于 0 的数组是空请求
+        if (*count <= 0) {
+            return pos;
+        }
+        pos_ = pos;
+        remaining_ = *count;
+        args_.clear();
+        phase_ = Phase::BulkHeader;
+    }
+
+    while (remaining_ > 0) {
+        if (phase_ == Phase::BulkHeader) {
+            if (pos_ >= input.size()) {
+                return std::unexpected(ParseError::Incomplete);
+            }
+            // 请求中的每个元素都必须是批量字符串
+            if (input[pos_] != '$') {
+                reset();
+                return std::unexpected(ParseError::InvalidType);
+            }
+            size_t pos = pos_ + 1;
+            auto len = read_length(input, pos);
+            if (!len) {
+                if (len.error() != ParseError::Incomplete) {
+                    reset();
+                }
+                return std::unexpected(len.error());
+            }
+            if (*len < 0 || *len > MAX_BULK_LENGTH) {
+                reset();
+                return std::unexpected(ParseError::InvalidLength);
+            }
+            pos_ = pos;
+            bulk_len_ = static_cast<size_t>(*len);
+            phase_ = Phase::BulkData;
+        }
+        // 参数数据尚未到齐时不做任何扫描，等待下次数据到达
+        if (input.size() - pos_ < bulk_len_ + 2) {
+            return std::unexpected(ParseError::Incomplete);
+        }
+        if (input[pos_ + bulk_len_] != '\r' || input[pos_ + bulk_len_ + 1] != '\n') {
+            reset();
+            return std::unexpected(ParseError::InvalidLength);
+        }
+        args_.push_back({pos_, bulk_len_});
+        pos_ += bulk_len_ + 2;
+        --remaining_;
+        phase_ = Phase::BulkHeader;
+    }
+
+    // 请求完整，按偏移生成指向本次输入的参数视图
+    for (const auto &arg : args_) {
+        argv.push_back(input.substr(arg.offset, arg.length));
+    }
+    size_t consumed = pos_;
+    reset();
+    return consumed;
+}
+
+std::expected<size_t, ParseError> parse_request(std::string_view input, RequestArgv &argv) {
+    RequestParser parser;
+    return parser.parse(input, argv);
+}
+
+std::vector<std::string> to_owned(std::span<const std::string_view> argv) {
+    return std::vector<std::string>(argv.begin(), argv.end());
+}
+
+bool equals_ignore_case(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (std::toupper(static_cast<unsigned char>(a[i])) != std::toupper(static_cast<unsigned char>(b[i]))) {
+            return false;
+        }
+    }
+    return true;
+}
+
 // 主解析函数，它处理回滚逻辑
 std::expected<RespValue, ParseError> parse(std::string_view &input) {
     std::string_view original_input = input;
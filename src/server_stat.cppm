@@ -1,13 +1,79 @@
 module;
 
-#include <atomic>
+#include <algorithm>
 #include <chrono>
 #include <format>
 #include <string>
+#include <string_view>
+#include <vector>
 
 export module server_stat;
 
+// slab 分配器中一个尺寸类别的占用情况
+export struct SlabClassInfo {
+  size_t object_size = 0; // 类别的对象大小（字节）
+  size_t slabs = 0;       // slab 数量
+  size_t used = 0;        // 已分配的对象数
+  size_t capacity = 0;    // 所有 slab 能容纳的对象数
+};
+
+// 键空间的统计信息，由键空间所在的 KVServer 提供给 INFO。
+export struct KeyspaceInfo {
+  size_t keys = 0;          // 键总数
+  size_t expires = 0;       // 设置了过期时间的键数量
+  long long avg_ttl_ms = 0; // 带过期时间的键的平均剩余生存时间（毫秒）
+  size_t table_bytes = 0;   // 哈希表本身占用的字节数
+  size_t entry_bytes = 0;   // 所有键值条目占用的字节数
+  size_t used_memory = 0;              // 计入内存上限的占用（键空间加过期索引）
+  size_t maxmemory = 0;                // 内存上限，0 表示不限制
+  std::string_view maxmemory_policy;   // 淘汰策略名
+  size_t lazyfree_pending_objects = 0; // 等待后台线程释放的对象数（全进程）
+  size_t lazyfreed_objects = 0;        // 后台线程已释放的对象数（全进程）
+  double mem_fragmentation_ratio = 1.0; // 条目实际占用（slab 加堆上的条目）与条目逻辑大小之比
+  size_t slab_bytes = 0;                // 所有 slab 的总字节数
+  size_t slab_used_bytes = 0;           // slab 中已分配对象按类别大小计算的字节数
+  bool active_defrag_running = false;   // 碎片整理是否正在进行
+  std::vector<SlabClassInfo> slab_classes; // 各尺寸类别的占用，只列出有 slab 的类别
+
+  // 合并另一个分片的键空间信息，多分片时 INFO 据此汇总。
+  // 平均 TTL 按过期键数加权，碎片率按条目逻辑大小加权；
+  // 内存上限、淘汰策略和惰性释放计数对全进程相同，保留自身的值
+  void merge(const KeyspaceInfo &other) {
+    if (expires + other.expires > 0) {
+      avg_ttl_ms = (avg_ttl_ms * static_cast<long long>(expires) +
+                    other.avg_ttl_ms * static_cast<long long>(other.expires)) /
+                   static_cast<long long>(expires + other.expires);
+    }
+    if (entry_bytes + other.entry_bytes > 0) {
+      mem_fragmentation_ratio = (mem_fragmentation_ratio * static_cast<double>(entry_bytes) +
+                                 other.mem_fragmentation_ratio * static_cast<double>(other.entry_bytes)) /
+                                static_cast<double>(entry_bytes + other.entry_bytes);
+    }
+    keys += other.keys;
+    expires += other.expires;
+    table_bytes += other.table_bytes;
+    entry_bytes += other.entry_bytes;
+    used_memory += other.used_memory;
+    slab_bytes += other.slab_bytes;
+    slab_used_bytes += other.slab_used_bytes;
+    active_defrag_running = active_defrag_running || other.active_defrag_running;
+    for (const auto &cls : other.slab_classes) {
+      auto it = std::lower_bound(slab_classes.begin(), slab_classes.end(), cls.object_size,
+                                 [](const SlabClassInfo &c, size_t size) { return c.object_size < size; });
+      if (it == slab_classes.end() || it->object_size != cls.object_size) {
+        slab_classes.insert(it, cls);
+        continue;
+      }
+      it->slabs += cls.slabs;
+      it->used += cls.used;
+      it->capacity += cls.capacity;
+    }
+  }
+};
+
 // ServerStat 类用于跟踪和报告服务器的统计信息。
+// 每个分片（事件循环）拥有自己的一份，只在该事件循环的线程上修改，计数器不需要原子操作；
+// 多分片时 INFO 把各分片的副本合并后输出
 export class ServerStat {
 public:
   // 构造函数，记录服务器启动时间。
@@ -17,16 +83,56 @@ public:
   void increment_clients() { connected_clients_++; }
   // 减少当前连接的客户端数量。
   void decrement_clients() { connected_clients_--; }
+  // 增加/减少因阻塞命令挂起的客户端数量。
+  void increment_blocked_clients() { blocked_clients_++; }
+  void decrement_blocked_clients() { blocked_clients_--; }
   // 增加已处理的命令总数。
   void increment_commands_processed() { total_commands_processed_++; }
   // 增加键空间命中次数。
   void increment_keyspace_hits() { keyspace_hits_++; }
   // 增加键空间未命中次数。
   void increment_keyspace_misses() { keyspace_misses_++; }
+  // 增加因过期被删除的键数量（惰性删除与主动过期都计入）。
+  void increment_expired_keys() { expired_keys_++; }
+  // 增加因内存上限被淘汰的键数量。
+  void increment_evicted_keys() { evicted_keys_++; }
+  // 记录一次碎片整理：搬迁的条目数和扫描到但无需搬迁的条目数。
+  void record_active_defrag(long long hits, long long misses) {
+    active_defrag_hits_ += hits;
+    active_defrag_misses_ += misses;
+  }
+  // 记录一次主动过期周期：删除的键数、耗时（微秒）以及是否因时间预算用尽而提前结束。
+  void record_expire_cycle(long long expired, long long elapsed_us, bool time_cap_reached) {
+    expire_cycles_++;
+    expire_cycle_time_us_ += elapsed_us;
+    expire_cycle_last_expired_ = expired;
+    expire_cycle_last_time_us_ = elapsed_us;
+    if (time_cap_reached) {
+      expired_time_cap_reached_count_++;
+    }
+  }
+
+  // 累加另一个分片的计数。最近一次过期周期的数据取各分片之和，启动时间保留自身的值
+  void merge(const ServerStat &other) {
+    connected_clients_ += other.connected_clients_;
+    blocked_clients_ += other.blocked_clients_;
+    total_commands_processed_ += other.total_commands_processed_;
+    keyspace_hits_ += other.keyspace_hits_;
+    keyspace_misses_ += other.keyspace_misses_;
+    expired_keys_ += other.expired_keys_;
+    evicted_keys_ += other.evicted_keys_;
+    active_defrag_hits_ += other.active_defrag_hits_;
+    active_defrag_misses_ += other.active_defrag_misses_;
+    expire_cycles_ += other.expire_cycles_;
+    expire_cycle_time_us_ += other.expire_cycle_time_us_;
+    expired_time_cap_reached_count_ += other.expired_time_cap_reached_count_;
+    expire_cycle_last_expired_ += other.expire_cycle_last_expired_;
+    expire_cycle_last_time_us_ += other.expire_cycle_last_time_us_;
+  }
 
   // 生成并返回格式化的服务器信息字符串，类似于 Redis 的 INFO 命令。
-  // @param num_keys 数据库中的键总数。
-  std::string get_info(size_t num_keys) const {
+  // @param keyspace 键空间的统计信息。
+  std::string get_info(const KeyspaceInfo &keyspace) const {
     auto now = std::chrono::steady_clock::now();
     auto uptime =
         std::chrono::duration_cast<std::chrono::seconds>(now - start_time_)
@@ -42,33 +148,102 @@ public:
     // --- 客户端信息 ---
     info_str += "# Clients\r\n";
     info_str +=
-        std::format("connected_clients:{}\r\n", connected_clients_.load());
+        std::format("connected_clients:{}\r\n", connected_clients_);
+    info_str += std::format("blocked_clients:{}\r\n", blocked_clients_);
     info_str += "\r\n";
 
     // --- 统计数据 ---
     info_str += "# Stats\r\n";
     info_str += std::format("total_commands_processed:{}\r\n",
-                            total_commands_processed_.load());
-    info_str += std::format("keyspace_hits:{}\r\n", keyspace_hits_.load());
-    info_str += std::format("keyspace_misses:{}\r\n", keyspace_misses_.load());
+                            total_commands_processed_);
+    info_str += std::format("keyspace_hits:{}\r\n", keyspace_hits_);
+    info_str += std::format("keyspace_misses:{}\r\n", keyspace_misses_);
+    info_str += std::format("expired_keys:{}\r\n", expired_keys_);
+    info_str += std::format("evicted_keys:{}\r\n", evicted_keys_);
+    info_str += std::format("expired_time_cap_reached_count:{}\r\n",
+                            expired_time_cap_reached_count_);
+    info_str += std::format("expire_cycles:{}\r\n", expire_cycles_);
+    info_str += std::format("expire_cycle_cpu_milliseconds:{}\r\n",
+                            expire_cycle_time_us_ / 1000);
+    info_str += std::format("expire_cycle_last_expired:{}\r\n",
+                            expire_cycle_last_expired_);
+    info_str += std::format("expire_cycle_last_time_us:{}\r\n",
+                            expire_cycle_last_time_us_);
+    info_str += std::format("active_defrag_running:{}\r\n", keyspace.active_defrag_running ? 1 : 0);
+    info_str += std::format("active_defrag_hits:{}\r\n", active_defrag_hits_);
+    info_str += std::format("active_defrag_misses:{}\r\n", active_defrag_misses_);
+    info_str += "\r\n";
+
+    // --- 内存信息 ---
+    size_t keyspace_bytes = keyspace.table_bytes + keyspace.entry_bytes;
+    info_str += "# Memory\r\n";
+    info_str += std::format("used_memory:{}\r\n", keyspace.used_memory);
+    info_str += std::format("maxmemory:{}\r\n", keyspace.maxmemory);
+    info_str += std::format("maxmemory_policy:{}\r\n", keyspace.maxmemory_policy);
+    info_str += std::format("used_memory_keyspace:{}\r\n", keyspace_bytes);
+    info_str += std::format("keyspace_table_bytes:{}\r\n", keyspace.table_bytes);
+    info_str += std::format("keyspace_entry_bytes:{}\r\n", keyspace.entry_bytes);
+    info_str += std::format(
+        "keyspace_bytes_per_key:{:.2f}\r\n",
+        keyspace.keys == 0 ? 0.0
+                           : static_cast<double>(keyspace_bytes) / keyspace.keys);
+    info_str += std::format("lazyfree_pending_objects:{}\r\n", keyspace.lazyfree_pending_objects);
+    info_str += std::format("lazyfreed_objects:{}\r\n", keyspace.lazyfreed_objects);
+    info_str += std::format("mem_fragmentation_ratio:{:.2f}\r\n", keyspace.mem_fragmentation_ratio);
+    info_str += std::format("slab_bytes:{}\r\n", keyspace.slab_bytes);
+    info_str += std::format("slab_used_bytes:{}\r\n", keyspace.slab_used_bytes);
+    info_str += "\r\n";
+
+    // --- slab 各尺寸类别的占用 ---
+    info_str += "# Slabs\r\n";
+    for (const auto &cls : keyspace.slab_classes) {
+      info_str += std::format(
+          "class_{}:slabs={},used={},capacity={},occupancy={:.2f}%\r\n", cls.object_size, cls.slabs,
+          cls.used, cls.capacity,
+          cls.capacity == 0 ? 0.0 : 100.0 * static_cast<double>(cls.used) / cls.capacity);
+    }
     info_str += "\r\n";
 
     // --- 键空间信息 ---
     info_str += "# Keyspace\r\n";
-    info_str += std::format("db0:keys={},expires=0,avg_ttl=0\r\n", num_keys);
+    info_str += std::format("db0:keys={},expires={},avg_ttl={}\r\n",
+                            keyspace.keys, keyspace.expires,
+                            keyspace.avg_ttl_ms);
 
     return info_str;
   }
 
 private:
-  // 原子变量，用于线程安全地跟踪连接的客户端数量。
-  std::atomic<int> connected_clients_{0};
-  // 原子变量，用于线程安全地跟踪已处理的命令总数。
-  std::atomic<long long> total_commands_processed_{0};
-  // 原子变量，用于线程安全地跟踪键空间命中次数。
-  std::atomic<long long> keyspace_hits_{0};
-  // 原子变量，用于线程安全地跟踪键空间未命中次数。
-  std::atomic<long long> keyspace_misses_{0};
+  // 连接在本事件循环上的客户端数量。
+  int connected_clients_ = 0;
+  // 在本分片的阻塞命令等待队列中挂起的客户端数量。
+  int blocked_clients_ = 0;
+  // 已处理的命令总数。
+  long long total_commands_processed_ = 0;
+  // 键空间命中次数。
+  long long keyspace_hits_ = 0;
+  // 键空间未命中次数。
+  long long keyspace_misses_ = 0;
+  // 因过期被删除的键总数。
+  long long expired_keys_ = 0;
+  // 因内存上限被淘汰的键总数。
+  long long evicted_keys_ = 0;
+  // 碎片整理搬迁的条目数和扫描到但无需搬迁的条目数。
+  long long active_defrag_hits_ = 0;
+  long long active_defrag_misses_ = 0;
+  // 主动过期周期的执行次数、累计耗时（微秒）和因时间预算用尽而提前结束的次数。
+  long long expire_cycles_ = 0;
+  long long expire_cycle_time_us_ = 0;
+  long long expired_time_cap_reached_count_ = 0;
+  // 最近一次主动过期周期删除的键数和耗时（微秒）。
+  long long expire_cycle_last_expired_ = 0;
+  long long expire_cycle_last_time_us_ = 0;
   // 服务器启动时间点，用于计算运行时长。
   std::chrono::steady_clock::time_point start_time_;
-};
\ No newline at end of file
+};
+
+// 一个分片的统计信息快照，在分片所在的事件循环上生成，交给执行 INFO 的事件循环汇总
+export struct ShardInfo {
+  ServerStat stats;
+  KeyspaceInfo keyspace;
+};
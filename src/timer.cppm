@@ -52,11 +52,19 @@ private:
     std::chrono::milliseconds interval_;   // 定时器间隔
 };
 
+// 按过期时间排序，支持直接用 Timer 指针查找（取消定时器时使用）
 struct TimerCmp {
+    using is_transparent = void;
     bool operator()(const std::unique_ptr<Timer> &lhs,
                     const std::unique_ptr<Timer> &rhs) const {
         return lhs->expiration() < rhs->expiration();
     }
+    bool operator()(const std::unique_ptr<Timer> &lhs, const Timer *rhs) const {
+        return lhs->expiration() < rhs->expiration();
+    }
+    bool operator()(const Timer *lhs, const std::unique_ptr<Timer> &rhs) const {
+        return lhs->expiration() < rhs->expiration();
+    }
 };
 
 // 定时器队列
@@ -67,13 +75,16 @@ public:
     int timer_fd() const { return timer_fd_; } // 获取 timer_fd
     Timer *add_timer(std::chrono::milliseconds when, TimerCallback cb, bool repeat = false,
                      std::chrono::milliseconds interval = std::chrono::milliseconds(0));           // 添加新定时器
+    // 取消尚未到期的定时器。只能传入仍在队列中的定时器，或正在本轮到期处理中的定时器（此时不做任何事）
+    void cancel_timer(Timer *timer);
     void process_timer_event(); // 处理定时器事件
 
 private:
     int timer_fd_; // timerfd 文件描述符
     void reset_timerfd(); // 重置 timerfd
     std::chrono::milliseconds now(); // 获取当前时间
-    std::set<std::unique_ptr<Timer>, TimerCmp> timers_; // 定时器集合
+    // 定时器集合。过期时间相同的定时器（如同一毫秒内以相同超时阻塞的客户端）可以共存
+    std::multiset<std::unique_ptr<Timer>, TimerCmp> timers_;
 };
 
 TimerQueue::TimerQueue(){
@@ -115,6 +126,17 @@ Timer *TimerQueue::add_timer(std::chrono::milliseconds when, TimerCallback cb, b
     return timer_ptr;
 }
 
+// 取消定时器。按过期时间找到范围后比较指针，不触发回调
+void TimerQueue::cancel_timer(Timer *timer) {
+    auto [first, last] = timers_.equal_range(timer);
+    for (auto it = first; it != last; ++it) {
+        if (it->get() == timer) {
+            timers_.erase(it);
+            return;
+        }
+    }
+}
+
 void TimerQueue::reset_timerfd() {
     if(timers_.empty()) {
         return;
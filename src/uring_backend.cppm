@@ -0,0 +1,506 @@
+module;
+
+#ifdef MINI_REDIS_HAVE_IO_URING
+#include <liburing.h>
+#endif
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <poll.h>
+#include <string_view>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+export module uring_backend;
+
+import event_backend;
+import buffer;
+import logger;
+
+// 创建 io_uring 事件后端。编译时未找到 liburing 或内核不支持所需特性
+// （multishot accept/recv、provided buffer ring，需要 Linux 6.0+）时返回 nullptr
+export std::unique_ptr<EventBackend> create_uring_backend();
+
+#ifdef MINI_REDIS_HAVE_IO_URING
+
+namespace {
+
+constexpr unsigned RING_ENTRIES = 4096;          // 提交队列大小
+constexpr unsigned RECV_BUFFER_COUNT = 1024;     // 提供给内核的接收缓冲区数量，必须是 2 的幂
+constexpr unsigned RECV_BUFFER_SIZE = 16 * 1024; // 每个接收缓冲区的大小
+constexpr int RECV_BUFFER_GROUP = 0;             // 接收缓冲区组编号
+
+// 操作类型编码在 user_data 的低 3 位，高位是连接对象指针或监听项下标
+enum UringOp : uint64_t { OpAccept = 0, OpWatch = 1, OpRecv = 2, OpSend = 3, OpCancel = 4, OpClose = 5, OpHup = 6 };
+constexpr uint64_t OP_MASK = 0x7;
+
+// 后端内部的连接状态。对象在所有已提交的操作完成前不能释放，
+// 因此与服务器中的连接对象分开管理
+struct alignas(8) UringConnection {
+    explicit UringConnection(int conn_fd) : fd(conn_fd) {}
+
+    int fd;
+    Buffer sending;             // 正在发送（或即将提交）的数据，发送期间内核直接读取，不能改动
+    bool send_queued = false;   // 有待在本轮末尾提交的发送
+    bool send_inflight = false; // 有已提交尚未完成的发送
+    bool recv_armed = false;    // multishot recv 仍在进行
+    bool recv_paused = false;   // 服务器暂停接收输入，recv 已取消且不再重新提交
+    bool hup_armed = false;     // 暂停期间监视对端关闭的 poll 仍在进行
+    bool closing = false;       // 服务器已关闭该连接
+    bool torn_down = false;     // 已提交取消和关闭操作
+    int pending_ops = 0;        // 已提交尚未完成的操作数量
+};
+
+uint64_t tag(const void *ptr, UringOp op) { return reinterpret_cast<uint64_t>(ptr) | op; }
+
+} // namespace
+
+// 基于 io_uring 的事件后端：multishot accept、provided buffer 上的 multishot recv，
+// 发送在每轮事件处理结束后批量提交，与等待完成事件合并为一次 io_uring_submit_and_wait
+class UringBackend : public EventBackend {
+public:
+    UringBackend() = default;
+    ~UringBackend() override;
+
+    bool setup(); // 创建 ring 和接收缓冲区，内核不支持时返回 false
+
+    const char *name() const override { return "io_uring"; }
+    bool init(int listen_fd, ConnectionHandler &handler) override;
+    bool watch(int fd, std::function<void()> on_readable) override;
+    bool send(int fd, Buffer &output) override;
+    void resume_reading(int fd) override;
+    void close_connection(int fd) override;
+    void run() override;
+
+private:
+    io_uring_sqe *get_sqe();                 // 获取一个 SQE，提交队列满时先提交
+    void arm_accept();                       // 提交 multishot accept
+    void arm_watch(size_t index);            // 提交内部文件描述符的 multishot poll
+    void arm_recv(UringConnection *conn);    // 提交 multishot recv
+    void pause_recv(UringConnection *conn);  // 取消 multishot recv，改为只监视对端关闭
+    void submit_send(UringConnection *conn); // 提交 conn->sending 的发送
+    void submit_teardown(UringConnection *conn, bool after_send); // 取消连接上的所有操作并关闭 fd
+    void flush_pending_sends();              // 提交本轮积累的发送
+    void handle_cqe(const io_uring_cqe *cqe);
+    void handle_recv(UringConnection *conn, const io_uring_cqe *cqe);
+    void handle_send(UringConnection *conn, int res);
+    void handle_hup(UringConnection *conn, int res);
+    void recycle_buffer(unsigned short bid); // 将接收缓冲区归还给内核
+    void release(UringConnection *conn);     // 一个操作完成，必要时释放连接对象
+
+    io_uring ring_{};
+    bool ring_ready_ = false;
+    io_uring_buf_ring *buf_ring_ = nullptr;
+    std::vector<char> recv_buffers_;
+    int listen_fd_ = -1;
+    ConnectionHandler *handler_ = nullptr;
+    std::vector<std::pair<int, std::function<void()>>> watchers_;
+    std::unordered_map<int, UringConnection *> connections_; // 仍处于打开状态的连接
+    std::vector<UringConnection *> pending_sends_;           // 本轮待提交发送的连接
+};
+
+UringBackend::~UringBackend() {
+    for (auto &[fd, conn] : connections_) {
+        close(fd);
+        delete conn;
+    }
+    if (buf_ring_) {
+        io_uring_free_buf_ring(&ring_, buf_ring_, RECV_BUFFER_COUNT, RECV_BUFFER_GROUP);
+    }
+    if (ring_ready_) {
+        io_uring_queue_exit(&ring_);
+    }
+}
+
+bool UringBackend::setup() {
+    io_uring_params params{};
+    params.flags = IORING_SETUP_COOP_TASKRUN; // 完成事件在下次进入内核时处理，减少处理器间中断
+    int ret = io_uring_queue_init_params(RING_ENTRIES, &ring_, &params);
+    if (ret == -EINVAL) {
+        params = io_uring_params{};
+        ret = io_uring_queue_init_params(RING_ENTRIES, &ring_, &params);
+    }
+    if (ret < 0) {
+        LOG_ERROR("创建 io_uring 失败: {}", strerror(-ret));
+        return false;
+    }
+    ring_ready_ = true;
+
+    buf_ring_ = io_uring_setup_buf_ring(&ring_, RECV_BUFFER_COUNT, RECV_BUFFER_GROUP, 0, &ret);
+    if (!buf_ring_) {
+        LOG_ERROR("注册 io_uring 接收缓冲区失败: {}", strerror(-ret));
+        return false;
+    }
+    recv_buffers_.resize(static_cast<size_t>(RECV_BUFFER_COUNT) * RECV_BUFFER_SIZE);
+    int mask = io_uring_buf_ring_mask(RECV_BUFFER_COUNT);
+    for (unsigned i = 0; i < RECV_BUFFER_COUNT; ++i) {
+        io_uring_buf_ring_add(buf_ring_, recv_buffers_.data() + static_cast<size_t>(i) * RECV_BUFFER_SIZE,
+                              RECV_BUFFER_SIZE, static_cast<unsigned short>(i), mask, static_cast<int>(i));
+    }
+    io_uring_buf_ring_advance(buf_ring_, RECV_BUFFER_COUNT);
+    return true;
+}
+
+bool UringBackend::init(int listen_fd, ConnectionHandler &handler) {
+    listen_fd_ = listen_fd;
+    handler_ = &handler;
+    arm_accept();
+    return true;
+}
+
+bool UringBackend::watch(int fd, std::function<void()> on_readable) {
+    watchers_.emplace_back(fd, std::move(on_readable));
+    arm_watch(watchers_.size() - 1);
+    return true;
+}
+
+io_uring_sqe *UringBackend::get_sqe() {
+    io_uring_sqe *sqe = io_uring_get_sqe(&ring_);
+    if (!sqe) {
+        io_uring_submit(&ring_);
+        sqe = io_uring_get_sqe(&ring_);
+    }
+    return sqe;
+}
+
+void UringBackend::arm_accept() {
+    io_uring_sqe *sqe = get_sqe();
+    io_uring_prep_multishot_accept(sqe, listen_fd_, nullptr, nullptr, 0);
+    io_uring_sqe_set_data64(sqe, OpAccept);
+}
+
+void UringBackend::arm_watch(size_t index) {
+    io_uring_sqe *sqe = get_sqe();
+    io_uring_prep_poll_multishot(sqe, watchers_[index].first, POLLIN);
+    io_uring_sqe_set_data64(sqe, (static_cast<uint64_t>(index) << 3) | OpWatch);
+}
+
+void UringBackend::arm_recv(UringConnection *conn) {
+    io_uring_sqe *sqe = get_sqe();
+    io_uring_prep_recv_multishot(sqe, conn->fd, nullptr, 0, 0);
+    sqe->flags |= IOSQE_BUFFER_SELECT;
+    sqe->buf_group = RECV_BUFFER_GROUP;
+    io_uring_sqe_set_data64(sqe, tag(conn, OpRecv));
+    conn->recv_armed = true;
+    conn->pending_ops++;
+}
+
+// 服务器暂停解析时停止接收：multishot recv 不取消的话会一直把数据拷进输入缓冲区。
+// 取消生效前已收到的数据照常追加。暂停期间数据留在内核中，由 TCP 流量控制反压客户端；
+// 另外提交一个 poll 监视对端关闭，使挂起的客户端断开时仍能及时关闭连接
+void UringBackend::pause_recv(UringConnection *conn) {
+    conn->recv_paused = true;
+    if (conn->recv_armed) {
+        io_uring_sqe *sqe = get_sqe();
+        io_uring_prep_cancel64(sqe, tag(conn, OpRecv), 0);
+        io_uring_sqe_set_data64(sqe, tag(conn, OpCancel));
+        conn->pending_ops++;
+    }
+    if (!conn->hup_armed) {
+        io_uring_sqe *sqe = get_sqe();
+        io_uring_prep_poll_add(sqe, conn->fd, POLLRDHUP);
+        io_uring_sqe_set_data64(sqe, tag(conn, OpHup));
+        conn->hup_armed = true;
+        conn->pending_ops++;
+    }
+}
+
+// 普通发送不与其他操作链接：同一连接同时只有一个发送在途，没有必须排在它之后的操作。
+// 只有关闭前的最后一次发送需要链接，见 submit_teardown
+void UringBackend::submit_send(UringConnection *conn) {
+    io_uring_sqe *sqe = get_sqe();
+    io_uring_prep_send(sqe, conn->fd, conn->sending.peek(), conn->sending.readable_bytes(), MSG_NOSIGNAL);
+    io_uring_sqe_set_data64(sqe, tag(conn, OpSend));
+    conn->send_inflight = true;
+    conn->pending_ops++;
+}
+
+// 关闭连接：取消该 fd 上的所有操作（multishot recv 等）后再关闭 fd。
+// 关闭前 fd 编号不会被复用，因此取消操作不会误伤新连接。
+// after_send 为 true 时，最后一次发送与取消、关闭硬链接在一起一次提交，保证先发后关
+void UringBackend::submit_teardown(UringConnection *conn, bool after_send) {
+    conn->torn_down = true;
+    // 链接中的 SQE 必须在同一次提交中
+    if (io_uring_sq_space_left(&ring_) < 3) {
+        io_uring_submit(&ring_);
+    }
+    if (after_send) {
+        io_uring_sqe *send_sqe = get_sqe();
+        io_uring_prep_send(send_sqe, conn->fd, conn->sending.peek(), conn->sending.readable_bytes(),
+                           MSG_NOSIGNAL);
+        send_sqe->flags |= IOSQE_IO_HARDLINK;
+        io_uring_sqe_set_data64(send_sqe, tag(conn, OpSend));
+        conn->send_inflight = true;
+        conn->pending_ops++;
+    }
+    io_uring_sqe *cancel_sqe = get_sqe();
+    io_uring_prep_cancel_fd(cancel_sqe, conn->fd, IORING_ASYNC_CANCEL_ALL);
+    cancel_sqe->flags |= IOSQE_IO_HARDLINK;
+    io_uring_sqe_set_data64(cancel_sqe, tag(conn, OpCancel));
+    conn->pending_ops++;
+
+    io_uring_sqe *close_sqe = get_sqe();
+    io_uring_prep_close(close_sqe, conn->fd);
+    io_uring_sqe_set_data64(close_sqe, tag(conn, OpClose));
+    conn->pending_ops++;
+}
+
+bool UringBackend::send(int fd, Buffer &output) {
+    auto it = connections_.find(fd);
+    if (it == connections_.end() || output.readable_bytes() == 0) {
+        return true;
+    }
+    UringConnection *conn = it->second;
+    if (conn->send_inflight || conn->send_queued) {
+        // 同一 socket 上同时只允许一个发送，剩余数据留在 output 中，完成后经 on_writable 再次提交。
+        // 不能追加到已排队的发送里：服务器按 output 的积压量暂停解析，取走的数据它看不到
+        return true;
+    }
+    conn->sending.swap(output); // 交换缓冲区，避免拷贝
+    conn->send_queued = true;
+    pending_sends_.push_back(conn);
+    return true;
+}
+
+void UringBackend::resume_reading(int fd) {
+    auto it = connections_.find(fd);
+    if (it == connections_.end() || !it->second->recv_paused) {
+        return;
+    }
+    UringConnection *conn = it->second;
+    conn->recv_paused = false;
+    // 取消尚未生效时 recv 仍在进行，其结束后在 handle_recv 中重新提交
+    if (!conn->recv_armed) {
+        arm_recv(conn);
+    }
+}
+
+void UringBackend::close_connection(int fd) {
+    auto it = connections_.find(fd);
+    if (it == connections_.end()) {
+        return;
+    }
+    UringConnection *conn = it->second;
+    connections_.erase(it);
+    conn->closing = true;
+    if (conn->send_queued) {
+        // 尚未提交的发送会在 flush_pending_sends 中与关闭操作链接在一起
+        return;
+    }
+    if (!conn->send_inflight) {
+        submit_teardown(conn, false);
+    }
+    // 发送进行中时，在发送完成后再关闭
+}
+
+void UringBackend::flush_pending_sends() {
+    for (UringConnection *conn : pending_sends_) {
+        conn->send_queued = false;
+        bool has_data = conn->sending.readable_bytes() > 0;
+        if (conn->closing) {
+            submit_teardown(conn, has_data);
+        } else if (has_data) {
+            submit_send(conn);
+        }
+    }
+    pending_sends_.clear();
+}
+
+void UringBackend::run() {
+    while (true) {
+        handler_->before_wait();
+        flush_pending_sends();
+        // 本轮准备的所有操作与等待合并为一次系统调用
+        int ret = io_uring_submit_and_wait(&ring_, 1);
+        if (ret < 0 && ret != -EINTR) {
+            LOG_ERROR("io_uring_submit_and_wait错误: {}", strerror(-ret));
+            break;
+        }
+        unsigned head;
+        unsigned count = 0;
+        io_uring_cqe *cqe;
+        io_uring_for_each_cqe(&ring_, head, cqe) {
+            handle_cqe(cqe);
+            ++count;
+        }
+        io_uring_cq_advance(&ring_, count);
+    }
+}
+
+void UringBackend::handle_cqe(const io_uring_cqe *cqe) {
+    uint64_t data = io_uring_cqe_get_data64(cqe);
+    bool more = cqe->flags & IORING_CQE_F_MORE;
+    switch (data & OP_MASK) {
+    case OpAccept:
+        if (cqe->res >= 0) {
+            auto *conn = new UringConnection(cqe->res);
+            connections_[conn->fd] = conn;
+            arm_recv(conn);
+            handler_->on_accept(conn->fd);
+        } else {
+            LOG_ERROR("接受连接失败: {}", strerror(-cqe->res));
+        }
+        if (!more) {
+            arm_accept();
+        }
+        return;
+    case OpWatch: {
+        size_t index = data >> 3;
+        if (cqe->res >= 0) {
+            watchers_[index].second();
+        }
+        if (!more) {
+            arm_watch(index);
+        }
+        return;
+    }
+    default:
+        break;
+    }
+
+    auto *conn = reinterpret_cast<UringConnection *>(data & ~OP_MASK);
+    switch (data & OP_MASK) {
+    case OpRecv:
+        handle_recv(conn, cqe);
+        if (!more) {
+            release(conn);
+        }
+        break;
+    case OpSend:
+        handle_send(conn, cqe->res);
+        release(conn);
+        break;
+    case OpHup:
+        handle_hup(conn, cqe->res);
+        release(conn);
+        break;
+    case OpClose:
+        if (cqe->res == -ECANCELED) {
+            close(conn->fd); // 链接被打断时自行关闭
+        }
+        release(conn);
+        break;
+    default: // OpCancel
+        release(conn);
+        break;
+    }
+}
+
+void UringBackend::handle_recv(UringConnection *conn, const io_uring_cqe *cqe) {
+    bool more = cqe->flags & IORING_CQE_F_MORE;
+    if (!more) {
+        conn->recv_armed = false;
+    }
+    if (cqe->res > 0) {
+        unsigned short bid = cqe->flags >> IORING_CQE_BUFFER_SHIFT;
+        std::string_view data(recv_buffers_.data() + static_cast<size_t>(bid) * RECV_BUFFER_SIZE,
+                              static_cast<size_t>(cqe->res));
+        Buffer *input = conn->closing ? nullptr : handler_->input_buffer(conn->fd);
+        if (input) {
+            input->append(data);
+        }
+        recycle_buffer(bid);
+        if (input) {
+            handler_->on_input(conn->fd);
+        }
+        // on_input 可能关闭了连接
+        if (conn->closing) {
+            return;
+        }
+        if (!conn->recv_paused && !handler_->accepts_input(conn->fd)) {
+            pause_recv(conn);
+        }
+        // multishot 被内核终止（例如接收缓冲区暂时耗尽）时重新提交，暂停期间不提交
+        if (!conn->recv_armed && !conn->recv_paused) {
+            arm_recv(conn);
+        }
+        return;
+    }
+    if (conn->closing) {
+        return;
+    }
+    if (cqe->res == -ECANCELED) {
+        // 暂停时取消的 recv 结束；取消生效前已经恢复的话重新提交
+        if (!conn->recv_paused) {
+            arm_recv(conn);
+        }
+    } else if (cqe->res == -ENOBUFS) {
+        if (!conn->recv_paused) {
+            LOG_WARN("io_uring 接收缓冲区耗尽，重新提交接收");
+            arm_recv(conn);
+        }
+    } else if (cqe->res == 0) {
+        handler_->on_peer_closed(conn->fd, 0);
+    } else {
+        handler_->on_peer_closed(conn->fd, -cqe->res);
+    }
+}
+
+void UringBackend::handle_send(UringConnection *conn, int res) {
+    conn->send_inflight = false;
+    if (res < 0) {
+        conn->sending.retrieve_all();
+    } else {
+        conn->sending.retrieve(static_cast<size_t>(res));
+    }
+    if (conn->closing) {
+        // 发送期间连接被关闭：发送结束后再关闭，剩余数据与关闭链接在一起提交
+        if (!conn->torn_down) {
+            submit_teardown(conn, conn->sending.readable_bytes() > 0);
+        }
+        return;
+    }
+    if (res < 0) {
+        handler_->on_peer_closed(conn->fd, -res);
+        return;
+    }
+    if (conn->sending.readable_bytes() > 0) {
+        submit_send(conn); // 部分发送，继续发送剩余数据
+        return;
+    }
+    handler_->on_writable(conn->fd);
+}
+
+// 暂停期间对端关闭或出错时关闭连接；已恢复接收时由 recv 读到 EOF 处理
+void UringBackend::handle_hup(UringConnection *conn, int res) {
+    conn->hup_armed = false;
+    if (conn->closing || !conn->recv_paused || res == -ECANCELED) {
+        return;
+    }
+    handler_->on_peer_closed(conn->fd, res < 0 ? -res : 0);
+}
+
+void UringBackend::recycle_buffer(unsigned short bid) {
+    io_uring_buf_ring_add(buf_ring_, recv_buffers_.data() + static_cast<size_t>(bid) * RECV_BUFFER_SIZE,
+                          RECV_BUFFER_SIZE, bid, io_uring_buf_ring_mask(RECV_BUFFER_COUNT), 0);
+    io_uring_buf_ring_advance(buf_ring_, 1);
+}
+
+// 仍在 pending_sends_ 中的连接不能释放，关闭操作在 flush_pending_sends 中才提交
+void UringBackend::release(UringConnection *conn) {
+    if (--conn->pending_ops == 0 && conn->closing && !conn->send_queued) {
+        delete conn;
+    }
+}
+
+std::unique_ptr<EventBackend> create_uring_backend() {
+    auto backend = std::make_unique<UringBackend>();
+    if (!backend->setup()) {
+        return nullptr;
+    }
+    return backend;
+}
+
+#else
+
+std::unique_ptr<EventBackend> create_uring_backend() {
+    LOG_WARN("编译时未找到 liburing，io_uring 事件后端不可用");
+    return nullptr;
+}
+
+#endif
@@ -5,6 +5,7 @@
 #include <iostream>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 
 // 导入所需的 C++23 模块。
@@ -124,6 +125,56 @@ void test_aof_load() {
   std::filesystem::remove(aof_filename);
 }
 
+// 测试带过期时间的写入：每次写入只追加一条记录，过期时间以绝对时间保存
+void test_aof_absolute_expiry() {
+  std::cout << "--- 正在测试: AOF 绝对过期时间 ---" << std::endl;
+  const std::string aof_filename = "test_expiry.aof";
+  std::filesystem::remove(aof_filename);
+
+  {
+    Aof aof_logger(aof_filename);
+    KVServer server;
+    server.set_aof(&aof_logger);
+    using Argv = std::vector<std::string_view>;
+    server.execute_command(Argv{"SET", "session", "abc", "EX", "100"});
+    server.execute_command(Argv{"SETEX", "token", "200", "xyz"});
+    server.execute_command(Argv{"SET", "session", "other", "NX"}); // 条件不满足，不追加
+    server.execute_command(Argv{"SET", "bad", "v", "EX", "0"});    // 出错，不追加
+    server.execute_command(Argv{"GETEX", "token", "PX", "300000"});
+
+    auto commands = aof_logger.load_commands();
+    assert(commands.size() == 3);
+    std::cout << "  [通过] 每次写入只追加一条记录，未生效的写入不追加。" << std::endl;
+  }
+
+  std::ifstream aof_file(aof_filename);
+  std::string content((std::istreambuf_iterator<char>(aof_file)),
+                      std::istreambuf_iterator<char>());
+  assert(content.find("PXAT") != std::string::npos);
+  assert(content.find("PEXPIREAT") != std::string::npos);
+  assert(content.find("SETEX") == std::string::npos);
+  assert(content.find("GETEX") == std::string::npos);
+  std::cout << "  [通过] 相对过期时间已换算为绝对时间。" << std::endl;
+
+  // 重放后过期时间不受重放时刻影响
+  Aof replay_logger(aof_filename);
+  KVServer server;
+  for (const auto &cmd : replay_logger.load_commands()) {
+    server.execute_command(cmd, true);
+  }
+  using Argv = std::vector<std::string_view>;
+  assert(server.execute_command(Argv{"GET", "session"}) == resp::serialize_bulk_string("abc"));
+  std::string ttl = server.execute_command(Argv{"TTL", "session"});
+  assert(ttl == resp::serialize_integer(100) || ttl == resp::serialize_integer(99));
+  std::string pttl = server.execute_command(Argv{"PTTL", "token"});
+  long long token_ms = std::stoll(pttl.substr(1));
+  assert(token_ms > 299000 && token_ms <= 300000);
+  std::cout << "  [通过] 重放后过期时间正确。" << std::endl;
+
+  aof_file.close();
+  std::filesystem::remove(aof_filename);
+}
+
 // 测试加载空的 AOF 文件
 void test_empty_aof_load() {
   std::cout << "--- 正在测试: 加载空 AOF 文件 ---" << std::endl;
@@ -148,6 +199,7 @@ int main() {
   std::cout << "--- 开始 AOF 单元测试 ---" << std::endl;
   test_aof_append();
   test_aof_load();
+  test_aof_absolute_expiry();
   test_empty_aof_load();
   std::cout << "--- AOF 单元测试全部通过 ---" << std::endl;
   return 0;
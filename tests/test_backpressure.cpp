@@ -0,0 +1,343 @@
+#include <arpa/inet.h>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <netinet/in.h>
+#include <optional>
+#include <poll.h>
+#include <string>
+#include <string_view>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+import application;
+
+// 输入背压的端到端测试：客户端只管发送、从不读取回复时，服务器在暂停解析的同时停止读取，
+// 请求积压在内核的套接字缓冲区中由 TCP 流量控制反压客户端，服务器的内存不随发送量增长
+
+// 测试辅助宏
+#define TEST_ASSERT(condition, message)                                        \
+  do {                                                                         \
+    if (!(condition)) {                                                        \
+      std::cerr << "断言失败: " << message << " 在 " << __FILE__ << " 行 "    \
+                << __LINE__ << std::endl;                                      \
+      return false;                                                            \
+    }                                                                          \
+  } while (0)
+
+constexpr int kPort = 16410;
+constexpr size_t kSendLimit = 256 * 1024 * 1024; // 服务器不停止读取时客户端最多发送的字节数
+constexpr size_t kStallBound = 64 * 1024 * 1024; // 停止读取前允许发出的字节数（内核缓冲区加一个高水位）
+
+pid_t server_pid = -1;
+// 服务器使用的事件后端，由第一个命令行参数指定（默认 epoll）
+std::string event_backend = "epoll";
+
+// 在子进程中启动服务器
+pid_t spawn_server(int port, const std::string &config_file) {
+  {
+    std::ofstream config(config_file);
+    config << "port " << port << "\n";
+    config << "loglevel error\n";
+    config << "event-backend " << event_backend << "\n";
+  }
+
+  pid_t pid = fork();
+  if (pid == 0) {
+    Application app;
+    if (!app.init(config_file)) {
+      _exit(1);
+    }
+    app.run();
+    _exit(0);
+  }
+  return pid;
+}
+
+// 服务器进程的常驻内存（字节），读取失败时返回 0
+size_t server_rss() {
+  std::ifstream status("/proc/" + std::to_string(server_pid) + "/status");
+  std::string line;
+  while (std::getline(status, line)) {
+    if (line.rfind("VmRSS:", 0) == 0) {
+      return std::stoull(line.substr(6)) * 1024;
+    }
+  }
+  return 0;
+}
+
+// 完整的一条回复在 data 开头时返回它的长度，不完整时返回 0
+size_t reply_length(std::string_view data) {
+  size_t line_end = data.find("\r\n");
+  if (line_end == std::string_view::npos) {
+    return 0;
+  }
+  size_t length = line_end + 2;
+  if (data[0] == '$') {
+    long long n = std::stoll(std::string(data.substr(1, line_end - 1)));
+    if (n < 0) {
+      return length;
+    }
+    return data.size() >= length + n + 2 ? length + n + 2 : 0;
+  }
+  return length;
+}
+
+std::string encode(const std::vector<std::string> &argv) {
+  std::string request = "*" + std::to_string(argv.size()) + "\r\n";
+  for (const auto &arg : argv) {
+    request += "$" + std::to_string(arg.size()) + "\r\n" + arg + "\r\n";
+  }
+  return request;
+}
+
+// 同步客户端：发送一条命令，读取一条完整的回复，读取超时或连接关闭时返回 nullopt
+class Client {
+public:
+  explicit Client(int port) {
+    // 服务器刚启动时可能还未开始监听，重试几次
+    for (int attempt = 0; attempt < 50 && fd_ == -1; ++attempt) {
+      fd_ = socket(AF_INET, SOCK_STREAM, 0);
+      sockaddr_in addr{};
+      addr.sin_family = AF_INET;
+      addr.sin_port = htons(port);
+      inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+      if (connect(fd_, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0) {
+        ::close(fd_);
+        fd_ = -1;
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+      }
+    }
+    if (fd_ != -1) {
+      timeval timeout{3, 0};
+      setsockopt(fd_, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    }
+  }
+  ~Client() {
+    if (fd_ != -1) {
+      ::close(fd_);
+    }
+  }
+  Client(const Client &) = delete;
+  Client &operator=(const Client &) = delete;
+
+  bool connected() const { return fd_ != -1; }
+
+  bool send_raw(const std::string &request) {
+    size_t sent = 0;
+    while (sent < request.size()) {
+      ssize_t n = ::send(fd_, request.data() + sent, request.size() - sent, MSG_NOSIGNAL);
+      if (n <= 0) {
+        return false;
+      }
+      sent += static_cast<size_t>(n);
+    }
+    return true;
+  }
+
+  // 不读取回复，反复发送 request，直到发送在 stall 时间内始终无法继续（对端停止读取）或发满 limit 字节。
+  // 返回已发出的字节数，以及是否因对端停止读取而停下
+  std::pair<size_t, bool> flood(const std::string &request, size_t limit, std::chrono::milliseconds stall) {
+    std::string batch;
+    while (batch.size() < 64 * 1024) {
+      batch += request;
+    }
+    size_t total = 0;
+    size_t offset = 0;
+    while (total < limit) {
+      ssize_t n = ::send(fd_, batch.data() + offset, batch.size() - offset, MSG_NOSIGNAL | MSG_DONTWAIT);
+      if (n > 0) {
+        total += static_cast<size_t>(n);
+        offset = (offset + static_cast<size_t>(n)) % batch.size();
+        continue;
+      }
+      if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+        break;
+      }
+      pollfd pfd{fd_, POLLOUT, 0};
+      if (poll(&pfd, 1, static_cast<int>(stall.count())) == 0) {
+        return {total, true};
+      }
+    }
+    return {total, false};
+  }
+
+  std::optional<std::string> read_reply() {
+    while (true) {
+      if (size_t length = reply_length(std::string_view(buffer_).substr(consumed_)); length > 0) {
+        std::string reply = buffer_.substr(consumed_, length);
+        consumed_ += length;
+        if (consumed_ > 1024 * 1024) {
+          buffer_.erase(0, consumed_);
+          consumed_ = 0;
+        }
+        return reply;
+      }
+      char chunk[65536];
+      ssize_t n = ::read(fd_, chunk, sizeof(chunk));
+      if (n <= 0) {
+        return std::nullopt;
+      }
+      buffer_.append(chunk, static_cast<size_t>(n));
+    }
+  }
+
+  std::optional<std::string> call(const std::vector<std::string> &argv) {
+    if (!send_raw(encode(argv))) {
+      return std::nullopt;
+    }
+    return read_reply();
+  }
+
+private:
+  int fd_ = -1;
+  std::string buffer_;
+  size_t consumed_ = 0;
+};
+
+std::string bulk(std::string_view s) { return "$" + std::to_string(s.size()) + "\r\n" + std::string(s) + "\r\n"; }
+
+// 测试从不读取回复的客户端：回复积压到高水位后服务器停止读取，客户端的发送被反压，服务器内存保持有界
+bool test_slow_reader_bounded() {
+  std::cout << "测试从不读取回复的客户端..." << std::endl;
+
+  Client admin(kPort);
+  TEST_ASSERT(admin.connected(), "无法连接服务器");
+  std::string value(1024, 'v');
+  TEST_ASSERT(admin.call({"SET", "big", value}) == "+OK\r\n", "SET 成功");
+  size_t rss_before = server_rss();
+  TEST_ASSERT(rss_before > 0, "无法读取服务器内存");
+
+  {
+    Client flooder(kPort);
+    TEST_ASSERT(flooder.connected(), "无法连接服务器");
+    auto [sent, stalled] = flooder.flood(encode({"GET", "big"}), kSendLimit, std::chrono::milliseconds(500));
+    size_t rss_after = server_rss();
+    std::cout << "停止前发出 " << sent << " 字节，服务器内存增长 "
+              << (rss_after > rss_before ? rss_after - rss_before : 0) << " 字节" << std::endl;
+    TEST_ASSERT(stalled, "服务器应停止读取，客户端的发送应被反压");
+    TEST_ASSERT(sent < kStallBound, "停止读取前不应接收过多请求");
+    TEST_ASSERT(rss_after < rss_before + kStallBound, "服务器内存不应随积压的请求增长");
+  }
+
+  // 积压的连接关闭后服务器照常服务
+  TEST_ASSERT(admin.call({"GET", "big"}) == bulk(value), "服务器应继续响应其他客户端");
+  std::cout << "从不读取回复的客户端测试通过！" << std::endl;
+  return true;
+}
+
+// 测试暂停后恢复：一次发出远超高水位的回复量，之后再读取，全部回复应按顺序到达
+bool test_resume_after_drain() {
+  std::cout << "测试回复读走后恢复读取..." << std::endl;
+
+  Client client(kPort);
+  TEST_ASSERT(client.connected(), "无法连接服务器");
+  std::string value(1024, 'r');
+  TEST_ASSERT(client.call({"SET", "resume", value}) == "+OK\r\n", "SET 成功");
+
+  constexpr int kCommands = 20000; // 约 20MB 回复，远超输出高水位
+  std::string batch;
+  for (int i = 0; i < kCommands; ++i) {
+    batch += encode({"GET", "resume"});
+  }
+  batch += encode({"EXISTS", "resume"});
+  // 另起线程发送，避免请求量超过内核缓冲区时与下面的读取互相等待
+  std::thread sender([&]() { client.send_raw(batch); });
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+  bool ok = true;
+  for (int i = 0; i < kCommands && ok; ++i) {
+    ok = client.read_reply() == bulk(value);
+  }
+  sender.join();
+  TEST_ASSERT(ok, "暂停期间的请求应在恢复后全部执行");
+  TEST_ASSERT(client.read_reply() == ":1\r\n", "最后一条命令的回复应最后到达");
+  std::cout << "回复读走后恢复读取测试通过！" << std::endl;
+  return true;
+}
+
+// 测试挂起的阻塞命令客户端继续发送：等待期间服务器同样停止读取，唤醒后积压的命令照常执行
+bool test_blocked_client_bounded() {
+  std::cout << "测试挂起期间继续发送的客户端..." << std::endl;
+
+  Client admin(kPort);
+  TEST_ASSERT(admin.connected(), "无法连接服务器");
+  Client blocked(kPort);
+  TEST_ASSERT(blocked.connected(), "无法连接服务器");
+  TEST_ASSERT(blocked.send_raw(encode({"BLPOP", "bp:list", "0"})), "发送 BLPOP 失败");
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+  auto [sent, stalled] = blocked.flood(encode({"EXISTS", "bp:list"}), kSendLimit, std::chrono::milliseconds(500));
+  TEST_ASSERT(stalled, "挂起期间服务器应停止读取");
+  TEST_ASSERT(sent < kStallBound, "挂起期间不应接收过多请求");
+
+  TEST_ASSERT(admin.call({"RPUSH", "bp:list", "x"}) == ":1\r\n", "RPUSH 成功");
+  TEST_ASSERT(blocked.read_reply() == "*2\r\n", "唤醒后收到 BLPOP 的回复");
+  TEST_ASSERT(blocked.read_reply() == bulk("bp:list"), "回复中的键名");
+  TEST_ASSERT(blocked.read_reply() == bulk("x"), "回复中的元素");
+  // 积压的命令可能以不完整的请求结尾，只检查之后仍能继续收到回复；元素已被取走，列表不存在
+  TEST_ASSERT(blocked.read_reply() == ":0\r\n", "唤醒后恢复读取并执行积压的命令");
+  std::cout << "挂起期间继续发送的客户端测试通过！" << std::endl;
+  return true;
+}
+
+int main(int argc, char *argv[]) {
+  if (argc > 1) {
+    event_backend = argv[1];
+  }
+  std::cout << "开始输入背压端到端测试（" << event_backend << "）..." << std::endl;
+  std::string config_file = "test_backpressure.conf";
+  server_pid = spawn_server(kPort, config_file);
+  if (server_pid <= 0) {
+    std::cerr << "启动服务器失败" << std::endl;
+    return 1;
+  }
+
+  bool all_passed = true;
+  std::vector<std::pair<std::string, std::function<bool()>>> tests = {
+      {"从不读取回复的客户端测试", test_slow_reader_bounded},
+      {"回复读走后恢复读取测试", test_resume_after_drain},
+      {"挂起期间继续发送的客户端测试", test_blocked_client_bounded}};
+
+  int passed = 0;
+  int failed = 0;
+
+  for (const auto &[name, test_func] : tests) {
+    std::cout << "\n===================================" << std::endl;
+    std::cout << "执行测试: " << name << std::endl;
+    std::cout << "===================================" << std::endl;
+
+    try {
+      if (test_func()) {
+        std::cout << "√ 测试通过: " << name << std::endl;
+        passed++;
+      } else {
+        std::cerr << "× 测试失败: " << name << std::endl;
+        all_passed = false;
+        failed++;
+      }
+    } catch (const std::exception &e) {
+      std::cerr << "× 测试出现异常: " << name << " - " << e.what() << std::endl;
+      all_passed = false;
+      failed++;
+    }
+  }
+
+  kill(server_pid, SIGKILL);
+  waitpid(server_pid, nullptr, 0);
+  std::remove(config_file.c_str());
+
+  std::cout << "\n===================================" << std::endl;
+  std::cout << "测试结果: " << (all_passed ? "全部通过" : "有测试失败") << std::endl;
+  std::cout << "通过: " << passed << " 个测试" << std::endl;
+  std::cout << "失败: " << failed << " 个测试" << std::endl;
+  std::cout << "===================================" << std::endl;
+
+  return all_passed ? 0 : 1;
+}
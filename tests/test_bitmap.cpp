@@ -0,0 +1,463 @@
+#include <functional>
+#include <iostream>
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+import resp;
+import kv_server;
+import command;
+import bitops;
+import logger;
+
+// 测试辅助宏
+#define TEST_ASSERT(condition, message)                                        \
+  do {                                                                         \
+    if (!(condition)) {                                                        \
+      std::cerr << "断言失败: " << message << " 在 " << __FILE__ << " 行 "    \
+                << __LINE__ << std::endl;                                      \
+      return false;                                                            \
+    }                                                                          \
+  } while (0)
+
+// 创建命令辅助函数
+resp::RespValue create_command(const std::vector<std::string> &parts) {
+  auto arr = std::make_unique<resp::RespArray>();
+
+  for (const auto &part : parts) {
+    resp::RespBulkString item;
+    item.value = part;
+    arr->values.push_back(item);
+  }
+
+  return resp::RespValue(std::move(arr));
+}
+
+std::string run(KVServer &server, const std::vector<std::string> &parts) {
+  return server.execute_command(create_command(parts));
+}
+
+std::string random_bytes(std::mt19937 &rng, size_t len) {
+  std::string s(len, '\0');
+  for (auto &c : s) {
+    c = static_cast<char>(rng());
+  }
+  return s;
+}
+
+// 逐位实现的参考版本
+bool naive_bit(std::string_view s, uint64_t pos) {
+  return pos / 8 < s.size() && ((static_cast<uint8_t>(s[pos / 8]) >> (7 - pos % 8)) & 1) != 0;
+}
+
+int64_t naive_count(std::string_view s, uint64_t first, uint64_t last) {
+  int64_t count = 0;
+  for (uint64_t pos = first; pos <= last; ++pos) {
+    count += naive_bit(s, pos) ? 1 : 0;
+  }
+  return count;
+}
+
+int64_t naive_pos(std::string_view s, bool bit, uint64_t first, uint64_t last) {
+  for (uint64_t pos = first; pos <= last; ++pos) {
+    if (naive_bit(s, pos) == bit) {
+      return static_cast<int64_t>(pos);
+    }
+  }
+  return -1;
+}
+
+// 测试 SETBIT/GETBIT：扩展、旧值、整数编码的值和错误
+bool test_setbit_getbit() {
+  std::cout << "测试 SETBIT/GETBIT..." << std::endl;
+
+  KVServer server;
+  TEST_ASSERT(run(server, {"SETBIT", "bm", "7", "1"}) == resp::serialize_integer(0), "新键返回原值 0");
+  TEST_ASSERT(run(server, {"GET", "bm"}) == resp::serialize_bulk_string(std::string(1, '\x01')),
+              "第 7 位是第一个字节的最低位");
+  TEST_ASSERT(run(server, {"SETBIT", "bm", "7", "0"}) == resp::serialize_integer(1), "返回原值 1");
+  TEST_ASSERT(run(server, {"SETBIT", "bm", "100", "1"}) == resp::serialize_integer(0), "超出长度时补零扩展");
+  TEST_ASSERT(run(server, {"GET", "bm"}).size() == resp::serialize_bulk_string(std::string(13, '\0')).size(),
+              "扩展到 13 字节");
+  TEST_ASSERT(run(server, {"GETBIT", "bm", "100"}) == resp::serialize_integer(1), "GETBIT 读取已设置的位");
+  TEST_ASSERT(run(server, {"GETBIT", "bm", "99"}) == resp::serialize_integer(0), "GETBIT 读取未设置的位");
+  TEST_ASSERT(run(server, {"GETBIT", "bm", "100000"}) == resp::serialize_integer(0), "超出长度的位为 0");
+  TEST_ASSERT(run(server, {"GETBIT", "nokey", "3"}) == resp::serialize_integer(0), "不存在的键为 0");
+
+  // 逐步增大偏移量，值原地扩展，内容与逐位设置的参考结果一致
+  std::string expected;
+  for (uint64_t offset = 0; offset < 20000; offset += 37) {
+    run(server, {"SETBIT", "grow", std::to_string(offset), "1"});
+    expected.resize(offset / 8 + 1, '\0');
+    expected[offset / 8] = static_cast<char>(expected[offset / 8] | (0x80 >> (offset % 8)));
+  }
+  TEST_ASSERT(run(server, {"GET", "grow"}) == resp::serialize_bulk_string(expected), "扩展后的内容正确");
+
+  // "1" 是 0x31，整数编码的值按字符串的字节读写
+  run(server, {"SET", "num", "1"});
+  TEST_ASSERT(run(server, {"GETBIT", "num", "2"}) == resp::serialize_integer(1), "读取整数编码的值");
+  TEST_ASSERT(run(server, {"SETBIT", "num", "6", "1"}) == resp::serialize_integer(0), "修改整数编码的值");
+  TEST_ASSERT(run(server, {"GET", "num"}) == resp::serialize_bulk_string("3"), "0x33 即 \"3\"");
+  TEST_ASSERT(run(server, {"INCR", "num"}) == resp::serialize_integer(4), "修改后仍是整数，可以 INCR");
+  run(server, {"SET", "str", "a"});
+  run(server, {"SETBIT", "str", "7", "0"});
+  TEST_ASSERT(run(server, {"GET", "str"}) == resp::serialize_bulk_string("`"), "0x61 清除最低位后为 0x60");
+  run(server, {"SETBIT", "str", "1", "0"});
+  run(server, {"SETBIT", "str", "3", "1"});
+  run(server, {"SETBIT", "str", "7", "1"});
+  TEST_ASSERT(run(server, {"GET", "str"}) == resp::serialize_bulk_string("1"), "字节变为 \"1\"");
+  TEST_ASSERT(run(server, {"INCR", "str"}) == resp::serialize_integer(2), "位运算得到的规范整数转为整数编码");
+
+  TEST_ASSERT(run(server, {"SETBIT", "bm", "-1", "1"}) ==
+                  resp::serialize_error("ERR bit offset is not an integer or out of range"),
+              "负偏移量应报错");
+  TEST_ASSERT(run(server, {"SETBIT", "bm", "4294967296", "1"}) ==
+                  resp::serialize_error("ERR bit offset is not an integer or out of range"),
+              "偏移量超过 512MB 应报错");
+  TEST_ASSERT(run(server, {"SETBIT", "bm", "1", "2"}) == resp::serialize_error("ERR bit is not an integer or out of range"),
+              "位值只能是 0 或 1");
+  run(server, {"HSET", "hash", "f", "v"});
+  const std::string wrongtype = resp::serialize_error("WRONGTYPE Operation against a key holding the wrong kind of value");
+  TEST_ASSERT(run(server, {"SETBIT", "hash", "1", "1"}) == wrongtype, "SETBIT 哈希键应报类型错误");
+  TEST_ASSERT(run(server, {"GETBIT", "hash", "1"}) == wrongtype, "GETBIT 哈希键应报类型错误");
+  TEST_ASSERT(run(server, {"BITCOUNT", "hash"}) == wrongtype, "BITCOUNT 哈希键应报类型错误");
+
+  std::cout << "SETBIT/GETBIT 测试通过！" << std::endl;
+  return true;
+}
+
+// 运行时选中的内核与逐字节的参考结果一致，覆盖各种长度和不对齐的起始地址
+bool test_bitops_kernels() {
+  std::cout << "测试位运算内核一致性（内核: " << bitops::simd_kernel() << "）..." << std::endl;
+
+  std::mt19937 rng(11);
+  for (size_t len : {0, 1, 7, 8, 31, 32, 33, 63, 64, 65, 255, 1000, 4099}) {
+    for (size_t shift : {0, 1, 5}) {
+      std::string a = random_bytes(rng, len + shift);
+      std::string b = random_bytes(rng, len + shift);
+      const auto *pa = reinterpret_cast<const uint8_t *>(a.data()) + shift;
+      const auto *pb = reinterpret_cast<const uint8_t *>(b.data()) + shift;
+
+      uint64_t expected = 0;
+      for (size_t i = 0; i < len; ++i) {
+        expected += static_cast<uint64_t>(__builtin_popcount(pa[i]));
+      }
+      TEST_ASSERT(bitops::popcount(pa, len) == expected, "位计数与参考结果一致");
+
+      for (auto op : {bitops::BitOp::And, bitops::BitOp::Or, bitops::BitOp::Xor, bitops::BitOp::Not}) {
+        std::string dst(a.begin() + static_cast<std::ptrdiff_t>(shift), a.end());
+        bitops::apply(op, reinterpret_cast<uint8_t *>(dst.data()), pb, len);
+        bool same = true;
+        for (size_t i = 0; i < len; ++i) {
+          uint8_t want = op == bitops::BitOp::And   ? pa[i] & pb[i]
+                         : op == bitops::BitOp::Or  ? pa[i] | pb[i]
+                         : op == bitops::BitOp::Xor ? pa[i] ^ pb[i]
+                                                    : static_cast<uint8_t>(~pb[i]);
+          same = same && static_cast<uint8_t>(dst[i]) == want;
+        }
+        TEST_ASSERT(same, "按字节位运算与参考结果一致");
+      }
+
+      // 在全为 fill 的字节中放一个不同的字节，应恰好找到它
+      for (uint8_t fill : {uint8_t{0x00}, uint8_t{0xff}}) {
+        std::string bytes(len + shift, static_cast<char>(fill));
+        const auto *p = reinterpret_cast<const uint8_t *>(bytes.data()) + shift;
+        TEST_ASSERT(bitops::find_byte_not(p, len, fill) == len, "都等于 fill 时返回长度");
+        if (len > 0) {
+          size_t at = rng() % len;
+          bytes[shift + at] = static_cast<char>(fill ^ 0x10);
+          TEST_ASSERT(bitops::find_byte_not(p, len, fill) == at, "找到第一个不等于 fill 的字节");
+        }
+      }
+    }
+  }
+
+  std::cout << "位运算内核一致性测试通过！" << std::endl;
+  return true;
+}
+
+// 测试 BITCOUNT/BITPOS 的字节区间和位区间，随机区间与逐位参考结果比较
+bool test_bitcount_bitpos() {
+  std::cout << "测试 BITCOUNT/BITPOS..." << std::endl;
+
+  KVServer server;
+  run(server, {"SET", "k", "foobar"});
+  TEST_ASSERT(run(server, {"BITCOUNT", "k"}) == resp::serialize_integer(26), "整个字符串");
+  TEST_ASSERT(run(server, {"BITCOUNT", "k", "0", "0"}) == resp::serialize_integer(4), "第一个字节");
+  TEST_ASSERT(run(server, {"BITCOUNT", "k", "1", "1"}) == resp::serialize_integer(6), "第二个字节");
+  TEST_ASSERT(run(server, {"BITCOUNT", "k", "1", "1", "BYTE"}) == resp::serialize_integer(6), "BYTE 单位");
+  TEST_ASSERT(run(server, {"BITCOUNT", "k", "5", "30", "BIT"}) == resp::serialize_integer(17), "BIT 单位");
+  TEST_ASSERT(run(server, {"BITCOUNT", "k", "-2", "-1"}) == resp::serialize_integer(7), "负数下标");
+  TEST_ASSERT(run(server, {"BITCOUNT", "k", "3", "1"}) == resp::serialize_integer(0), "空区间");
+  TEST_ASSERT(run(server, {"BITCOUNT", "nokey"}) == resp::serialize_integer(0), "不存在的键");
+  TEST_ASSERT(run(server, {"BITCOUNT", "k", "0"}) == resp::serialize_error("ERR syntax error"), "只有 start 应报错");
+  TEST_ASSERT(run(server, {"BITCOUNT", "k", "0", "1", "BAD"}) == resp::serialize_error("ERR syntax error"),
+              "未知单位应报错");
+  TEST_ASSERT(run(server, {"BITCOUNT", "k", "a", "1"}) ==
+                  resp::serialize_error("ERR value is not an integer or out of range"),
+              "非整数下标应报错");
+
+  run(server, {"SET", "p", std::string("\xff\xf0\x00", 3)});
+  TEST_ASSERT(run(server, {"BITPOS", "p", "0"}) == resp::serialize_integer(12), "第一个 0");
+  TEST_ASSERT(run(server, {"BITPOS", "p", "1", "2"}) == resp::serialize_integer(-1), "区间内没有 1");
+  TEST_ASSERT(run(server, {"BITPOS", "p", "1", "1", "-1", "BIT"}) == resp::serialize_integer(1), "BIT 单位");
+  run(server, {"SET", "ones", std::string("\xff\xff", 2)});
+  TEST_ASSERT(run(server, {"BITPOS", "ones", "0"}) == resp::serialize_integer(16), "没有指定 end 时返回字符串之后的位");
+  TEST_ASSERT(run(server, {"BITPOS", "ones", "0", "0", "-1"}) == resp::serialize_integer(-1), "指定 end 时返回 -1");
+  TEST_ASSERT(run(server, {"BITPOS", "nokey", "0"}) == resp::serialize_integer(0), "不存在的键找 0 返回 0");
+  TEST_ASSERT(run(server, {"BITPOS", "nokey", "1"}) == resp::serialize_integer(-1), "不存在的键找 1 返回 -1");
+  TEST_ASSERT(run(server, {"BITPOS", "p", "2"}) == resp::serialize_error("ERR The bit argument must be 1 or 0."),
+              "位值只能是 0 或 1");
+
+  // 稀疏位图：大块全 0（找 1）或全 1（找 0）的字节由内核跳过
+  std::mt19937 rng(5);
+  for (int round = 0; round < 50; ++round) {
+    size_t len = 1 + rng() % 3000;
+    std::string value = round % 2 == 0 ? std::string(len, '\0') : std::string(len, '\xff');
+    for (size_t i = 0, n = rng() % 4; i < n; ++i) {
+      value[rng() % len] = static_cast<char>(rng());
+    }
+    if (round % 5 == 0) {
+      value = random_bytes(rng, len);
+    }
+    run(server, {"SET", "r", value});
+    size_t bits = len * 8;
+    int64_t start = static_cast<int64_t>(rng() % bits);
+    int64_t end = static_cast<int64_t>(rng() % bits);
+    uint64_t lo = static_cast<uint64_t>(std::min(start, end));
+    uint64_t hi = static_cast<uint64_t>(std::max(start, end));
+    std::string s_lo = std::to_string(lo);
+    std::string s_hi = std::to_string(hi);
+    TEST_ASSERT(run(server, {"BITCOUNT", "r", s_lo, s_hi, "BIT"}) == resp::serialize_integer(naive_count(value, lo, hi)),
+                "BITCOUNT 位区间与参考结果一致");
+    std::string b_lo = std::to_string(lo / 8);
+    std::string b_hi = std::to_string(hi / 8);
+    TEST_ASSERT(run(server, {"BITCOUNT", "r", b_lo, b_hi}) ==
+                    resp::serialize_integer(naive_count(value, lo / 8 * 8, hi / 8 * 8 + 7)),
+                "BITCOUNT 字节区间与参考结果一致");
+    for (bool bit : {false, true}) {
+      std::string b = bit ? "1" : "0";
+      TEST_ASSERT(run(server, {"BITPOS", "r", b, s_lo, s_hi, "BIT"}) == resp::serialize_integer(naive_pos(value, bit, lo, hi)),
+                  "BITPOS 位区间与参考结果一致");
+      TEST_ASSERT(run(server, {"BITPOS", "r", b, b_lo, b_hi}) ==
+                      resp::serialize_integer(naive_pos(value, bit, lo / 8 * 8, hi / 8 * 8 + 7)),
+                  "BITPOS 字节区间与参考结果一致");
+    }
+  }
+
+  std::cout << "BITCOUNT/BITPOS 测试通过！" << std::endl;
+  return true;
+}
+
+// 测试 BITOP：不同长度的源按补零处理，结果覆盖目标键
+bool test_bitop() {
+  std::cout << "测试 BITOP..." << std::endl;
+
+  KVServer server;
+  std::mt19937 rng(3);
+  std::string a = random_bytes(rng, 1000);
+  std::string b = random_bytes(rng, 333);
+  std::string c = random_bytes(rng, 1500);
+  run(server, {"SET", "a", a});
+  run(server, {"SET", "b", b});
+  run(server, {"SET", "c", c});
+
+  std::string and_expected(1500, '\0');
+  std::string or_expected(1500, '\0');
+  std::string xor_expected(1500, '\0');
+  for (size_t i = 0; i < 1500; ++i) {
+    uint8_t x = i < a.size() ? static_cast<uint8_t>(a[i]) : 0;
+    uint8_t y = i < b.size() ? static_cast<uint8_t>(b[i]) : 0;
+    uint8_t z = static_cast<uint8_t>(c[i]);
+    and_expected[i] = static_cast<char>(x & y & z);
+    or_expected[i] = static_cast<char>(x | y | z);
+    xor_expected[i] = static_cast<char>(x ^ y ^ z);
+  }
+  TEST_ASSERT(run(server, {"BITOP", "AND", "dest", "a", "b", "c"}) == resp::serialize_integer(1500),
+              "返回最长源的长度");
+  TEST_ASSERT(run(server, {"GET", "dest"}) == resp::serialize_bulk_string(and_expected), "AND");
+  run(server, {"BITOP", "or", "dest", "a", "b", "c"});
+  TEST_ASSERT(run(server, {"GET", "dest"}) == resp::serialize_bulk_string(or_expected), "OR");
+  run(server, {"BITOP", "XOR", "dest", "a", "b", "c"});
+  TEST_ASSERT(run(server, {"GET", "dest"}) == resp::serialize_bulk_string(xor_expected), "XOR");
+  std::string not_expected = a;
+  for (auto &ch : not_expected) {
+    ch = static_cast<char>(~ch);
+  }
+  run(server, {"BITOP", "NOT", "dest", "a"});
+  TEST_ASSERT(run(server, {"GET", "dest"}) == resp::serialize_bulk_string(not_expected), "NOT");
+  run(server, {"BITOP", "NOT", "a", "a"});
+  TEST_ASSERT(run(server, {"GET", "a"}) == resp::serialize_bulk_string(not_expected), "目标键也是源键");
+
+  TEST_ASSERT(run(server, {"BITOP", "AND", "dest", "b", "nokey"}) == resp::serialize_integer(333),
+              "不存在的源按空字符串处理");
+  TEST_ASSERT(run(server, {"GET", "dest"}) == resp::serialize_bulk_string(std::string(333, '\0')),
+              "与空字符串 AND 得到全 0");
+
+  run(server, {"SET", "num", "12"});
+  run(server, {"BITOP", "OR", "dest", "num"});
+  TEST_ASSERT(run(server, {"GET", "dest"}) == resp::serialize_bulk_string("12"), "整数编码的源按字符串处理");
+
+  run(server, {"HSET", "h", "f", "v"});
+  run(server, {"EXPIRE", "dest", "100"});
+  run(server, {"BITOP", "OR", "h", "b"});
+  TEST_ASSERT(run(server, {"TYPE", "h"}) == resp::serialize_simple_string("string"), "覆盖其他类型的目标键");
+  run(server, {"BITOP", "OR", "dest", "b"});
+  TEST_ASSERT(run(server, {"TTL", "dest"}) == resp::serialize_integer(-1), "不保留目标键的过期时间");
+  TEST_ASSERT(run(server, {"BITOP", "OR", "dest", "nokey"}) == resp::serialize_integer(0), "结果为空");
+  TEST_ASSERT(run(server, {"EXISTS", "dest"}) == resp::serialize_integer(0), "结果为空时删除目标键");
+
+  TEST_ASSERT(run(server, {"BITOP", "NOT", "dest", "a", "b"}) ==
+                  resp::serialize_error("ERR BITOP NOT must be called with a single source key."),
+              "NOT 只能有一个源");
+  TEST_ASSERT(run(server, {"BITOP", "NAND", "dest", "a"}) == resp::serialize_error("ERR syntax error"), "未知运算");
+  run(server, {"HSET", "h2", "f", "v"});
+  TEST_ASSERT(run(server, {"BITOP", "AND", "dest", "b", "h2"}) ==
+                  resp::serialize_error("WRONGTYPE Operation against a key holding the wrong kind of value"),
+              "源的类型不符时报错");
+
+  std::cout << "BITOP 测试通过！" << std::endl;
+  return true;
+}
+
+// 测试 BITFIELD：GET/SET/INCRBY、溢出策略、# 偏移量和错误
+bool test_bitfield() {
+  std::cout << "测试 BITFIELD..." << std::endl;
+
+  KVServer server;
+  auto ints = [](std::initializer_list<int64_t> values) {
+    std::string reply = "*" + std::to_string(values.size()) + "\r\n";
+    for (int64_t v : values) {
+      reply += resp::serialize_integer(v);
+    }
+    return reply;
+  };
+  TEST_ASSERT(run(server, {"BITFIELD", "bf", "GET", "u8", "0"}) == ints({0}), "不存在的键读出 0");
+  TEST_ASSERT(run(server, {"EXISTS", "bf"}) == resp::serialize_integer(0), "只有 GET 时不创建键");
+  TEST_ASSERT(run(server, {"BITFIELD", "bf", "SET", "u8", "0", "255", "GET", "u8", "0", "GET", "i8", "0"}) ==
+                  ints({0, 255, -1}),
+              "SET 返回旧值，有符号读取按补码解释");
+  TEST_ASSERT(run(server, {"BITFIELD", "bf", "SET", "i5", "#1", "-3", "GET", "u5", "5"}) == ints({-4, 29}),
+              "#N 偏移量按字段宽度计算");
+  TEST_ASSERT(run(server, {"BITFIELD", "bf", "INCRBY", "u8", "0", "10"}) == ints({9}), "默认 WRAP 回绕");
+  TEST_ASSERT(run(server, {"BITFIELD", "bf", "OVERFLOW", "SAT", "INCRBY", "u8", "0", "1000", "INCRBY", "u8", "0",
+                           "-1000"}) == ints({255, 0}),
+              "SAT 截到最值");
+  TEST_ASSERT(run(server, {"BITFIELD", "bf", "OVERFLOW", "SAT", "SET", "i8", "0", "200"}) == ints({0}),
+              "SAT 下 SET 的旧值");
+  TEST_ASSERT(run(server, {"BITFIELD", "bf", "GET", "i8", "0"}) == ints({127}), "SET 超出范围时截到最大值");
+  TEST_ASSERT(run(server, {"BITFIELD", "bf", "OVERFLOW", "FAIL", "INCRBY", "i8", "0", "1", "INCRBY", "i8", "0", "-1"}) ==
+                  "*2\r\n" + resp::serialize_null_bulk_string() + resp::serialize_integer(126),
+              "FAIL 溢出时返回 nil 且不写入");
+  TEST_ASSERT(run(server, {"BITFIELD", "bf", "OVERFLOW", "WRAP", "INCRBY", "i8", "0", "3"}) == ints({-127}),
+              "有符号 WRAP");
+  TEST_ASSERT(run(server, {"BITFIELD", "bf", "SET", "u8", "0", "-1"}) == ints({129}), "无符号 SET 负数按回绕处理");
+  TEST_ASSERT(run(server, {"BITFIELD", "bf", "SET", "i64", "64", "-9223372036854775808", "INCRBY", "i64", "64",
+                           "-1"}) == ints({0, 9223372036854775807LL}),
+              "64 位有符号回绕");
+  TEST_ASSERT(run(server, {"BITFIELD", "bf", "SET", "u63", "128", "9223372036854775807", "GET", "u63", "128"}) ==
+                  ints({0, 9223372036854775807LL}),
+              "63 位无符号");
+  TEST_ASSERT(run(server, {"BITFIELD", "big", "SET", "u4", "100", "15"}) == ints({0}), "写入时补零扩展");
+  TEST_ASSERT(run(server, {"BITCOUNT", "big"}) == resp::serialize_integer(4), "只设置了字段中的位");
+  TEST_ASSERT(run(server, {"GETBIT", "big", "103"}) == resp::serialize_integer(1), "与 GETBIT 的位序一致");
+
+  const std::string type_error = resp::serialize_error(
+      "ERR Invalid bitfield type. Use something like i16 u8. Note that u64 is not supported but i64 is.");
+  TEST_ASSERT(run(server, {"BITFIELD", "bf", "GET", "u64", "0"}) == type_error, "不支持 u64");
+  TEST_ASSERT(run(server, {"BITFIELD", "bf", "GET", "x8", "0"}) == type_error, "未知类型");
+  TEST_ASSERT(run(server, {"BITFIELD", "bf", "GET", "i0", "0"}) == type_error, "宽度为 0");
+  TEST_ASSERT(run(server, {"BITFIELD", "bf", "GET", "u8", "-1"}) ==
+                  resp::serialize_error("ERR bit offset is not an integer or out of range"),
+              "负偏移量");
+  TEST_ASSERT(run(server, {"BITFIELD", "bf", "OVERFLOW", "BAD", "GET", "u8", "0"}) ==
+                  resp::serialize_error("ERR Invalid OVERFLOW type specified"),
+              "未知溢出策略");
+  TEST_ASSERT(run(server, {"BITFIELD", "bf", "SET", "u8", "0"}) == resp::serialize_error("ERR syntax error"),
+              "缺少参数");
+  TEST_ASSERT(run(server, {"BITFIELD", "bf", "SET", "u8", "0", "1", "FOO"}) == resp::serialize_error("ERR syntax error"),
+              "未知子命令");
+  TEST_ASSERT(run(server, {"BITFIELD", "bf", "GET", "u8", "0"}) == ints({255}), "出错的命令不做任何修改");
+
+  std::cout << "BITFIELD 测试通过！" << std::endl;
+  return true;
+}
+
+// BITOP 的源键重复出现，且键恰好在命令执行期间过期：过期按命令开始时的时间判断，
+// 一条命令看到的要么都是整个值，要么都不存在，不会读到前面查找引用、后面查找时已删除的条目
+bool test_bitop_repeated_expiring_key() {
+  std::cout << "测试 BITOP 重复出现的过期键..." << std::endl;
+
+  KVServer server;
+  const std::string value(4096, '\x5a');
+  // 键重复多次，让一条命令的执行时间足够长，过期时刻大概率落在某条命令执行期间
+  std::vector<std::string> bitop = {"BITOP", "OR", "dst"};
+  for (int i = 0; i < 500; ++i) {
+    bitop.push_back("k");
+  }
+  for (int round = 0; round < 30; ++round) {
+    run(server, {"SET", "k", value, "PX", "20"});
+    for (;;) {
+      std::string reply = run(server, bitop);
+      if (reply == resp::serialize_integer(0)) {
+        TEST_ASSERT(run(server, {"EXISTS", "dst"}) == resp::serialize_integer(0), "结果为空时删除目标键");
+        break;
+      }
+      TEST_ASSERT(reply == resp::serialize_integer(static_cast<long long>(value.size())),
+                  "BITOP 看到的应是整个值或不存在的键");
+      TEST_ASSERT(run(server, {"GET", "dst"}) == resp::serialize_bulk_string(value), "同一个值的 OR 等于它本身");
+    }
+    TEST_ASSERT(run(server, {"EXISTS", "k"}) == resp::serialize_integer(0), "过期的键应已删除");
+  }
+
+  std::cout << "BITOP 重复出现的过期键测试通过！" << std::endl;
+  return true;
+}
+
+int main() {
+  Logger::instance().set_level(LogLevel::ERROR);
+  std::cout << "开始位图命令测试..." << std::endl;
+
+  bool all_passed = true;
+  std::vector<std::pair<std::string, std::function<bool()>>> tests = {
+      {"SETBIT/GETBIT 测试", test_setbit_getbit},
+      {"位运算内核一致性测试", test_bitops_kernels},
+      {"BITCOUNT/BITPOS 测试", test_bitcount_bitpos},
+      {"BITOP 测试", test_bitop},
+      {"BITFIELD 测试", test_bitfield},
+      {"BITOP 重复出现的过期键测试", test_bitop_repeated_expiring_key}};
+
+  int passed = 0;
+  int failed = 0;
+
+  for (const auto &[name, test_func] : tests) {
+    std::cout << "\n===================================" << std::endl;
+    std::cout << "执行测试: " << name << std::endl;
+    std::cout << "===================================" << std::endl;
+
+    try {
+      if (test_func()) {
+        std::cout << "√ 测试通过: " << name << std::endl;
+        passed++;
+      } else {
+        std::cerr << "× 测试失败: " << name << std::endl;
+        all_passed = false;
+        failed++;
+      }
+    } catch (const std::exception &e) {
+      std::cerr << "× 测试出现异常: " << name << " - " << e.what() << std::endl;
+      all_passed = false;
+      failed++;
+    }
+  }
+
+  std::cout << "\n===================================" << std::endl;
+  std::cout << "测试结果: " << passed << " 通过, " << failed << " 失败" << std::endl;
+  std::cout << "===================================" << std::endl;
+
+  return all_passed ? 0 : 1;
+}
@@ -0,0 +1,350 @@
+#include <arpa/inet.h>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <netinet/in.h>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+import application;
+
+// 阻塞命令的端到端测试：在子进程中启动服务器，通过套接字验证挂起、按顺序唤醒、
+// 超时回复、断开连接时的清理，以及多个事件循环时挂起在其他分片上的客户端
+
+// 测试辅助宏
+#define TEST_ASSERT(condition, message)                                        \
+  do {                                                                         \
+    if (!(condition)) {                                                        \
+      std::cerr << "断言失败: " << message << " 在 " << __FILE__ << " 行 "    \
+                << __LINE__ << std::endl;                                      \
+      return false;                                                            \
+    }                                                                          \
+  } while (0)
+
+constexpr int kBasePort = 16390;
+
+int server_port = 0;
+int server_io_threads = 1;
+// 服务器使用的事件后端，由第一个命令行参数指定（默认 epoll）
+std::string event_backend = "epoll";
+
+// 在子进程中以给定的事件循环数启动服务器
+pid_t spawn_server(int port, int io_threads, const std::string &config_file) {
+  {
+    std::ofstream config(config_file);
+    config << "port " << port << "\n";
+    config << "loglevel error\n";
+    config << "io-threads " << io_threads << "\n";
+    config << "event-backend " << event_backend << "\n";
+  }
+
+  pid_t pid = fork();
+  if (pid == 0) {
+    Application app;
+    if (!app.init(config_file)) {
+      _exit(1);
+    }
+    app.run();
+    _exit(0);
+  }
+  return pid;
+}
+
+// 完整的一条回复在 data 开头时返回它的长度，不完整时返回 0
+size_t reply_length(std::string_view data) {
+  size_t line_end = data.find("\r\n");
+  if (line_end == std::string_view::npos) {
+    return 0;
+  }
+  size_t length = line_end + 2;
+  if (data[0] == '$') {
+    long long n = std::stoll(std::string(data.substr(1, line_end - 1)));
+    if (n < 0) {
+      return length;
+    }
+    return data.size() >= length + n + 2 ? length + n + 2 : 0;
+  }
+  if (data[0] == '*') {
+    long long n = std::stoll(std::string(data.substr(1, line_end - 1)));
+    for (long long i = 0; i < n; ++i) {
+      size_t element = reply_length(data.substr(length));
+      if (element == 0) {
+        return 0;
+      }
+      length += element;
+    }
+  }
+  return length;
+}
+
+// 同步客户端：发送一条命令，读取一条完整的回复，读取超时或连接关闭时返回 nullopt
+class Client {
+public:
+  explicit Client(int port) {
+    // 服务器刚启动时可能还未开始监听，重试几次
+    for (int attempt = 0; attempt < 50 && fd_ == -1; ++attempt) {
+      fd_ = socket(AF_INET, SOCK_STREAM, 0);
+      sockaddr_in addr{};
+      addr.sin_family = AF_INET;
+      addr.sin_port = htons(port);
+      inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+      if (connect(fd_, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0) {
+        ::close(fd_);
+        fd_ = -1;
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+      }
+    }
+    if (fd_ != -1) {
+      timeval timeout{3, 0};
+      setsockopt(fd_, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    }
+  }
+  ~Client() { close(); }
+  Client(const Client &) = delete;
+  Client &operator=(const Client &) = delete;
+
+  bool connected() const { return fd_ != -1; }
+
+  void close() {
+    if (fd_ != -1) {
+      ::close(fd_);
+      fd_ = -1;
+    }
+  }
+
+  bool send(const std::vector<std::string> &argv) {
+    std::string request = "*" + std::to_string(argv.size()) + "\r\n";
+    for (const auto &arg : argv) {
+      request += "$" + std::to_string(arg.size()) + "\r\n" + arg + "\r\n";
+    }
+    size_t sent = 0;
+    while (sent < request.size()) {
+      ssize_t n = ::send(fd_, request.data() + sent, request.size() - sent, MSG_NOSIGNAL);
+      if (n <= 0) {
+        return false;
+      }
+      sent += static_cast<size_t>(n);
+    }
+    return true;
+  }
+
+  std::optional<std::string> read_reply() {
+    while (true) {
+      if (size_t length = reply_length(buffer_); length > 0) {
+        std::string reply = buffer_.substr(0, length);
+        buffer_.erase(0, length);
+        return reply;
+      }
+      char chunk[4096];
+      ssize_t n = ::read(fd_, chunk, sizeof(chunk));
+      if (n <= 0) {
+        return std::nullopt;
+      }
+      buffer_.append(chunk, static_cast<size_t>(n));
+    }
+  }
+
+  std::optional<std::string> call(const std::vector<std::string> &argv) {
+    if (!send(argv)) {
+      return std::nullopt;
+    }
+    return read_reply();
+  }
+
+private:
+  int fd_ = -1;
+  std::string buffer_;
+};
+
+std::string bulk(std::string_view s) { return "$" + std::to_string(s.size()) + "\r\n" + std::string(s) + "\r\n"; }
+
+// BLPOP/BRPOP 弹出元素时的回复：键名和元素
+std::string pop_reply(std::string_view key, std::string_view element) { return "*2\r\n" + bulk(key) + bulk(element); }
+
+// 等待 INFO 中的 blocked_clients 变为 count。挂起在其他分片上时要经过邮箱，不能发送后立即检查
+bool wait_blocked_clients(Client &admin, int count) {
+  std::string expected = "blocked_clients:" + std::to_string(count) + "\r\n";
+  for (int i = 0; i < 200; ++i) {
+    auto info = admin.call({"INFO"});
+    if (info && info->find(expected) != std::string::npos) {
+      return true;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  return false;
+}
+
+// 测试用的键。多个事件循环时连接随机落在某个事件循环上，换用几个键，
+// 让挂起既发生在连接自己的分片上，也发生在其他分片上
+std::vector<std::string> test_keys(std::string_view prefix) {
+  std::vector<std::string> keys;
+  int count = server_io_threads > 1 ? 8 : 1;
+  for (int i = 0; i < count; ++i) {
+    keys.push_back(std::string(prefix) + ":" + std::to_string(i));
+  }
+  return keys;
+}
+
+// 测试两个客户端阻塞在同一个键上，一次 LPUSH 按挂起的先后顺序唤醒
+bool test_blpop_fifo() {
+  std::cout << "测试按挂起顺序唤醒..." << std::endl;
+
+  Client admin(server_port);
+  TEST_ASSERT(admin.connected(), "无法连接服务器");
+  for (const auto &key : test_keys("fifo")) {
+    Client first(server_port);
+    Client second(server_port);
+    TEST_ASSERT(first.send({"BLPOP", key, "0"}), "发送 BLPOP 失败");
+    TEST_ASSERT(wait_blocked_clients(admin, 1), "第一个客户端应挂起");
+    TEST_ASSERT(second.send({"BLPOP", key, "0"}), "发送 BLPOP 失败");
+    TEST_ASSERT(wait_blocked_clients(admin, 2), "第二个客户端应挂起");
+
+    TEST_ASSERT(admin.call({"LPUSH", key, "x", "y"}) == ":2\r\n", "LPUSH 返回压入后的长度");
+    TEST_ASSERT(first.read_reply() == pop_reply(key, "y"), "先挂起的客户端先取得表头元素");
+    TEST_ASSERT(second.read_reply() == pop_reply(key, "x"), "后挂起的客户端取得下一个元素");
+    TEST_ASSERT(wait_blocked_clients(admin, 0), "唤醒后不再计入阻塞客户端");
+    TEST_ASSERT(admin.call({"EXISTS", key}) == ":0\r\n", "元素都被取走，列表被删除");
+
+    // 唤醒后连接恢复处理后续命令
+    TEST_ASSERT(first.call({"EXISTS", key}) == ":0\r\n", "唤醒后连接可以继续执行命令");
+  }
+
+  std::cout << "按挂起顺序唤醒测试通过！" << std::endl;
+  return true;
+}
+
+// 测试超时：没有元素时在超时后返回空数组
+bool test_blpop_timeout() {
+  std::cout << "测试阻塞超时..." << std::endl;
+
+  Client admin(server_port);
+  TEST_ASSERT(admin.connected(), "无法连接服务器");
+  for (const auto &key : test_keys("timeout")) {
+    Client client(server_port);
+    auto start = std::chrono::steady_clock::now();
+    auto reply = client.call({"BLPOP", key, "0.1"});
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    TEST_ASSERT(reply == "*-1\r\n", "超时后返回空数组");
+    TEST_ASSERT(elapsed >= std::chrono::milliseconds(90), "不应在超时之前返回");
+    TEST_ASSERT(elapsed < std::chrono::seconds(2), "应在超时后及时返回");
+    TEST_ASSERT(wait_blocked_clients(admin, 0), "超时后不再计入阻塞客户端");
+
+    // 超时的客户端已从等待队列中移除，之后压入的元素留在列表中
+    TEST_ASSERT(admin.call({"RPUSH", key, "v"}) == ":1\r\n", "RPUSH 成功");
+    TEST_ASSERT(admin.call({"LLEN", key}) == ":1\r\n", "超时的客户端不应取走元素");
+    TEST_ASSERT(client.call({"LLEN", key}) == ":1\r\n", "超时后连接可以继续执行命令");
+    admin.call({"DEL", key});
+  }
+
+  std::cout << "阻塞超时测试通过！" << std::endl;
+  return true;
+}
+
+// 测试断开连接：挂起的客户端关闭连接后从等待队列中移除，之后压入的元素不被取走
+bool test_blpop_disconnect() {
+  std::cout << "测试挂起的客户端断开连接..." << std::endl;
+
+  Client admin(server_port);
+  TEST_ASSERT(admin.connected(), "无法连接服务器");
+  for (const auto &key : test_keys("disconnect")) {
+    Client client(server_port);
+    TEST_ASSERT(client.send({"BLPOP", key, "0"}), "发送 BLPOP 失败");
+    TEST_ASSERT(wait_blocked_clients(admin, 1), "客户端应挂起");
+    client.close();
+    TEST_ASSERT(wait_blocked_clients(admin, 0), "断开连接后应从等待队列中移除");
+
+    TEST_ASSERT(admin.call({"RPUSH", key, "v"}) == ":1\r\n", "RPUSH 成功");
+    TEST_ASSERT(admin.call({"LRANGE", key, "0", "-1"}) == "*1\r\n" + bulk("v"), "已断开的客户端不应取走元素");
+
+    // 断开的客户端之后仍有其他客户端等待时，元素交给仍在等待的客户端
+    admin.call({"DEL", key});
+    Client gone(server_port);
+    Client waiting(server_port);
+    TEST_ASSERT(gone.send({"BRPOP", key, "0"}), "发送 BRPOP 失败");
+    TEST_ASSERT(wait_blocked_clients(admin, 1), "第一个客户端应挂起");
+    TEST_ASSERT(waiting.send({"BRPOP", key, "0"}), "发送 BRPOP 失败");
+    TEST_ASSERT(wait_blocked_clients(admin, 2), "第二个客户端应挂起");
+    gone.close();
+    TEST_ASSERT(wait_blocked_clients(admin, 1), "断开的客户端应被移除");
+    TEST_ASSERT(admin.call({"RPUSH", key, "w"}) == ":1\r\n", "RPUSH 成功");
+    TEST_ASSERT(waiting.read_reply() == pop_reply(key, "w"), "仍在等待的客户端取得元素");
+    TEST_ASSERT(admin.call({"EXISTS", key}) == ":0\r\n", "元素被取走，列表被删除");
+  }
+
+  std::cout << "挂起的客户端断开连接测试通过！" << std::endl;
+  return true;
+}
+
+// 以给定的事件循环数启动服务器并执行全部测试
+bool run_suite(int io_threads, int &passed, int &failed) {
+  server_port = kBasePort + io_threads;
+  server_io_threads = io_threads;
+  std::string config_file = "test_blocking_" + std::to_string(io_threads) + ".conf";
+  pid_t pid = spawn_server(server_port, io_threads, config_file);
+  if (pid <= 0) {
+    std::cerr << "启动服务器失败" << std::endl;
+    return false;
+  }
+
+  bool all_passed = true;
+  std::vector<std::pair<std::string, std::function<bool()>>> tests = {
+      {"按挂起顺序唤醒测试", test_blpop_fifo},
+      {"阻塞超时测试", test_blpop_timeout},
+      {"挂起的客户端断开连接测试", test_blpop_disconnect}};
+
+  for (const auto &[name, test_func] : tests) {
+    std::cout << "\n===================================" << std::endl;
+    std::cout << "执行测试: " << name << "（io-threads " << io_threads << "）" << std::endl;
+    std::cout << "===================================" << std::endl;
+
+    try {
+      if (test_func()) {
+        std::cout << "√ 测试通过: " << name << std::endl;
+        passed++;
+      } else {
+        std::cerr << "× 测试失败: " << name << std::endl;
+        all_passed = false;
+        failed++;
+      }
+    } catch (const std::exception &e) {
+      std::cerr << "× 测试出现异常: " << name << " - " << e.what() << std::endl;
+      all_passed = false;
+      failed++;
+    }
+  }
+
+  kill(pid, SIGKILL);
+  waitpid(pid, nullptr, 0);
+  std::remove(config_file.c_str());
+  return all_passed;
+}
+
+int main(int argc, char *argv[]) {
+  if (argc > 1) {
+    event_backend = argv[1];
+  }
+  std::cout << "开始阻塞命令端到端测试（" << event_backend << "）..." << std::endl;
+
+  int passed = 0;
+  int failed = 0;
+  bool all_passed = run_suite(1, passed, failed);
+  // 多个事件循环：键属于其他分片时，挂起、唤醒和清理都经过分片间的邮箱
+  all_passed = run_suite(2, passed, failed) && all_passed;
+
+  std::cout << "\n===================================" << std::endl;
+  std::cout << "测试结果: " << (all_passed ? "全部通过" : "有测试失败") << std::endl;
+  std::cout << "通过: " << passed << " 个测试" << std::endl;
+  std::cout << "失败: " << failed << " 个测试" << std::endl;
+  std::cout << "===================================" << std::endl;
+
+  return all_passed ? 0 : 1;
+}
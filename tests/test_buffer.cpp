@@ -148,6 +148,32 @@ void test_read_fd() {
   std::cout << "  [PASS]" << std::endl;
 }
 
+void test_write_fd() {
+  std::cout << "Test: Write to FD..." << std::endl;
+  int fds[2];
+  assert(pipe(fds) == 0);
+
+  Buffer buf;
+  std::string data = "+OK\r\n:1\r\n$5\r\nhello\r\n";
+  buf.append(data);
+
+  int saved_errno = 0;
+  ssize_t n = buf.write_fd(fds[1], &saved_errno);
+  close(fds[1]);
+
+  assert(n == static_cast<ssize_t>(data.size()));
+  assert(saved_errno == 0);
+  assert(buf.readable_bytes() == 0);
+
+  char out[64] = {0};
+  ssize_t r = read(fds[0], out, sizeof(out));
+  close(fds[0]);
+  assert(r == static_cast<ssize_t>(data.size()));
+  assert(std::string(out, r) == data);
+
+  std::cout << "  [PASS]" << std::endl;
+}
+
 int main() {
   std::cout << "--- Starting Buffer Unit Tests ---" << std::endl;
   test_buffer_append_retrieve();
@@ -158,6 +184,7 @@ int main() {
   test_retrieve_edge_cases();
   test_continuous_append_retrieve();
   test_read_fd();
+  test_write_fd();
   std::cout << "\n✅ All Buffer tests passed!" << std::endl;
   return 0;
 }
\ No newline at end of file
@@ -0,0 +1,194 @@
+// tests/test_dict.cpp
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+import dict;
+
+// 测试用条目：键和一个整数值
+struct Entry {
+  std::string name;
+  int value = 0;
+  std::string_view key() const { return name; }
+};
+
+void test_dict_basic() {
+  std::cout << "Test: Dict Insert, Find and Erase..." << std::endl;
+  Dict<Entry> dict;
+  assert(dict.empty() && dict.find("missing") == dict.end());
+
+  auto [it, inserted] = dict.insert(Entry{"key", 1});
+  assert(inserted && it->key() == "key" && it->value == 1);
+  auto [again, inserted_again] = dict.insert(Entry{"key", 2});
+  assert(!inserted_again && again->value == 1); // 已存在的键不被覆盖
+
+  dict.find("key")->value = 3;
+  assert(dict.find("key")->value == 3);
+  assert(dict.size() == 1 && dict.contains("key"));
+
+  dict.erase(dict.find("key"));
+  assert(dict.empty() && !dict.contains("key"));
+  assert(dict.erase("key") == 0);
+
+  std::cout << "  [PASS]" << std::endl;
+}
+
+void test_dict_incremental_rehash() {
+  std::cout << "Test: Dict Incremental Rehash..." << std::endl;
+  Dict<Entry> dict;
+  bool saw_rehash = false;
+  for (int i = 0; i < 100000; ++i) {
+    dict.insert(Entry{"key:" + std::to_string(i), i});
+    if (dict.rehashing()) {
+      saw_rehash = true;
+      // 扩容期间所有已插入的键都能找到，不论在哪张表中
+      assert(dict.find("key:0")->value == 0);
+      assert(dict.find("key:" + std::to_string(i))->value == i);
+    }
+  }
+  assert(saw_rehash);
+  assert(dict.size() == 100000);
+  // 按时间预算推进直到扩容完成
+  while (dict.rehash_for(std::chrono::microseconds(100))) {
+  }
+  assert(!dict.rehashing());
+  for (int i = 0; i < 100000; ++i) {
+    assert(dict.find("key:" + std::to_string(i))->value == i);
+  }
+
+  std::cout << "  [PASS]" << std::endl;
+}
+
+void test_dict_incremental_shrink() {
+  std::cout << "Test: Dict Incremental Shrink..." << std::endl;
+  Dict<Entry> dict;
+  for (int i = 0; i < 100000; ++i) {
+    dict.insert(Entry{"key:" + std::to_string(i), i});
+  }
+  while (dict.rehash_for(std::chrono::microseconds(100))) {
+  }
+  size_t full_buckets = dict.bucket_count();
+  bool saw_shrink = false;
+  for (int i = 0; i < 99000; ++i) {
+    dict.erase("key:" + std::to_string(i));
+    if (dict.rehashing()) {
+      saw_shrink = true;
+      // 缩容期间剩余的键都能找到
+      assert(dict.find("key:99999")->value == 99999);
+      assert(dict.find("key:" + std::to_string(i + 1))->value == i + 1);
+    }
+  }
+  assert(saw_shrink);
+  while (dict.rehash_for(std::chrono::microseconds(100))) {
+  }
+  assert(dict.size() == 1000);
+  assert(dict.bucket_count() * 16 <= full_buckets);
+  for (int i = 99000; i < 100000; ++i) {
+    assert(dict.find("key:" + std::to_string(i))->value == i);
+  }
+  // 全部删除后接近最小容量（最后一次缩容开始时可能还剩少量键）
+  for (int i = 99000; i < 100000; ++i) {
+    dict.erase("key:" + std::to_string(i));
+  }
+  while (dict.rehash_for(std::chrono::microseconds(100))) {
+  }
+  assert(dict.empty() && dict.bucket_count() <= 64);
+
+  std::cout << "  [PASS]" << std::endl;
+}
+
+void test_dict_matches_unordered_map() {
+  std::cout << "Test: Dict Random Operations Against unordered_map..." << std::endl;
+  Dict<Entry> dict;
+  std::unordered_map<std::string, int> reference;
+  std::mt19937 rng(12345);
+  // 键集合较小，插入和删除频繁交替，覆盖墓碑复用与原容量重建
+  for (int round = 0; round < 300000; ++round) {
+    std::string key = "k" + std::to_string(rng() % 5000);
+    switch (rng() % 3) {
+    case 0:
+      assert(dict.insert(Entry{key, round}).second == reference.emplace(key, round).second);
+      break;
+    case 1:
+      assert(dict.erase(key) == reference.erase(key));
+      break;
+    default: {
+      auto it = dict.find(key);
+      auto ref = reference.find(key);
+      assert((it == dict.end()) == (ref == reference.end()));
+      assert(it == dict.end() || it->value == ref->second);
+    }
+    }
+    assert(dict.size() == reference.size());
+  }
+  // 迭代恰好访问每个键一次
+  size_t visited = 0;
+  for (const auto &entry : dict) {
+    assert(reference.at(entry.name) == entry.value);
+    ++visited;
+  }
+  assert(visited == reference.size());
+
+  std::cout << "  [PASS]" << std::endl;
+}
+
+void test_dict_find_batch() {
+  std::cout << "Test: Dict Batched Lookup..." << std::endl;
+  Dict<Entry> dict;
+  // 插入到扩容进行中为止，覆盖两张表都要查找的情况
+  int count = 0;
+  while (count < 40000 || !dict.rehashing()) {
+    dict.insert(Entry{"key:" + std::to_string(count), count});
+    ++count;
+  }
+
+  // 一半存在、一半不存在，并含有重复的键；跨越多个预取窗口
+  std::vector<std::string> keys;
+  for (int i = 0; i < 100; ++i) {
+    keys.push_back("key:" + std::to_string(i * 1000));
+  }
+  keys.push_back("key:0");
+  size_t calls = 0;
+  dict.find_batch(
+      keys.size(), [&](size_t i) { return std::string_view(keys[i]); },
+      [&](size_t i, Dict<Entry>::iterator it) {
+        assert(i == calls++); // 按顺序回调
+        int expected = i < 100 ? static_cast<int>(i) * 1000 : 0;
+        if (expected < count) {
+          assert(it != dict.end() && it->value == expected);
+        } else {
+          assert(it == dict.end());
+        }
+      });
+  assert(calls == keys.size());
+
+  // 回调中删除键不影响后续键的定位，重复的键第二次查找时已不存在
+  size_t erased = 0;
+  dict.find_batch(
+      keys.size(), [&](size_t i) { return std::string_view(keys[i]); },
+      [&](size_t, Dict<Entry>::iterator it) {
+        if (it != dict.end()) {
+          dict.erase(it);
+          ++erased;
+        }
+      });
+  size_t present = static_cast<size_t>((count - 1) / 1000 + 1);
+  assert(erased == present && dict.size() == static_cast<size_t>(count) - present);
+
+  std::cout << "  [PASS]" << std::endl;
+}
+
+int main() {
+  std::cout << "--- Starting Dict Unit Tests ---" << std::endl;
+  test_dict_basic();
+  test_dict_incremental_rehash();
+  test_dict_incremental_shrink();
+  test_dict_matches_unordered_map();
+  test_dict_find_batch();
+  std::cout << "\n✅ All Dict tests passed!" << std::endl;
+  return 0;
+}
@@ -0,0 +1,232 @@
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+import resp;
+import kv_server;
+import command;
+import logger;
+
+// 测试辅助宏
+#define TEST_ASSERT(condition, message)                                        \
+  do {                                                                         \
+    if (!(condition)) {                                                        \
+      std::cerr << "断言失败: " << message << " 在 " << __FILE__ << " 行 "    \
+                << __LINE__ << std::endl;                                      \
+      return false;                                                            \
+    }                                                                          \
+  } while (0)
+
+// 创建命令辅助函数
+resp::RespValue create_command(const std::vector<std::string> &parts) {
+  auto arr = std::make_unique<resp::RespArray>();
+
+  for (const auto &part : parts) {
+    resp::RespBulkString item;
+    item.value = part;
+    arr->values.push_back(item);
+  }
+
+  return resp::RespValue(std::move(arr));
+}
+
+std::string run(KVServer &server, const std::vector<std::string> &parts) {
+  return server.execute_command(create_command(parts));
+}
+
+// 从 INFO 中读取一个数值字段
+long long info_field(KVServer &server, const std::string &name) {
+  std::string info = run(server, {"INFO"});
+  auto pos = info.find(name + ":");
+  return pos == std::string::npos ? -1 : std::stoll(info.substr(pos + name.size() + 1));
+}
+
+bool exists(KVServer &server, const std::string &key) {
+  return run(server, {"EXISTS", key}) == resp::serialize_integer(1);
+}
+
+const std::string VALUE(100, 'v');
+
+// 测试 noeviction：超过上限后拒绝写入，读取和删除不受影响
+bool test_noeviction() {
+  std::cout << "测试 noeviction 策略..." << std::endl;
+
+  KVServer server;
+  for (int i = 0; i < 100; ++i) {
+    run(server, {"SET", "key:" + std::to_string(i), VALUE});
+  }
+  long long used = info_field(server, "used_memory");
+  TEST_ASSERT(used > 100 * 100, "used_memory 应包含所有条目");
+  server.set_maxmemory_config({static_cast<size_t>(used / 2), EvictionPolicy::NoEviction, 5});
+
+  std::string oom = resp::serialize_error("OOM command not allowed when used memory > 'maxmemory'.");
+  TEST_ASSERT(run(server, {"SET", "new", "1"}) == oom, "超过上限时 SET 应被拒绝");
+  TEST_ASSERT(run(server, {"INCR", "key:0"}) == oom, "超过上限时 INCR 应被拒绝");
+  TEST_ASSERT(run(server, {"GET", "key:0"}) == resp::serialize_bulk_string(VALUE), "超过上限时仍可读取");
+  TEST_ASSERT(run(server, {"DEL", "key:0"}) == resp::serialize_integer(1), "超过上限时仍可删除");
+  TEST_ASSERT(info_field(server, "evicted_keys") == 0, "noeviction 不应淘汰键");
+  TEST_ASSERT(info_field(server, "used_memory") < used, "删除后 used_memory 应减少");
+
+  std::cout << "noeviction 策略测试通过！" << std::endl;
+  return true;
+}
+
+// 测试 allkeys-lru：持续写入时内存保持在上限附近
+bool test_allkeys_lru() {
+  std::cout << "测试 allkeys-lru 策略..." << std::endl;
+
+  KVServer server;
+  constexpr size_t MAXMEMORY = 64 * 1024;
+  server.set_maxmemory_config({MAXMEMORY, EvictionPolicy::AllKeysLru, 5});
+  long long evicted_before = info_field(server, "evicted_keys");
+
+  for (int i = 0; i < 5000; ++i) {
+    std::string reply = run(server, {"SET", "key:" + std::to_string(i), VALUE});
+    TEST_ASSERT(reply == resp::serialize_ok(), "allkeys-lru 下写入应始终成功");
+  }
+  // 淘汰发生在每条命令执行之前，INFO 看到的内存占用不超过上限
+  TEST_ASSERT(info_field(server, "used_memory") <= static_cast<long long>(MAXMEMORY),
+              "内存占用应保持在上限以内");
+  TEST_ASSERT(info_field(server, "evicted_keys") - evicted_before > 4000, "应淘汰大部分旧键");
+  TEST_ASSERT(info_field(server, "maxmemory") == static_cast<long long>(MAXMEMORY), "INFO 应报告内存上限");
+  TEST_ASSERT(run(server, {"INFO"}).find("maxmemory_policy:allkeys-lru") != std::string::npos,
+              "INFO 应报告淘汰策略");
+
+  std::cout << "allkeys-lru 策略测试通过！" << std::endl;
+  return true;
+}
+
+// 写入并频繁访问一组热键，再写入大量冷键触发淘汰
+bool hot_keys_survive(KVServer &server) {
+  for (int i = 0; i < 10; ++i) {
+    run(server, {"SET", "hot:" + std::to_string(i), VALUE});
+  }
+  for (int round = 0; round < 50; ++round) {
+    for (int i = 0; i < 10; ++i) {
+      run(server, {"GET", "hot:" + std::to_string(i)});
+    }
+  }
+  for (int i = 0; i < 3000; ++i) {
+    run(server, {"SET", "cold:" + std::to_string(i), VALUE});
+  }
+
+  for (int i = 0; i < 10; ++i) {
+    TEST_ASSERT(exists(server, "hot:" + std::to_string(i)), "频繁访问的键应保留");
+  }
+  return true;
+}
+
+// 测试 allkeys-lfu：频繁访问的键不会被淘汰
+bool test_allkeys_lfu() {
+  std::cout << "测试 allkeys-lfu 策略..." << std::endl;
+
+  KVServer server;
+  constexpr size_t MAXMEMORY = 64 * 1024;
+  server.set_maxmemory_config({MAXMEMORY, EvictionPolicy::AllKeysLfu, 5});
+  TEST_ASSERT(hot_keys_survive(server), "allkeys-lfu 应保留热键");
+
+  std::cout << "allkeys-lfu 策略测试通过！" << std::endl;
+  return true;
+}
+
+// 测试 FLUSHALL ASYNC 之后 allkeys-lfu 仍然生效：键空间整体换成新表后，
+// 新键仍按 LFU 记录访问信息，而不是 LRU 时钟
+bool test_allkeys_lfu_after_async_flush() {
+  std::cout << "测试 FLUSHALL ASYNC 之后的 allkeys-lfu..." << std::endl;
+
+  KVServer server;
+  constexpr size_t MAXMEMORY = 64 * 1024;
+  server.set_maxmemory_config({MAXMEMORY, EvictionPolicy::AllKeysLfu, 5});
+  server.set_lazyfree_threshold(0);
+  for (int i = 0; i < 100; ++i) {
+    run(server, {"SET", "old:" + std::to_string(i), VALUE});
+  }
+  TEST_ASSERT(run(server, {"FLUSHALL", "ASYNC"}) == resp::serialize_ok(), "FLUSHALL ASYNC 应成功");
+  TEST_ASSERT(!exists(server, "old:0"), "FLUSHALL ASYNC 后键空间应为空");
+  TEST_ASSERT(hot_keys_survive(server), "FLUSHALL ASYNC 之后 allkeys-lfu 应保留热键");
+
+  std::cout << "FLUSHALL ASYNC 之后的 allkeys-lfu 测试通过！" << std::endl;
+  return true;
+}
+
+// 测试 volatile 策略：只淘汰设置了过期时间的键
+bool test_volatile_policies() {
+  std::cout << "测试 volatile 策略..." << std::endl;
+
+  KVServer server;
+  for (int i = 0; i < 100; ++i) {
+    run(server, {"SET", "persistent:" + std::to_string(i), VALUE});
+  }
+  for (int i = 0; i < 100; ++i) {
+    run(server, {"SET", "volatile:" + std::to_string(i), VALUE, "EX", std::to_string(1000 + i)});
+  }
+  long long used = info_field(server, "used_memory");
+  long long evicted_before = info_field(server, "evicted_keys");
+  server.set_maxmemory_config({static_cast<size_t>(used - 2000), EvictionPolicy::VolatileTtl, 5});
+
+  TEST_ASSERT(run(server, {"SET", "trigger", "1"}) == resp::serialize_ok(), "volatile-ttl 淘汰后应能写入");
+  TEST_ASSERT(info_field(server, "evicted_keys") > evicted_before, "应淘汰带过期时间的键");
+  for (int i = 0; i < 100; ++i) {
+    TEST_ASSERT(exists(server, "persistent:" + std::to_string(i)), "没有过期时间的键不应被淘汰");
+  }
+  TEST_ASSERT(exists(server, "volatile:99"), "剩余时间最长的键应保留");
+
+  // 带过期时间的键全部淘汰后无法再释放内存，写入被拒绝
+  server.set_maxmemory_config({1024, EvictionPolicy::VolatileLru, 5});
+  std::string oom = resp::serialize_error("OOM command not allowed when used memory > 'maxmemory'.");
+  TEST_ASSERT(run(server, {"SET", "another", "1"}) == oom, "没有可淘汰的键时应拒绝写入");
+  TEST_ASSERT(exists(server, "persistent:0") && !exists(server, "volatile:99"),
+              "volatile-lru 只淘汰带过期时间的键");
+
+  std::cout << "volatile 策略测试通过！" << std::endl;
+  return true;
+}
+
+int main() {
+  Logger::instance().set_level(LogLevel::ERROR);
+  std::cout << "开始内存淘汰测试..." << std::endl;
+
+  bool all_passed = true;
+  std::vector<std::pair<std::string, std::function<bool()>>> tests = {
+      {"noeviction 策略测试", test_noeviction},
+      {"allkeys-lru 策略测试", test_allkeys_lru},
+      {"allkeys-lfu 策略测试", test_allkeys_lfu},
+      {"FLUSHALL ASYNC 之后的 allkeys-lfu 测试", test_allkeys_lfu_after_async_flush},
+      {"volatile 策略测试", test_volatile_policies}};
+
+  int passed = 0;
+  int failed = 0;
+
+  for (const auto &[name, test_func] : tests) {
+    std::cout << "\n===================================" << std::endl;
+    std::cout << "执行测试: " << name << std::endl;
+    std::cout << "===================================" << std::endl;
+
+    try {
+      if (test_func()) {
+        std::cout << "√ 测试通过: " << name << std::endl;
+        passed++;
+      } else {
+        std::cerr << "× 测试失败: " << name << std::endl;
+        all_passed = false;
+        failed++;
+      }
+    } catch (const std::exception &e) {
+      std::cerr << "× 测试出现异常: " << name << " - " << e.what()
+                << std::endl;
+      all_passed = false;
+      failed++;
+    }
+  }
+
+  std::cout << "\n===================================" << std::endl;
+  std::cout << "测试结果摘要:" << std::endl;
+  std::cout << "总计: " << tests.size() << " 个测试" << std::endl;
+  std::cout << "通过: " << passed << " 个测试" << std::endl;
+  std::cout << "失败: " << failed << " 个测试" << std::endl;
+  std::cout << "===================================" << std::endl;
+
+  return all_passed ? 0 : 1;
+}
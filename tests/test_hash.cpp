@@ -0,0 +1,292 @@
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+import resp;
+import kv_server;
+import command;
+import logger;
+
+// 测试辅助宏
+#define TEST_ASSERT(condition, message)                                        \
+  do {                                                                         \
+    if (!(condition)) {                                                        \
+      std::cerr << "断言失败: " << message << " 在 " << __FILE__ << " 行 "    \
+                << __LINE__ << std::endl;                                      \
+      return false;                                                            \
+    }                                                                          \
+  } while (0)
+
+// 创建命令辅助函数
+resp::RespValue create_command(const std::vector<std::string> &parts) {
+  auto arr = std::make_unique<resp::RespArray>();
+
+  for (const auto &part : parts) {
+    resp::RespBulkString item;
+    item.value = part;
+    arr->values.push_back(item);
+  }
+
+  return resp::RespValue(std::move(arr));
+}
+
+std::string run(KVServer &server, const std::vector<std::string> &parts) {
+  return server.execute_command(create_command(parts));
+}
+
+// 把数组回复解析为字符串列表，nil 记为 "(nil)"；嵌套数组（HSCAN）展开为游标加元素
+bool parse_array(const std::string &response, std::vector<std::string> &items) {
+  std::string_view input = response;
+  auto value = resp::parse(input);
+  if (!value) {
+    return false;
+  }
+  auto *arr = std::get_if<std::unique_ptr<resp::RespArray>>(&*value);
+  if (!arr) {
+    return false;
+  }
+  items.clear();
+  std::function<void(const resp::RespArray &)> flatten = [&](const resp::RespArray &a) {
+    for (const auto &item : a.values) {
+      if (auto *nested = std::get_if<std::unique_ptr<resp::RespArray>>(&item)) {
+        flatten(**nested);
+      } else {
+        const auto &bulk = std::get<resp::RespBulkString>(item);
+        items.push_back(bulk.value ? *bulk.value : "(nil)");
+      }
+    }
+  };
+  flatten(**arr);
+  return true;
+}
+
+std::string encoding(KVServer &server, const std::string &key) {
+  return run(server, {"OBJECT", "ENCODING", key});
+}
+
+// 测试基本命令：HSET/HGET/HMGET/HDEL/HINCRBY/HGETALL
+bool test_hash_basic() {
+  std::cout << "测试哈希基本命令..." << std::endl;
+
+  KVServer server;
+  TEST_ASSERT(run(server, {"HSET", "user", "name", "alice", "age", "30"}) == resp::serialize_integer(2),
+              "HSET 返回新增的字段数");
+  TEST_ASSERT(run(server, {"HSET", "user", "name", "bob", "city", "x"}) == resp::serialize_integer(1),
+              "已有字段只更新值，不计入新增");
+  TEST_ASSERT(run(server, {"HGET", "user", "name"}) == resp::serialize_bulk_string("bob"), "HGET 读取更新后的值");
+  TEST_ASSERT(run(server, {"HGET", "user", "age"}) == resp::serialize_bulk_string("30"), "整数值按字符串返回");
+  TEST_ASSERT(run(server, {"HGET", "user", "none"}) == resp::serialize_null_bulk_string(), "不存在的字段返回 nil");
+  TEST_ASSERT(run(server, {"HGET", "nokey", "f"}) == resp::serialize_null_bulk_string(), "不存在的键返回 nil");
+
+  std::vector<std::string> items;
+  TEST_ASSERT(parse_array(run(server, {"HMGET", "user", "name", "none", "city"}), items), "HMGET 返回数组");
+  TEST_ASSERT((items == std::vector<std::string>{"bob", "(nil)", "x"}), "HMGET 按顺序返回，缺失的字段为 nil");
+
+  TEST_ASSERT(run(server, {"HINCRBY", "user", "age", "5"}) == resp::serialize_integer(35), "HINCRBY 累加整数值");
+  TEST_ASSERT(run(server, {"HINCRBY", "user", "visits", "-2"}) == resp::serialize_integer(-2),
+              "HINCRBY 不存在的字段从 0 开始");
+  TEST_ASSERT(run(server, {"HINCRBY", "user", "name", "1"}) == resp::serialize_error("ERR hash value is not an integer"),
+              "非整数值不能累加");
+  run(server, {"HSET", "user", "big", "9223372036854775807"});
+  TEST_ASSERT(run(server, {"HINCRBY", "user", "big", "1"}) ==
+                  resp::serialize_error("ERR increment or decrement would overflow"),
+              "溢出应报错");
+
+  TEST_ASSERT(parse_array(run(server, {"HGETALL", "user"}), items), "HGETALL 返回数组");
+  std::map<std::string, std::string> all;
+  for (size_t i = 0; i + 1 < items.size(); i += 2) {
+    all[items[i]] = items[i + 1];
+  }
+  TEST_ASSERT(items.size() == 10 && all["age"] == "35" && all["visits"] == "-2", "HGETALL 返回全部字段和值");
+
+  TEST_ASSERT(run(server, {"HDEL", "user", "name", "none", "city"}) == resp::serialize_integer(2), "HDEL 返回删除的字段数");
+  TEST_ASSERT(run(server, {"HDEL", "user", "age", "visits", "big"}) == resp::serialize_integer(3), "删除剩余字段");
+  TEST_ASSERT(run(server, {"EXISTS", "user"}) == resp::serialize_integer(0), "哈希变空时删除键");
+
+  TEST_ASSERT(run(server, {"HSET", "user", "name", "v", "extra"}) ==
+                  resp::serialize_error("ERR wrong number of arguments for 'HSET' command"),
+              "字段和值必须成对");
+
+  std::cout << "哈希基本命令测试通过！" << std::endl;
+  return true;
+}
+
+// 测试类型检查：字符串命令不能操作哈希，哈希命令不能操作字符串，SET 可以覆盖任何类型
+bool test_hash_types() {
+  std::cout << "测试类型检查..." << std::endl;
+
+  KVServer server;
+  std::string wrongtype = resp::serialize_error("WRONGTYPE Operation against a key holding the wrong kind of value");
+  run(server, {"HSET", "h", "f", "v"});
+  run(server, {"SET", "s", "10"});
+
+  TEST_ASSERT(run(server, {"TYPE", "h"}) == resp::serialize_simple_string("hash"), "TYPE 返回 hash");
+  TEST_ASSERT(run(server, {"TYPE", "s"}) == resp::serialize_simple_string("string"), "TYPE 返回 string");
+  TEST_ASSERT(run(server, {"TYPE", "none"}) == resp::serialize_simple_string("none"), "不存在的键返回 none");
+
+  TEST_ASSERT(run(server, {"GET", "h"}) == wrongtype, "GET 哈希应报 WRONGTYPE");
+  TEST_ASSERT(run(server, {"INCR", "h"}) == wrongtype, "INCR 哈希应报 WRONGTYPE");
+  TEST_ASSERT(run(server, {"GETDEL", "h"}) == wrongtype, "GETDEL 哈希应报 WRONGTYPE");
+  TEST_ASSERT(run(server, {"HGET", "s", "f"}) == wrongtype, "HGET 字符串应报 WRONGTYPE");
+  TEST_ASSERT(run(server, {"HSET", "s", "f", "v"}) == wrongtype, "HSET 字符串应报 WRONGTYPE");
+  TEST_ASSERT(run(server, {"GET", "s"}) == resp::serialize_bulk_string("10"), "类型错误不应修改原值");
+
+  std::vector<std::string> items;
+  TEST_ASSERT(parse_array(run(server, {"MGET", "h", "s"}), items), "MGET 返回数组");
+  TEST_ASSERT((items == std::vector<std::string>{"(nil)", "10"}), "MGET 中不是字符串的键返回 nil");
+
+  // 过期时间对哈希同样有效
+  TEST_ASSERT(run(server, {"EXPIRE", "h", "100"}) == resp::serialize_integer(1), "哈希可以设置过期时间");
+  TEST_ASSERT(run(server, {"HGET", "h", "f"}) == resp::serialize_bulk_string("v"), "设置过期时间后字段不变");
+  TEST_ASSERT(run(server, {"PERSIST", "h"}) == resp::serialize_integer(1), "哈希可以移除过期时间");
+
+  TEST_ASSERT(run(server, {"SET", "h", "plain"}) == resp::serialize_ok(), "SET 覆盖哈希");
+  TEST_ASSERT(run(server, {"GET", "h"}) == resp::serialize_bulk_string("plain"), "覆盖后是字符串");
+  TEST_ASSERT(run(server, {"TYPE", "h"}) == resp::serialize_simple_string("string"), "覆盖后类型为 string");
+
+  std::cout << "类型检查测试通过！" << std::endl;
+  return true;
+}
+
+// 测试编码转换：字段数或值长度超过阈值时从 listpack 转换为哈希表，内容不变
+bool test_hash_encoding() {
+  std::cout << "测试哈希编码转换..." << std::endl;
+
+  KVServer server;
+  TEST_ASSERT(encoding(server, "none") == resp::serialize_null_bulk_string(), "不存在的键返回 nil");
+  run(server, {"SET", "num", "12345"});
+  run(server, {"SET", "str", "hello"});
+  TEST_ASSERT(encoding(server, "num") == resp::serialize_bulk_string("int"), "整数字符串为 int 编码");
+  TEST_ASSERT(encoding(server, "str") == resp::serialize_bulk_string("embstr"), "普通字符串为 embstr 编码");
+
+  for (int i = 0; i < 128; ++i) {
+    run(server, {"HSET", "small", "field:" + std::to_string(i), std::to_string(i)});
+  }
+  TEST_ASSERT(encoding(server, "small") == resp::serialize_bulk_string("listpack"), "128 个字段内使用 listpack");
+  run(server, {"HSET", "small", "field:128", "x"});
+  TEST_ASSERT(encoding(server, "small") == resp::serialize_bulk_string("hashtable"), "超过字段数阈值后转换为哈希表");
+  for (int i = 0; i < 128; ++i) {
+    TEST_ASSERT(run(server, {"HGET", "small", "field:" + std::to_string(i)}) ==
+                    resp::serialize_bulk_string(std::to_string(i)),
+                "转换后字段不变");
+  }
+
+  run(server, {"HSET", "long", "f", "short"});
+  TEST_ASSERT(encoding(server, "long") == resp::serialize_bulk_string("listpack"), "短值使用 listpack");
+  run(server, {"HSET", "long", "g", std::string(65, 'v')});
+  TEST_ASSERT(encoding(server, "long") == resp::serialize_bulk_string("hashtable"), "超过值长度阈值后转换为哈希表");
+  TEST_ASSERT(run(server, {"HGET", "long", "f"}) == resp::serialize_bulk_string("short"), "转换后原有字段不变");
+
+  // 阈值可配置
+  EncodingConfig config;
+  config.hash_max_listpack_entries = 4;
+  server.set_encoding_config(config);
+  for (int i = 0; i < 4; ++i) {
+    run(server, {"HSET", "tiny", "f" + std::to_string(i), "v"});
+  }
+  TEST_ASSERT(encoding(server, "tiny") == resp::serialize_bulk_string("listpack"), "不超过配置的阈值时使用 listpack");
+  run(server, {"HSET", "tiny", "f4", "v"});
+  TEST_ASSERT(encoding(server, "tiny") == resp::serialize_bulk_string("hashtable"), "超过配置的阈值后转换");
+
+  TEST_ASSERT(run(server, {"OBJECT", "FREQ", "tiny"}).starts_with("-ERR unknown subcommand"), "未知子命令应报错");
+
+  std::cout << "哈希编码转换测试通过！" << std::endl;
+  return true;
+}
+
+// 测试 HSCAN：两种编码下都返回全部字段，MATCH 只匹配字段名
+bool test_hscan() {
+  std::cout << "测试 HSCAN..." << std::endl;
+
+  KVServer server;
+  for (int i = 0; i < 10; ++i) {
+    run(server, {"HSET", "small", "f" + std::to_string(i), "v" + std::to_string(i)});
+  }
+  std::vector<std::string> items;
+  TEST_ASSERT(parse_array(run(server, {"HSCAN", "small", "0"}), items), "HSCAN 返回游标和数组");
+  TEST_ASSERT(items.size() == 21 && items[0] == "0", "listpack 编码一次返回全部字段，游标为 0");
+
+  const int count = 3000;
+  for (int i = 0; i < count; ++i) {
+    run(server, {"HSET", "big", "field:" + std::to_string(i), std::to_string(i)});
+  }
+  std::map<std::string, std::string> seen;
+  std::string cursor = "0";
+  size_t calls = 0;
+  do {
+    TEST_ASSERT(parse_array(run(server, {"HSCAN", "big", cursor, "COUNT", "50"}), items), "HSCAN 返回游标和数组");
+    cursor = items[0];
+    for (size_t i = 1; i + 1 < items.size(); i += 2) {
+      seen[items[i]] = items[i + 1];
+    }
+  } while (cursor != "0" && ++calls < 100000);
+  TEST_ASSERT(seen.size() == count && seen["field:42"] == "42", "哈希表编码逐步返回全部字段");
+  TEST_ASSERT(calls > 10, "COUNT 限制每次调用的工作量");
+
+  std::set<std::string> matched;
+  cursor = "0";
+  do {
+    TEST_ASSERT(parse_array(run(server, {"HSCAN", "big", cursor, "MATCH", "field:1?", "NOVALUES"}), items),
+                "带 MATCH 的 HSCAN");
+    cursor = items[0];
+    matched.insert(items.begin() + 1, items.end());
+  } while (cursor != "0");
+  TEST_ASSERT(matched.size() == 10 && matched.count("field:15") == 1, "MATCH 只返回匹配的字段，NOVALUES 不返回值");
+
+  TEST_ASSERT(parse_array(run(server, {"HSCAN", "nokey", "0"}), items) && items.size() == 1 && items[0] == "0",
+              "不存在的键返回空结果");
+  TEST_ASSERT(run(server, {"HSCAN", "big", "x"}) == resp::serialize_error("ERR invalid cursor"), "无效游标应报错");
+  TEST_ASSERT(run(server, {"HSCAN", "big", "0", "COUNT"}) == resp::serialize_error("ERR syntax error"),
+              "缺少选项值应报错");
+
+  std::cout << "HSCAN 测试通过！" << std::endl;
+  return true;
+}
+
+int main() {
+  Logger::instance().set_level(LogLevel::ERROR);
+  std::cout << "开始哈希类型测试..." << std::endl;
+
+  bool all_passed = true;
+  std::vector<std::pair<std::string, std::function<bool()>>> tests = {
+      {"哈希基本命令测试", test_hash_basic},
+      {"类型检查测试", test_hash_types},
+      {"哈希编码转换测试", test_hash_encoding},
+      {"HSCAN 测试", test_hscan}};
+
+  int passed = 0;
+  int failed = 0;
+
+  for (const auto &[name, test_func] : tests) {
+    std::cout << "\n===================================" << std::endl;
+    std::cout << "执行测试: " << name << std::endl;
+    std::cout << "===================================" << std::endl;
+
+    try {
+      if (test_func()) {
+        std::cout << "√ 测试通过: " << name << std::endl;
+        passed++;
+      } else {
+        std::cerr << "× 测试失败: " << name << std::endl;
+        all_passed = false;
+        failed++;
+      }
+    } catch (const std::exception &e) {
+      std::cerr << "× 测试出现异常: " << name << " - " << e.what() << std::endl;
+      all_passed = false;
+      failed++;
+    }
+  }
+
+  std::cout << "\n===================================" << std::endl;
+  std::cout << "测试结果: " << passed << " 通过, " << failed << " 失败" << std::endl;
+  std::cout << "===================================" << std::endl;
+
+  return all_passed ? 0 : 1;
+}
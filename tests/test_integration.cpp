@@ -24,6 +24,9 @@ import logger;
     }                                                                          \
   } while (0)
 
+// 服务器使用的事件后端，由第一个命令行参数指定（默认 epoll）
+std::string event_backend = "epoll";
+
 // 准备测试配置文件
 bool prepare_test_config(const std::string &config_file,
                          const std::string &aof_file,
@@ -39,6 +42,7 @@ bool prepare_test_config(const std::string &config_file,
   config << "aof-enabled yes\n"; // 启用AOF
   config << "aof-file " << aof_file << "\n";         // AOF文件路径
   config << "appendfsync " << sync_strategy << "\n"; // 同步策略
+  config << "event-backend " << event_backend << "\n"; // 事件后端
 
   config.close();
   return true;
@@ -301,7 +305,10 @@ bool test_sync_strategy_performance() {
   return true;
 }
 
-int main() {
+int main(int argc, char *argv[]) {
+  if (argc > 1) {
+    event_backend = argv[1];
+  }
   // 初始化日志
   Logger::instance().set_level(LogLevel::DEBUG);
 
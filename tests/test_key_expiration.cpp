@@ -379,6 +379,94 @@ bool test_integration() {
   return true;
 }
 
+// 测试 INFO 中的 expires 和 avg_ttl 统计
+bool test_info_expires() {
+  std::cout << "测试 INFO 过期统计..." << std::endl;
+
+  KVServer server;
+
+  for (int i = 1; i <= 3; ++i) {
+    server.execute_command(
+        create_command({"SET", "key_" + std::to_string(i), "value"}));
+  }
+  server.execute_command(create_command({"PEXPIRE", "key_1", "10000"}));
+  server.execute_command(create_command({"PEXPIRE", "key_2", "20000"}));
+
+  auto info = server.execute_command(create_command({"INFO"}));
+  auto line_start = info.find("db0:keys=3,expires=2,avg_ttl=");
+  TEST_ASSERT(line_start != std::string::npos, "INFO 应报告 2 个带过期时间的键");
+  long long avg_ttl = std::stoll(info.substr(line_start + 29));
+  TEST_ASSERT(avg_ttl > 14000 && avg_ttl <= 15000, "avg_ttl 应接近 15000 毫秒");
+
+  // PERSIST、SET 覆盖和删除都要同步更新过期统计
+  server.execute_command(create_command({"PERSIST", "key_1"}));
+  info = server.execute_command(create_command({"INFO"}));
+  TEST_ASSERT(info.find("db0:keys=3,expires=1,") != std::string::npos,
+              "PERSIST 后应剩 1 个带过期时间的键");
+  server.execute_command(create_command({"SET", "key_2", "new_value"}));
+  info = server.execute_command(create_command({"INFO"}));
+  TEST_ASSERT(info.find("db0:keys=3,expires=0,avg_ttl=0") != std::string::npos,
+              "SET 覆盖后不应再有带过期时间的键");
+
+  server.execute_command(create_command({"PEXPIRE", "key_3", "1"}));
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  server.execute_command(create_command({"GET", "key_3"}));
+  info = server.execute_command(create_command({"INFO"}));
+  TEST_ASSERT(info.find("db0:keys=2,expires=0,avg_ttl=0") != std::string::npos,
+              "惰性删除后过期统计应同步更新");
+
+  std::cout << "INFO 过期统计测试通过！" << std::endl;
+  return true;
+}
+
+// 测试主动过期周期：迭代执行，每个周期受时间预算约束
+bool test_active_expire_cycle() {
+  std::cout << "测试主动过期周期..." << std::endl;
+
+  KVServer server;
+  // 预算很小（每个慢周期约 20 微秒），大量键同时过期时需要多个周期才能清理完
+  server.set_active_expire_config({500, 1});
+
+  constexpr int KEY_COUNT = 20000;
+  for (int i = 0; i < KEY_COUNT; ++i) {
+    std::string key = "key_" + std::to_string(i);
+    server.execute_command(create_command({"SET", key, "value"}));
+    server.execute_command(create_command({"PEXPIRE", key, "1"}));
+  }
+  server.execute_command(create_command({"SET", "persistent", "value"}));
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+  // 第一个周期至少删除一部分过期键
+  server.active_expire_cycle(ExpireCycleType::Slow);
+  auto info = server.execute_command(create_command({"INFO"}));
+  TEST_ASSERT(info.find("expire_cycles:") != std::string::npos,
+              "INFO 应报告过期周期统计");
+  TEST_ASSERT(info.find("db0:keys=" + std::to_string(KEY_COUNT + 1) + ",") ==
+                  std::string::npos,
+              "第一个过期周期应删除部分过期键");
+
+  // 快周期与慢周期交替执行，直到所有过期键都被清理
+  int cycles = 1;
+  while (info.find("db0:keys=1,expires=0,") == std::string::npos &&
+         cycles < 100000) {
+    server.active_expire_cycle(ExpireCycleType::Fast);
+    server.active_expire_cycle(ExpireCycleType::Slow);
+    info = server.execute_command(create_command({"INFO"}));
+    ++cycles;
+  }
+  TEST_ASSERT(info.find("db0:keys=1,expires=0,") != std::string::npos,
+              "多个过期周期后所有过期键都应被删除");
+  std::cout << "  共执行 " << cycles << " 轮过期周期" << std::endl;
+
+  // 没有设置过期时间的键不受影响
+  TEST_ASSERT(server.execute_command(create_command({"GET", "persistent"})) ==
+                  resp::serialize_bulk_string("value"),
+              "未设置过期时间的键不应被删除");
+
+  std::cout << "主动过期周期测试通过！" << std::endl;
+  return true;
+}
+
 int main() {
   // 设置日志级别
   Logger::instance().set_level(LogLevel::INFO);
@@ -392,6 +480,8 @@ int main() {
       {"惰性删除机制测试", test_lazy_deletion},
       {"定期删除机制测试", test_periodic_deletion},
       {"SET 覆盖过期时间测试", test_set_with_expire_overwrite},
+      {"INFO 过期统计测试", test_info_expires},
+      {"主动过期周期测试", test_active_expire_cycle},
       {"集成测试", test_integration}};
 
   int passed = 0;
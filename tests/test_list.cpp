@@ -0,0 +1,240 @@
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+import resp;
+import kv_server;
+import logger;
+
+// 测试辅助宏
+#define TEST_ASSERT(condition, message)                                        \
+  do {                                                                         \
+    if (!(condition)) {                                                        \
+      std::cerr << "断言失败: " << message << " 在 " << __FILE__ << " 行 "    \
+                << __LINE__ << std::endl;                                      \
+      return false;                                                            \
+    }                                                                          \
+  } while (0)
+
+// 创建命令辅助函数
+resp::RespValue create_command(const std::vector<std::string> &parts) {
+  auto arr = std::make_unique<resp::RespArray>();
+
+  for (const auto &part : parts) {
+    resp::RespBulkString item;
+    item.value = part;
+    arr->values.push_back(item);
+  }
+
+  return resp::RespValue(std::move(arr));
+}
+
+std::string run(KVServer &server, const std::vector<std::string> &parts) {
+  return server.execute_command(create_command(parts));
+}
+
+// 把数组回复解析为字符串列表，nil 记为 "(nil)"
+bool parse_array(const std::string &response, std::vector<std::string> &items) {
+  std::string_view input = response;
+  auto value = resp::parse(input);
+  if (!value) {
+    return false;
+  }
+  auto *arr = std::get_if<std::unique_ptr<resp::RespArray>>(&*value);
+  if (!arr) {
+    return false;
+  }
+  items.clear();
+  for (const auto &item : (*arr)->values) {
+    const auto &bulk = std::get<resp::RespBulkString>(item);
+    items.push_back(bulk.value ? *bulk.value : "(nil)");
+  }
+  return true;
+}
+
+// 从 INFO 中读取一个数值字段
+double info_field(KVServer &server, const std::string &name) {
+  std::string info = run(server, {"INFO"});
+  auto pos = info.find(name + ":");
+  return pos == std::string::npos ? -1 : std::stod(info.substr(pos + name.size() + 1));
+}
+
+// 测试压入和弹出：LPUSH/RPUSH/LPOP/RPOP/LLEN，弹空时删除键
+bool test_list_push_pop() {
+  std::cout << "测试列表压入和弹出..." << std::endl;
+
+  KVServer server;
+  TEST_ASSERT(run(server, {"RPUSH", "q", "a", "b", "c"}) == resp::serialize_integer(3), "RPUSH 返回列表长度");
+  TEST_ASSERT(run(server, {"LPUSH", "q", "x", "y"}) == resp::serialize_integer(5), "LPUSH 返回列表长度");
+  std::vector<std::string> items;
+  TEST_ASSERT(parse_array(run(server, {"LRANGE", "q", "0", "-1"}), items), "LRANGE 返回数组");
+  TEST_ASSERT((items == std::vector<std::string>{"y", "x", "a", "b", "c"}), "LPUSH 的元素依次压入头部");
+
+  TEST_ASSERT(run(server, {"LPOP", "q"}) == resp::serialize_bulk_string("y"), "LPOP 弹出头部");
+  TEST_ASSERT(run(server, {"RPOP", "q"}) == resp::serialize_bulk_string("c"), "RPOP 弹出尾部");
+  TEST_ASSERT(run(server, {"LLEN", "q"}) == resp::serialize_integer(3), "LLEN 返回剩余长度");
+  TEST_ASSERT(parse_array(run(server, {"LPOP", "q", "2"}), items), "带 count 的 LPOP 返回数组");
+  TEST_ASSERT((items == std::vector<std::string>{"x", "a"}), "按顺序弹出 count 个元素");
+  TEST_ASSERT(parse_array(run(server, {"RPOP", "q", "10"}), items) && items == std::vector<std::string>{"b"},
+              "count 超过长度时弹出全部");
+  TEST_ASSERT(run(server, {"EXISTS", "q"}) == resp::serialize_integer(0), "列表弹空时删除键");
+
+  TEST_ASSERT(run(server, {"LPOP", "q"}) == resp::serialize_null_bulk_string(), "空键 LPOP 返回 nil");
+  TEST_ASSERT(run(server, {"LPOP", "q", "1"}) == "*-1\r\n", "空键带 count 的 LPOP 返回空数组回复");
+  TEST_ASSERT(run(server, {"LLEN", "q"}) == resp::serialize_integer(0), "不存在的键长度为 0");
+  TEST_ASSERT(run(server, {"LPOP", "q", "-1"}) == resp::serialize_error("ERR value is out of range, must be positive"),
+              "负数 count 应报错");
+
+  run(server, {"SET", "s", "v"});
+  std::string wrongtype = resp::serialize_error("WRONGTYPE Operation against a key holding the wrong kind of value");
+  TEST_ASSERT(run(server, {"LPUSH", "s", "a"}) == wrongtype, "LPUSH 字符串应报 WRONGTYPE");
+  TEST_ASSERT(run(server, {"LLEN", "s"}) == wrongtype, "LLEN 字符串应报 WRONGTYPE");
+  run(server, {"RPUSH", "l", "a"});
+  TEST_ASSERT(run(server, {"GET", "l"}) == wrongtype, "GET 列表应报 WRONGTYPE");
+  TEST_ASSERT(run(server, {"TYPE", "l"}) == resp::serialize_simple_string("list"), "TYPE 返回 list");
+  TEST_ASSERT(run(server, {"OBJECT", "ENCODING", "l"}) == resp::serialize_bulk_string("quicklist"),
+              "列表为 quicklist 编码");
+
+  std::cout << "列表压入和弹出测试通过！" << std::endl;
+  return true;
+}
+
+// 测试跨越多个节点的大列表：LINDEX、LRANGE、LTRIM 的下标与两端的压入弹出一致
+bool test_list_large() {
+  std::cout << "测试大列表..." << std::endl;
+
+  KVServer server;
+  const int count = 50000;
+  // 两端交替压入，最终列表为 -count/2 .. count/2-1 的元素
+  for (int i = 0; i < count / 2; ++i) {
+    run(server, {"RPUSH", "big", "item:" + std::to_string(i)});
+    run(server, {"LPUSH", "big", "item:" + std::to_string(-i - 1)});
+  }
+  TEST_ASSERT(run(server, {"LLEN", "big"}) == resp::serialize_integer(count), "长度应正确");
+  auto expected = [](long long index) { return "item:" + std::to_string(index - count / 2); };
+  for (long long index : {0LL, 1LL, 4095LL, 12345LL, 25000LL, 49999LL}) {
+    TEST_ASSERT(run(server, {"LINDEX", "big", std::to_string(index)}) == resp::serialize_bulk_string(expected(index)),
+                "LINDEX 应返回对应位置的元素");
+  }
+  TEST_ASSERT(run(server, {"LINDEX", "big", "-1"}) == resp::serialize_bulk_string(expected(count - 1)),
+              "负数下标从尾部计数");
+  TEST_ASSERT(run(server, {"LINDEX", "big", std::to_string(count)}) == resp::serialize_null_bulk_string(),
+              "越界返回 nil");
+
+  std::vector<std::string> items;
+  TEST_ASSERT(parse_array(run(server, {"LRANGE", "big", "20000", "20999"}), items), "LRANGE 返回数组");
+  TEST_ASSERT(items.size() == 1000, "LRANGE 返回区间内的全部元素");
+  for (size_t i = 0; i < items.size(); ++i) {
+    TEST_ASSERT(items[i] == expected(20000 + static_cast<long long>(i)), "LRANGE 跨越节点时顺序正确");
+  }
+  TEST_ASSERT(parse_array(run(server, {"LRANGE", "big", "-3", "100000"}), items) && items.size() == 3,
+              "超出末尾的 stop 截到最后一个元素");
+  TEST_ASSERT(parse_array(run(server, {"LRANGE", "big", "5", "2"}), items) && items.empty(), "空区间返回空数组");
+
+  // 每个元素的内存开销只有几个字节（元素本身约 10 字节）
+  double per_element = info_field(server, "keyspace_entry_bytes") / count;
+  std::cout << "每个元素占用 " << per_element << " 字节" << std::endl;
+  TEST_ASSERT(per_element < 20, "紧凑节点中每个元素的额外开销应很小");
+
+  TEST_ASSERT(run(server, {"LTRIM", "big", "10000", "-10001"}) == resp::serialize_ok(), "LTRIM 返回 OK");
+  TEST_ASSERT(run(server, {"LLEN", "big"}) == resp::serialize_integer(count - 20000), "LTRIM 后长度正确");
+  TEST_ASSERT(run(server, {"LINDEX", "big", "0"}) == resp::serialize_bulk_string(expected(10000)), "LTRIM 保留区间的开头");
+  TEST_ASSERT(run(server, {"LINDEX", "big", "-1"}) == resp::serialize_bulk_string(expected(count - 10001)),
+              "LTRIM 保留区间的结尾");
+  TEST_ASSERT(run(server, {"LTRIM", "big", "1", "0"}) == resp::serialize_ok(), "空区间的 LTRIM 返回 OK");
+  TEST_ASSERT(run(server, {"EXISTS", "big"}) == resp::serialize_integer(0), "区间为空时删除键");
+
+  std::cout << "大列表测试通过！" << std::endl;
+  return true;
+}
+
+// 测试阻塞命令在键空间层的行为：有元素时立即完成，没有元素时得到超时时的空回复
+// （直接执行和事务中的阻塞命令不会挂起，挂起由连接层完成），以及 LMOVE/BLMOVE 的移动规则
+bool test_list_blocking_commands() {
+  std::cout << "测试阻塞命令..." << std::endl;
+
+  KVServer server;
+  run(server, {"RPUSH", "q", "a", "b"});
+  std::vector<std::string> items;
+  TEST_ASSERT(parse_array(run(server, {"BLPOP", "empty", "q", "0"}), items), "BLPOP 返回数组");
+  TEST_ASSERT((items == std::vector<std::string>{"q", "a"}), "BLPOP 跳过空键，返回键名和头部元素");
+  TEST_ASSERT(parse_array(run(server, {"BRPOP", "q", "1.5"}), items) && (items == std::vector<std::string>{"q", "b"}),
+              "BRPOP 弹出尾部元素");
+  TEST_ASSERT(run(server, {"EXISTS", "q"}) == resp::serialize_integer(0), "弹空后删除键");
+  TEST_ASSERT(run(server, {"BLPOP", "q", "0.1"}) == "*-1\r\n", "没有元素时返回空数组回复");
+  TEST_ASSERT(run(server, {"BLPOP", "q", "-1"}) == resp::serialize_error("ERR timeout is negative"),
+              "负数超时应报错");
+  TEST_ASSERT(run(server, {"BLPOP", "q", "abc"}) == resp::serialize_error("ERR timeout is not a float or out of range"),
+              "非数字超时应报错");
+
+  run(server, {"RPUSH", "src", "1", "2", "3"});
+  TEST_ASSERT(run(server, {"LMOVE", "src", "dst", "RIGHT", "LEFT"}) == resp::serialize_bulk_string("3"),
+              "LMOVE 返回被移动的元素");
+  TEST_ASSERT(parse_array(run(server, {"LRANGE", "dst", "0", "-1"}), items) && items == std::vector<std::string>{"3"},
+              "LMOVE 在目标键不存在时创建列表");
+  TEST_ASSERT(run(server, {"LMOVE", "src", "src", "LEFT", "RIGHT"}) == resp::serialize_bulk_string("1"),
+              "同一列表内轮转");
+  TEST_ASSERT(parse_array(run(server, {"LRANGE", "src", "0", "-1"}), items) &&
+                  (items == std::vector<std::string>{"2", "1"}),
+              "轮转后头部元素移到尾部");
+  run(server, {"SET", "s", "v"});
+  TEST_ASSERT(run(server, {"LMOVE", "src", "s", "LEFT", "LEFT"}) ==
+                  resp::serialize_error("WRONGTYPE Operation against a key holding the wrong kind of value"),
+              "目标键类型不符时报错");
+  TEST_ASSERT(run(server, {"LLEN", "src"}) == resp::serialize_integer(2), "目标键类型不符时不弹出元素");
+  TEST_ASSERT(run(server, {"LMOVE", "src", "dst", "UP", "LEFT"}) == resp::serialize_error("ERR syntax error"),
+              "无效的方向应报错");
+  TEST_ASSERT(run(server, {"BLMOVE", "src", "dst", "LEFT", "RIGHT", "0"}) == resp::serialize_bulk_string("2"),
+              "BLMOVE 有元素时立即完成");
+  TEST_ASSERT(run(server, {"BLMOVE", "none", "dst", "LEFT", "RIGHT", "0"}) == resp::serialize_null_bulk_string(),
+              "BLMOVE 没有元素时返回 nil");
+  TEST_ASSERT(info_field(server, "blocked_clients") == 0, "键空间层不挂起客户端");
+
+  std::cout << "阻塞命令测试通过！" << std::endl;
+  return true;
+}
+
+int main() {
+  Logger::instance().set_level(LogLevel::ERROR);
+  std::cout << "开始列表类型测试..." << std::endl;
+
+  bool all_passed = true;
+  std::vector<std::pair<std::string, std::function<bool()>>> tests = {
+      {"列表压入和弹出测试", test_list_push_pop},
+      {"大列表测试", test_list_large},
+      {"阻塞命令测试", test_list_blocking_commands}};
+
+  int passed = 0;
+  int failed = 0;
+
+  for (const auto &[name, test_func] : tests) {
+    std::cout << "\n===================================" << std::endl;
+    std::cout << "执行测试: " << name << std::endl;
+    std::cout << "===================================" << std::endl;
+
+    try {
+      if (test_func()) {
+        std::cout << "√ 测试通过: " << name << std::endl;
+        passed++;
+      } else {
+        std::cerr << "× 测试失败: " << name << std::endl;
+        all_passed = false;
+        failed++;
+      }
+    } catch (const std::exception &e) {
+      std::cerr << "× 测试出现异常: " << name << " - " << e.what() << std::endl;
+      all_passed = false;
+      failed++;
+    }
+  }
+
+  std::cout << "\n===================================" << std::endl;
+  std::cout << "测试结果: " << passed << " 通过, " << failed << " 失败" << std::endl;
+  std::cout << "===================================" << std::endl;
+
+  return all_passed ? 0 : 1;
+}
@@ -0,0 +1,146 @@
+// tests/test_request_parser.cpp
+#include <cassert>
+#include <iostream>
+#include <string>
+#include <string_view>
+
+import resp;
+
+void test_parse_multibulk() {
+  std::cout << "Test: Parse Multibulk Request..." << std::endl;
+  std::string input = "*3\r\n$3\r\nSET\r\n$3\r\nkey\r\n$5\r\nvalue\r\n";
+  resp::RequestArgv argv;
+  auto result = resp::parse_request(input, argv);
+  assert(result.has_value());
+  assert(*result == input.size());
+  assert(argv.size() == 3);
+  assert(argv[0] == "SET");
+  assert(argv[1] == "key");
+  assert(argv[2] == "value");
+  // 参数直接指向输入数据，没有拷贝
+  assert(argv[1].data() == input.data() + 17);
+
+  std::cout << "  [PASS]" << std::endl;
+}
+
+void test_parse_incomplete() {
+  std::cout << "Test: Parse Incomplete Request..." << std::endl;
+  std::string input = "*2\r\n$3\r\nGET\r\n$3\r\nkey\r\n";
+  resp::RequestArgv argv;
+  // 任何一个真前缀都是不完整的请求
+  for (size_t len = 0; len < input.size(); ++len) {
+    auto result = resp::parse_request(std::string_view(input).substr(0, len), argv);
+    assert(!result.has_value());
+    assert(result.error() == resp::ParseError::Incomplete);
+  }
+  auto result = resp::parse_request(input, argv);
+  assert(result.has_value() && *result == input.size());
+
+  std::cout << "  [PASS]" << std::endl;
+}
+
+void test_resumable_parse() {
+  std::cout << "Test: Resume Parsing Across Chunks..." << std::endl;
+  std::string value(100000, 'v');
+  std::string input = "*3\r\n$3\r\nSET\r\n$3\r\nbig\r\n$" +
+                      std::to_string(value.size()) + "\r\n" + value + "\r\n";
+  resp::RequestParser parser;
+  resp::RequestArgv argv;
+  // 每次多给一块数据，同一个解析器从断点继续
+  size_t header_end = input.size() - value.size() - 2;
+  for (size_t len = 1; len < input.size(); len += 997) {
+    auto result = parser.parse(std::string_view(input).substr(0, len), argv);
+    assert(!result.has_value());
+    assert(result.error() == resp::ParseError::Incomplete);
+    // 读到 $len 之后，解析器知道整条请求的大小
+    if (len >= header_end) {
+      assert(parser.expected_size() == input.size());
+    }
+  }
+  // 模拟缓冲区扩容后数据搬到了新的地址
+  std::string moved = input;
+  auto result = parser.parse(moved, argv);
+  assert(result.has_value() && *result == input.size());
+  assert(argv.size() == 3 && argv[1] == "big" && argv[2] == value);
+  assert(argv[2].data() >= moved.data() && argv[2].data() < moved.data() + moved.size());
+  // 解析器已重置，可以继续解析下一条请求
+  assert(parser.expected_size() == 0);
+  result = parser.parse("*1\r\n$4\r\nPING\r\n", argv);
+  assert(result.has_value() && argv.size() == 1 && argv[0] == "PING");
+
+  std::cout << "  [PASS]" << std::endl;
+}
+
+void test_parse_pipeline() {
+  std::cout << "Test: Parse Pipelined Requests..." << std::endl;
+  std::string input = "*1\r\n$4\r\nPING\r\n*2\r\n$3\r\nGET\r\n$1\r\na\r\n";
+  resp::RequestArgv argv;
+  auto first = resp::parse_request(input, argv);
+  assert(first.has_value() && *first == 14);
+  assert(argv.size() == 1 && argv[0] == "PING");
+  auto second = resp::parse_request(std::string_view(input).substr(*first), argv);
+  assert(second.has_value() && *first + *second == input.size());
+  assert(argv.size() == 2 && argv[1] == "a");
+
+  std::cout << "  [PASS]" << std::endl;
+}
+
+void test_parse_inline_and_empty() {
+  std::cout << "Test: Parse Inline and Empty Requests..." << std::endl;
+  resp::RequestArgv argv;
+  std::string input = "SET  key value\r\n";
+  auto result = resp::parse_request(input, argv);
+  assert(result.has_value() && *result == input.size());
+  assert(argv.size() == 3 && argv[0] == "SET" && argv[2] == "value");
+
+  result = resp::parse_request("*0\r\n", argv);
+  assert(result.has_value() && *result == 4 && argv.empty());
+  result = resp::parse_request("\r\n", argv);
+  assert(result.has_value() && *result == 2 && argv.empty());
+
+  std::cout << "  [PASS]" << std::endl;
+}
+
+void test_parse_errors() {
+  std::cout << "Test: Parse Protocol Errors..." << std::endl;
+  resp::RequestArgv argv;
+  assert(resp::parse_request("*1\r\n:1\r\n", argv).error() == resp::ParseError::InvalidType);
+  assert(resp::parse_request("*x\r\n", argv).error() == resp::ParseError::InvalidLength);
+  assert(resp::parse_request("*1\r\n$-1\r\n", argv).error() == resp::ParseError::InvalidLength);
+  assert(resp::parse_request("*1\r\n$3\r\nabcXY", argv).error() == resp::ParseError::InvalidLength);
+
+  std::cout << "  [PASS]" << std::endl;
+}
+
+void test_argv_overflow() {
+  std::cout << "Test: Argv Beyond Inline Capacity..." << std::endl;
+  const size_t count = resp::RequestArgv::INLINE_CAPACITY * 2 + 1;
+  std::string input = "*" + std::to_string(count) + "\r\n";
+  for (size_t i = 0; i < count; ++i) {
+    std::string arg = "arg" + std::to_string(i);
+    input += "$" + std::to_string(arg.size()) + "\r\n" + arg + "\r\n";
+  }
+  resp::RequestArgv argv;
+  auto result = resp::parse_request(input, argv);
+  assert(result.has_value() && *result == input.size());
+  assert(argv.size() == count);
+  for (size_t i = 0; i < count; ++i) {
+    assert(argv[i] == "arg" + std::to_string(i));
+  }
+  assert(resp::serialize_command(argv.view()) == input);
+
+  std::cout << "  [PASS]" << std::endl;
+}
+
+int main() {
+  std::cout << "--- Starting Request Parser Unit Tests ---" << std::endl;
+  test_parse_multibulk();
+  test_parse_incomplete();
+  test_resumable_parse();
+  test_parse_pipeline();
+  test_parse_inline_and_empty();
+  test_parse_errors();
+  test_argv_overflow();
+  std::cout << "\n✅ All Request Parser tests passed!" << std::endl;
+  return 0;
+}
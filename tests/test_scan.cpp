@@ -0,0 +1,310 @@
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <set>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <variant>
+#include <vector>
+
+import resp;
+import kv_server;
+import logger;
+
+// 测试辅助宏
+#define TEST_ASSERT(condition, message)                                        \
+  do {                                                                         \
+    if (!(condition)) {                                                        \
+      std::cerr << "断言失败: " << message << " 在 " << __FILE__ << " 行 "    \
+                << __LINE__ << std::endl;                                      \
+      return false;                                                            \
+    }                                                                          \
+  } while (0)
+
+// 创建命令辅助函数
+resp::RespValue create_command(const std::vector<std::string> &parts) {
+  auto arr = std::make_unique<resp::RespArray>();
+
+  for (const auto &part : parts) {
+    resp::RespBulkString item;
+    item.value = part;
+    arr->values.push_back(item);
+  }
+
+  return resp::RespValue(std::move(arr));
+}
+
+std::string run(KVServer &server, const std::vector<std::string> &parts) {
+  return server.execute_command(create_command(parts));
+}
+
+// 执行一次 SCAN，解析出下一个游标和键
+struct ScanReply {
+  std::string cursor;
+  std::vector<std::string> keys;
+};
+
+bool scan_once(KVServer &server, std::vector<std::string> command, ScanReply &reply) {
+  std::string response = run(server, command);
+  std::string_view input = response;
+  auto value = resp::parse(input);
+  if (!value) {
+    return false;
+  }
+  auto *outer = std::get_if<std::unique_ptr<resp::RespArray>>(&*value);
+  if (!outer || (*outer)->values.size() != 2) {
+    return false;
+  }
+  reply.cursor = *std::get<resp::RespBulkString>((*outer)->values[0]).value;
+  reply.keys.clear();
+  auto &inner = std::get<std::unique_ptr<resp::RespArray>>((*outer)->values[1]);
+  for (const auto &key : inner->values) {
+    reply.keys.push_back(*std::get<resp::RespBulkString>(key).value);
+  }
+  return true;
+}
+
+// 从游标 0 开始遍历到结束，extra 为附加的选项，after_call 在每次调用后执行
+bool scan_all(KVServer &server, const std::vector<std::string> &extra, std::multiset<std::string> &keys,
+              size_t &calls, const std::function<void()> &after_call = {}) {
+  std::string cursor = "0";
+  calls = 0;
+  do {
+    std::vector<std::string> command = {"SCAN", cursor};
+    command.insert(command.end(), extra.begin(), extra.end());
+    ScanReply reply;
+    if (!scan_once(server, command, reply)) {
+      return false;
+    }
+    keys.insert(reply.keys.begin(), reply.keys.end());
+    cursor = reply.cursor;
+    ++calls;
+    if (after_call) {
+      after_call();
+    }
+  } while (cursor != "0" && calls < 1000000);
+  return cursor == "0";
+}
+
+// 测试完整遍历与 COUNT：每个键都返回，COUNT 越大调用次数越少
+bool test_scan_full_iteration() {
+  std::cout << "测试 SCAN 完整遍历..." << std::endl;
+
+  KVServer server;
+  std::multiset<std::string> keys;
+  size_t calls = 0;
+  TEST_ASSERT(scan_all(server, {}, keys, calls) && keys.empty() && calls == 1, "空键空间一次返回游标 0");
+
+  const int count = 5000;
+  for (int i = 0; i < count; ++i) {
+    run(server, {"SET", "key:" + std::to_string(i), "v"});
+  }
+  TEST_ASSERT(scan_all(server, {}, keys, calls), "SCAN 应能遍历结束");
+  std::set<std::string> unique(keys.begin(), keys.end());
+  TEST_ASSERT(unique.size() == count, "每个键都应被返回");
+  TEST_ASSERT(calls > count / 50, "默认 COUNT 为 10，每次调用只做有限的工作");
+
+  keys.clear();
+  size_t large_calls = 0;
+  TEST_ASSERT(scan_all(server, {"COUNT", "1000"}, keys, large_calls), "带 COUNT 的 SCAN 应能遍历结束");
+  TEST_ASSERT(std::set<std::string>(keys.begin(), keys.end()).size() == count, "COUNT 不影响覆盖");
+  TEST_ASSERT(large_calls * 10 < calls, "COUNT 越大调用次数越少");
+
+  std::cout << "SCAN 完整遍历测试通过！" << std::endl;
+  return true;
+}
+
+// 测试遍历期间表扩容：遍历开始前就存在且未被删除的键都要返回
+bool test_scan_during_rehash() {
+  std::cout << "测试 SCAN 期间扩容..." << std::endl;
+
+  KVServer server;
+  const int initial = 2000;
+  for (int i = 0; i < initial; ++i) {
+    run(server, {"SET", "old:" + std::to_string(i), "v"});
+  }
+  int added = 0;
+  std::multiset<std::string> keys;
+  size_t calls = 0;
+  // 每次调用之间插入大量新键，表在遍历期间多次翻倍
+  bool finished = scan_all(server, {}, keys, calls, [&]() {
+    for (int j = 0; j < 50; ++j) {
+      run(server, {"SET", "new:" + std::to_string(added++), "v"});
+    }
+  });
+  TEST_ASSERT(finished, "扩容期间 SCAN 应能遍历结束");
+  for (int i = 0; i < initial; ++i) {
+    TEST_ASSERT(keys.count("old:" + std::to_string(i)) > 0, "遍历前存在的键都应被返回");
+  }
+  std::cout << "遍历期间新增 " << added << " 个键，调用 " << calls << " 次" << std::endl;
+
+  std::cout << "SCAN 期间扩容测试通过！" << std::endl;
+  return true;
+}
+
+// 从 INFO 中取出键空间哈希表占用的字节数
+size_t table_bytes(KVServer &server) {
+  std::string info = run(server, {"INFO"});
+  size_t pos = info.find("keyspace_table_bytes:") + std::string("keyspace_table_bytes:").size();
+  return std::stoull(info.substr(pos, info.find("\r\n", pos) - pos));
+}
+
+// 测试遍历期间表缩容：大量删除使表缩小，一直存在的键仍然都要返回
+bool test_scan_during_shrink() {
+  std::cout << "测试 SCAN 期间缩容..." << std::endl;
+
+  KVServer server;
+  const int kept = 500;
+  const int doomed = 20000;
+  for (int i = 0; i < kept; ++i) {
+    run(server, {"SET", "keep:" + std::to_string(i), "v"});
+  }
+  for (int i = 0; i < doomed; ++i) {
+    run(server, {"SET", "gone:" + std::to_string(i), "v"});
+  }
+  size_t bytes_before = table_bytes(server);
+  int deleted = 0;
+  std::multiset<std::string> keys;
+  size_t calls = 0;
+  // 每次调用之间删除一批键，表在遍历期间多次缩小
+  bool finished = scan_all(server, {}, keys, calls, [&]() {
+    for (int j = 0; j < 400 && deleted < doomed; ++j) {
+      run(server, {"DEL", "gone:" + std::to_string(deleted++)});
+    }
+  });
+  TEST_ASSERT(finished, "缩容期间 SCAN 应能遍历结束");
+  for (int i = 0; i < kept; ++i) {
+    TEST_ASSERT(keys.count("keep:" + std::to_string(i)) > 0, "一直存在的键都应被返回");
+  }
+  TEST_ASSERT(table_bytes(server) < bytes_before / 4, "删除大部分键后哈希表应缩小");
+  std::cout << "遍历期间删除 " << deleted << " 个键，调用 " << calls << " 次" << std::endl;
+
+  std::cout << "SCAN 期间缩容测试通过！" << std::endl;
+  return true;
+}
+
+// 测试 MATCH、TYPE 过滤与过期键
+bool test_scan_filters() {
+  std::cout << "测试 SCAN 过滤..." << std::endl;
+
+  KVServer server;
+  for (int i = 0; i < 300; ++i) {
+    run(server, {"SET", "user:" + std::to_string(i), "v"});
+    run(server, {"SET", "order:" + std::to_string(i), "v"});
+  }
+  std::multiset<std::string> keys;
+  size_t calls = 0;
+  TEST_ASSERT(scan_all(server, {"MATCH", "user:1?"}, keys, calls), "MATCH 遍历应结束");
+  TEST_ASSERT(keys.size() == 10 && keys.count("user:15") == 1, "MATCH 应只返回匹配的键");
+
+  keys.clear();
+  TEST_ASSERT(scan_all(server, {"MATCH", "order:*", "COUNT", "100"}, keys, calls), "MATCH 与 COUNT 组合");
+  TEST_ASSERT(keys.size() == 300, "order:* 应匹配 300 个键");
+
+  keys.clear();
+  TEST_ASSERT(scan_all(server, {"TYPE", "STRING", "COUNT", "1000"}, keys, calls), "TYPE 遍历应结束");
+  TEST_ASSERT(keys.size() == 600, "TYPE 不区分大小写，字符串键都应返回");
+  keys.clear();
+  TEST_ASSERT(scan_all(server, {"TYPE", "hash"}, keys, calls) && keys.empty(), "没有其他类型的键");
+
+  // 已过期的键不返回，并在遍历时删除
+  run(server, {"PEXPIRE", "user:0", "1"});
+  std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  keys.clear();
+  TEST_ASSERT(scan_all(server, {"MATCH", "user:0"}, keys, calls) && keys.empty(), "已过期的键不应返回");
+  TEST_ASSERT(run(server, {"EXISTS", "user:0"}) == resp::serialize_integer(0), "过期键应已删除");
+
+  std::string syntax = resp::serialize_error("ERR syntax error");
+  TEST_ASSERT(run(server, {"SCAN", "abc"}) == resp::serialize_error("ERR invalid cursor"), "无效游标应报错");
+  TEST_ASSERT(run(server, {"SCAN", "-1"}) == resp::serialize_error("ERR invalid cursor"), "负数游标应报错");
+  TEST_ASSERT(run(server, {"SCAN", "0", "COUNT", "0"}) == syntax, "COUNT 为 0 应报错");
+  TEST_ASSERT(run(server, {"SCAN", "0", "COUNT", "x"}) ==
+                  resp::serialize_error("ERR value is not an integer or out of range"),
+              "COUNT 不是整数应报错");
+  TEST_ASSERT(run(server, {"SCAN", "0", "MATCH"}) == syntax, "缺少选项值应报错");
+  TEST_ASSERT(run(server, {"SCAN", "0", "LIMIT", "1"}) == syntax, "未知选项应报错");
+
+  std::cout << "SCAN 过滤测试通过！" << std::endl;
+  return true;
+}
+
+// 测试多分片的游标编码：游标对分片数取模得到分片号，一个分片遍历完后转到下一个分片
+bool test_scan_shard_cursor() {
+  std::cout << "测试 SCAN 分片游标..." << std::endl;
+
+  const size_t shards = 3;
+  std::vector<std::unique_ptr<KVServer>> servers;
+  for (size_t i = 0; i < shards; ++i) {
+    servers.push_back(std::make_unique<KVServer>());
+    servers.back()->set_shard(i, shards);
+    for (int k = 0; k < 100; ++k) {
+      run(*servers.back(), {"SET", "s" + std::to_string(i) + ":" + std::to_string(k), "v"});
+    }
+  }
+  std::set<std::string> keys;
+  std::string cursor = "0";
+  size_t calls = 0;
+  do {
+    auto shard = KVServer::cursor_shard(cursor, shards);
+    TEST_ASSERT(shard.has_value(), "游标应能解析出分片号");
+    ScanReply reply;
+    TEST_ASSERT(scan_once(*servers[*shard], {"SCAN", cursor}, reply), "SCAN 回复格式应正确");
+    for (const auto &key : reply.keys) {
+      TEST_ASSERT(key.starts_with("s" + std::to_string(*shard) + ":"), "键应来自游标指向的分片");
+      keys.insert(key);
+    }
+    cursor = reply.cursor;
+  } while (cursor != "0" && ++calls < 10000);
+  TEST_ASSERT(keys.size() == shards * 100, "应遍历所有分片的全部键");
+
+  std::cout << "SCAN 分片游标测试通过！" << std::endl;
+  return true;
+}
+
+int main() {
+  Logger::instance().set_level(LogLevel::ERROR);
+  std::cout << "开始 SCAN 测试..." << std::endl;
+
+  bool all_passed = true;
+  std::vector<std::pair<std::string, std::function<bool()>>> tests = {
+      {"SCAN 完整遍历测试", test_scan_full_iteration},
+      {"SCAN 期间扩容测试", test_scan_during_rehash},
+      {"SCAN 期间缩容测试", test_scan_during_shrink},
+      {"SCAN 过滤测试", test_scan_filters},
+      {"SCAN 分片游标测试", test_scan_shard_cursor}};
+
+  int passed = 0;
+  int failed = 0;
+
+  for (const auto &[name, test_func] : tests) {
+    std::cout << "\n===================================" << std::endl;
+    std::cout << "执行测试: " << name << std::endl;
+    std::cout << "===================================" << std::endl;
+
+    try {
+      if (test_func()) {
+        std::cout << "√ 测试通过: " << name << std::endl;
+        passed++;
+      } else {
+        std::cerr << "× 测试失败: " << name << std::endl;
+        all_passed = false;
+        failed++;
+      }
+    } catch (const std::exception &e) {
+      std::cerr << "× 测试出现异常: " << name << " - " << e.what() << std::endl;
+      all_passed = false;
+      failed++;
+    }
+  }
+
+  std::cout << "\n===================================" << std::endl;
+  std::cout << "测试结果摘要:" << std::endl;
+  std::cout << "总计: " << tests.size() << " 个测试" << std::endl;
+  std::cout << "通过: " << passed << " 个测试" << std::endl;
+  std::cout << "失败: " << failed << " 个测试" << std::endl;
+  std::cout << "===================================" << std::endl;
+
+  return all_passed ? 0 : 1;
+}
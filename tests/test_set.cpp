@@ -0,0 +1,357 @@
+#include <functional>
+#include <iostream>
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <set>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+import resp;
+import kv_server;
+import command;
+import intset;
+import logger;
+
+// 测试辅助宏
+#define TEST_ASSERT(condition, message)                                        \
+  do {                                                                         \
+    if (!(condition)) {                                                        \
+      std::cerr << "断言失败: " << message << " 在 " << __FILE__ << " 行 "    \
+                << __LINE__ << std::endl;                                      \
+      return false;                                                            \
+    }                                                                          \
+  } while (0)
+
+// 创建命令辅助函数
+resp::RespValue create_command(const std::vector<std::string> &parts) {
+  auto arr = std::make_unique<resp::RespArray>();
+
+  for (const auto &part : parts) {
+    resp::RespBulkString item;
+    item.value = part;
+    arr->values.push_back(item);
+  }
+
+  return resp::RespValue(std::move(arr));
+}
+
+std::string run(KVServer &server, const std::vector<std::string> &parts) {
+  return server.execute_command(create_command(parts));
+}
+
+// 把数组回复解析为字符串列表，nil 记为 "(nil)"
+bool parse_array(const std::string &response, std::vector<std::string> &items) {
+  std::string_view input = response;
+  auto value = resp::parse(input);
+  if (!value) {
+    return false;
+  }
+  auto *arr = std::get_if<std::unique_ptr<resp::RespArray>>(&*value);
+  if (!arr) {
+    return false;
+  }
+  items.clear();
+  std::function<void(const resp::RespArray &)> flatten = [&](const resp::RespArray &a) {
+    for (const auto &item : a.values) {
+      if (auto *nested = std::get_if<std::unique_ptr<resp::RespArray>>(&item)) {
+        flatten(**nested);
+      } else {
+        const auto &bulk = std::get<resp::RespBulkString>(item);
+        items.push_back(bulk.value ? *bulk.value : "(nil)");
+      }
+    }
+  };
+  flatten(**arr);
+  return true;
+}
+
+std::string encoding(KVServer &server, const std::string &key) {
+  return run(server, {"OBJECT", "ENCODING", key});
+}
+
+// 排序后的数组回复，哈希表编码的成员顺序不确定
+std::vector<std::string> sorted_members(KVServer &server, const std::vector<std::string> &command) {
+  std::vector<std::string> items;
+  parse_array(run(server, command), items);
+  std::sort(items.begin(), items.end());
+  return items;
+}
+
+// 测试基本命令：SADD/SREM/SISMEMBER/SMEMBERS/SCARD
+bool test_set_basic() {
+  std::cout << "测试集合基本命令..." << std::endl;
+
+  KVServer server;
+  TEST_ASSERT(run(server, {"SADD", "tags", "a", "b", "c", "a"}) == resp::serialize_integer(3), "SADD 返回新增的成员数");
+  TEST_ASSERT(run(server, {"SADD", "tags", "c", "d"}) == resp::serialize_integer(1), "已有成员不计入");
+  TEST_ASSERT(run(server, {"SCARD", "tags"}) == resp::serialize_integer(4), "SCARD 返回成员数");
+  TEST_ASSERT(run(server, {"SISMEMBER", "tags", "b"}) == resp::serialize_integer(1), "成员存在返回 1");
+  TEST_ASSERT(run(server, {"SISMEMBER", "tags", "z"}) == resp::serialize_integer(0), "成员不存在返回 0");
+  TEST_ASSERT((sorted_members(server, {"SMEMBERS", "tags"}) == std::vector<std::string>{"a", "b", "c", "d"}),
+              "SMEMBERS 返回全部成员");
+  TEST_ASSERT(run(server, {"SREM", "tags", "a", "z"}) == resp::serialize_integer(1), "SREM 返回删除的成员数");
+  TEST_ASSERT(run(server, {"SREM", "tags", "b", "c", "d"}) == resp::serialize_integer(3), "删除剩余成员");
+  TEST_ASSERT(run(server, {"EXISTS", "tags"}) == resp::serialize_integer(0), "集合变空后删除键");
+
+  TEST_ASSERT(run(server, {"SCARD", "nokey"}) == resp::serialize_integer(0), "不存在的键 SCARD 为 0");
+  TEST_ASSERT(run(server, {"SISMEMBER", "nokey", "a"}) == resp::serialize_integer(0), "不存在的键不包含任何成员");
+  TEST_ASSERT(run(server, {"SMEMBERS", "nokey"}) == resp::serialize_array({}), "不存在的键返回空数组");
+  TEST_ASSERT(run(server, {"SREM", "nokey", "a"}) == resp::serialize_integer(0), "不存在的键 SREM 返回 0");
+
+  run(server, {"SET", "str", "v"});
+  run(server, {"HSET", "hash", "f", "v"});
+  const std::string wrongtype = resp::serialize_error("WRONGTYPE Operation against a key holding the wrong kind of value");
+  TEST_ASSERT(run(server, {"SADD", "str", "a"}) == wrongtype, "SADD 字符串键应报类型错误");
+  TEST_ASSERT(run(server, {"SMEMBERS", "hash"}) == wrongtype, "SMEMBERS 哈希键应报类型错误");
+  TEST_ASSERT(run(server, {"SINTER", "nokey", "str"}) == wrongtype, "集合运算中任一键类型不符应报错");
+  run(server, {"SADD", "set", "a"});
+  TEST_ASSERT(run(server, {"GET", "set"}) == wrongtype, "GET 集合键应报类型错误");
+  TEST_ASSERT(run(server, {"TYPE", "set"}) == resp::serialize_simple_string("set"), "TYPE 返回 set");
+
+  std::cout << "集合基本命令测试通过！" << std::endl;
+  return true;
+}
+
+// 测试编码：整数成员使用 intset 并按宽度升级，非整数成员或超过阈值后转换为哈希表
+bool test_set_encoding() {
+  std::cout << "测试集合编码转换..." << std::endl;
+
+  KVServer server;
+  run(server, {"SADD", "ints", "5", "-3", "100", "7"});
+  TEST_ASSERT(encoding(server, "ints") == resp::serialize_bulk_string("intset"), "整数成员使用 intset");
+  std::vector<std::string> items;
+  TEST_ASSERT(parse_array(run(server, {"SMEMBERS", "ints"}), items), "SMEMBERS 返回数组");
+  TEST_ASSERT((items == std::vector<std::string>{"-3", "5", "7", "100"}), "intset 按从小到大的顺序返回");
+
+  // 超出 16 位、32 位的整数触发宽度升级，原有成员不变
+  run(server, {"SADD", "ints", "70000", "-5000000000"});
+  TEST_ASSERT(encoding(server, "ints") == resp::serialize_bulk_string("intset"), "升级宽度后仍是 intset");
+  TEST_ASSERT(parse_array(run(server, {"SMEMBERS", "ints"}), items), "SMEMBERS 返回数组");
+  TEST_ASSERT((items == std::vector<std::string>{"-5000000000", "-3", "5", "7", "100", "70000"}), "升级后顺序不变");
+  TEST_ASSERT(run(server, {"SISMEMBER", "ints", "70000"}) == resp::serialize_integer(1), "升级后能查到新成员");
+  TEST_ASSERT(run(server, {"SISMEMBER", "ints", "007"}) == resp::serialize_integer(0), "非规范整数不是成员");
+
+  run(server, {"SADD", "ints", "x"});
+  TEST_ASSERT(encoding(server, "ints") == resp::serialize_bulk_string("hashtable"), "非整数成员转换为哈希表");
+  TEST_ASSERT((sorted_members(server, {"SMEMBERS", "ints"}) ==
+               std::vector<std::string>{"-3", "-5000000000", "100", "5", "7", "70000", "x"}),
+              "转换后成员不变");
+
+  EncodingConfig config;
+  config.set_max_intset_entries = 8;
+  server.set_encoding_config(config);
+  for (int i = 0; i < 8; ++i) {
+    run(server, {"SADD", "small", std::to_string(i)});
+  }
+  TEST_ASSERT(encoding(server, "small") == resp::serialize_bulk_string("intset"), "不超过配置的阈值时使用 intset");
+  run(server, {"SADD", "small", "8"});
+  TEST_ASSERT(encoding(server, "small") == resp::serialize_bulk_string("hashtable"), "超过配置的阈值后转换");
+  TEST_ASSERT(run(server, {"SCARD", "small"}) == resp::serialize_integer(9), "转换后成员数不变");
+
+  std::cout << "集合编码转换测试通过！" << std::endl;
+  return true;
+}
+
+// 测试整数集合交集：各种宽度组合和大小差异下与逐个查找的结果一致
+bool test_intset_intersect() {
+  std::cout << "测试整数集合交集（" << Intset::simd_kernel() << "）..." << std::endl;
+
+  std::mt19937_64 rng(42);
+  const int64_t ranges[] = {30000, 100000, 10000000000LL}; // 分别使用 2、4、8 字节宽度
+  const size_t sizes[] = {0, 1, 7, 33, 500, 5000};
+  for (int64_t range_a : ranges) {
+    for (int64_t range_b : ranges) {
+      for (size_t size_a : sizes) {
+        for (size_t size_b : sizes) {
+          Intset a;
+          Intset b;
+          std::uniform_int_distribution<int64_t> dist_a(-range_a, range_a);
+          std::uniform_int_distribution<int64_t> dist_b(-range_b, range_b);
+          while (a.size() < size_a) {
+            a.insert(dist_a(rng));
+          }
+          while (b.size() < size_b) {
+            // 一半的成员取自 a，保证有交集
+            if (size_a > 0 && rng() % 2 == 0) {
+              b.insert(a.at(rng() % a.size()));
+            } else {
+              b.insert(dist_b(rng));
+            }
+          }
+          std::vector<int64_t> expected;
+          a.for_each([&](int64_t v) {
+            if (b.contains(v)) {
+              expected.push_back(v);
+            }
+          });
+          const Intset *sets[] = {&a, &b};
+          TEST_ASSERT(Intset::intersect(sets) == expected, "交集与逐个查找的结果一致");
+        }
+      }
+    }
+  }
+
+  // 三个集合相交，中间结果变空时提前结束
+  Intset a = Intset::from_sorted(std::vector<int64_t>{1, 2, 3, 4, 5, 6, 7, 8, 9, 10});
+  Intset b = Intset::from_sorted(std::vector<int64_t>{2, 4, 6, 8, 10, 12});
+  Intset c = Intset::from_sorted(std::vector<int64_t>{-40000, 4, 8, 70000});
+  const Intset *three[] = {&a, &b, &c};
+  TEST_ASSERT((Intset::intersect(three) == std::vector<int64_t>{4, 8}), "三个集合的交集");
+  Intset empty;
+  const Intset *with_empty[] = {&a, &empty, &b};
+  TEST_ASSERT(Intset::intersect(with_empty).empty(), "与空集合的交集为空");
+
+  std::cout << "整数集合交集测试通过！" << std::endl;
+  return true;
+}
+
+// 测试 SINTER/SUNION/SDIFF 及 *STORE 变体
+bool test_set_algebra() {
+  std::cout << "测试集合运算..." << std::endl;
+
+  KVServer server;
+  run(server, {"SADD", "a", "1", "2", "3", "4"});
+  run(server, {"SADD", "b", "3", "4", "5"});
+  run(server, {"SADD", "c", "4", "x"});
+
+  TEST_ASSERT((sorted_members(server, {"SINTER", "a", "b"}) == std::vector<std::string>{"3", "4"}), "intset 的交集");
+  TEST_ASSERT((sorted_members(server, {"SINTER", "a", "b", "c"}) == std::vector<std::string>{"4"}),
+              "与哈希表编码集合的交集");
+  TEST_ASSERT(run(server, {"SINTER", "a", "nokey"}) == resp::serialize_array({}), "与不存在的键的交集为空");
+  TEST_ASSERT((sorted_members(server, {"SUNION", "a", "c", "nokey"}) ==
+               std::vector<std::string>{"1", "2", "3", "4", "x"}),
+              "并集，不存在的键视为空集合");
+  TEST_ASSERT((sorted_members(server, {"SDIFF", "a", "b", "nokey"}) == std::vector<std::string>{"1", "2"}), "差集");
+  TEST_ASSERT(run(server, {"SDIFF", "nokey", "a"}) == resp::serialize_array({}), "第一个键不存在时差集为空");
+
+  TEST_ASSERT(run(server, {"SINTERSTORE", "dst", "a", "b"}) == resp::serialize_integer(2), "SINTERSTORE 返回成员数");
+  TEST_ASSERT(encoding(server, "dst") == resp::serialize_bulk_string("intset"), "整数结果使用 intset");
+  TEST_ASSERT((sorted_members(server, {"SMEMBERS", "dst"}) == std::vector<std::string>{"3", "4"}), "结果写入目标键");
+  TEST_ASSERT(run(server, {"SUNIONSTORE", "dst", "dst", "c"}) == resp::serialize_integer(3), "目标键可以是源键");
+  TEST_ASSERT((sorted_members(server, {"SMEMBERS", "dst"}) == std::vector<std::string>{"3", "4", "x"}), "覆盖目标键");
+  TEST_ASSERT(run(server, {"SDIFFSTORE", "dst", "a", "b"}) == resp::serialize_integer(2), "SDIFFSTORE 返回成员数");
+
+  run(server, {"SET", "str", "v", "EX", "100"});
+  TEST_ASSERT(run(server, {"SUNIONSTORE", "str", "a"}) == resp::serialize_integer(4), "覆盖其他类型的目标键");
+  TEST_ASSERT(run(server, {"TYPE", "str"}) == resp::serialize_simple_string("set"), "目标键变为集合");
+  TEST_ASSERT(run(server, {"TTL", "str"}) == resp::serialize_integer(-1), "不保留原来的过期时间");
+  TEST_ASSERT(run(server, {"SINTERSTORE", "str", "a", "nokey"}) == resp::serialize_integer(0), "结果为空");
+  TEST_ASSERT(run(server, {"EXISTS", "str"}) == resp::serialize_integer(0), "结果为空时删除目标键");
+
+  // 大集合：intset 交集与哈希表编码的交集结果一致
+  std::vector<std::string> evens = {"SADD", "evens"};
+  std::vector<std::string> threes = {"SADD", "threes"};
+  for (int i = 0; i < 500; ++i) {
+    evens.push_back(std::to_string(i * 2));
+    threes.push_back(std::to_string(i * 3));
+  }
+  run(server, evens);
+  run(server, threes);
+  TEST_ASSERT(run(server, {"SINTERSTORE", "sixes", "evens", "threes"}) == resp::serialize_integer(167),
+              "大 intset 的交集");
+  run(server, {"SADD", "threes", "x"});
+  TEST_ASSERT(run(server, {"SINTERSTORE", "sixes2", "evens", "threes"}) == resp::serialize_integer(167),
+              "哈希表编码的交集结果一致");
+  TEST_ASSERT(sorted_members(server, {"SMEMBERS", "sixes"}) == sorted_members(server, {"SMEMBERS", "sixes2"}),
+              "两种路径的交集成员一致");
+
+  std::cout << "集合运算测试通过！" << std::endl;
+  return true;
+}
+
+// 同一个键在一条命令中重复出现，且键恰好在命令执行期间过期：过期按命令开始时的时间判断，
+// 一条命令看到的要么都是整个集合，要么都不存在，不会读到前面查找取得、后面查找时已删除的集合
+bool test_set_repeated_expiring_key() {
+  std::cout << "测试重复出现的过期键..." << std::endl;
+
+  KVServer server;
+  std::vector<std::string> members = {"SADD", "k"};
+  for (int i = 0; i < 10; ++i) {
+    members.push_back("m" + std::to_string(i));
+  }
+  // 键重复多次，让一条命令的执行时间足够长，过期时刻大概率落在某条命令执行期间
+  std::vector<std::string> sunion = {"SUNION"};
+  std::vector<std::string> sinter = {"SINTER"};
+  std::vector<std::string> sinterstore = {"SINTERSTORE", "dst"};
+  for (int i = 0; i < 500; ++i) {
+    sunion.push_back("k");
+    sinter.push_back("k");
+    sinterstore.push_back("k");
+  }
+  const std::vector<std::string> full(members.begin() + 2, members.end());
+
+  // SUNION 读取前面取得的集合，最常执行；SINTER/SINTERSTORE 检查结果
+  const std::vector<const std::vector<std::string> *> commands = {&sunion, &sinter, &sunion, &sinterstore};
+  for (int round = 0; round < 30; ++round) {
+    run(server, members);
+    run(server, {"PEXPIRE", "k", "20"});
+    for (size_t i = 0;; ++i) {
+      const auto &command = *commands[i % commands.size()];
+      if (&command == &sinterstore) {
+        std::string reply = run(server, command);
+        TEST_ASSERT(reply == resp::serialize_integer(10) || reply == resp::serialize_integer(0),
+                    "SINTERSTORE 看到的应是整个集合或不存在的键");
+        if (reply == resp::serialize_integer(0)) {
+          break;
+        }
+        continue;
+      }
+      std::vector<std::string> items = sorted_members(server, command);
+      TEST_ASSERT(items == full || items.empty(), "SUNION/SINTER 看到的应是整个集合或不存在的键");
+      if (items.empty()) {
+        break;
+      }
+    }
+    TEST_ASSERT(run(server, {"EXISTS", "k"}) == resp::serialize_integer(0), "过期的键应已删除");
+  }
+
+  std::cout << "重复出现的过期键测试通过！" << std::endl;
+  return true;
+}
+
+int main() {
+  Logger::instance().set_level(LogLevel::ERROR);
+  std::cout << "开始集合类型测试..." << std::endl;
+
+  bool all_passed = true;
+  std::vector<std::pair<std::string, std::function<bool()>>> tests = {
+      {"集合基本命令测试", test_set_basic},
+      {"集合编码转换测试", test_set_encoding},
+      {"整数集合交集测试", test_intset_intersect},
+      {"集合运算测试", test_set_algebra},
+      {"重复出现的过期键测试", test_set_repeated_expiring_key}};
+
+  int passed = 0;
+  int failed = 0;
+
+  for (const auto &[name, test_func] : tests) {
+    std::cout << "\n===================================" << std::endl;
+    std::cout << "执行测试: " << name << std::endl;
+    std::cout << "===================================" << std::endl;
+
+    try {
+      if (test_func()) {
+        std::cout << "√ 测试通过: " << name << std::endl;
+        passed++;
+      } else {
+        std::cerr << "× 测试失败: " << name << std::endl;
+        all_passed = false;
+        failed++;
+      }
+    } catch (const std::exception &e) {
+      std::cerr << "× 测试出现异常: " << name << " - " << e.what() << std::endl;
+      all_passed = false;
+      failed++;
+    }
+  }
+
+  std::cout << "\n===================================" << std::endl;
+  std::cout << "测试结果: " << passed << " 通过, " << failed << " 失败" << std::endl;
+  std::cout << "===================================" << std::endl;
+
+  return all_passed ? 0 : 1;
+}
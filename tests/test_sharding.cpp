@@ -0,0 +1,532 @@
+#include <arpa/inet.h>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <netinet/in.h>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+import application;
+
+// 多个事件循环时的端到端测试：一个连接以流水线发送键分布在各个分片上的命令，
+// 转发到其他分片的命令不阻塞后续命令的解析，回复仍须与请求顺序一致
+
+// 测试辅助宏
+#define TEST_ASSERT(condition, message)                                        \
+  do {                                                                         \
+    if (!(condition)) {                                                        \
+      std::cerr << "断言失败: " << message << " 在 " << __FILE__ << " 行 "    \
+                << __LINE__ << std::endl;                                      \
+      return false;                                                            \
+    }                                                                          \
+  } while (0)
+
+constexpr int kPort = 16400;
+constexpr int kIoThreads = 4;
+constexpr long long kMaxmemory = 64 * 1024 * 1024;
+
+// 服务器使用的事件后端，由第一个命令行参数指定（默认 epoll）
+std::string event_backend = "epoll";
+
+// 在子进程中以给定的事件循环数启动服务器，extra 为追加的配置行
+pid_t spawn_server(int port, int io_threads, const std::string &config_file, const std::string &extra = "") {
+  {
+    std::ofstream config(config_file);
+    config << "port " << port << "\n";
+    config << "loglevel error\n";
+    config << "io-threads " << io_threads << "\n";
+    config << "maxmemory " << kMaxmemory << "\n";
+    config << "event-backend " << event_backend << "\n";
+    config << extra;
+  }
+
+  pid_t pid = fork();
+  if (pid == 0) {
+    Application app;
+    if (!app.init(config_file)) {
+      _exit(1);
+    }
+    app.run();
+    _exit(0);
+  }
+  return pid;
+}
+
+// 结束服务器进程，并等待它的监听 socket 全部关闭。io_uring 后端的进程被杀死后，内核异步回收 ring，
+// 在此之前监听 socket 仍会完成握手，立即重启的话新连接可能落到旧进程上
+void stop_server(pid_t pid, int port) {
+  kill(pid, SIGKILL);
+  waitpid(pid, nullptr, 0);
+  for (int attempt = 0; attempt < 100; ++attempt) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+    bool listening = connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) == 0;
+    ::close(fd);
+    if (!listening) {
+      return;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  }
+}
+
+// 完整的一条回复在 data 开头时返回它的长度，不完整时返回 0
+size_t reply_length(std::string_view data) {
+  size_t line_end = data.find("\r\n");
+  if (line_end == std::string_view::npos) {
+    return 0;
+  }
+  size_t length = line_end + 2;
+  if (data[0] == '$') {
+    long long n = std::stoll(std::string(data.substr(1, line_end - 1)));
+    if (n < 0) {
+      return length;
+    }
+    return data.size() >= length + n + 2 ? length + n + 2 : 0;
+  }
+  if (data[0] == '*') {
+    long long n = std::stoll(std::string(data.substr(1, line_end - 1)));
+    for (long long i = 0; i < n; ++i) {
+      size_t element = reply_length(data.substr(length));
+      if (element == 0) {
+        return 0;
+      }
+      length += element;
+    }
+  }
+  return length;
+}
+
+// 同步客户端：发送一条命令，读取一条完整的回复，读取超时或连接关闭时返回 nullopt
+class Client {
+public:
+  explicit Client(int port) {
+    // 服务器刚启动时可能还未开始监听，重试几次
+    for (int attempt = 0; attempt < 50 && fd_ == -1; ++attempt) {
+      fd_ = socket(AF_INET, SOCK_STREAM, 0);
+      sockaddr_in addr{};
+      addr.sin_family = AF_INET;
+      addr.sin_port = htons(port);
+      inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+      if (connect(fd_, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0) {
+        ::close(fd_);
+        fd_ = -1;
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+      }
+    }
+    if (fd_ != -1) {
+      timeval timeout{3, 0};
+      setsockopt(fd_, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    }
+  }
+  ~Client() { close(); }
+  Client(const Client &) = delete;
+  Client &operator=(const Client &) = delete;
+
+  bool connected() const { return fd_ != -1; }
+
+  void close() {
+    if (fd_ != -1) {
+      ::close(fd_);
+      fd_ = -1;
+    }
+  }
+
+  bool send(const std::vector<std::string> &argv) { return send_raw(encode(argv)); }
+
+  static std::string encode(const std::vector<std::string> &argv) {
+    std::string request = "*" + std::to_string(argv.size()) + "\r\n";
+    for (const auto &arg : argv) {
+      request += "$" + std::to_string(arg.size()) + "\r\n" + arg + "\r\n";
+    }
+    return request;
+  }
+
+  bool send_raw(const std::string &request) {
+    size_t sent = 0;
+    while (sent < request.size()) {
+      ssize_t n = ::send(fd_, request.data() + sent, request.size() - sent, MSG_NOSIGNAL);
+      if (n <= 0) {
+        return false;
+      }
+      sent += static_cast<size_t>(n);
+    }
+    return true;
+  }
+
+  std::optional<std::string> read_reply() {
+    while (true) {
+      if (size_t length = reply_length(buffer_); length > 0) {
+        std::string reply = buffer_.substr(0, length);
+        buffer_.erase(0, length);
+        return reply;
+      }
+      char chunk[4096];
+      ssize_t n = ::read(fd_, chunk, sizeof(chunk));
+      if (n <= 0) {
+        return std::nullopt;
+      }
+      buffer_.append(chunk, static_cast<size_t>(n));
+    }
+  }
+
+  std::optional<std::string> call(const std::vector<std::string> &argv) {
+    if (!send(argv)) {
+      return std::nullopt;
+    }
+    return read_reply();
+  }
+
+private:
+  int fd_ = -1;
+  std::string buffer_;
+};
+
+std::string bulk(std::string_view s) { return "$" + std::to_string(s.size()) + "\r\n" + std::string(s) + "\r\n"; }
+
+std::string integer(long long n) { return ":" + std::to_string(n) + "\r\n"; }
+
+// 一次发送整个流水线，再按顺序读取并比较每条回复
+bool run_pipeline(Client &client, const std::vector<std::vector<std::string>> &commands,
+                  const std::vector<std::string> &expected) {
+  std::string batch;
+  for (const auto &command : commands) {
+    batch += Client::encode(command);
+  }
+  TEST_ASSERT(client.send_raw(batch), "发送流水线失败");
+  for (size_t i = 0; i < expected.size(); ++i) {
+    auto reply = client.read_reply();
+    TEST_ASSERT(reply.has_value(), "读取回复超时，第 " + std::to_string(i) + " 条");
+    TEST_ASSERT(*reply == expected[i], "第 " + std::to_string(i) + " 条回复顺序或内容错误: " + *reply);
+  }
+  return true;
+}
+
+// 一次发送整个流水线，按顺序读取全部回复；读取超时时返回的回复少于命令数
+std::vector<std::string> call_pipeline(Client &client, const std::vector<std::vector<std::string>> &commands) {
+  std::string batch;
+  for (const auto &command : commands) {
+    batch += Client::encode(command);
+  }
+  std::vector<std::string> replies;
+  if (!client.send_raw(batch)) {
+    return replies;
+  }
+  for (size_t i = 0; i < commands.size(); ++i) {
+    auto reply = client.read_reply();
+    if (!reply) {
+      break;
+    }
+    replies.push_back(std::move(*reply));
+  }
+  return replies;
+}
+
+// 测试流水线中的跨分片命令：键均匀分布在各个分片上，本分片与其他分片的命令交错，回复按请求顺序返回
+bool test_pipeline_order() {
+  std::cout << "测试跨分片流水线的回复顺序..." << std::endl;
+
+  Client client(kPort);
+  TEST_ASSERT(client.connected(), "无法连接服务器");
+  std::vector<std::vector<std::string>> commands;
+  std::vector<std::string> expected;
+  for (int i = 0; i < 3000; ++i) {
+    std::string key = "key:" + std::to_string(i);
+    commands.push_back({"SET", key, std::to_string(i)});
+    expected.push_back("+OK\r\n");
+    commands.push_back({"INCR", key});
+    expected.push_back(integer(i + 1));
+    if (i > 0) {
+      // 读取前一个键：与上一条 INCR 可能在不同分片上
+      commands.push_back({"GET", "key:" + std::to_string(i - 1)});
+      expected.push_back(bulk(std::to_string(i)));
+    }
+    if (i % 100 == 0) {
+      // 本分片直接回复的错误同样排在之前转发的命令之后
+      commands.push_back({"NOSUCHCOMMAND"});
+      expected.push_back("-ERR unknown command 'NOSUCHCOMMAND'\r\n");
+    }
+  }
+  TEST_ASSERT(run_pipeline(client, commands, expected), "流水线回复不符");
+
+  std::cout << "跨分片流水线的回复顺序测试通过！" << std::endl;
+  return true;
+}
+
+// 测试需要等待之前转发的命令都返回的命令：事务、阻塞命令和全分片命令夹在跨分片流水线中
+bool test_pipeline_barriers() {
+  std::cout << "测试流水线中的事务和阻塞命令..." << std::endl;
+
+  Client client(kPort);
+  TEST_ASSERT(client.connected(), "无法连接服务器");
+  std::vector<std::vector<std::string>> commands;
+  std::vector<std::string> expected;
+  for (int i = 0; i < 200; ++i) {
+    std::string key = "barrier:" + std::to_string(i);
+    std::string list = "list:" + std::to_string(i);
+    commands.push_back({"SET", key, "v"});
+    expected.push_back("+OK\r\n");
+    commands.push_back({"MULTI"});
+    expected.push_back("+OK\r\n");
+    commands.push_back({"INCR", key + ":n"});
+    expected.push_back("+QUEUED\r\n");
+    commands.push_back({"EXEC"});
+    expected.push_back("*1\r\n" + integer(1));
+    commands.push_back({"RPUSH", list, "a"});
+    expected.push_back(integer(1));
+    commands.push_back({"BLPOP", list, "0"});
+    expected.push_back("*2\r\n" + bulk(list) + bulk("a"));
+    commands.push_back({"EXISTS", key});
+    expected.push_back(integer(1));
+  }
+  commands.push_back({"FLUSHALL"});
+  expected.push_back("+OK\r\n");
+  commands.push_back({"EXISTS", "barrier:0"});
+  expected.push_back(integer(0));
+  TEST_ASSERT(run_pipeline(client, commands, expected), "流水线回复不符");
+
+  std::cout << "流水线中的事务和阻塞命令测试通过！" << std::endl;
+  return true;
+}
+
+// 测试断开连接：转发的命令尚未返回时关闭连接，迟到的回复被丢弃，服务器继续正常工作
+bool test_disconnect_with_pending_replies() {
+  std::cout << "测试等待跨分片回复时断开连接..." << std::endl;
+
+  for (int round = 0; round < 20; ++round) {
+    Client client(kPort);
+    TEST_ASSERT(client.connected(), "无法连接服务器");
+    std::string batch;
+    for (int i = 0; i < 500; ++i) {
+      batch += Client::encode({"SET", "gone:" + std::to_string(i), "v"});
+    }
+    TEST_ASSERT(client.send_raw(batch), "发送流水线失败");
+  }
+  Client client(kPort);
+  TEST_ASSERT(client.connected(), "无法连接服务器");
+  TEST_ASSERT(client.call({"SET", "after", "v"}) == "+OK\r\n", "断开的连接不应影响其他连接");
+
+  std::cout << "等待跨分片回复时断开连接测试通过！" << std::endl;
+  return true;
+}
+
+// 测试 INFO：键空间和内存信息汇总所有分片，maxmemory 报告配置值而不是每个分片的份额
+bool test_info_aggregates_shards() {
+  std::cout << "测试多分片 INFO 汇总..." << std::endl;
+
+  Client client(kPort);
+  TEST_ASSERT(client.connected(), "无法连接服务器");
+  TEST_ASSERT(client.call({"FLUSHALL"}) == "+OK\r\n", "FLUSHALL 失败");
+  std::vector<std::vector<std::string>> commands;
+  std::vector<std::string> expected;
+  for (int i = 0; i < 200; ++i) {
+    std::string key = "info:" + std::to_string(i);
+    if (i % 4 == 0) {
+      commands.push_back({"SET", key, "v", "EX", "1000"});
+    } else {
+      commands.push_back({"SET", key, "v"});
+    }
+    expected.push_back("+OK\r\n");
+  }
+  TEST_ASSERT(run_pipeline(client, commands, expected), "写入键失败");
+
+  auto info = client.call({"INFO"});
+  TEST_ASSERT(info.has_value(), "INFO 没有回复");
+  TEST_ASSERT(info->find("db0:keys=200,expires=50,") != std::string::npos, "键空间应汇总所有分片: " << *info);
+  TEST_ASSERT(info->find("maxmemory:" + std::to_string(kMaxmemory) + "\r\n") != std::string::npos,
+              "maxmemory 应报告配置值: " << *info);
+  TEST_ASSERT(client.call({"EXISTS", "info:0"}) == integer(1), "INFO 之后应继续处理命令");
+
+  std::cout << "多分片 INFO 汇总测试通过！" << std::endl;
+  return true;
+}
+
+// 测试启动失败：端口已被占用时任何一个事件循环初始化失败，init 都应返回 false，而不是留下没有线程处理的分片
+bool test_startup_fails_when_a_loop_cannot_bind() {
+  std::cout << "测试事件循环初始化失败时终止启动..." << std::endl;
+
+  const int port = kPort + 1;
+  int blocker = socket(AF_INET, SOCK_STREAM, 0);
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  addr.sin_addr.s_addr = INADDR_ANY;
+  TEST_ASSERT(bind(blocker, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) == 0, "占用端口失败");
+
+  std::string config_file = "test_sharding_bind.conf";
+  {
+    std::ofstream config(config_file);
+    config << "port " << port << "\n";
+    config << "loglevel fatal\n";
+    config << "io-threads " << kIoThreads << "\n";
+    config << "event-backend " << event_backend << "\n";
+  }
+  pid_t pid = fork();
+  if (pid == 0) {
+    Application app;
+    _exit(app.init(config_file) ? 0 : 1);
+  }
+  int status = 0;
+  bool exited = false;
+  for (int i = 0; i < 100 && !exited; ++i) {
+    exited = waitpid(pid, &status, WNOHANG) == pid;
+    if (!exited) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+  }
+  if (!exited) {
+    kill(pid, SIGKILL);
+    waitpid(pid, nullptr, 0);
+  }
+  ::close(blocker);
+  std::remove(config_file.c_str());
+  TEST_ASSERT(exited, "初始化不应挂起");
+  TEST_ASSERT(WIFEXITED(status) && WEXITSTATUS(status) == 1, "端口被占用时 init 应返回 false");
+
+  std::cout << "事件循环初始化失败时终止启动测试通过！" << std::endl;
+  return true;
+}
+
+// 测试 FLUSHALL 与其他分片上的写入并发时 AOF 的顺序：一个连接持续向各个分片写入，
+// 另一个连接同时执行 FLUSHALL。重放 AOF 得到的键空间必须与重启前一致，
+// 即每个分片上写入与 FLUSHALL 在 AOF 中的先后和它们实际执行的先后相同
+bool test_flushall_aof_matches_execution_order() {
+  std::cout << "测试 FLUSHALL 与并发写入的 AOF 重放..." << std::endl;
+
+  const int port = kPort + 2;
+  std::string config_file = "test_sharding_aof.conf";
+  std::string aof_file = "test_sharding_flush.aof";
+  std::string extra = "aof-enabled yes\naof-file " + aof_file + "\nappendfsync always\n";
+  std::remove(aof_file.c_str());
+  pid_t pid = spawn_server(port, kIoThreads, config_file, extra);
+  TEST_ASSERT(pid > 0, "启动服务器失败");
+
+  std::vector<std::vector<std::string>> exists_commands;
+  bool ok = true;
+  {
+    Client writer(port);
+    Client flusher(port);
+    ok = writer.connected() && flusher.connected();
+    for (int round = 0; ok && round < 20; ++round) {
+      std::vector<std::vector<std::string>> commands;
+      for (int i = 0; i < 2000; ++i) {
+        std::string key = "r" + std::to_string(round) + ":" + std::to_string(i);
+        commands.push_back({"SET", key, "v"});
+        exists_commands.push_back({"EXISTS", key});
+      }
+      std::string batch;
+      for (const auto &command : commands) {
+        batch += Client::encode(command);
+      }
+      // 写入还在各分片上执行时发出 FLUSHALL
+      ok = writer.send_raw(batch) && flusher.call({"FLUSHALL"}) == "+OK\r\n";
+      for (size_t i = 0; ok && i < commands.size(); ++i) {
+        ok = writer.read_reply() == "+OK\r\n";
+      }
+    }
+  }
+  std::vector<std::string> live;
+  if (ok) {
+    Client client(port);
+    live = call_pipeline(client, exists_commands);
+  }
+  stop_server(pid, port);
+  TEST_ASSERT(ok, "并发写入和 FLUSHALL 应成功");
+  TEST_ASSERT(live.size() == exists_commands.size(), "读取键状态失败");
+
+  // 从 AOF 重放后逐个比较键是否存在
+  pid = spawn_server(port, kIoThreads, config_file, extra);
+  TEST_ASSERT(pid > 0, "重启服务器失败");
+  std::vector<std::string> replayed;
+  {
+    Client client(port);
+    if (client.connected()) {
+      replayed = call_pipeline(client, exists_commands);
+    }
+  }
+  kill(pid, SIGKILL);
+  waitpid(pid, nullptr, 0);
+  std::remove(config_file.c_str());
+  std::remove(aof_file.c_str());
+  TEST_ASSERT(replayed.size() == exists_commands.size(), "重放后读取键状态失败");
+  size_t surviving = 0;
+  for (size_t i = 0; i < live.size(); ++i) {
+    TEST_ASSERT(live[i] == replayed[i], "重放后键 " << exists_commands[i][1] << " 的状态与重启前不同: 重启前 "
+                                                   << live[i] << " 重放后 " << replayed[i]);
+    surviving += live[i] == integer(1);
+  }
+  std::cout << "FLUSHALL 之后保留的键: " << surviving << std::endl;
+
+  std::cout << "FLUSHALL 与并发写入的 AOF 重放测试通过！" << std::endl;
+  return true;
+}
+
+int main(int argc, char *argv[]) {
+  if (argc > 1) {
+    event_backend = argv[1];
+  }
+  std::cout << "开始多事件循环端到端测试（" << event_backend << "）..." << std::endl;
+
+  std::string config_file = "test_sharding.conf";
+  pid_t pid = spawn_server(kPort, kIoThreads, config_file);
+  if (pid <= 0) {
+    std::cerr << "启动服务器失败" << std::endl;
+    return 1;
+  }
+
+  bool all_passed = true;
+  std::vector<std::pair<std::string, std::function<bool()>>> tests = {
+      {"多分片 INFO 汇总测试", test_info_aggregates_shards},
+      {"跨分片流水线的回复顺序测试", test_pipeline_order},
+      {"流水线中的事务和阻塞命令测试", test_pipeline_barriers},
+      {"等待跨分片回复时断开连接测试", test_disconnect_with_pending_replies},
+      {"事件循环初始化失败时终止启动测试", test_startup_fails_when_a_loop_cannot_bind},
+      {"FLUSHALL 与并发写入的 AOF 重放测试", test_flushall_aof_matches_execution_order}};
+
+  int passed = 0;
+  int failed = 0;
+
+  for (const auto &[name, test_func] : tests) {
+    std::cout << "\n===================================" << std::endl;
+    std::cout << "执行测试: " << name << std::endl;
+    std::cout << "===================================" << std::endl;
+
+    try {
+      if (test_func()) {
+        std::cout << "√ 测试通过: " << name << std::endl;
+        passed++;
+      } else {
+        std::cerr << "× 测试失败: " << name << std::endl;
+        all_passed = false;
+        failed++;
+      }
+    } catch (const std::exception &e) {
+      std::cerr << "× 测试出现异常: " << name << " - " << e.what() << std::endl;
+      all_passed = false;
+      failed++;
+    }
+  }
+
+  kill(pid, SIGKILL);
+  waitpid(pid, nullptr, 0);
+  std::remove(config_file.c_str());
+
+  std::cout << "\n===================================" << std::endl;
+  std::cout << "测试结果: " << (all_passed ? "全部通过" : "有测试失败") << std::endl;
+  std::cout << "通过: " << passed << " 个测试" << std::endl;
+  std::cout << "失败: " << failed << " 个测试" << std::endl;
+  std::cout << "===================================" << std::endl;
+
+  return all_passed ? 0 : 1;
+}
@@ -0,0 +1,224 @@
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+import resp;
+import kv_server;
+import command;
+import logger;
+
+// 测试辅助宏
+#define TEST_ASSERT(condition, message)                                        \
+  do {                                                                         \
+    if (!(condition)) {                                                        \
+      std::cerr << "断言失败: " << message << " 在 " << __FILE__ << " 行 "    \
+                << __LINE__ << std::endl;                                      \
+      return false;                                                            \
+    }                                                                          \
+  } while (0)
+
+// 创建命令辅助函数
+resp::RespValue create_command(const std::vector<std::string> &parts) {
+  auto arr = std::make_unique<resp::RespArray>();
+
+  for (const auto &part : parts) {
+    resp::RespBulkString item;
+    item.value = part;
+    arr->values.push_back(item);
+  }
+
+  return resp::RespValue(std::move(arr));
+}
+
+std::string run(KVServer &server, const std::vector<std::string> &parts) {
+  return server.execute_command(create_command(parts));
+}
+
+// 从 INFO 中读取一个数值字段
+double info_field(KVServer &server, const std::string &name) {
+  std::string info = run(server, {"INFO"});
+  auto pos = info.find(name + ":");
+  return pos == std::string::npos ? -1 : std::stod(info.substr(pos + name.size() + 1));
+}
+
+// 测试分配器本身：按尺寸分类、复用空位、归还空 slab、超过最大类别时拒绝
+bool test_allocator() {
+  std::cout << "测试 slab 分配器..." << std::endl;
+
+  SlabAllocator slabs;
+  TEST_ASSERT(slabs.allocate(SlabAllocator::MAX_SIZE + 1) == nullptr, "超过最大类别时应返回空指针");
+  TEST_ASSERT(SlabAllocator::usable_size(33) == 48, "33 字节应归入 48 字节类别");
+
+  std::vector<void *> blocks;
+  for (int i = 0; i < 5000; ++i) {
+    void *p = slabs.allocate(40);
+    TEST_ASSERT(p != nullptr, "分配不应失败");
+    std::memset(p, i & 0xFF, 40);
+    blocks.push_back(p);
+  }
+  size_t full_bytes = slabs.slab_bytes();
+  TEST_ASSERT(slabs.requested_bytes() == 5000 * 40, "申请字节数统计应准确");
+  TEST_ASSERT(slabs.used_bytes() == 5000 * 48, "按类别大小统计的字节数应准确");
+  TEST_ASSERT(full_bytes < 5000 * 48 * 11 / 10, "写满的 slab 不应有明显浪费");
+
+  // 释放后再分配应复用空位，不申请新的 slab
+  SlabAllocator::deallocate(blocks[10], 40);
+  void *reused = slabs.allocate(40);
+  TEST_ASSERT(reused == blocks[10], "应复用刚释放的空位");
+
+  for (void *p : blocks) {
+    SlabAllocator::deallocate(p, 40);
+  }
+  TEST_ASSERT(slabs.requested_bytes() == 0, "全部释放后申请字节数应归零");
+  TEST_ASSERT(slabs.slab_bytes() == SlabAllocator::SLAB_SIZE, "全部释放后每个类别只保留一个 slab");
+
+  std::cout << "slab 分配器测试通过！" << std::endl;
+  return true;
+}
+
+// 测试稀疏 slab 的标记：只有对象能放进其他 slab 空位时才标记
+bool test_mark_sparse_slabs() {
+  std::cout << "测试稀疏 slab 标记..." << std::endl;
+
+  SlabAllocator slabs;
+  std::vector<void *> blocks;
+  for (int i = 0; i < 4000; ++i) {
+    blocks.push_back(slabs.allocate(64));
+  }
+  size_t before = slabs.slab_bytes();
+  // 每 4 个释放 3 个，所有 slab 的占用率降到约 25%
+  std::vector<void *> live;
+  for (size_t i = 0; i < blocks.size(); ++i) {
+    if (i % 4 == 0) {
+      live.push_back(blocks[i]);
+    } else {
+      SlabAllocator::deallocate(blocks[i], 64);
+    }
+  }
+  TEST_ASSERT(slabs.slab_bytes() == before, "稀疏的 slab 不会自动归还");
+
+  TEST_ASSERT(slabs.mark_sparse_slabs(0.5) > 0, "应有稀疏的 slab 被标记");
+  size_t evacuating = slabs.evacuating_slabs();
+  TEST_ASSERT(evacuating > 0 && evacuating * SlabAllocator::SLAB_SIZE < before, "不应标记全部 slab");
+
+  // 模拟搬迁：正在清空的 slab 中的对象换到新分配的块
+  size_t moved = 0;
+  for (void *&p : live) {
+    if (SlabAllocator::should_relocate(p)) {
+      void *target = slabs.allocate(64);
+      TEST_ASSERT(!SlabAllocator::should_relocate(target), "不应分配到正在清空的 slab");
+      SlabAllocator::deallocate(p, 64);
+      p = target;
+      ++moved;
+    }
+  }
+  TEST_ASSERT(moved > 0, "应有对象需要搬迁");
+  TEST_ASSERT(slabs.evacuating_slabs() == 0, "搬迁后被标记的 slab 应全部归还");
+  TEST_ASSERT(slabs.slab_bytes() < before / 2, "搬迁后 slab 总大小应明显减少");
+
+  for (void *p : live) {
+    SlabAllocator::deallocate(p, 64);
+  }
+  std::cout << "稀疏 slab 标记测试通过！" << std::endl;
+  return true;
+}
+
+// 测试碎片整理：大量删除后碎片率升高，整理后下降，剩余的键不受影响
+bool test_active_defrag() {
+  std::cout << "测试碎片整理..." << std::endl;
+
+  KVServer server;
+  const int count = 20000;
+  for (int i = 0; i < count; ++i) {
+    run(server, {"SET", "key:" + std::to_string(i), "value-" + std::to_string(i) + std::string(40, 'x')});
+  }
+  for (int i = 0; i < count; i += 10) {
+    run(server, {"EXPIRE", "key:" + std::to_string(i), "1000"});
+  }
+  TEST_ASSERT(info_field(server, "mem_fragmentation_ratio") < 1.5, "连续写入后碎片率应较低");
+
+  for (int i = 0; i < count; ++i) {
+    if (i % 4 != 0) {
+      run(server, {"DEL", "key:" + std::to_string(i)});
+    }
+  }
+  double ratio_before = info_field(server, "mem_fragmentation_ratio");
+  double slab_bytes_before = info_field(server, "slab_bytes");
+  TEST_ASSERT(ratio_before > 2.0, "删除 3/4 的键后碎片率应明显升高");
+  TEST_ASSERT(run(server, {"INFO"}).find("# Slabs\r\nclass_") != std::string::npos, "INFO 应列出各尺寸类别");
+
+  // 未开启时不整理
+  server.active_defrag_cycle();
+  TEST_ASSERT(!server.active_defrag_running(), "未开启时不应整理");
+
+  server.set_active_defrag_config({true, 10, 0, 25});
+  server.active_defrag_cycle();
+  for (int i = 0; i < 1000 && server.active_defrag_running(); ++i) {
+    // 整理期间命令照常执行
+    run(server, {"SET", "during:" + std::to_string(i), "v"});
+    server.active_defrag_cycle();
+  }
+  TEST_ASSERT(!server.active_defrag_running(), "整理应在有限的周期内完成");
+  TEST_ASSERT(info_field(server, "active_defrag_hits") > 0, "应有条目被搬迁");
+
+  double ratio_after = info_field(server, "mem_fragmentation_ratio");
+  TEST_ASSERT(ratio_after < ratio_before * 0.75, "整理后碎片率应下降");
+  TEST_ASSERT(info_field(server, "slab_bytes") < slab_bytes_before * 0.75, "整理后 slab 总大小应减少");
+
+  // 搬迁后的条目内容、过期时间不变
+  for (int i = 0; i < count; i += 4) {
+    std::string key = "key:" + std::to_string(i);
+    std::string value = "value-" + std::to_string(i) + std::string(40, 'x');
+    TEST_ASSERT(run(server, {"GET", key}) == resp::serialize_bulk_string(value), "整理后应能读到原值");
+    bool volatile_key = i % 10 == 0;
+    TEST_ASSERT((run(server, {"TTL", key}) == resp::serialize_integer(-1)) != volatile_key,
+                "整理后过期时间应保持不变");
+  }
+
+  std::cout << "碎片整理测试通过！" << std::endl;
+  return true;
+}
+
+int main() {
+  Logger::instance().set_level(LogLevel::ERROR);
+  std::cout << "开始 slab 分配器与碎片整理测试..." << std::endl;
+
+  bool all_passed = true;
+  std::vector<std::pair<std::string, std::function<bool()>>> tests = {
+      {"slab 分配器测试", test_allocator},
+      {"稀疏 slab 标记测试", test_mark_sparse_slabs},
+      {"碎片整理测试", test_active_defrag}};
+
+  int passed = 0;
+  int failed = 0;
+
+  for (const auto &[name, test_func] : tests) {
+    std::cout << "\n===================================" << std::endl;
+    std::cout << "执行测试: " << name << std::endl;
+    std::cout << "===================================" << std::endl;
+
+    try {
+      if (test_func()) {
+        std::cout << "√ 测试通过: " << name << std::endl;
+        passed++;
+      } else {
+        std::cerr << "× 测试失败: " << name << std::endl;
+        all_passed = false;
+        failed++;
+      }
+    } catch (const std::exception &e) {
+      std::cerr << "× 测试出现异常: " << name << " - " << e.what() << std::endl;
+      all_passed = false;
+      failed++;
+    }
+  }
+
+  std::cout << "\n===================================" << std::endl;
+  std::cout << "测试结果: " << passed << " 通过, " << failed << " 失败" << std::endl;
+  std::cout << "===================================" << std::endl;
+
+  return all_passed ? 0 : 1;
+}
@@ -0,0 +1,457 @@
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+import resp;
+import kv_server;
+import logger;
+
+// 测试辅助宏
+#define TEST_ASSERT(condition, message)                                        \
+  do {                                                                         \
+    if (!(condition)) {                                                        \
+      std::cerr << "断言失败: " << message << " 在 " << __FILE__ << " 行 "    \
+                << __LINE__ << std::endl;                                      \
+      return false;                                                            \
+    }                                                                          \
+  } while (0)
+
+// 创建命令辅助函数
+resp::RespValue create_command(const std::vector<std::string> &parts) {
+  auto arr = std::make_unique<resp::RespArray>();
+
+  for (const auto &part : parts) {
+    resp::RespBulkString item;
+    item.value = part;
+    arr->values.push_back(item);
+  }
+
+  return resp::RespValue(std::move(arr));
+}
+
+std::string run(KVServer &server, const std::vector<std::string> &parts) {
+  return server.execute_command(create_command(parts));
+}
+
+// 从 INFO 中读取一个数值字段
+long long info_field(KVServer &server, const std::string &name) {
+  std::string info = run(server, {"INFO"});
+  auto pos = info.find(name + ":");
+  return pos == std::string::npos ? -1 : std::stoll(info.substr(pos + name.size() + 1));
+}
+
+// 测试 INCR/DECR/INCRBY/DECRBY
+bool test_incr_family() {
+  std::cout << "测试 INCR 系列命令..." << std::endl;
+
+  KVServer server;
+
+  TEST_ASSERT(run(server, {"INCR", "counter"}) == resp::serialize_integer(1),
+              "不存在的键应从 0 开始递增");
+  TEST_ASSERT(run(server, {"INCRBY", "counter", "41"}) == resp::serialize_integer(42),
+              "INCRBY 应返回新值");
+  TEST_ASSERT(run(server, {"DECR", "counter"}) == resp::serialize_integer(41),
+              "DECR 应减 1");
+  TEST_ASSERT(run(server, {"DECRBY", "counter", "50"}) == resp::serialize_integer(-9),
+              "DECRBY 可以得到负数");
+  TEST_ASSERT(run(server, {"GET", "counter"}) == resp::serialize_bulk_string("-9"),
+              "GET 应返回格式化后的整数");
+
+  // SET 写入的整数字符串同样可以递增
+  run(server, {"SET", "n", "100"});
+  TEST_ASSERT(run(server, {"INCR", "n"}) == resp::serialize_integer(101),
+              "SET 写入的整数应能递增");
+  TEST_ASSERT(run(server, {"GET", "n"}) == resp::serialize_bulk_string("101"),
+              "GET 应返回递增后的值");
+
+  std::cout << "INCR 系列命令测试通过！" << std::endl;
+  return true;
+}
+
+// 测试错误处理：非整数值、非法增量和溢出
+bool test_incr_errors() {
+  std::cout << "测试 INCR 错误处理..." << std::endl;
+
+  KVServer server;
+  const std::string not_integer =
+      resp::serialize_error("ERR value is not an integer or out of range");
+
+  run(server, {"SET", "text", "hello"});
+  TEST_ASSERT(run(server, {"INCR", "text"}) == not_integer, "非整数值不能递增");
+  TEST_ASSERT(run(server, {"GET", "text"}) == resp::serialize_bulk_string("hello"),
+              "失败的 INCR 不应修改值");
+
+  // 不规范的整数写法按字符串保存，原样返回，也不能递增
+  for (const std::string value : {"007", "+5", " 5", "-0"}) {
+    run(server, {"SET", "odd", value});
+    TEST_ASSERT(run(server, {"GET", "odd"}) == resp::serialize_bulk_string(value),
+                "不规范的整数应原样保存: " + value);
+    TEST_ASSERT(run(server, {"INCR", "odd"}) == not_integer,
+                "不规范的整数不能递增: " + value);
+  }
+
+  TEST_ASSERT(run(server, {"INCRBY", "counter", "abc"}) == not_integer,
+              "非法增量应报错");
+  TEST_ASSERT(run(server, {"GET", "counter"}) == resp::serialize_null_bulk_string(),
+              "非法增量不应创建键");
+
+  std::string max = std::to_string(std::numeric_limits<int64_t>::max());
+  std::string min = std::to_string(std::numeric_limits<int64_t>::min());
+  run(server, {"SET", "big", max});
+  TEST_ASSERT(run(server, {"INCR", "big"}) ==
+                  resp::serialize_error("ERR increment or decrement would overflow"),
+              "最大值递增应报溢出");
+  TEST_ASSERT(run(server, {"GET", "big"}) == resp::serialize_bulk_string(max),
+              "溢出时不应修改值");
+  run(server, {"SET", "small", min});
+  TEST_ASSERT(run(server, {"DECR", "small"}) ==
+                  resp::serialize_error("ERR increment or decrement would overflow"),
+              "最小值递减应报溢出");
+  TEST_ASSERT(run(server, {"DECRBY", "zero", min}) ==
+                  resp::serialize_error("ERR decrement would overflow"),
+              "DECRBY 最小值应报溢出");
+
+  std::cout << "INCR 错误处理测试通过！" << std::endl;
+  return true;
+}
+
+// 测试 INCRBYFLOAT
+bool test_incrbyfloat() {
+  std::cout << "测试 INCRBYFLOAT 命令..." << std::endl;
+
+  KVServer server;
+
+  TEST_ASSERT(run(server, {"INCRBYFLOAT", "f", "10.5"}) == resp::serialize_bulk_string("10.5"),
+              "不存在的键应从 0 开始");
+  TEST_ASSERT(run(server, {"INCRBYFLOAT", "f", "0.1"}) == resp::serialize_bulk_string("10.6"),
+              "结果应去掉末尾的零");
+  TEST_ASSERT(run(server, {"INCRBYFLOAT", "f", "-5.6"}) == resp::serialize_bulk_string("5"),
+              "整数结果不带小数点");
+  TEST_ASSERT(run(server, {"INCR", "f"}) == resp::serialize_integer(6),
+              "整数结果应能继续用 INCR 递增");
+
+  run(server, {"SET", "i", "3"});
+  TEST_ASSERT(run(server, {"INCRBYFLOAT", "i", "1.5e1"}) == resp::serialize_bulk_string("18"),
+              "整数值应能按浮点递增");
+
+  TEST_ASSERT(run(server, {"INCRBYFLOAT", "f", "abc"}) ==
+                  resp::serialize_error("ERR value is not a valid float"),
+              "非法增量应报错");
+  run(server, {"SET", "text", "hello"});
+  TEST_ASSERT(run(server, {"INCRBYFLOAT", "text", "1"}) ==
+                  resp::serialize_error("ERR value is not a valid float"),
+              "非数值不能递增");
+  TEST_ASSERT(run(server, {"INCRBYFLOAT", "f", "inf"}) ==
+                  resp::serialize_error("ERR increment would produce NaN or Infinity"),
+              "结果为无穷时应报错");
+
+  std::cout << "INCRBYFLOAT 命令测试通过！" << std::endl;
+  return true;
+}
+
+// 测试整数编码：过期时间保持不变、条目不含值字节
+bool test_integer_encoding() {
+  std::cout << "测试整数编码..." << std::endl;
+
+  KVServer server;
+
+  run(server, {"SET", "counter", "1"});
+  run(server, {"EXPIRE", "counter", "100"});
+  run(server, {"INCRBY", "counter", "9999"});
+  TEST_ASSERT(run(server, {"TTL", "counter"}) != resp::serialize_integer(-1),
+              "INCR 应保留过期时间");
+  TEST_ASSERT(run(server, {"GET", "counter"}) == resp::serialize_bulk_string("10000"),
+              "GET 应返回 10000");
+
+  // 整数编码的条目不存放值字节，数值再大也只占头部、过期时间和键
+  KVServer fresh;
+  run(fresh, {"SET", "k", "1234567890123"});
+  long long int_bytes = info_field(fresh, "keyspace_entry_bytes");
+  run(fresh, {"SET", "k", "x1234567890123"});
+  long long raw_bytes = info_field(fresh, "keyspace_entry_bytes");
+  TEST_ASSERT(int_bytes > 0 && raw_bytes - int_bytes == 14,
+              "整数编码的条目应比同长度字符串少全部值字节");
+
+  std::cout << "整数编码测试通过！" << std::endl;
+  return true;
+}
+
+// 从 PTTL 回复中取出毫秒数
+long long pttl_of(KVServer &server, const std::string &key) {
+  return std::stoll(run(server, {"PTTL", key}).substr(1));
+}
+
+// 测试 SET 的条件、过期和 GET 选项
+bool test_set_options() {
+  std::cout << "测试 SET 选项..." << std::endl;
+
+  KVServer server;
+  const std::string nil = resp::serialize_null_bulk_string();
+
+  TEST_ASSERT(run(server, {"SET", "k", "v1", "XX"}) == nil, "XX 在键不存在时不写入");
+  TEST_ASSERT(run(server, {"SET", "k", "v1", "NX"}) == resp::serialize_ok(), "NX 在键不存在时写入");
+  TEST_ASSERT(run(server, {"SET", "k", "v2", "nx"}) == nil, "NX 在键存在时不写入，选项不区分大小写");
+  TEST_ASSERT(run(server, {"SET", "k", "v2", "XX", "GET"}) == resp::serialize_bulk_string("v1"),
+              "GET 应返回旧值");
+  TEST_ASSERT(run(server, {"SET", "new", "v", "GET"}) == nil, "GET 在键不存在时返回 nil");
+
+  TEST_ASSERT(run(server, {"SET", "k", "v3", "EX", "100"}) == resp::serialize_ok(), "EX 应成功");
+  long long ms = pttl_of(server, "k");
+  TEST_ASSERT(ms > 99000 && ms <= 100000, "EX 应设置秒级过期时间");
+  run(server, {"SET", "k", "v4", "KEEPTTL"});
+  TEST_ASSERT(pttl_of(server, "k") > 99000, "KEEPTTL 应保留过期时间");
+  run(server, {"SET", "k", "v5"});
+  TEST_ASSERT(pttl_of(server, "k") == -1, "不带选项的 SET 应清除过期时间");
+
+  run(server, {"SET", "k", "v6", "PX", "5000"});
+  ms = pttl_of(server, "k");
+  TEST_ASSERT(ms > 4000 && ms <= 5000, "PX 应设置毫秒级过期时间");
+
+  auto now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    std::chrono::system_clock::now().time_since_epoch())
+                    .count();
+  run(server, {"SET", "k", "v7", "PXAT", std::to_string(now_ms + 60000)});
+  ms = pttl_of(server, "k");
+  TEST_ASSERT(ms > 59000 && ms <= 60000, "PXAT 应按绝对时间设置过期");
+  run(server, {"SET", "k", "v8", "EXAT", std::to_string(now_ms / 1000 - 10)});
+  TEST_ASSERT(run(server, {"GET", "k"}) == nil, "过去的 EXAT 时间应使键立即过期");
+
+  const std::string syntax_error = resp::serialize_error("ERR syntax error");
+  TEST_ASSERT(run(server, {"SET", "k", "v", "NX", "XX"}) == syntax_error, "NX 与 XX 不能同时使用");
+  TEST_ASSERT(run(server, {"SET", "k", "v", "EX", "10", "PX", "10"}) == syntax_error,
+              "多个过期选项应报错");
+  TEST_ASSERT(run(server, {"SET", "k", "v", "KEEPTTL", "EX", "10"}) == syntax_error,
+              "KEEPTTL 与过期选项不能同时使用");
+  TEST_ASSERT(run(server, {"SET", "k", "v", "EX"}) == syntax_error, "EX 缺少参数应报错");
+  TEST_ASSERT(run(server, {"SET", "k", "v", "EX", "0"}) ==
+                  resp::serialize_error("ERR invalid expire time in 'set' command"),
+              "非正数过期时间应报错");
+  TEST_ASSERT(run(server, {"SET", "k", "v", "EX", "abc"}) ==
+                  resp::serialize_error("ERR value is not an integer or out of range"),
+              "非整数过期时间应报错");
+
+  std::cout << "SET 选项测试通过！" << std::endl;
+  return true;
+}
+
+// 测试 SETNX/SETEX/PSETEX/GETEX/GETDEL
+bool test_set_get_variants() {
+  std::cout << "测试 SET/GET 变体命令..." << std::endl;
+
+  KVServer server;
+  const std::string nil = resp::serialize_null_bulk_string();
+
+  TEST_ASSERT(run(server, {"SETNX", "a", "1"}) == resp::serialize_integer(1), "SETNX 写入新键返回 1");
+  TEST_ASSERT(run(server, {"SETNX", "a", "2"}) == resp::serialize_integer(0), "SETNX 不覆盖已有键");
+  TEST_ASSERT(run(server, {"GET", "a"}) == resp::serialize_bulk_string("1"), "SETNX 不应修改已有值");
+
+  TEST_ASSERT(run(server, {"SETEX", "b", "100", "v"}) == resp::serialize_ok(), "SETEX 应成功");
+  TEST_ASSERT(pttl_of(server, "b") > 99000, "SETEX 应设置过期时间");
+  TEST_ASSERT(run(server, {"PSETEX", "c", "5000", "v"}) == resp::serialize_ok(), "PSETEX 应成功");
+  long long ms = pttl_of(server, "c");
+  TEST_ASSERT(ms > 4000 && ms <= 5000, "PSETEX 应设置毫秒级过期时间");
+  TEST_ASSERT(run(server, {"SETEX", "d", "-1", "v"}) ==
+                  resp::serialize_error("ERR invalid expire time in 'setex' command"),
+              "SETEX 非正数过期时间应报错");
+
+  TEST_ASSERT(run(server, {"GETEX", "a"}) == resp::serialize_bulk_string("1"), "GETEX 不带选项等同 GET");
+  TEST_ASSERT(run(server, {"GETEX", "a", "EX", "50"}) == resp::serialize_bulk_string("1"),
+              "GETEX EX 应返回值");
+  TEST_ASSERT(pttl_of(server, "a") > 49000, "GETEX EX 应设置过期时间");
+  run(server, {"GETEX", "a", "PERSIST"});
+  TEST_ASSERT(pttl_of(server, "a") == -1, "GETEX PERSIST 应移除过期时间");
+  TEST_ASSERT(run(server, {"GETEX", "missing", "EX", "10"}) == nil, "GETEX 不存在的键返回 nil");
+  TEST_ASSERT(run(server, {"GETEX", "a", "EX"}) == resp::serialize_error("ERR syntax error"),
+              "GETEX 缺少参数应报错");
+
+  TEST_ASSERT(run(server, {"GETDEL", "a"}) == resp::serialize_bulk_string("1"), "GETDEL 应返回值");
+  TEST_ASSERT(run(server, {"GET", "a"}) == nil, "GETDEL 后键应被删除");
+  TEST_ASSERT(run(server, {"GETDEL", "a"}) == nil, "GETDEL 不存在的键返回 nil");
+
+  auto now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    std::chrono::system_clock::now().time_since_epoch())
+                    .count();
+  TEST_ASSERT(run(server, {"PEXPIREAT", "b", std::to_string(now_ms + 30000)}) ==
+                  resp::serialize_integer(1),
+              "PEXPIREAT 应成功");
+  ms = pttl_of(server, "b");
+  TEST_ASSERT(ms > 29000 && ms <= 30000, "PEXPIREAT 应按绝对时间设置过期");
+  TEST_ASSERT(run(server, {"EXPIREAT", "b", std::to_string(now_ms / 1000 - 1)}) ==
+                  resp::serialize_integer(1),
+              "过去的 EXPIREAT 时间返回 1");
+  TEST_ASSERT(run(server, {"GET", "b"}) == nil, "过去的 EXPIREAT 时间应删除键");
+
+  std::cout << "SET/GET 变体命令测试通过！" << std::endl;
+  return true;
+}
+
+// 测试多键命令 MGET/MSET/MSETNX/DEL/EXISTS
+bool test_multi_key_commands() {
+  std::cout << "测试多键命令..." << std::endl;
+
+  KVServer server;
+  const std::string nil = resp::serialize_null_bulk_string();
+
+  TEST_ASSERT(run(server, {"MSET", "a", "1", "b", "two", "c", "3"}) == resp::serialize_ok(),
+              "MSET 应成功");
+  TEST_ASSERT(run(server, {"MSET", "a", "1", "b"}) ==
+                  resp::serialize_error("ERR wrong number of arguments for 'MSET' command"),
+              "MSET 键值不成对应报错");
+
+  std::string expected = "*4\r\n" + resp::serialize_bulk_string("1") + resp::serialize_bulk_string("two") +
+                         nil + resp::serialize_bulk_string("3");
+  TEST_ASSERT(run(server, {"MGET", "a", "b", "missing", "c"}) == expected,
+              "MGET 应按顺序返回值，不存在的键为 nil");
+
+  // 过期的键按不存在处理
+  run(server, {"PEXPIRE", "c", "1"});
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  TEST_ASSERT(run(server, {"MGET", "c"}) == "*1\r\n" + nil, "MGET 不返回过期的键");
+  TEST_ASSERT(run(server, {"EXISTS", "a", "b", "c", "a"}) == resp::serialize_integer(3),
+              "EXISTS 应重复计数且不计过期的键");
+
+  TEST_ASSERT(run(server, {"MSETNX", "x", "1", "a", "9"}) == resp::serialize_integer(0),
+              "MSETNX 有键存在时不写入");
+  TEST_ASSERT(run(server, {"EXISTS", "x"}) == resp::serialize_integer(0), "MSETNX 失败时不写入任何键");
+  TEST_ASSERT(run(server, {"MSETNX", "x", "1", "y", "2"}) == resp::serialize_integer(1),
+              "MSETNX 所有键都不存在时写入");
+
+  run(server, {"EXPIRE", "x", "100"});
+  run(server, {"MSET", "x", "10", "x", "11"});
+  TEST_ASSERT(run(server, {"GET", "x"}) == resp::serialize_bulk_string("11"), "MSET 中重复的键以最后一个为准");
+  TEST_ASSERT(run(server, {"TTL", "x"}) == resp::serialize_integer(-1), "MSET 应清除过期时间");
+
+  TEST_ASSERT(run(server, {"DEL", "a", "b", "missing", "a"}) == resp::serialize_integer(2),
+              "DEL 应返回实际删除的个数");
+  TEST_ASSERT(run(server, {"MGET", "a", "b"}) == "*2\r\n" + nil + nil, "DEL 后键应不存在");
+
+  // 批量查找跨越多个预取窗口
+  std::vector<std::string> mset = {"MSET"};
+  std::vector<std::string> mget = {"MGET"};
+  std::string replies = "*100\r\n";
+  for (int i = 0; i < 100; ++i) {
+    std::string key = "batch:" + std::to_string(i);
+    if (i % 2 == 0) {
+      mset.push_back(key);
+      mset.push_back("v" + std::to_string(i));
+      replies += resp::serialize_bulk_string("v" + std::to_string(i));
+    } else {
+      replies += nil;
+    }
+    mget.push_back(key);
+  }
+  run(server, mset);
+  TEST_ASSERT(run(server, mget) == replies, "大批量 MGET 的结果应与逐个查找一致");
+
+  std::cout << "多键命令测试通过！" << std::endl;
+  return true;
+}
+
+// 测试 UNLINK、FLUSHDB/FLUSHALL 和覆盖写入的惰性释放
+bool test_lazyfree() {
+  std::cout << "测试惰性释放..." << std::endl;
+
+  KVServer server;
+  server.set_lazyfree_threshold(1024);
+  long long freed_before = info_field(server, "lazyfreed_objects");
+  std::string big(4096, 'x');
+
+  run(server, {"SET", "big", big});
+  run(server, {"SET", "small", "v"});
+  run(server, {"EXPIRE", "big", "100"});
+  TEST_ASSERT(run(server, {"UNLINK", "big", "small", "missing"}) == resp::serialize_integer(2),
+              "UNLINK 应返回实际删除的个数");
+  TEST_ASSERT(run(server, {"EXISTS", "big", "small"}) == resp::serialize_integer(0), "UNLINK 后键应不存在");
+  TEST_ASSERT(info_field(server, "keyspace_entry_bytes") == 0, "UNLINK 后条目内存统计应归零");
+
+  // 覆盖大值时换上新条目，旧值在后台释放，过期时间保留
+  run(server, {"SET", "big", big, "EX", "100"});
+  run(server, {"SET", "big", "small", "KEEPTTL"});
+  TEST_ASSERT(run(server, {"GET", "big"}) == resp::serialize_bulk_string("small"), "覆盖大值后应读到新值");
+  TEST_ASSERT(run(server, {"TTL", "big"}) != resp::serialize_integer(-1), "KEEPTTL 覆盖大值应保留过期时间");
+
+  std::vector<std::string> mset = {"MSET"};
+  for (int i = 0; i < 100; ++i) {
+    mset.push_back("key:" + std::to_string(i));
+    mset.push_back("value");
+  }
+  run(server, mset);
+  TEST_ASSERT(run(server, {"FLUSHALL", "BAD"}) == resp::serialize_error("ERR syntax error"),
+              "FLUSHALL 的参数无效应报错");
+  TEST_ASSERT(run(server, {"FLUSHALL", "async"}) == resp::serialize_ok(), "FLUSHALL ASYNC 应成功");
+  TEST_ASSERT(run(server, {"EXISTS", "key:0", "big"}) == resp::serialize_integer(0), "FLUSHALL 后键应不存在");
+  TEST_ASSERT(info_field(server, "keyspace_entry_bytes") == 0, "FLUSHALL 后条目内存统计应归零");
+  TEST_ASSERT(run(server, {"TTL", "big"}) == resp::serialize_integer(-2), "FLUSHALL 应同时清空过期索引");
+
+  // 清空后的键空间可以继续使用
+  run(server, {"SET", "after", "1"});
+  TEST_ASSERT(run(server, {"FLUSHDB", "SYNC"}) == resp::serialize_ok(), "FLUSHDB SYNC 应成功");
+  TEST_ASSERT(run(server, {"EXISTS", "after"}) == resp::serialize_integer(0), "FLUSHDB 后键应不存在");
+
+  // 大值、被覆盖的旧值、键空间和过期索引共 4 个对象在后台释放；小值和小键空间同步释放
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (info_field(server, "lazyfree_pending_objects") > 0 && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  TEST_ASSERT(info_field(server, "lazyfree_pending_objects") == 0, "后台线程应释放完所有对象");
+  TEST_ASSERT(info_field(server, "lazyfreed_objects") - freed_before == 4, "应有 4 个对象在后台释放");
+
+  std::cout << "惰性释放测试通过！" << std::endl;
+  return true;
+}
+
+int main() {
+  // 设置日志级别
+  Logger::instance().set_level(LogLevel::INFO);
+  std::cout << "开始字符串命令测试..." << std::endl;
+
+  bool all_passed = true;
+  std::vector<std::pair<std::string, std::function<bool()>>> tests = {
+      {"INCR 系列命令测试", test_incr_family},
+      {"INCR 错误处理测试", test_incr_errors},
+      {"INCRBYFLOAT 命令测试", test_incrbyfloat},
+      {"整数编码测试", test_integer_encoding},
+      {"SET 选项测试", test_set_options},
+      {"SET/GET 变体命令测试", test_set_get_variants},
+      {"多键命令测试", test_multi_key_commands},
+      {"惰性释放测试", test_lazyfree}};
+
+  int passed = 0;
+  int failed = 0;
+
+  for (const auto &[name, test_func] : tests) {
+    std::cout << "\n===================================" << std::endl;
+    std::cout << "执行测试: " << name << std::endl;
+    std::cout << "===================================" << std::endl;
+
+    try {
+      if (test_func()) {
+        std::cout << "√ 测试通过: " << name << std::endl;
+        passed++;
+      } else {
+        std::cerr << "× 测试失败: " << name << std::endl;
+        all_passed = false;
+        failed++;
+      }
+    } catch (const std::exception &e) {
+      std::cerr << "× 测试出现异常: " << name << " - " << e.what()
+                << std::endl;
+      all_passed = false;
+      failed++;
+    }
+  }
+
+  std::cout << "\n===================================" << std::endl;
+  std::cout << "测试结果摘要:" << std::endl;
+  std::cout << "总计: " << tests.size() << " 个测试" << std::endl;
+  std::cout << "通过: " << passed << " 个测试" << std::endl;
+  std::cout << "失败: " << failed << " 个测试" << std::endl;
+  std::cout << "===================================" << std::endl;
+
+  return all_passed ? 0 : 1;
+}
@@ -214,6 +214,66 @@ bool test_aof_sync_timer_simulation() {
   return true;
 }
 
+// 测试过期时间相同的定时器：同一毫秒内添加的定时器在 multiset 中共存，到期时按添加顺序都执行
+bool test_duplicate_expiration_timers() {
+  std::cout << "测试过期时间相同的定时器..." << std::endl;
+
+  TimerQueue timer_queue;
+  std::vector<int> execution_order;
+  std::vector<Timer *> timers;
+  for (int i = 0; i < 10; i++) {
+    timers.push_back(timer_queue.add_timer(std::chrono::milliseconds(50),
+                                           [&execution_order, i]() { execution_order.push_back(i); }));
+  }
+  // 循环在一毫秒内完成，至少有两个定时器的过期时间相同
+  bool has_duplicate = false;
+  for (size_t i = 1; i < timers.size(); i++) {
+    has_duplicate = has_duplicate || timers[i]->expiration() == timers[i - 1]->expiration();
+  }
+  TEST_ASSERT(has_duplicate, "应有过期时间相同的定时器");
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  timer_queue.process_timer_event();
+
+  TEST_ASSERT(execution_order == std::vector<int>({0, 1, 2, 3, 4, 5, 6, 7, 8, 9}),
+              "过期时间相同的定时器应全部按添加顺序执行");
+
+  return true;
+}
+
+// 测试取消定时器：在过期时间相同的定时器中只取消指定的那个，被取消的回调不执行
+bool test_cancel_timer() {
+  std::cout << "测试取消定时器..." << std::endl;
+
+  TimerQueue timer_queue;
+  std::vector<int> execution_order;
+  std::vector<Timer *> timers;
+  for (int i = 0; i < 10; i++) {
+    timers.push_back(timer_queue.add_timer(std::chrono::milliseconds(50),
+                                           [&execution_order, i]() { execution_order.push_back(i); }));
+  }
+  // 取消相同过期时间范围中的第一个、中间和最后一个
+  timer_queue.cancel_timer(timers[0]);
+  timer_queue.cancel_timer(timers[4]);
+  timer_queue.cancel_timer(timers[9]);
+
+  // 到期回调中取消另一个尚未到期的定时器，如阻塞客户端被唤醒后取消它的超时
+  bool later_fired = false;
+  Timer *later = timer_queue.add_timer(std::chrono::milliseconds(150), [&later_fired]() { later_fired = true; });
+  timer_queue.add_timer(std::chrono::milliseconds(50), [&timer_queue, later]() { timer_queue.cancel_timer(later); });
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  timer_queue.process_timer_event();
+  TEST_ASSERT(execution_order == std::vector<int>({1, 2, 3, 5, 6, 7, 8}), "被取消的定时器不应执行，其余照常执行");
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  timer_queue.process_timer_event();
+  TEST_ASSERT(!later_fired, "在回调中取消的定时器不应执行");
+  TEST_ASSERT(execution_order.size() == 7, "已执行的单次定时器不应再次执行");
+
+  return true;
+}
+
 int main() {
   // 初始化日志
   Logger::instance().set_level(LogLevel::INFO);
@@ -227,6 +287,8 @@ int main() {
       {"Timer类基本功能测试", test_timer_class},
       {"重复定时器restart测试", test_timer_restart},
       {"AOF每秒同步定时器模拟测试", test_aof_sync_timer_simulation},
+      {"过期时间相同的定时器测试", test_duplicate_expiration_timers},
+      {"取消定时器测试", test_cancel_timer},
   };
 
   int passed = 0;
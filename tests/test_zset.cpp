@@ -0,0 +1,368 @@
+#include <functional>
+#include <iostream>
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <set>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+import resp;
+import kv_server;
+import command;
+import logger;
+
+// 测试辅助宏
+#define TEST_ASSERT(condition, message)                                        \
+  do {                                                                         \
+    if (!(condition)) {                                                        \
+      std::cerr << "断言失败: " << message << " 在 " << __FILE__ << " 行 "    \
+                << __LINE__ << std::endl;                                      \
+      return false;                                                            \
+    }                                                                          \
+  } while (0)
+
+// 创建命令辅助函数
+resp::RespValue create_command(const std::vector<std::string> &parts) {
+  auto arr = std::make_unique<resp::RespArray>();
+
+  for (const auto &part : parts) {
+    resp::RespBulkString item;
+    item.value = part;
+    arr->values.push_back(item);
+  }
+
+  return resp::RespValue(std::move(arr));
+}
+
+std::string run(KVServer &server, const std::vector<std::string> &parts) {
+  return server.execute_command(create_command(parts));
+}
+
+// 把数组回复解析为字符串列表，nil 记为 "(nil)"
+bool parse_array(const std::string &response, std::vector<std::string> &items) {
+  std::string_view input = response;
+  auto value = resp::parse(input);
+  if (!value) {
+    return false;
+  }
+  auto *arr = std::get_if<std::unique_ptr<resp::RespArray>>(&*value);
+  if (!arr) {
+    return false;
+  }
+  items.clear();
+  std::function<void(const resp::RespArray &)> flatten = [&](const resp::RespArray &a) {
+    for (const auto &item : a.values) {
+      if (auto *nested = std::get_if<std::unique_ptr<resp::RespArray>>(&item)) {
+        flatten(**nested);
+      } else {
+        const auto &bulk = std::get<resp::RespBulkString>(item);
+        items.push_back(bulk.value ? *bulk.value : "(nil)");
+      }
+    }
+  };
+  flatten(**arr);
+  return true;
+}
+
+std::string encoding(KVServer &server, const std::string &key) {
+  return run(server, {"OBJECT", "ENCODING", key});
+}
+
+std::vector<std::string> array_of(KVServer &server, const std::vector<std::string> &command) {
+  std::vector<std::string> items;
+  parse_array(run(server, command), items);
+  return items;
+}
+
+// 测试基本命令：ZADD/ZSCORE/ZRANK/ZCARD/ZINCRBY
+bool test_zset_basic() {
+  std::cout << "测试有序集合基本命令..." << std::endl;
+
+  KVServer server;
+  TEST_ASSERT(run(server, {"ZADD", "board", "100", "alice", "80", "bob", "95.5", "carol"}) == resp::serialize_integer(3),
+              "ZADD 返回新增的成员数");
+  TEST_ASSERT(run(server, {"ZADD", "board", "90", "bob", "70", "dave"}) == resp::serialize_integer(1),
+              "修改分数不计入新增");
+  TEST_ASSERT(run(server, {"ZCARD", "board"}) == resp::serialize_integer(4), "ZCARD 返回成员数");
+  TEST_ASSERT(run(server, {"ZSCORE", "board", "bob"}) == resp::serialize_bulk_string("90"), "ZSCORE 返回分数");
+  TEST_ASSERT(run(server, {"ZSCORE", "board", "carol"}) == resp::serialize_bulk_string("95.5"), "小数分数");
+  TEST_ASSERT(run(server, {"ZSCORE", "board", "nobody"}) == resp::serialize_null_bulk_string(), "成员不存在返回 nil");
+  TEST_ASSERT(run(server, {"ZRANK", "board", "dave"}) == resp::serialize_integer(0), "最低分排名为 0");
+  TEST_ASSERT(run(server, {"ZRANK", "board", "alice"}) == resp::serialize_integer(3), "最高分排名最后");
+  TEST_ASSERT(run(server, {"ZRANK", "board", "carol", "WITHSCORE"}) ==
+                  "*2\r\n" + resp::serialize_integer(2) + resp::serialize_bulk_string("95.5"),
+              "WITHSCORE 同时返回分数");
+  TEST_ASSERT(run(server, {"ZRANK", "board", "nobody"}) == resp::serialize_null_bulk_string(), "成员不存在返回 nil");
+  TEST_ASSERT(run(server, {"ZRANK", "board", "bob", "BAD"}) == resp::serialize_error("ERR syntax error"),
+              "未知选项应报错");
+
+  TEST_ASSERT(run(server, {"ZINCRBY", "board", "15", "bob"}) == resp::serialize_bulk_string("105"),
+              "ZINCRBY 返回新分数");
+  TEST_ASSERT(run(server, {"ZRANK", "board", "bob"}) == resp::serialize_integer(3), "ZINCRBY 后排名随之改变");
+  TEST_ASSERT(run(server, {"ZINCRBY", "board", "2.5", "erin"}) == resp::serialize_bulk_string("2.5"),
+              "ZINCRBY 新成员从 0 开始");
+  TEST_ASSERT(run(server, {"ZINCRBY", "board", "abc", "erin"}) == resp::serialize_error("ERR value is not a valid float"),
+              "无效增量应报错");
+  TEST_ASSERT(run(server, {"ZADD", "inf", "+inf", "a", "-inf", "b"}) == resp::serialize_integer(2), "接受无穷分数");
+  TEST_ASSERT(run(server, {"ZSCORE", "inf", "a"}) == resp::serialize_bulk_string("inf"), "正无穷");
+  TEST_ASSERT(run(server, {"ZINCRBY", "inf", "-inf", "a"}) ==
+                  resp::serialize_error("ERR resulting score is not a number (NaN)"),
+              "结果为 NaN 时报错");
+  TEST_ASSERT(run(server, {"ZADD", "inf", "nan", "c"}) == resp::serialize_error("ERR value is not a valid float"),
+              "不接受 NaN");
+
+  TEST_ASSERT(run(server, {"ZCARD", "nokey"}) == resp::serialize_integer(0), "不存在的键 ZCARD 为 0");
+  run(server, {"SET", "str", "v"});
+  const std::string wrongtype = resp::serialize_error("WRONGTYPE Operation against a key holding the wrong kind of value");
+  TEST_ASSERT(run(server, {"ZADD", "str", "1", "a"}) == wrongtype, "ZADD 字符串键应报类型错误");
+  TEST_ASSERT(run(server, {"ZRANGE", "str", "0", "-1"}) == wrongtype, "ZRANGE 字符串键应报类型错误");
+  TEST_ASSERT(run(server, {"TYPE", "board"}) == resp::serialize_simple_string("zset"), "TYPE 返回 zset");
+
+  std::cout << "有序集合基本命令测试通过！" << std::endl;
+  return true;
+}
+
+// 测试 ZADD 的 NX/XX/GT/LT/CH/INCR 选项
+bool test_zadd_options() {
+  std::cout << "测试 ZADD 选项..." << std::endl;
+
+  KVServer server;
+  run(server, {"ZADD", "z", "10", "a", "20", "b"});
+  TEST_ASSERT(run(server, {"ZADD", "z", "NX", "99", "a", "30", "c"}) == resp::serialize_integer(1), "NX 只新增");
+  TEST_ASSERT(run(server, {"ZSCORE", "z", "a"}) == resp::serialize_bulk_string("10"), "NX 不修改已有成员");
+  TEST_ASSERT(run(server, {"ZADD", "z", "XX", "11", "a", "40", "d"}) == resp::serialize_integer(0), "XX 不新增");
+  TEST_ASSERT(run(server, {"ZSCORE", "z", "a"}) == resp::serialize_bulk_string("11"), "XX 修改已有成员");
+  TEST_ASSERT(run(server, {"ZSCORE", "z", "d"}) == resp::serialize_null_bulk_string(), "XX 不加入新成员");
+  TEST_ASSERT(run(server, {"ZADD", "z", "CH", "12", "a", "20", "b", "50", "e"}) == resp::serialize_integer(2),
+              "CH 计入被修改的成员");
+  TEST_ASSERT(run(server, {"ZADD", "z", "GT", "CH", "5", "a", "25", "b"}) == resp::serialize_integer(1),
+              "GT 只在新分数更大时修改");
+  TEST_ASSERT(run(server, {"ZSCORE", "z", "a"}) == resp::serialize_bulk_string("12"), "GT 拦下更小的分数");
+  TEST_ASSERT(run(server, {"ZADD", "z", "LT", "CH", "5", "a", "30", "b"}) == resp::serialize_integer(1),
+              "LT 只在新分数更小时修改");
+  TEST_ASSERT(run(server, {"ZADD", "z", "INCR", "3", "a"}) == resp::serialize_bulk_string("8"), "INCR 返回新分数");
+  TEST_ASSERT(run(server, {"ZADD", "z", "NX", "INCR", "3", "a"}) == resp::serialize_null_bulk_string(),
+              "INCR 被 NX 拦下时返回 nil");
+  TEST_ASSERT(run(server, {"ZADD", "missing", "XX", "1", "a"}) == resp::serialize_integer(0), "XX 不创建键");
+  TEST_ASSERT(run(server, {"EXISTS", "missing"}) == resp::serialize_integer(0), "XX 不创建键");
+
+  TEST_ASSERT(run(server, {"ZADD", "z", "NX", "XX", "1", "a"}) ==
+                  resp::serialize_error("ERR XX and NX options at the same time are not compatible"),
+              "NX 与 XX 不能同时使用");
+  TEST_ASSERT(run(server, {"ZADD", "z", "GT", "LT", "1", "a"}) ==
+                  resp::serialize_error("ERR GT, LT, and/or NX options at the same time are not compatible"),
+              "GT 与 LT 不能同时使用");
+  TEST_ASSERT(run(server, {"ZADD", "z", "INCR", "1", "a", "2", "b"}) ==
+                  resp::serialize_error("ERR INCR option supports a single increment-element pair"),
+              "INCR 只能有一对参数");
+  TEST_ASSERT(run(server, {"ZADD", "z", "1", "a", "2"}) == resp::serialize_error("ERR syntax error"), "参数不成对");
+  TEST_ASSERT(run(server, {"ZADD", "z", "1", "x", "bad", "y"}) == resp::serialize_error("ERR value is not a valid float"),
+              "无效分数应报错");
+  TEST_ASSERT(run(server, {"ZSCORE", "z", "x"}) == resp::serialize_null_bulk_string(), "分数无效时不做任何修改");
+
+  std::cout << "ZADD 选项测试通过！" << std::endl;
+  return true;
+}
+
+// 测试 ZRANGE 的排名、分数、字典序区间以及 REV/LIMIT/WITHSCORES
+bool test_zrange() {
+  std::cout << "测试 ZRANGE..." << std::endl;
+
+  KVServer server;
+  run(server, {"ZADD", "z", "1", "a", "2", "b", "3", "c", "4", "d", "5", "e"});
+  using V = std::vector<std::string>;
+  TEST_ASSERT((array_of(server, {"ZRANGE", "z", "0", "-1"}) == V{"a", "b", "c", "d", "e"}), "全部成员按分数升序");
+  TEST_ASSERT((array_of(server, {"ZRANGE", "z", "1", "2", "WITHSCORES"}) == V{"b", "2", "c", "3"}), "WITHSCORES");
+  TEST_ASSERT((array_of(server, {"ZRANGE", "z", "0", "1", "REV"}) == V{"e", "d"}), "REV 按分数降序");
+  TEST_ASSERT((array_of(server, {"ZRANGE", "z", "-2", "100"}) == V{"d", "e"}), "负数下标和越界");
+  TEST_ASSERT(array_of(server, {"ZRANGE", "z", "3", "1"}).empty(), "空区间");
+
+  TEST_ASSERT((array_of(server, {"ZRANGE", "z", "2", "4", "BYSCORE"}) == V{"b", "c", "d"}), "BYSCORE 闭区间");
+  TEST_ASSERT((array_of(server, {"ZRANGE", "z", "(2", "(4", "BYSCORE"}) == V{"c"}), "BYSCORE 开区间");
+  TEST_ASSERT((array_of(server, {"ZRANGE", "z", "-inf", "+inf", "BYSCORE", "LIMIT", "1", "2"}) == V{"b", "c"}),
+              "LIMIT 跳过 offset 个并限制个数");
+  TEST_ASSERT((array_of(server, {"ZRANGE", "z", "4", "2", "BYSCORE", "REV"}) == V{"d", "c", "b"}),
+              "BYSCORE REV 先写上界");
+  TEST_ASSERT((array_of(server, {"ZRANGE", "z", "+inf", "-inf", "BYSCORE", "REV", "LIMIT", "0", "1", "WITHSCORES"}) ==
+               V{"e", "5"}),
+              "BYSCORE REV LIMIT WITHSCORES");
+  TEST_ASSERT(array_of(server, {"ZRANGE", "z", "6", "10", "BYSCORE"}).empty(), "没有分数在区间内");
+  TEST_ASSERT(run(server, {"ZRANGE", "z", "x", "2", "BYSCORE"}) == resp::serialize_error("ERR min or max is not a float"),
+              "无效分数区间应报错");
+
+  run(server, {"ZADD", "lex", "0", "apple", "0", "banana", "0", "cherry", "0", "date"});
+  TEST_ASSERT((array_of(server, {"ZRANGE", "lex", "[banana", "(date", "BYLEX"}) == V{"banana", "cherry"}), "BYLEX");
+  TEST_ASSERT((array_of(server, {"ZRANGE", "lex", "-", "+", "BYLEX", "LIMIT", "1", "1"}) == V{"banana"}),
+              "BYLEX 无穷端点和 LIMIT");
+  TEST_ASSERT((array_of(server, {"ZRANGE", "lex", "+", "(b", "BYLEX", "REV"}) == V{"date", "cherry", "banana"}),
+              "BYLEX REV");
+  TEST_ASSERT(run(server, {"ZRANGE", "lex", "a", "b", "BYLEX"}) ==
+                  resp::serialize_error("ERR min or max not valid string range item"),
+              "无效字典序区间应报错");
+  TEST_ASSERT(run(server, {"ZRANGE", "z", "0", "1", "LIMIT", "0", "1"}) ==
+                  resp::serialize_error(
+                      "ERR syntax error, LIMIT is only supported in combination with either BYSCORE or BYLEX"),
+              "按排名时不支持 LIMIT");
+  TEST_ASSERT(run(server, {"ZRANGE", "lex", "-", "+", "BYLEX", "WITHSCORES"}) ==
+                  resp::serialize_error("ERR syntax error, WITHSCORES not supported in combination with BYLEX"),
+              "BYLEX 不支持 WITHSCORES");
+  TEST_ASSERT(array_of(server, {"ZRANGE", "nokey", "0", "-1"}).empty(), "不存在的键返回空数组");
+
+  std::cout << "ZRANGE 测试通过！" << std::endl;
+  return true;
+}
+
+// 测试 ZREM/ZREMRANGEBYSCORE/ZPOPMIN
+bool test_zset_remove() {
+  std::cout << "测试有序集合删除..." << std::endl;
+
+  KVServer server;
+  run(server, {"ZADD", "z", "1", "a", "2", "b", "3", "c", "4", "d", "5", "e"});
+  TEST_ASSERT(run(server, {"ZREM", "z", "a", "x"}) == resp::serialize_integer(1), "ZREM 返回删除的成员数");
+  TEST_ASSERT(run(server, {"ZREMRANGEBYSCORE", "z", "(2", "4"}) == resp::serialize_integer(2),
+              "ZREMRANGEBYSCORE 返回删除的成员数");
+  using V = std::vector<std::string>;
+  TEST_ASSERT((array_of(server, {"ZRANGE", "z", "0", "-1"}) == V{"b", "e"}), "删除区间内的成员");
+  TEST_ASSERT((array_of(server, {"ZPOPMIN", "z"}) == V{"b", "2"}), "ZPOPMIN 弹出最低分的成员");
+  TEST_ASSERT((array_of(server, {"ZPOPMIN", "z", "10"}) == V{"e", "5"}), "count 超过成员数时弹出全部");
+  TEST_ASSERT(run(server, {"EXISTS", "z"}) == resp::serialize_integer(0), "弹空后删除键");
+  TEST_ASSERT(array_of(server, {"ZPOPMIN", "z"}).empty(), "不存在的键返回空数组");
+  TEST_ASSERT(run(server, {"ZPOPMIN", "z", "-1"}) == resp::serialize_error("ERR value is out of range, must be positive"),
+              "负数 count 应报错");
+
+  run(server, {"ZADD", "y", "1", "a", "2", "b"});
+  TEST_ASSERT(run(server, {"ZREMRANGEBYSCORE", "y", "-inf", "+inf"}) == resp::serialize_integer(2), "删除全部成员");
+  TEST_ASSERT(run(server, {"EXISTS", "y"}) == resp::serialize_integer(0), "集合变空后删除键");
+  run(server, {"ZADD", "y", "1", "a"});
+  TEST_ASSERT(run(server, {"ZREM", "y", "a"}) == resp::serialize_integer(1), "ZREM 删除最后一个成员");
+  TEST_ASSERT(run(server, {"EXISTS", "y"}) == resp::serialize_integer(0), "ZREM 删空后删除键");
+
+  std::cout << "有序集合删除测试通过！" << std::endl;
+  return true;
+}
+
+// 同样的操作序列分别作用于紧凑编码和跳表编码，所有查询结果应一致
+bool test_zset_encodings_agree() {
+  std::cout << "测试跳表与紧凑编码一致性..." << std::endl;
+
+  KVServer small_server;
+  KVServer big_server;
+  EncodingConfig config;
+  config.zset_max_listpack_entries = 0; // 从第一个成员起就使用跳表
+  big_server.set_encoding_config(config);
+  EncodingConfig small_config;
+  small_config.zset_max_listpack_entries = 1000;
+  small_server.set_encoding_config(small_config);
+
+  std::mt19937 rng(7);
+  for (int i = 0; i < 3000; ++i) {
+    std::string member = "m" + std::to_string(rng() % 200);
+    std::string score = std::to_string(static_cast<int>(rng() % 50) - 25);
+    std::vector<std::string> command;
+    switch (rng() % 6) {
+    case 0:
+    case 1:
+    case 2:
+      command = {"ZADD", "z", score, member};
+      break;
+    case 3:
+      command = {"ZINCRBY", "z", "1.5", member};
+      break;
+    case 4:
+      command = {"ZREM", "z", member};
+      break;
+    default:
+      command = {"ZREMRANGEBYSCORE", "z", score, "(" + std::to_string(std::stoi(score) + 2)};
+      break;
+    }
+    TEST_ASSERT(run(small_server, command) == run(big_server, command), "两种编码的写命令回复一致");
+  }
+  TEST_ASSERT(encoding(small_server, "z") == resp::serialize_bulk_string("listpack"), "使用紧凑编码");
+  TEST_ASSERT(encoding(big_server, "z") == resp::serialize_bulk_string("skiplist"), "使用跳表编码");
+  // BYLEX 只在所有成员分数相同时有确定的结果，另用一个分数全为 0 的键比较
+  for (int i = 0; i < 200; ++i) {
+    std::vector<std::string> command = {"ZADD", "lexz", "0", "m" + std::to_string(rng() % 300)};
+    TEST_ASSERT(run(small_server, command) == run(big_server, command), "两种编码的写命令回复一致");
+  }
+
+  const std::vector<std::vector<std::string>> queries = {
+      {"ZRANGE", "z", "0", "-1", "WITHSCORES"},
+      {"ZRANGE", "z", "5", "20", "REV"},
+      {"ZRANGE", "z", "-10", "(10", "BYSCORE", "WITHSCORES"},
+      {"ZRANGE", "z", "(10", "-10", "BYSCORE", "REV", "LIMIT", "3", "5"},
+      {"ZRANGE", "lexz", "[m1", "(m5", "BYLEX"},
+      {"ZRANGE", "lexz", "(m8", "-", "BYLEX", "REV", "LIMIT", "2", "10"},
+      {"ZRANK", "z", "m42"},
+      {"ZSCORE", "z", "m42"},
+      {"ZCARD", "z"},
+      {"ZPOPMIN", "z", "3"},
+      {"ZRANGE", "z", "0", "-1", "WITHSCORES"},
+  };
+  for (const auto &query : queries) {
+    TEST_ASSERT(run(small_server, query) == run(big_server, query), "两种编码的查询结果一致");
+  }
+
+  // 超过成员数阈值时转换编码，顺序和分数不变
+  KVServer server;
+  EncodingConfig tiny;
+  tiny.zset_max_listpack_entries = 4;
+  server.set_encoding_config(tiny);
+  run(server, {"ZADD", "t", "4", "d", "1", "a", "3", "c", "2", "b"});
+  TEST_ASSERT(encoding(server, "t") == resp::serialize_bulk_string("listpack"), "不超过阈值时使用 listpack");
+  run(server, {"ZADD", "t", "0", "z"});
+  TEST_ASSERT(encoding(server, "t") == resp::serialize_bulk_string("skiplist"), "超过阈值后转换为跳表");
+  TEST_ASSERT((array_of(server, {"ZRANGE", "t", "0", "-1"}) == std::vector<std::string>{"z", "a", "b", "c", "d"}),
+              "转换后顺序不变");
+  run(server, {"ZADD", "long", "1", std::string(65, 'm')});
+  TEST_ASSERT(encoding(server, "long") == resp::serialize_bulk_string("skiplist"), "成员超过长度阈值时使用跳表");
+
+  std::cout << "跳表与紧凑编码一致性测试通过！" << std::endl;
+  return true;
+}
+
+int main() {
+  Logger::instance().set_level(LogLevel::ERROR);
+  std::cout << "开始有序集合类型测试..." << std::endl;
+
+  bool all_passed = true;
+  std::vector<std::pair<std::string, std::function<bool()>>> tests = {
+      {"有序集合基本命令测试", test_zset_basic},
+      {"ZADD 选项测试", test_zadd_options},
+      {"ZRANGE 测试", test_zrange},
+      {"有序集合删除测试", test_zset_remove},
+      {"跳表与紧凑编码一致性测试", test_zset_encodings_agree}};
+
+  int passed = 0;
+  int failed = 0;
+
+  for (const auto &[name, test_func] : tests) {
+    std::cout << "\n===================================" << std::endl;
+    std::cout << "执行测试: " << name << std::endl;
+    std::cout << "===================================" << std::endl;
+
+    try {
+      if (test_func()) {
+        std::cout << "√ 测试通过: " << name << std::endl;
+        passed++;
+      } else {
+        std::cerr << "× 测试失败: " << name << std::endl;
+        all_passed = false;
+        failed++;
+      }
+    } catch (const std::exception &e) {
+      std::cerr << "× 测试出现异常: " << name << " - " << e.what() << std::endl;
+      all_passed = false;
+      failed++;
+    }
+  }
+
+  std::cout << "\n===================================" << std::endl;
+  std::cout << "测试结果: " << passed << " 通过, " << failed << " 失败" << std::endl;
+  std::cout << "===================================" << std::endl;
+
+  return all_passed ? 0 : 1;
+}
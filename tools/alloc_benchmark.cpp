@@ -0,0 +1,165 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+import kv_server;
+import resp;
+import buffer;
+import command;
+import server_stat;
+import logger;
+
+// 请求路径内存分配基准测试：
+// 通过替换全局 operator new 统计每次操作的堆分配次数，同时给出每次操作的耗时。
+// 回复部分对比旧的 std::string 序列化与直接写入输出缓冲区两种方式，
+// 命令分派部分对比旧的“std::function 创建命令对象 + 虚调用”与新的处理函数表，
+// 命令部分测量 GET/SET/TTL 完整执行路径（输出缓冲区在每次操作后清空，模拟已写出到 socket）。
+
+static size_t g_allocations = 0;
+static bool g_counting = false;
+
+void *operator new(std::size_t size) {
+  if (g_counting) {
+    ++g_allocations;
+  }
+  if (void *p = std::malloc(size == 0 ? 1 : size)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+
+constexpr int kIterations = 1000000;
+
+// 旧的命令分派方式：按名字查找创建函数，每条命令在堆上创建一个命令对象再虚调用
+class LegacyCommand {
+public:
+  virtual ~LegacyCommand() = default;
+  virtual void execute(Buffer &out) = 0;
+};
+
+class LegacyGetCommand : public LegacyCommand {
+public:
+  LegacyGetCommand(KVServerContext &context, CommandArgs args) : context_(context), args_(args) {}
+  void execute(Buffer &out) override { get_command(context_, args_, out); }
+
+private:
+  KVServerContext &context_;
+  CommandArgs args_;
+};
+
+using LegacyCreator = std::function<std::unique_ptr<LegacyCommand>(CommandArgs)>;
+
+void run_case(const std::string &name, const std::function<void()> &op) {
+  // 预热，让各种缓冲区达到稳定容量
+  for (int i = 0; i < 1000; ++i) {
+    op();
+  }
+  g_allocations = 0;
+  g_counting = true;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < kIterations; ++i) {
+    op();
+  }
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  g_counting = false;
+
+  double ns = std::chrono::duration<double, std::nano>(elapsed).count() / kIterations;
+  double allocs = static_cast<double>(g_allocations) / kIterations;
+  std::cout << std::left << std::setw(36) << name << std::right << std::setw(12)
+            << std::fixed << std::setprecision(2) << allocs << std::setw(12)
+            << std::setprecision(1) << ns << std::endl;
+}
+
+int main() {
+  Logger::instance().set_level(LogLevel::ERROR);
+
+  KVServer server;
+  const std::string value = "value-0123456789"; // 16 字节的小值
+  std::vector<std::string_view> set_argv = {"SET", "key:1", value};
+  std::vector<std::string_view> get_argv = {"GET", "key:1"};
+  std::vector<std::string_view> ttl_argv = {"TTL", "key:1"};
+  server.execute_command(set_argv);
+
+  Buffer out;
+  // 模拟每轮事件处理后输出缓冲区被完全写出
+  auto drain = [&out]() { out.retrieve_all(); };
+
+  // 命令分派对比使用独立的键空间
+  Storage db;
+  ExpiresIndex expires;
+  ServerStat stats;
+  KVServerContext context(db, expires, nullptr, stats);
+  db.insert(KvEntry::create("key:1", value));
+  std::unordered_map<std::string, LegacyCreator> legacy_creators;
+  legacy_creators["GET"] = [&context](CommandArgs args) {
+    return std::make_unique<LegacyGetCommand>(context, args);
+  };
+
+  std::cout << "--- 请求路径内存分配基准测试（" << kIterations << " 次/项）---" << std::endl;
+  std::cout << std::left << std::setw(36) << "测试项" << std::right << std::setw(12)
+            << "分配/次" << std::setw(12) << "ns/次" << std::endl;
+
+  // 回复序列化
+  run_case("回复 bulk string (std::string)", [&]() {
+    std::string reply = resp::serialize_bulk_string(value);
+    out.append(reply);
+    drain();
+  });
+  run_case("回复 bulk string (写入缓冲区)", [&]() {
+    resp::write_bulk_string(out, value);
+    drain();
+  });
+  run_case("回复 integer (std::string)", [&]() {
+    std::string reply = resp::serialize_integer(123456);
+    out.append(reply);
+    drain();
+  });
+  run_case("回复 integer (写入缓冲区)", [&]() {
+    resp::write_integer(out, 123456);
+    drain();
+  });
+  run_case("回复 +OK (写入缓冲区)", [&]() {
+    resp::write_ok(out);
+    drain();
+  });
+
+  // 命令分派
+  run_case("分派 GET（旧：创建命令对象）", [&]() {
+    auto command = legacy_creators.find("GET")->second(std::span(get_argv).subspan(1));
+    command->execute(out);
+    drain();
+  });
+  run_case("分派 GET（新：处理函数表）", [&]() {
+    const CommandSpec *spec = lookup_command(get_argv[0]);
+    handler_of(*spec)(context, std::span(get_argv).subspan(1), out);
+    drain();
+  });
+
+  // 完整命令路径
+  run_case("命令 GET", [&]() {
+    server.execute_command(get_argv, out);
+    drain();
+  });
+  run_case("命令 SET（覆盖已有键）", [&]() {
+    server.execute_command(set_argv, out);
+    drain();
+  });
+  run_case("命令 TTL", [&]() {
+    server.execute_command(ttl_argv, out);
+    drain();
+  });
+  return 0;
+}
@@ -131,8 +131,7 @@ int main() {
       run_test_case("GET 参数过少", "GET",
                     "ERR wrong number of arguments for 'GET' command"));
   results.push_back(
-      run_test_case("SET 参数过多", "SET key val extra",
-                    "ERR wrong number of arguments for 'SET' command"));
+      run_test_case("SET 选项无效", "SET key val extra", "ERR syntax error"));
   results.push_back(
       run_test_case("SET 参数过少", "SET key",
                     "ERR wrong number of arguments for 'SET' command"));
@@ -0,0 +1,160 @@
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+import kv_server;
+import buffer;
+import command;
+import bitops;
+import logger;
+
+// 位图基准测试：日活用户位图
+// - 内核：bitops::popcount / bitops::apply（运行时选择的 SIMD 内核）与按 64 位字的标量循环
+// - 命令层：BITCOUNT、两个位图的 BITOP AND/OR、稀疏位图上的 BITPOS，以及随机 SETBIT 的耗时
+// 用法: bitmap_benchmark [位数，默认 100000000]
+
+using Clock = std::chrono::steady_clock;
+
+double us_per_op(Clock::time_point start, size_t ops) {
+  return std::chrono::duration<double, std::micro>(Clock::now() - start).count() / ops;
+}
+
+void print_row(std::string_view name, double us, size_t bytes) {
+  double gbps = static_cast<double>(bytes) / (us * 1e3);
+  std::cout << std::left << std::setw(40) << name << std::right << std::fixed << std::setprecision(1)
+            << std::setw(12) << us << std::setw(12) << std::setprecision(2) << gbps << std::endl;
+}
+
+// 标量基线：与关闭 SIMD 时的内核相同，按 64 位字处理
+uint64_t scalar_popcount(const uint8_t *p, size_t n) {
+  uint64_t count = 0;
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    uint64_t v;
+    std::memcpy(&v, p + i, sizeof(v));
+    count += static_cast<uint64_t>(std::popcount(v));
+  }
+  for (; i < n; ++i) {
+    count += static_cast<uint64_t>(std::popcount(p[i]));
+  }
+  return count;
+}
+
+void scalar_and(uint8_t *dst, const uint8_t *src, size_t n) {
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    uint64_t a, b;
+    std::memcpy(&a, dst + i, sizeof(a));
+    std::memcpy(&b, src + i, sizeof(b));
+    a &= b;
+    std::memcpy(dst + i, &a, sizeof(a));
+  }
+  for (; i < n; ++i) {
+    dst[i] &= src[i];
+  }
+}
+
+int main(int argc, char *argv[]) {
+  Logger::instance().set_level(LogLevel::ERROR);
+  size_t bits = argc > 1 ? std::stoul(argv[1]) : 100000000;
+  size_t bytes = (bits + 7) / 8;
+  std::mt19937_64 rng(42);
+
+  // 两天的活跃用户，各约 25% 的位为 1
+  std::string day1(bytes, '\0');
+  std::string day2(bytes, '\0');
+  for (size_t i = 0; i < bytes; ++i) {
+    uint64_t r = rng();
+    day1[i] = static_cast<char>(r & (r >> 8));
+    day2[i] = static_cast<char>((r >> 32) & (r >> 40));
+  }
+  std::cout << "位图大小: " << bits << " 位（" << bytes << " 字节），内核: " << bitops::simd_kernel() << std::endl
+            << std::endl;
+
+  std::cout << std::left << std::setw(40) << "每次耗时" << std::right << std::setw(12) << "us" << std::setw(12)
+            << "GB/s" << std::endl;
+  const auto *p1 = reinterpret_cast<const uint8_t *>(day1.data());
+  const auto *p2 = reinterpret_cast<const uint8_t *>(day2.data());
+  size_t rounds = 20;
+  uint64_t sink = 0;
+  auto start = Clock::now();
+  for (size_t i = 0; i < rounds; ++i) {
+    sink += scalar_popcount(p1, bytes);
+  }
+  print_row("标量 popcount", us_per_op(start, rounds), bytes);
+  start = Clock::now();
+  for (size_t i = 0; i < rounds; ++i) {
+    sink -= bitops::popcount(p1, bytes);
+  }
+  print_row("bitops::popcount", us_per_op(start, rounds), bytes);
+  if (sink != 0) {
+    std::cerr << "位计数结果不一致" << std::endl;
+    return 1;
+  }
+
+  std::string dst = day1;
+  auto *pd = reinterpret_cast<uint8_t *>(dst.data());
+  start = Clock::now();
+  for (size_t i = 0; i < rounds; ++i) {
+    scalar_and(pd, p2, bytes);
+  }
+  print_row("标量 AND", us_per_op(start, rounds), bytes);
+  start = Clock::now();
+  for (size_t i = 0; i < rounds; ++i) {
+    bitops::apply(bitops::BitOp::And, pd, p2, bytes);
+  }
+  print_row("bitops::apply AND", us_per_op(start, rounds), bytes);
+
+  KVServer server;
+  Buffer out;
+  std::vector<std::string_view> args = {"SET", "dau:day1", day1};
+  server.execute_command(args, out);
+  args = {"SET", "dau:day2", day2};
+  server.execute_command(args, out);
+  // 只有最后一位为 1 的稀疏位图，BITPOS 要扫描整个值
+  args = {"SETBIT", "sparse", std::to_string(bits - 1), "1"};
+  server.execute_command(args, out);
+  out.retrieve_all();
+
+  auto command = [&](std::string_view name, std::vector<std::string_view> cmd) {
+    auto begin = Clock::now();
+    for (size_t i = 0; i < rounds; ++i) {
+      server.execute_command(cmd, out);
+      out.retrieve_all();
+    }
+    print_row(name, us_per_op(begin, rounds), bytes);
+  };
+  std::cout << std::endl;
+  command("BITCOUNT", {"BITCOUNT", "dau:day1"});
+  command("BITOP AND（两天都活跃）", {"BITOP", "AND", "dau:both", "dau:day1", "dau:day2"});
+  command("BITOP OR（任一天活跃）", {"BITOP", "OR", "dau:any", "dau:day1", "dau:day2"});
+  command("BITPOS 1（稀疏位图）", {"BITPOS", "sparse", "1"});
+
+  size_t updates = 1000000;
+  std::vector<std::string> offsets;
+  offsets.reserve(updates);
+  std::uniform_int_distribution<size_t> pick(0, bits - 1);
+  for (size_t i = 0; i < updates; ++i) {
+    offsets.push_back(std::to_string(pick(rng)));
+  }
+  start = Clock::now();
+  for (size_t i = 0; i < updates; ++i) {
+    args = {"SETBIT", "dau:day1", offsets[i], "1"};
+    server.execute_command(args, out);
+    if (i % 1000 == 999) {
+      out.retrieve_all();
+    }
+  }
+  out.retrieve_all();
+  std::cout << std::left << std::setw(40) << "SETBIT（ns/次）" << std::right << std::fixed << std::setprecision(1)
+            << std::setw(12) << us_per_op(start, updates) * 1e3 << std::endl;
+  return 0;
+}
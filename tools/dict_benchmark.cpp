@@ -0,0 +1,124 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <malloc.h>
+#include <new>
+#include <optional>
+#include <random>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+import command;
+import logger;
+
+// 键空间哈希表基准测试：对比原来的 std::unordered_map<std::string, {std::string, optional<time_point>}>
+// 与现在的键空间（开放寻址的 Dict + 单次分配的紧凑条目）。
+// - 增长：逐个插入 N 个键，记录每次插入的耗时分布。一次性重建整张表的停顿体现在 p99.9 和最大值上
+// - 查找：随机查找已存在的键，给出平均耗时
+// - 内存：插入前后堆上存活字节数之差除以键数（按 malloc_usable_size 统计，含分配器取整）
+// 用法: dict_benchmark [键数量，默认 2000000]
+
+static long long g_live_bytes = 0;
+
+void *operator new(std::size_t size) {
+  if (void *p = std::malloc(size == 0 ? 1 : size)) {
+    g_live_bytes += static_cast<long long>(malloc_usable_size(p));
+    return p;
+  }
+  throw std::bad_alloc();
+}
+void operator delete(void *p) noexcept {
+  if (p) {
+    g_live_bytes -= static_cast<long long>(malloc_usable_size(p));
+  }
+  std::free(p);
+}
+void operator delete(void *p, std::size_t) noexcept { operator delete(p); }
+
+struct StringHash {
+  using is_transparent = void;
+  size_t operator()(std::string_view s) const noexcept { return std::hash<std::string_view>{}(s); }
+};
+// 原来的条目格式：键、值各一个 std::string，过期时间总是占 16 字节
+struct LegacyValue {
+  std::string value;
+  std::optional<std::chrono::steady_clock::time_point> expires_at;
+};
+using UnorderedStorage = std::unordered_map<std::string, LegacyValue, StringHash, std::equal_to<>>;
+
+constexpr std::string_view VALUE = "value-0123456789abcd"; // 20 字节的小值
+
+void insert(UnorderedStorage &map, const std::string &key) {
+  map.emplace(key, LegacyValue{std::string(VALUE), std::nullopt});
+}
+void insert(Storage &map, const std::string &key) { map.insert(KvEntry::create(key, VALUE)); }
+
+double percentile(std::vector<long long> &sorted, double p) {
+  size_t index = static_cast<size_t>(p * (sorted.size() - 1));
+  return static_cast<double>(sorted[index]);
+}
+
+template <typename Map> void run(const std::string &name, const std::vector<std::string> &keys) {
+  std::vector<long long> latencies;
+  latencies.reserve(keys.size());
+
+  long long bytes_before = g_live_bytes;
+  auto *map = new Map();
+  for (const auto &key : keys) {
+    auto start = std::chrono::steady_clock::now();
+    insert(*map, key);
+    auto end = std::chrono::steady_clock::now();
+    latencies.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+  }
+  double bytes_per_key = static_cast<double>(g_live_bytes - bytes_before) / keys.size();
+  std::sort(latencies.begin(), latencies.end());
+
+  // 随机查找
+  std::mt19937 rng(42);
+  std::uniform_int_distribution<size_t> dist(0, keys.size() - 1);
+  std::vector<size_t> order(1000000);
+  for (auto &i : order) {
+    i = dist(rng);
+  }
+  size_t found = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i : order) {
+    found += map->find(keys[i]) != map->end();
+  }
+  double lookup_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() /
+                     order.size();
+  if (found != order.size()) {
+    std::cerr << "查找结果错误" << std::endl;
+  }
+  delete map;
+
+  std::cout << std::left << std::setw(20) << name << std::right << std::fixed << std::setprecision(0)
+            << std::setw(10) << percentile(latencies, 0.5) << std::setw(10) << percentile(latencies, 0.99)
+            << std::setw(10) << percentile(latencies, 0.999) << std::setw(14) << latencies.back()
+            << std::setprecision(1) << std::setw(12) << lookup_ns << std::setw(12) << bytes_per_key
+            << std::endl;
+}
+
+int main(int argc, char *argv[]) {
+  Logger::instance().set_level(LogLevel::ERROR);
+  size_t count = argc > 1 ? std::stoul(argv[1]) : 2000000;
+
+  std::vector<std::string> keys;
+  keys.reserve(count);
+  for (size_t i = 0; i < count; ++i) {
+    keys.push_back("key:" + std::to_string(i));
+  }
+
+  std::cout << "--- 键空间哈希表基准测试（" << count << " 个键）---" << std::endl;
+  std::cout << std::left << std::setw(20) << "实现" << std::right << std::setw(10) << "插入p50"
+            << std::setw(10) << "p99" << std::setw(10) << "p99.9" << std::setw(14) << "最大(ns)"
+            << std::setw(12) << "查找ns" << std::setw(12) << "字节/键" << std::endl;
+  run<UnorderedStorage>("std::unordered_map", keys);
+  run<Storage>("Dict + KvEntry", keys);
+  return 0;
+}
@@ -0,0 +1,148 @@
+#include <chrono>
+#include <cstdlib>
+#include <deque>
+#include <iomanip>
+#include <iostream>
+#include <list>
+#include <malloc.h>
+#include <new>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+import kv_server;
+import buffer;
+import command;
+import value_object;
+import list_object;
+import logger;
+
+// 列表基准测试：百万元素级别的列表
+// - 内存：quicklist 与 std::list<std::string>、std::deque<std::string> 每个元素占用的堆内存
+//   （替换全局 operator new，按 malloc_usable_size 统计实际占用）
+// - 数据结构层：ListObject 两端压入和弹出的每元素耗时
+// - 命令层：RPUSH/LPUSH 每条命令压入一个元素、LPOP/RPOP 每条命令弹出一个元素的耗时（含命令分派和回复编码）
+// 用法: list_benchmark [元素数量，默认 1000000]
+
+static size_t g_live_bytes = 0;
+
+void *operator new(std::size_t size) {
+  if (void *p = std::malloc(size == 0 ? 1 : size)) {
+    g_live_bytes += malloc_usable_size(p);
+    return p;
+  }
+  throw std::bad_alloc();
+}
+void operator delete(void *p) noexcept {
+  if (p) {
+    g_live_bytes -= malloc_usable_size(p);
+  }
+  std::free(p);
+}
+void operator delete(void *p, std::size_t) noexcept { operator delete(p); }
+
+using Clock = std::chrono::steady_clock;
+
+double ns_per_op(Clock::time_point start, size_t ops) {
+  return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / ops;
+}
+
+void print_row(std::string_view name, double value) {
+  std::cout << std::left << std::setw(36) << name << std::right << std::fixed << std::setprecision(1)
+            << std::setw(12) << value << std::endl;
+}
+
+// 构造一个容器并统计每个元素占用的堆内存
+template <typename Fn> double bytes_per_element(size_t count, Fn build) {
+  size_t before = g_live_bytes;
+  auto container = build();
+  return static_cast<double>(g_live_bytes - before) / static_cast<double>(count);
+}
+
+int main(int argc, char *argv[]) {
+  Logger::instance().set_level(LogLevel::ERROR);
+  size_t count = argc > 1 ? std::stoul(argv[1]) : 1000000;
+
+  std::vector<std::string> values;
+  values.reserve(count);
+  for (size_t i = 0; i < count; ++i) {
+    values.push_back("item:" + std::to_string(i));
+  }
+  EncodingConfig config;
+
+  std::cout << "元素数量: " << count << "，元素形如 item:N" << std::endl << std::endl;
+  std::cout << std::left << std::setw(36) << "每元素内存" << std::right << std::setw(12) << "字节" << std::endl;
+  print_row("quicklist", bytes_per_element(count, [&] {
+              auto list = std::make_unique<ListObject>();
+              for (const auto &value : values) {
+                list->push_back(value, config);
+              }
+              return list;
+            }));
+  print_row("std::list<std::string>", bytes_per_element(count, [&] {
+              std::list<std::string> list;
+              for (const auto &value : values) {
+                list.push_back(value);
+              }
+              return list;
+            }));
+  print_row("std::deque<std::string>", bytes_per_element(count, [&] {
+              std::deque<std::string> list;
+              for (const auto &value : values) {
+                list.push_back(value);
+              }
+              return list;
+            }));
+
+  std::cout << std::endl << std::left << std::setw(36) << "每元素耗时" << std::right << std::setw(12) << "ns"
+            << std::endl;
+  {
+    ListObject list;
+    std::string out;
+    auto start = Clock::now();
+    for (const auto &value : values) {
+      list.push_back(value, config);
+    }
+    print_row("ListObject push_back", ns_per_op(start, count));
+    start = Clock::now();
+    while (list.pop_front(out)) {
+    }
+    print_row("ListObject pop_front", ns_per_op(start, count));
+    start = Clock::now();
+    for (const auto &value : values) {
+      list.push_front(value, config);
+    }
+    print_row("ListObject push_front", ns_per_op(start, count));
+    start = Clock::now();
+    while (list.pop_back(out)) {
+    }
+    print_row("ListObject pop_back", ns_per_op(start, count));
+  }
+
+  KVServer server;
+  Buffer out;
+  std::vector<std::string_view> argv;
+  auto run_commands = [&](std::string_view name, std::string_view command, bool with_value) {
+    auto start = Clock::now();
+    for (size_t i = 0; i < count; ++i) {
+      if (with_value) {
+        argv = {command, "list", values[i]};
+      } else {
+        argv = {command, "list"};
+      }
+      server.execute_command(argv, out);
+      // 每 1000 条清空一次输出缓冲区，模拟已写出到 socket
+      if (i % 1000 == 999) {
+        out.retrieve_all();
+      }
+    }
+    out.retrieve_all();
+    print_row(name, ns_per_op(start, count));
+  };
+  run_commands("RPUSH", "RPUSH", true);
+  run_commands("LPOP", "LPOP", false);
+  run_commands("LPUSH", "LPUSH", true);
+  run_commands("RPOP", "RPOP", false);
+  return 0;
+}
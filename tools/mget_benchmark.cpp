@@ -0,0 +1,113 @@
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+import kv_server;
+import buffer;
+import command;
+import logger;
+
+// 多键查找基准测试：键空间远大于缓存，随机取键，每次查找基本都是缓存未命中。
+// - 哈希表层：同一组键逐个 find 与 find_batch（先算哈希、预取，再探测）的每键耗时
+// - 命令层：一条 MGET 与等量的 GET 命令的每键耗时（含命令分派和回复编码）
+// 批量大小为 1、10、100、1000。
+// 用法: mget_benchmark [键数量，默认 4000000]
+
+constexpr size_t BATCH_SIZES[] = {1, 10, 100, 1000};
+constexpr size_t KEYS_PER_ROUND = 200000; // 每个批量大小总共查找的键数
+
+using Clock = std::chrono::steady_clock;
+
+double ns_per_key(Clock::time_point start, size_t keys) {
+  return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / keys;
+}
+
+int main(int argc, char *argv[]) {
+  Logger::instance().set_level(LogLevel::ERROR);
+  size_t count = argc > 1 ? std::stoul(argv[1]) : 4000000;
+
+  std::vector<std::string> keys;
+  keys.reserve(count);
+  for (size_t i = 0; i < count; ++i) {
+    keys.push_back("key:" + std::to_string(i));
+  }
+
+  KVServer server;
+  Storage db;
+  for (const auto &key : keys) {
+    std::vector<std::string_view> argv = {"SET", key, "value-0123456789abcd"};
+    server.execute_command(argv);
+    db.insert(KvEntry::create(key, "value-0123456789abcd"));
+  }
+  db.rehash_for(std::chrono::seconds(10));
+
+  // 预先生成随机查找顺序，不计入耗时
+  std::mt19937 rng(42);
+  std::uniform_int_distribution<size_t> dist(0, count - 1);
+  std::vector<std::string_view> lookups(KEYS_PER_ROUND);
+  for (auto &key : lookups) {
+    key = keys[dist(rng)];
+  }
+
+  std::cout << "--- 多键查找基准测试（键空间 " << count << " 个键，每键耗时 ns）---" << std::endl;
+  std::cout << std::left << std::setw(10) << "批量大小" << std::right << std::setw(14) << "逐个find"
+            << std::setw(14) << "find_batch" << std::setw(14) << "N 条 GET" << std::setw(14) << "MGET"
+            << std::endl;
+
+  Buffer out;
+  std::vector<std::string_view> argv;
+  for (size_t batch : BATCH_SIZES) {
+    size_t rounds = KEYS_PER_ROUND / batch;
+    size_t found = 0;
+
+    auto start = Clock::now();
+    for (size_t r = 0; r < rounds; ++r) {
+      for (size_t i = 0; i < batch; ++i) {
+        found += db.find(lookups[r * batch + i]) != db.end();
+      }
+    }
+    double sequential = ns_per_key(start, rounds * batch);
+
+    start = Clock::now();
+    for (size_t r = 0; r < rounds; ++r) {
+      std::span<const std::string_view> group(lookups.data() + r * batch, batch);
+      db.find_batch(
+          batch, [group](size_t i) { return group[i]; },
+          [&](size_t, Storage::iterator it) { found += it != db.end(); });
+    }
+    double batched = ns_per_key(start, rounds * batch);
+
+    start = Clock::now();
+    for (size_t r = 0; r < rounds; ++r) {
+      for (size_t i = 0; i < batch; ++i) {
+        argv = {"GET", lookups[r * batch + i]};
+        server.execute_command(argv, out);
+      }
+      out.retrieve_all();
+    }
+    double gets = ns_per_key(start, rounds * batch);
+
+    start = Clock::now();
+    for (size_t r = 0; r < rounds; ++r) {
+      argv.assign(1, "MGET");
+      argv.insert(argv.end(), lookups.begin() + r * batch, lookups.begin() + (r + 1) * batch);
+      server.execute_command(argv, out);
+      out.retrieve_all();
+    }
+    double mget = ns_per_key(start, rounds * batch);
+
+    if (found != 2 * rounds * batch) {
+      std::cerr << "查找结果错误" << std::endl;
+    }
+    std::cout << std::left << std::setw(10) << batch << std::right << std::fixed << std::setprecision(1)
+              << std::setw(14) << sequential << std::setw(14) << batched << std::setw(14) << gets
+              << std::setw(14) << mget << std::endl;
+  }
+  return 0;
+}
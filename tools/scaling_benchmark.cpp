@@ -0,0 +1,213 @@
+#include <arpa/inet.h>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <netinet/in.h>
+#include <random>
+#include <sched.h>
+#include <string>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+import application;
+import client_utils;
+
+// 多事件循环扩展性基准测试：
+// 依次以 1, 2, 4 ... N 个事件循环启动服务器（子进程），
+// 用固定数量的客户端线程发送流水线 SET 请求，统计吞吐量随事件循环数量的变化。
+//
+// 事件循环和客户端线程争用同一批 CPU 时测得的是调度开销而不是扩展性，
+// 因此可用的 CPU 少于 事件循环数 + 客户端线程数 的轮次不测量，只报告跳过
+
+constexpr int kBasePort = 17000;
+constexpr size_t kReplySize = 5; // "+OK\r\n"
+
+std::string event_backend = "epoll";
+std::atomic<bool> running{false};
+std::atomic<long long> completed_ops{0};
+
+// 在子进程中启动服务器
+pid_t spawn_server(int loops, int port) {
+  std::string config_file = "scaling_benchmark_" + std::to_string(loops) + ".conf";
+  {
+    std::ofstream config(config_file);
+    config << "port " << port << "\n";
+    config << "loglevel error\n";
+    config << "io-threads " << loops << "\n";
+    config << "event-backend " << event_backend << "\n";
+  }
+
+  pid_t pid = fork();
+  if (pid == 0) {
+    Application app;
+    if (!app.init(config_file)) {
+      _exit(1);
+    }
+    app.run();
+    _exit(0);
+  }
+  return pid;
+}
+
+int connect_to(int port) {
+  int sock = socket(AF_INET, SOCK_STREAM, 0);
+  if (sock == -1) {
+    return -1;
+  }
+  sockaddr_in serv_addr{};
+  serv_addr.sin_family = AF_INET;
+  serv_addr.sin_port = htons(port);
+  inet_pton(AF_INET, "127.0.0.1", &serv_addr.sin_addr);
+  if (connect(sock, (sockaddr *)&serv_addr, sizeof(serv_addr)) < 0) {
+    close(sock);
+    return -1;
+  }
+  return sock;
+}
+
+void client_worker(int port, int client_id, int pipeline) {
+  int sock = -1;
+  // 服务器刚启动时可能还未开始监听，重试几次
+  for (int attempt = 0; attempt < 50 && sock == -1; ++attempt) {
+    sock = connect_to(port);
+    if (sock == -1) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+  }
+  if (sock == -1) {
+    std::cerr << "客户端 " << client_id << " 连接失败" << std::endl;
+    return;
+  }
+
+  std::mt19937 rng(client_id);
+  std::uniform_int_distribution<int> key_dist(0, 1000000);
+  std::vector<char> reply(kReplySize * pipeline);
+
+  while (!running.load()) {
+    std::this_thread::yield();
+  }
+  while (running.load()) {
+    std::string batch;
+    for (int i = 0; i < pipeline; ++i) {
+      batch += common::ClientUtils::serialize_command(
+          "SET key:" + std::to_string(key_dist(rng)) + " value");
+    }
+    if (send(sock, batch.data(), batch.size(), 0) < 0) {
+      break;
+    }
+    size_t received = 0;
+    while (received < reply.size()) {
+      ssize_t n = read(sock, reply.data() + received, reply.size() - received);
+      if (n <= 0) {
+        close(sock);
+        return;
+      }
+      received += n;
+    }
+    completed_ops += pipeline;
+  }
+  close(sock);
+}
+
+// 本进程可以使用的 CPU 数量（考虑 taskset 等设置的亲和性）
+int available_cpus() {
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  if (sched_getaffinity(0, sizeof(set), &set) != 0) {
+    return static_cast<int>(std::thread::hardware_concurrency());
+  }
+  return CPU_COUNT(&set);
+}
+
+double run_round(int loops, int clients, int seconds, int pipeline) {
+  int port = kBasePort + loops;
+  pid_t pid = spawn_server(loops, port);
+  if (pid <= 0) {
+    std::cerr << "启动服务器失败" << std::endl;
+    return 0;
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(300));
+
+  completed_ops = 0;
+  running = false;
+  std::vector<std::thread> threads;
+  for (int i = 0; i < clients; ++i) {
+    threads.emplace_back(client_worker, port, i, pipeline);
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  running = true;
+  std::this_thread::sleep_for(std::chrono::seconds(seconds));
+  running = false;
+  auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start);
+  for (auto &t : threads) {
+    t.join();
+  }
+
+  kill(pid, SIGKILL);
+  waitpid(pid, nullptr, 0);
+  std::remove(("scaling_benchmark_" + std::to_string(loops) + ".conf").c_str());
+  return completed_ops.load() / elapsed.count();
+}
+
+int main(int argc, char *argv[]) {
+  if (argc < 4) {
+    std::cerr << "用法: " << argv[0]
+              << " <最大事件循环数> <客户端数量> <每轮秒数> [流水线深度] [epoll|io_uring]" << std::endl;
+    return 1;
+  }
+  int max_loops = std::stoi(argv[1]);
+  int clients = std::stoi(argv[2]);
+  int seconds = std::stoi(argv[3]);
+  int pipeline = argc > 4 ? std::stoi(argv[4]) : 16;
+  if (argc > 5) {
+    event_backend = argv[5];
+  }
+
+  std::vector<int> rounds;
+  for (int n = 1; n < max_loops; n *= 2) {
+    rounds.push_back(n);
+  }
+  rounds.push_back(max_loops);
+
+  int cpus = available_cpus();
+  std::cout << "--- 多事件循环扩展性测试 ---" << std::endl;
+  std::cout << "客户端数量: " << clients << "，流水线深度: " << pipeline
+            << "，每轮 " << seconds << " 秒，事件后端: " << event_backend
+            << "，可用 CPU: " << cpus << std::endl;
+  std::cout << std::setw(10) << "io-threads" << std::setw(16) << "ops/s"
+            << std::setw(12) << "加速比" << std::setw(12) << "效率" << std::endl;
+
+  double baseline = 0;
+  int measured = 0;
+  for (int loops : rounds) {
+    if (loops + clients > cpus) {
+      std::cout << std::setw(10) << loops << "  跳过：需要 " << loops + clients << " 个 CPU" << std::endl;
+      continue;
+    }
+    ++measured;
+    double qps = run_round(loops, clients, seconds, pipeline);
+    if (baseline == 0) {
+      baseline = qps;
+    }
+    double speedup = baseline > 0 ? qps / baseline : 0;
+    std::cout << std::setw(10) << loops << std::setw(16) << std::fixed
+              << std::setprecision(0) << qps << std::setw(12)
+              << std::setprecision(2) << speedup << std::setw(12)
+              << std::setprecision(2) << speedup / loops << std::endl;
+  }
+  std::cout << "注意：客户端线程与服务器运行在同一台机器上，" << std::endl
+            << "客户端数量应足以压满所有事件循环，并为客户端预留 CPU。" << std::endl;
+  if (measured < static_cast<int>(rounds.size())) {
+    std::cerr << "可用 CPU 不足，未测量全部轮次，结果不能说明扩展性" << std::endl;
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,158 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <malloc.h>
+#include <new>
+#include <random>
+#include <set>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+import kv_server;
+import buffer;
+import command;
+import value_object;
+import intset;
+import logger;
+
+// 集合基准测试：整数标签集合
+// - 内存：intset 与 std::unordered_set<int64_t>、std::set<int64_t> 每个元素占用的堆内存
+//   （替换全局 operator new，按 malloc_usable_size 统计实际占用）
+// - 交集：Intset::intersect（运行时选择的 SIMD 内核）与 std::set_intersection 在不同大小比例下的耗时
+// - 命令层：SISMEMBER 和两个集合的 SINTER 的耗时（含命令分派和回复编码）
+// 用法: set_benchmark [集合大小，默认 10000]
+
+static size_t g_live_bytes = 0;
+
+void *operator new(std::size_t size) {
+  if (void *p = std::malloc(size == 0 ? 1 : size)) {
+    g_live_bytes += malloc_usable_size(p);
+    return p;
+  }
+  throw std::bad_alloc();
+}
+void operator delete(void *p) noexcept {
+  if (p) {
+    g_live_bytes -= malloc_usable_size(p);
+  }
+  std::free(p);
+}
+void operator delete(void *p, std::size_t) noexcept { operator delete(p); }
+
+using Clock = std::chrono::steady_clock;
+
+double ns_per_op(Clock::time_point start, size_t ops) {
+  return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / ops;
+}
+
+void print_row(std::string_view name, double value) {
+  std::cout << std::left << std::setw(40) << name << std::right << std::fixed << std::setprecision(1)
+            << std::setw(12) << value << std::endl;
+}
+
+// 构造一个容器并统计每个元素占用的堆内存
+template <typename Fn> double bytes_per_element(size_t count, Fn build) {
+  size_t before = g_live_bytes;
+  auto container = build();
+  return static_cast<double>(g_live_bytes - before) / static_cast<double>(count);
+}
+
+// 从 [0, range) 中取 count 个不同的整数，升序
+std::vector<int64_t> random_sorted(std::mt19937_64 &rng, size_t count, int64_t range) {
+  std::set<int64_t> picked;
+  std::uniform_int_distribution<int64_t> dist(0, range - 1);
+  while (picked.size() < count) {
+    picked.insert(dist(rng));
+  }
+  return {picked.begin(), picked.end()};
+}
+
+int main(int argc, char *argv[]) {
+  Logger::instance().set_level(LogLevel::ERROR);
+  size_t count = argc > 1 ? std::stoul(argv[1]) : 10000;
+  std::mt19937_64 rng(42);
+
+  // 标签编号取自 [0, 4 * count)，使用 2 或 4 字节宽度
+  std::vector<int64_t> values = random_sorted(rng, count, static_cast<int64_t>(count) * 4);
+  std::cout << "集合大小: " << count << "，交集内核: " << Intset::simd_kernel() << std::endl << std::endl;
+
+  std::cout << std::left << std::setw(40) << "每元素内存" << std::right << std::setw(12) << "字节" << std::endl;
+  print_row("intset", bytes_per_element(count, [&] { return Intset::from_sorted(values); }));
+  print_row("std::unordered_set<int64_t>", bytes_per_element(count, [&] {
+              return std::unordered_set<int64_t>(values.begin(), values.end());
+            }));
+  print_row("std::set<int64_t>", bytes_per_element(count, [&] { return std::set<int64_t>(values.begin(), values.end()); }));
+
+  std::cout << std::endl << std::left << std::setw(40) << "每次交集耗时" << std::right << std::setw(12) << "ns"
+            << std::endl;
+  for (size_t ratio : {1, 8, 64}) {
+    size_t small_size = std::max<size_t>(count / ratio, 1);
+    std::vector<int64_t> small = random_sorted(rng, small_size, static_cast<int64_t>(count) * 4);
+    Intset a = Intset::from_sorted(small);
+    Intset b = Intset::from_sorted(values);
+    const Intset *sets[] = {&a, &b};
+    size_t rounds = std::max<size_t>(1000000 / count, 10);
+    size_t sink = 0;
+    auto start = Clock::now();
+    for (size_t i = 0; i < rounds; ++i) {
+      sink += Intset::intersect(sets).size();
+    }
+    print_row("Intset::intersect 1:" + std::to_string(ratio), ns_per_op(start, rounds));
+    start = Clock::now();
+    for (size_t i = 0; i < rounds; ++i) {
+      std::vector<int64_t> out;
+      std::set_intersection(small.begin(), small.end(), values.begin(), values.end(), std::back_inserter(out));
+      sink += out.size();
+    }
+    print_row("std::set_intersection 1:" + std::to_string(ratio), ns_per_op(start, rounds));
+    if (sink == 0) {
+      std::cout << "(交集为空)" << std::endl;
+    }
+  }
+
+  std::cout << std::endl << std::left << std::setw(40) << "每条命令耗时" << std::right << std::setw(12) << "ns"
+            << std::endl;
+  KVServer server;
+  Buffer out;
+  std::vector<std::string> members;
+  for (int64_t v : values) {
+    members.push_back(std::to_string(v));
+  }
+  std::vector<std::string_view> args = {"SADD", "tags:a"};
+  args.insert(args.end(), members.begin(), members.end());
+  server.execute_command(args, out);
+  args = {"SADD", "tags:b"};
+  for (size_t i = 0; i < members.size(); i += 2) {
+    args.push_back(members[i]);
+  }
+  server.execute_command(args, out);
+  out.retrieve_all();
+
+  size_t lookups = 1000000;
+  auto start = Clock::now();
+  for (size_t i = 0; i < lookups; ++i) {
+    args = {"SISMEMBER", "tags:a", members[i % members.size()]};
+    server.execute_command(args, out);
+    if (i % 1000 == 999) {
+      out.retrieve_all();
+    }
+  }
+  out.retrieve_all();
+  print_row("SISMEMBER", ns_per_op(start, lookups));
+
+  size_t rounds = std::max<size_t>(1000000 / count, 10);
+  start = Clock::now();
+  for (size_t i = 0; i < rounds; ++i) {
+    args = {"SINTER", "tags:a", "tags:b"};
+    server.execute_command(args, out);
+    out.retrieve_all();
+  }
+  print_row("SINTER", ns_per_op(start, rounds));
+  return 0;
+}
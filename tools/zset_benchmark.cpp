@@ -0,0 +1,116 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+import kv_server;
+import buffer;
+import command;
+import logger;
+
+// 有序集合基准测试：排行榜场景
+// - ZADD：逐个加入 N 个成员，记录每条命令的耗时分布（含跳表插入和哈希索引）
+// - ZADD 更新：随机成员改分数，需要在跳表中移动节点
+// - ZRANGE：按排名、按分数区间取前 10 名 / 中间 10 名，以及 ZRANK、ZSCORE 的单点查询
+// 用法: zset_benchmark [成员数，默认 1000000]
+
+using Clock = std::chrono::steady_clock;
+
+double percentile(std::vector<long long> &sorted, double p) {
+  size_t index = static_cast<size_t>(p * (sorted.size() - 1));
+  return static_cast<double>(sorted[index]);
+}
+
+void print_header(std::string_view title) {
+  std::cout << std::left << std::setw(40) << title << std::right << std::setw(10) << "p50" << std::setw(10) << "p99"
+            << std::setw(10) << "p99.9" << std::setw(14) << "最大(ns)" << std::endl;
+}
+
+void print_latencies(std::string_view name, std::vector<long long> &latencies) {
+  std::sort(latencies.begin(), latencies.end());
+  std::cout << std::left << std::setw(40) << name << std::right << std::fixed << std::setprecision(0)
+            << std::setw(10) << percentile(latencies, 0.5) << std::setw(10) << percentile(latencies, 0.99)
+            << std::setw(10) << percentile(latencies, 0.999) << std::setw(14) << latencies.back() << std::endl;
+}
+
+// 执行 rounds 次命令并记录每次的耗时，make_args(i) 返回第 i 次的参数
+template <typename MakeArgs>
+void measure(KVServer &server, std::string_view name, size_t rounds, MakeArgs make_args) {
+  Buffer out;
+  std::vector<long long> latencies;
+  latencies.reserve(rounds);
+  for (size_t i = 0; i < rounds; ++i) {
+    std::vector<std::string_view> args = make_args(i);
+    auto start = Clock::now();
+    server.execute_command(args, out);
+    latencies.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+    out.retrieve_all();
+  }
+  print_latencies(name, latencies);
+}
+
+int main(int argc, char *argv[]) {
+  Logger::instance().set_level(LogLevel::ERROR);
+  size_t count = argc > 1 ? std::stoul(argv[1]) : 1000000;
+  std::mt19937_64 rng(42);
+  std::uniform_int_distribution<int64_t> score_dist(0, 100000000);
+
+  std::vector<std::string> members;
+  std::vector<std::string> scores;
+  members.reserve(count);
+  scores.reserve(count);
+  for (size_t i = 0; i < count; ++i) {
+    members.push_back("player:" + std::to_string(i));
+    scores.push_back(std::to_string(score_dist(rng)));
+  }
+  std::vector<std::string> new_scores;
+  for (size_t i = 0; i < count; ++i) {
+    new_scores.push_back(std::to_string(score_dist(rng)));
+  }
+
+  std::cout << "--- 有序集合基准测试（" << count << " 个成员）---" << std::endl;
+  KVServer server;
+  print_header("写命令");
+  measure(server, "ZADD 新成员", count, [&](size_t i) {
+    return std::vector<std::string_view>{"ZADD", "board", scores[i], members[i]};
+  });
+  std::uniform_int_distribution<size_t> pick(0, count - 1);
+  std::vector<size_t> order(std::min<size_t>(count, 1000000));
+  for (auto &i : order) {
+    i = pick(rng);
+  }
+  measure(server, "ZADD 修改分数", order.size(), [&](size_t i) {
+    return std::vector<std::string_view>{"ZADD", "board", new_scores[order[i]], members[order[i]]};
+  });
+
+  std::cout << std::endl;
+  print_header("读命令");
+  size_t rounds = 100000;
+  measure(server, "ZRANGE 0 9 REV WITHSCORES", rounds, [&](size_t) {
+    return std::vector<std::string_view>{"ZRANGE", "board", "0", "9", "REV", "WITHSCORES"};
+  });
+  std::string middle = std::to_string(count / 2);
+  std::string middle_end = std::to_string(count / 2 + 9);
+  measure(server, "ZRANGE 中间排名 10 个", rounds, [&](size_t) {
+    return std::vector<std::string_view>{"ZRANGE", "board", middle, middle_end};
+  });
+  std::vector<std::string> bounds;
+  for (size_t i = 0; i < rounds; ++i) {
+    bounds.push_back(std::to_string(score_dist(rng)));
+  }
+  measure(server, "ZRANGE BYSCORE LIMIT 0 10", rounds, [&](size_t i) {
+    return std::vector<std::string_view>{"ZRANGE", "board", bounds[i], "+inf", "BYSCORE", "LIMIT", "0", "10"};
+  });
+  measure(server, "ZRANK", rounds, [&](size_t i) {
+    return std::vector<std::string_view>{"ZRANK", "board", members[order[i % order.size()]]};
+  });
+  measure(server, "ZSCORE", rounds, [&](size_t i) {
+    return std::vector<std::string_view>{"ZSCORE", "board", members[order[i % order.size()]]};
+  });
+  return 0;
+}